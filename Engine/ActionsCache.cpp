@@ -0,0 +1,450 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ActionsCache.h"
+
+#include <cassert>
+#include <utility>
+
+
+NATRON_NAMESPACE_ENTER;
+
+// Approximate memory used by the bookkeeping of a node of a std::map or std::list, besides its value
+static std::size_t
+getContainerNodeOverhead()
+{
+    return 4 * sizeof(void*);
+}
+
+static std::size_t
+getFramesNeededSizeInBytes(const FramesNeededMap& framesNeeded)
+{
+    std::size_t size = 0;
+
+    for (FramesNeededMap::const_iterator it = framesNeeded.begin(); it != framesNeeded.end(); ++it) {
+        size += getContainerNodeOverhead() + sizeof(FramesNeededMap::value_type);
+        for (FrameRangesMap::const_iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+            size += getContainerNodeOverhead() + sizeof(FrameRangesMap::value_type) + it2->second.size() * sizeof(RangeD);
+        }
+    }
+
+    return size;
+}
+
+static std::size_t
+getMetadataResultsSizeInBytes(const MetadataActionInputs& inputs,
+                              const NodeMetadata& metadata)
+{
+    std::size_t size = sizeof(MetadataResults) + inputs.connected.size() / 8 + metadata.getSizeInBytes();
+
+    for (std::vector<NodeMetadata>::const_iterator it = inputs.metadatas.begin(); it != inputs.metadatas.end(); ++it) {
+        size += it->getSizeInBytes();
+    }
+
+    return size;
+}
+
+ActionsCache::ActionsCacheInstance::ActionsCacheInstance()
+    : _hash(0)
+    , _timeDomain()
+    , _timeDomainSet(false)
+    , _identityCache()
+    , _rodCache()
+    , _framesNeededCache()
+    , _metadataCache()
+    , _sizeInBytes(0)
+{
+}
+
+ActionsCache::ActionsCacheInstanceList::iterator
+ActionsCache::createActionCacheInternal(U64 newHash)
+{
+    std::map<U64, ActionsCacheInstanceList::iterator>::iterator found = _instancesByHash.find(newHash);
+
+    if ( found != _instancesByHash.end() ) {
+        // Start over with an empty cache for this hash
+        eraseActionCache(found->second);
+    }
+    ActionsCacheInstance cache;
+    cache._hash = newHash;
+    // The instance itself, its node in the LRU list and its entry in the index
+    cache._sizeInBytes = sizeof(ActionsCacheInstance) + 2 * getContainerNodeOverhead() + sizeof(std::pair<U64, ActionsCacheInstanceList::iterator>);
+    _sizeInBytes += cache._sizeInBytes;
+
+    ActionsCacheInstanceList::iterator ret = _instances.insert(_instances.end(), cache);
+    _instancesByHash[newHash] = ret;
+
+    return ret;
+}
+
+ActionsCache::ActionsCacheInstance*
+ActionsCache::findActionCache(U64 hash)
+{
+    std::map<U64, ActionsCacheInstanceList::iterator>::iterator found = _instancesByHash.find(hash);
+
+    if ( found == _instancesByHash.end() ) {
+        return 0;
+    }
+
+    // Mark it as the most recently used, splice does not invalidate iterators
+    _instances.splice(_instances.end(), _instances, found->second);
+
+    return &*found->second;
+}
+
+ActionsCache::ActionsCacheInstance &
+ActionsCache::getOrCreateActionCache(U64 newHash)
+{
+    ActionsCacheInstance* found = findActionCache(newHash);
+
+    if (found) {
+        return *found;
+    }
+
+    return *createActionCacheInternal(newHash);
+}
+
+void
+ActionsCache::eraseActionCache(ActionsCacheInstanceList::iterator it)
+{
+    assert(_sizeInBytes >= it->_sizeInBytes);
+    _sizeInBytes -= it->_sizeInBytes;
+    _instancesByHash.erase(it->_hash);
+    _instances.erase(it);
+}
+
+void
+ActionsCache::addSizeInBytes(ActionsCacheInstance& cache,
+                             std::size_t added,
+                             std::size_t removed)
+{
+    assert(cache._sizeInBytes + added >= removed);
+    cache._sizeInBytes += added;
+    cache._sizeInBytes -= removed;
+    _sizeInBytes += added;
+    _sizeInBytes -= removed;
+}
+
+void
+ActionsCache::evictLeastRecentlyUsed()
+{
+    // The most recently used hash is at the back and is always kept
+    while ( _sizeInBytes > _maxSizeInBytes && _instances.size() > 1 ) {
+        eraseActionCache( _instances.begin() );
+    }
+}
+
+ActionsCache::ActionsCache(std::size_t maxSizeInBytes)
+    : _cacheMutex()
+    , _instances()
+    , _instancesByHash()
+    , _sizeInBytes(0)
+    , _maxSizeInBytes(maxSizeInBytes)
+{
+}
+
+void
+ActionsCache::clearAll()
+{
+    QMutexLocker l(&_cacheMutex);
+
+    _instances.clear();
+    _instancesByHash.clear();
+    _sizeInBytes = 0;
+}
+
+void
+ActionsCache::invalidateAll(U64 newHash)
+{
+    QMutexLocker l(&_cacheMutex);
+
+    createActionCacheInternal(newHash);
+    evictLeastRecentlyUsed();
+}
+
+std::size_t
+ActionsCache::getSizeInBytes() const
+{
+    QMutexLocker l(&_cacheMutex);
+
+    return _sizeInBytes;
+}
+
+std::size_t
+ActionsCache::getNumHashes() const
+{
+    QMutexLocker l(&_cacheMutex);
+
+    return _instances.size();
+}
+
+bool
+ActionsCache::getIdentityResult(U64 hash,
+                                double time,
+                                ViewIdx view,
+                                int* inputNbIdentity,
+                                ViewIdx *inputView,
+                                double* identityTime)
+{
+    QMutexLocker l(&_cacheMutex);
+    ActionsCacheInstance* cache = findActionCache(hash);
+
+    if (!cache) {
+        return false;
+    }
+
+    ActionKey key;
+    key.time = time;
+    key.view = view;
+    key.mipMapLevel = 0;
+
+    IdentityCacheMap::const_iterator found = cache->_identityCache.find(key);
+    if ( found != cache->_identityCache.end() ) {
+        *inputNbIdentity = found->second.inputIdentityNb;
+        *identityTime = found->second.inputIdentityTime;
+        *inputView = found->second.inputView;
+
+        return true;
+    }
+
+    return false;
+}
+
+void
+ActionsCache::setIdentityResult(U64 hash,
+                                double time,
+                                ViewIdx view,
+                                int inputNbIdentity,
+                                ViewIdx inputView,
+                                double identityTime)
+{
+    QMutexLocker l(&_cacheMutex);
+    ActionsCacheInstance & cache = getOrCreateActionCache(hash);
+    ActionKey key;
+
+    key.time = time;
+    key.view = view;
+    key.mipMapLevel = 0;
+
+    IdentityResults v;
+    v.inputIdentityNb = inputNbIdentity;
+    v.inputIdentityTime = identityTime;
+    v.inputView = inputView;
+
+    std::pair<IdentityCacheMap::iterator, bool> ret = cache._identityCache.insert( std::make_pair(key, v) );
+    if (ret.second) {
+        addSizeInBytes(cache, getContainerNodeOverhead() + sizeof(IdentityCacheMap::value_type), 0);
+    } else {
+        ret.first->second = v;
+    }
+    evictLeastRecentlyUsed();
+}
+
+bool
+ActionsCache::getRoDResult(U64 hash,
+                           double time,
+                           ViewIdx view,
+                           unsigned int mipMapLevel,
+                           RectD* rod)
+{
+    QMutexLocker l(&_cacheMutex);
+    ActionsCacheInstance* cache = findActionCache(hash);
+
+    if (!cache) {
+        return false;
+    }
+
+    ActionKey key;
+    key.time = time;
+    key.view = view;
+    key.mipMapLevel = mipMapLevel;
+
+    RoDCacheMap::const_iterator found = cache->_rodCache.find(key);
+    if ( found != cache->_rodCache.end() ) {
+        *rod = found->second;
+
+        return true;
+    }
+
+    return false;
+}
+
+void
+ActionsCache::setRoDResult(U64 hash,
+                           double time,
+                           ViewIdx view,
+                           unsigned int mipMapLevel,
+                           const RectD & rod)
+{
+    QMutexLocker l(&_cacheMutex);
+    ActionsCacheInstance & cache = getOrCreateActionCache(hash);
+    ActionKey key;
+
+    key.time = time;
+    key.view = view;
+    key.mipMapLevel = mipMapLevel;
+
+    std::pair<RoDCacheMap::iterator, bool> ret = cache._rodCache.insert( std::make_pair(key, rod) );
+    if (ret.second) {
+        addSizeInBytes(cache, getContainerNodeOverhead() + sizeof(RoDCacheMap::value_type), 0);
+    } else {
+        ret.first->second = rod;
+    }
+    evictLeastRecentlyUsed();
+}
+
+bool
+ActionsCache::getFramesNeededResult(U64 hash,
+                                    double time,
+                                    ViewIdx view,
+                                    unsigned int mipMapLevel,
+                                    FramesNeededMap* framesNeeded)
+{
+    QMutexLocker l(&_cacheMutex);
+    ActionsCacheInstance* cache = findActionCache(hash);
+
+    if (!cache) {
+        return false;
+    }
+
+    ActionKey key;
+    key.time = time;
+    key.view = view;
+    key.mipMapLevel = mipMapLevel;
+
+    FramesNeededCacheMap::const_iterator found = cache->_framesNeededCache.find(key);
+    if ( found != cache->_framesNeededCache.end() ) {
+        *framesNeeded = found->second;
+
+        return true;
+    }
+
+    return false;
+}
+
+void
+ActionsCache::setFramesNeededResult(U64 hash,
+                                    double time,
+                                    ViewIdx view,
+                                    unsigned int mipMapLevel,
+                                    const FramesNeededMap & framesNeeded)
+{
+    QMutexLocker l(&_cacheMutex);
+    ActionsCacheInstance & cache = getOrCreateActionCache(hash);
+    ActionKey key;
+
+    key.time = time;
+    key.view = view;
+    key.mipMapLevel = mipMapLevel;
+
+    FramesNeededCacheMap::iterator found = cache._framesNeededCache.find(key);
+    if ( found == cache._framesNeededCache.end() ) {
+        cache._framesNeededCache.insert( std::make_pair(key, framesNeeded) );
+        addSizeInBytes(cache, getContainerNodeOverhead() + sizeof(FramesNeededCacheMap::value_type) + getFramesNeededSizeInBytes(framesNeeded), 0);
+    } else {
+        addSizeInBytes( cache, getFramesNeededSizeInBytes(framesNeeded), getFramesNeededSizeInBytes(found->second) );
+        found->second = framesNeeded;
+    }
+    evictLeastRecentlyUsed();
+}
+
+bool
+ActionsCache::getTimeDomainResult(U64 hash,
+                                  double *first,
+                                  double* last)
+{
+    QMutexLocker l(&_cacheMutex);
+    ActionsCacheInstance* cache = findActionCache(hash);
+
+    if ( !cache || !cache->_timeDomainSet ) {
+        return false;
+    }
+    *first = cache->_timeDomain.min;
+    *last = cache->_timeDomain.max;
+
+    return true;
+}
+
+void
+ActionsCache::setTimeDomainResult(U64 hash,
+                                  double first,
+                                  double last)
+{
+    QMutexLocker l(&_cacheMutex);
+    ActionsCacheInstance & cache = getOrCreateActionCache(hash);
+
+    // Stored in the instance itself, already accounted for
+    cache._timeDomainSet = true;
+    cache._timeDomain.min = first;
+    cache._timeDomain.max = last;
+}
+
+bool
+ActionsCache::getMetadataResult(U64 hash,
+                                ViewIdx view,
+                                const MetadataActionInputs& inputs,
+                                StatusEnum* stat,
+                                NodeMetadata* metadata)
+{
+    QMutexLocker l(&_cacheMutex);
+    ActionsCacheInstance* cache = findActionCache(hash);
+
+    if (!cache) {
+        return false;
+    }
+
+    MetadataCacheMap::const_iterator found = cache->_metadataCache.find(view);
+    if ( found == cache->_metadataCache.end() || !(found->second.inputs == inputs) ) {
+        return false;
+    }
+    *stat = found->second.status;
+    *metadata = found->second.metadata;
+
+    return true;
+}
+
+void
+ActionsCache::setMetadataResult(U64 hash,
+                                ViewIdx view,
+                                const MetadataActionInputs& inputs,
+                                StatusEnum stat,
+                                const NodeMetadata& metadata)
+{
+    QMutexLocker l(&_cacheMutex);
+    ActionsCacheInstance & cache = getOrCreateActionCache(hash);
+    MetadataCacheMap::iterator found = cache._metadataCache.find(view);
+
+    if ( found == cache._metadataCache.end() ) {
+        found = cache._metadataCache.insert( std::make_pair( view, MetadataResults() ) ).first;
+        addSizeInBytes(cache, getContainerNodeOverhead() + sizeof(ViewIdx) + getMetadataResultsSizeInBytes(inputs, metadata), 0);
+    } else {
+        addSizeInBytes( cache, getMetadataResultsSizeInBytes(inputs, metadata), getMetadataResultsSizeInBytes(found->second.inputs, found->second.metadata) );
+    }
+    found->second.inputs = inputs;
+    found->second.status = stat;
+    found->second.metadata = metadata;
+    evictLeastRecentlyUsed();
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,207 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_ActionsCache_h
+#define Engine_ActionsCache_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <map>
+#include <list>
+#include <vector>
+#include <cstddef>
+
+#include <QtCore/QMutex>
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/NodeMetadata.h"
+#include "Engine/ParallelRenderArgs.h"
+#include "Engine/RectD.h"
+#include "Engine/ViewIdx.h"
+#include "Engine/EngineFwd.h"
+
+// Memory budget, in bytes, of the action results kept by each node. Animated nodes have a different hash
+// at each frame: the results of as many hashes as fit in the budget are kept, so that scrubbing back and forth
+// on the timeline does not call the actions again.
+#define NATRON_ACTIONS_CACHE_MAX_SIZE_BYTES (256 * 1024)
+
+NATRON_NAMESPACE_ENTER;
+
+struct ActionKey
+{
+    double time;
+    ViewIdx view;
+    unsigned int mipMapLevel;
+};
+
+struct IdentityResults
+{
+    int inputIdentityNb;
+    double inputIdentityTime;
+    ViewIdx inputView;
+};
+
+struct CompareActionsCacheKeys
+{
+    bool operator() (const ActionKey & lhs,
+                     const ActionKey & rhs) const
+    {
+        if (lhs.time < rhs.time) {
+            return true;
+        } else if (lhs.time == rhs.time) {
+            if (lhs.mipMapLevel < rhs.mipMapLevel) {
+                return true;
+            } else if (lhs.mipMapLevel == rhs.mipMapLevel) {
+                if (lhs.view < rhs.view) {
+                    return true;
+                } else {
+                    return false;
+                }
+            } else {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+};
+
+typedef std::map<ActionKey, IdentityResults, CompareActionsCacheKeys> IdentityCacheMap;
+typedef std::map<ActionKey, RectD, CompareActionsCacheKeys> RoDCacheMap;
+typedef std::map<ActionKey, FramesNeededMap, CompareActionsCacheKeys> FramesNeededCacheMap;
+
+/**
+ * @brief What the getPreferredMetaDatas action depends on besides the parameters of the node:
+ * the metadata of each input, or nothing if it is disconnected.
+ **/
+struct MetadataActionInputs
+{
+    std::vector<bool> connected;
+    std::vector<NodeMetadata> metadatas;
+
+    bool operator==(const MetadataActionInputs& other) const
+    {
+        return connected == other.connected && metadatas == other.metadatas;
+    }
+};
+
+struct MetadataResults
+{
+    MetadataActionInputs inputs;
+    StatusEnum status;
+    NodeMetadata metadata;
+};
+
+typedef std::map<ViewIdx, MetadataResults> MetadataCacheMap;
+
+/**
+ * @brief This class stores all results of the following actions:
+   - getRegionOfDefinition (invalidated on hash change, mapped across time + scale)
+   - getTimeDomain (invalidated on hash change, only 1 value possible
+   - isIdentity (invalidated on hash change,mapped across time + scale)
+   - getFramesNeeded (invalidated on hash change, mapped across time)
+   - getPreferredMetaDatas (invalidated on hash change or when the metadata of an input changes, mapped across view)
+ * Results are kept for the least recently used hashes so that they survive across renders, as long as their
+ * approximate size does not exceed the memory budget given to the constructor. The results of the most recently
+ * used hash are always kept.
+ * The reason we store them is that the OFX Clip API can potentially call these actions recursively
+ * but this is forbidden by the spec:
+ * http://openfx.sourceforge.net/Documentation/1.3/ofxProgrammingReference.html#id475585
+ **/
+class ActionsCache
+{
+public:
+    ActionsCache(std::size_t maxSizeInBytes);
+
+    void clearAll();
+
+    void invalidateAll(U64 newHash);
+
+    /**
+     * @brief Returns the approximate memory used by the results currently held, in bytes.
+     **/
+    std::size_t getSizeInBytes() const;
+
+    /**
+     * @brief Returns the number of hashes for which results are currently held.
+     **/
+    std::size_t getNumHashes() const;
+
+    bool getIdentityResult(U64 hash, double time, ViewIdx view, int* inputNbIdentity, ViewIdx *inputView, double* identityTime);
+
+    void setIdentityResult(U64 hash, double time, ViewIdx view, int inputNbIdentity, ViewIdx inputView, double identityTime);
+
+    bool getRoDResult(U64 hash, double time, ViewIdx view, unsigned int mipMapLevel, RectD* rod);
+
+    void setRoDResult(U64 hash, double time, ViewIdx view, unsigned int mipMapLevel, const RectD & rod);
+
+    bool getFramesNeededResult(U64 hash, double time, ViewIdx view, unsigned int mipMapLevel, FramesNeededMap* framesNeeded);
+
+    void setFramesNeededResult(U64 hash, double time, ViewIdx view, unsigned int mipMapLevel, const FramesNeededMap & framesNeeded);
+
+    bool getTimeDomainResult(U64 hash, double *first, double* last);
+
+    void setTimeDomainResult(U64 hash, double first, double last);
+
+    bool getMetadataResult(U64 hash, ViewIdx view, const MetadataActionInputs& inputs, StatusEnum* stat, NodeMetadata* metadata);
+
+    void setMetadataResult(U64 hash, ViewIdx view, const MetadataActionInputs& inputs, StatusEnum stat, const NodeMetadata& metadata);
+
+private:
+    mutable QMutex _cacheMutex; //< protects everything in the cache
+    struct ActionsCacheInstance
+    {
+        U64 _hash;
+        OfxRangeD _timeDomain;
+        bool _timeDomainSet;
+        IdentityCacheMap _identityCache;
+        RoDCacheMap _rodCache;
+        FramesNeededCacheMap _framesNeededCache;
+        MetadataCacheMap _metadataCache;
+
+        // Approximate memory used by this instance and its results
+        std::size_t _sizeInBytes;
+
+        ActionsCacheInstance();
+    };
+
+    typedef std::list<ActionsCacheInstance> ActionsCacheInstanceList;
+
+    //In  a list to track the LRU: the most recently used is at the back
+    ActionsCacheInstanceList _instances;
+    std::map<U64, ActionsCacheInstanceList::iterator> _instancesByHash;
+    std::size_t _sizeInBytes;
+    std::size_t _maxSizeInBytes;
+    ActionsCacheInstanceList::iterator createActionCacheInternal(U64 newHash);
+    ActionsCacheInstance & getOrCreateActionCache(U64 newHash);
+    ActionsCacheInstance* findActionCache(U64 hash);
+    void eraseActionCache(ActionsCacheInstanceList::iterator it);
+    void addSizeInBytes(ActionsCacheInstance& cache, std::size_t added, std::size_t removed);
+    void evictLeastRecentlyUsed();
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_ActionsCache_h
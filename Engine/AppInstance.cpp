@@ -26,6 +26,7 @@
 
 #include <fstream>
 #include <list>
+#include <set>
 #include <cassert>
 #include <stdexcept>
 
@@ -145,6 +146,16 @@ struct RenderQueueItem
     QString sequenceName;
     QString savePath;
     ProcessHandlerPtr process;
+
+    // Writers rendered together with work.writer, @see OutputEffectInstance::setCombinedRenderWriters
+    std::list<OutputEffectInstancePtr> combinedWriters;
+};
+
+struct CombinedRenderGroup
+{
+    RenderQueueItem item;
+    std::set<NodePtr> upstreamNodes;
+    bool canCombine;
 };
 
 class CreateNodeStackItem
@@ -228,6 +239,9 @@ public:
 
     mutable QMutex renderQueueMutex;
     std::list<RenderQueueItem> renderQueue, activeRenders;
+    // Number of renders that were aborted or failed, see AppInstance::renderJob
+    QMutex failedRendersMutex;
+    int failedRendersCount;
     mutable QMutex invalidExprKnobsMutex;
     std::list<KnobIWPtr> invalidExprKnobs;
 
@@ -255,6 +269,8 @@ public:
         , renderQueueMutex()
         , renderQueue()
         , activeRenders()
+        , failedRendersMutex()
+        , failedRendersCount(0)
         , invalidExprKnobsMutex()
         , invalidExprKnobs()
         , projectBeingLoaded()
@@ -279,6 +295,8 @@ public:
 
     void startRenderingFullSequence(bool blocking, const RenderQueueItem& writerWork);
 
+    void combineRenderQueueItems(std::list<RenderQueueItem>* items);
+
     void checkNumberOfNonFloatingPanes();
 
 };
@@ -666,83 +684,8 @@ AppInstance::loadInternal(const CLArgs& cl,
     ///if the app is a background project autorun and the project name is empty just throw an exception.
     if ( ( (appPTR->getAppType() == AppManager::eAppTypeBackgroundAutoRun) ||
            ( appPTR->getAppType() == AppManager::eAppTypeBackgroundAutoRunLaunchedFromGui) ) ) {
-        const QString& scriptFilename =  cl.getScriptFilename();
-
-        if ( scriptFilename.isEmpty() ) {
-            // cannot start a background process without a file
-            throw std::invalid_argument( tr("Project file name is empty.").toStdString() );
-        }
-
-
-        QFileInfo info(scriptFilename);
-        if ( !info.exists() ) {
-            throw std::invalid_argument( tr("%1: No such file.").arg(scriptFilename).toStdString() );
-        }
-
-        std::list<AppInstance::RenderWork> writersWork;
-
-
-        if ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ) {
-            ///Load the project
-            if ( !_imp->_currentProject->loadProject( info.path(), info.fileName() ) ) {
-                throw std::invalid_argument( tr("Project file loading failed.").toStdString() );
-            }
-        } else if ( info.suffix() == QString::fromUtf8("py") ) {
-            ///Load the python script
-            loadPythonScript(info);
-        } else {
-            throw std::invalid_argument( tr("%1 only accepts python scripts or .ntp project files.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ).toStdString() );
-        }
-
-
-        ///exec the python script specified via --onload
-        if ( !extraOnProjectCreatedScript.isEmpty() ) {
-            QFileInfo cbInfo(extraOnProjectCreatedScript);
-            if ( cbInfo.exists() ) {
-                loadPythonScript(cbInfo);
-            }
-        }
-
-
-        getWritersWorkForCL(cl, writersWork);
-
-
-        ///Set reader parameters if specified from the command-line
-        const std::list<CLArgs::ReaderArg>& readerArgs = cl.getReaderArgs();
-        for (std::list<CLArgs::ReaderArg>::const_iterator it = readerArgs.begin(); it != readerArgs.end(); ++it) {
-            std::string readerName = it->name.toStdString();
-            NodePtr readNode = getNodeByFullySpecifiedName(readerName);
-
-            if (!readNode) {
-                std::string exc( tr("%1 does not belong to the project file. Please enter a valid Read node script-name.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
-                throw std::invalid_argument(exc);
-            } else {
-                if ( !readNode->getEffectInstance()->isReader() ) {
-                    std::string exc( tr("%1 is not a Read node! It cannot render anything.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
-                    throw std::invalid_argument(exc);
-                }
-            }
-
-            if ( it->filename.isEmpty() ) {
-                std::string exc( tr("%1: Filename specified is empty but [-i] or [--reader] was passed to the command-line.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
-                throw std::invalid_argument(exc);
-            }
-            KnobIPtr fileKnob = readNode->getKnobByName(kOfxImageEffectFileParamName);
-            if (fileKnob) {
-                KnobFilePtr outFile = toKnobFile(fileKnob);
-                if (outFile) {
-                    outFile->setValue( it->filename.toStdString() );
-                }
-            }
-        }
-
-        ///launch renders
-        if ( !writersWork.empty() ) {
-            startWritersRendering(false, writersWork);
-        } else {
-            std::list<std::string> writers;
-            startWritersRenderingFromNames( cl.areRenderStatsEnabled(), false, writers, cl.getFrameRanges() );
-        }
+        loadProjectFromCommandLine(cl);
+        renderFromCommandLine(cl);
     } else if (appPTR->getAppType() == AppManager::eAppTypeInterpreter) {
         QFileInfo info( cl.getScriptFilename() );
         if ( info.exists() ) {
@@ -776,6 +719,116 @@ AppInstance::loadInternal(const CLArgs& cl,
     }
 } // AppInstance::load
 
+void
+AppInstance::loadProjectFromCommandLine(const CLArgs& cl)
+{
+    const QString& extraOnProjectCreatedScript = cl.getDefaultOnProjectLoadedScript();
+    const QString& scriptFilename =  cl.getScriptFilename();
+
+    if ( scriptFilename.isEmpty() ) {
+        // cannot start a background process without a file
+        throw std::invalid_argument( tr("Project file name is empty.").toStdString() );
+    }
+
+
+    QFileInfo info(scriptFilename);
+    if ( !info.exists() ) {
+        throw std::invalid_argument( tr("%1: No such file.").arg(scriptFilename).toStdString() );
+    }
+
+    if ( info.suffix() == QString::fromUtf8(NATRON_PROJECT_FILE_EXT) ) {
+        ///Load the project
+        if ( !_imp->_currentProject->loadProject( info.path(), info.fileName() ) ) {
+            throw std::invalid_argument( tr("Project file loading failed.").toStdString() );
+        }
+    } else if ( info.suffix() == QString::fromUtf8("py") ) {
+        ///Load the python script
+        loadPythonScript(info);
+    } else {
+        throw std::invalid_argument( tr("%1 only accepts python scripts or .ntp project files.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ).toStdString() );
+    }
+
+
+    ///exec the python script specified via --onload
+    if ( !extraOnProjectCreatedScript.isEmpty() ) {
+        QFileInfo cbInfo(extraOnProjectCreatedScript);
+        if ( cbInfo.exists() ) {
+            loadPythonScript(cbInfo);
+        }
+    }
+} // AppInstance::loadProjectFromCommandLine
+
+void
+AppInstance::renderFromCommandLine(const CLArgs& cl)
+{
+    std::list<AppInstance::RenderWork> writersWork;
+    getWritersWorkForCL(cl, writersWork);
+
+
+    ///Set reader parameters if specified from the command-line
+    const std::list<CLArgs::ReaderArg>& readerArgs = cl.getReaderArgs();
+    for (std::list<CLArgs::ReaderArg>::const_iterator it = readerArgs.begin(); it != readerArgs.end(); ++it) {
+        std::string readerName = it->name.toStdString();
+        NodePtr readNode = getNodeByFullySpecifiedName(readerName);
+
+        if (!readNode) {
+            std::string exc( tr("%1 does not belong to the project file. Please enter a valid Read node script-name.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
+            throw std::invalid_argument(exc);
+        } else {
+            if ( !readNode->getEffectInstance()->isReader() ) {
+                std::string exc( tr("%1 is not a Read node! It cannot render anything.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
+                throw std::invalid_argument(exc);
+            }
+        }
+
+        if ( it->filename.isEmpty() ) {
+            std::string exc( tr("%1: Filename specified is empty but [-i] or [--reader] was passed to the command-line.").arg( QString::fromUtf8( readerName.c_str() ) ).toStdString() );
+            throw std::invalid_argument(exc);
+        }
+        KnobIPtr fileKnob = readNode->getKnobByName(kOfxImageEffectFileParamName);
+        if (fileKnob) {
+            KnobFilePtr outFile = toKnobFile(fileKnob);
+            if (outFile) {
+                outFile->setValue( it->filename.toStdString() );
+            }
+        }
+    }
+
+    ///launch renders
+    if ( !writersWork.empty() ) {
+        startWritersRendering(false, writersWork);
+    } else {
+        std::list<std::string> writers;
+        startWritersRenderingFromNames( cl.areRenderStatsEnabled(), false, writers, cl.getFrameRanges() );
+    }
+} // AppInstance::renderFromCommandLine
+
+void
+AppInstance::renderJob(const CLArgs& cl)
+{
+    loadProjectFromCommandLine(cl);
+
+    // The Python commands of a job are overrides applied to the loaded project, unlike on the command-line
+    // where they are executed before loading
+    _imp->executeCommandLinePythonCommands(cl);
+
+    {
+        QMutexLocker k(&_imp->failedRendersMutex);
+        _imp->failedRendersCount = 0;
+    }
+
+    renderFromCommandLine(cl);
+
+    int failedRendersCount;
+    {
+        QMutexLocker k(&_imp->failedRendersMutex);
+        failedRendersCount = _imp->failedRendersCount;
+    }
+    if (failedRendersCount > 0) {
+        throw std::runtime_error( tr("%1 render(s) failed or were aborted.").arg(failedRendersCount).toStdString() );
+    }
+}
+
 bool
 AppInstance::loadPythonScriptAndReportToScriptEditor(const QString& script)
 {
@@ -1477,9 +1530,9 @@ AppInstance::questionDialog(const std::string & title,
 }
 
 void
-AppInstance::triggerAutoSave()
+AppInstance::triggerAutoSave(const NodePtr& changedNode)
 {
-    _imp->_currentProject->triggerAutoSave();
+    _imp->_currentProject->triggerAutoSave(changedNode);
 }
 
 void
@@ -1577,22 +1630,32 @@ AppInstance::startWritersRendering(bool doBlockingRender,
         }
         _imp->getSequenceNameFromWriter(it->writer, &item.sequenceName);
         item.savePath = savePath;
+        itemsToQueue.push_back(item);
+    }
 
+    // Writers that share nodes upstream are rendered together, frame by frame, by the first writer of their group
+    if ( !renderInSeparateProcess && appPTR->getCurrentSettings()->isRenderWritersTogetherEnabled() ) {
+        _imp->combineRenderQueueItems(&itemsToQueue);
+    }
+
+    for (std::list<RenderQueueItem>::iterator it = itemsToQueue.begin(); it != itemsToQueue.end(); ++it) {
+        RenderQueueItem& item = *it;
         if (renderInSeparateProcess) {
             item.process.reset( new ProcessHandler(savePath, item.work.writer) );
             QObject::connect( item.process.get(), SIGNAL(processFinished(int)), this, SLOT(onBackgroundRenderProcessFinished()) );
         } else {
             QObject::connect(item.work.writer->getRenderEngine().get(), SIGNAL(renderFinished(int)), this, SLOT(onQueuedRenderFinished(int)), Qt::UniqueConnection);
+            // Direct connection: the main thread may be blocked until the render is done
+            QObject::connect(item.work.writer->getRenderEngine().get(), SIGNAL(renderFinished(int)), this, SLOT(onRenderFinishedRecordStatus(int)), (Qt::ConnectionType)(Qt::DirectConnection | Qt::UniqueConnection));
         }
 
         bool canPause = !item.work.writer->isVideoWriter();
 
-        if (!it->isRestart) {
+        if (!item.work.isRestart) {
             notifyRenderStarted(item.sequenceName, item.work.firstFrame, item.work.lastFrame, item.work.frameStep, canPause, item.work.writer, item.process);
         } else {
             notifyRenderRestarted(item.work.writer, item.process);
         }
-        itemsToQueue.push_back(item);
     }
     if ( itemsToQueue.empty() ) {
         return;
@@ -1627,6 +1690,68 @@ AppInstance::startWritersRendering(bool doBlockingRender,
     }
 } // AppInstance::startWritersRendering
 
+/**
+ * @brief Merges the items of writers rendering the same frame range and sharing nodes upstream into the item of the first
+ * of them. Writers that must write their frames in order are not merged since they are called by the scheduler thread
+ * rather than by the render threads.
+ **/
+void
+AppInstancePrivate::combineRenderQueueItems(std::list<RenderQueueItem>* items)
+{
+    // The writers of a group render the views of the first writer
+    if (_currentProject->getProjectViewsCount() > 1) {
+        return;
+    }
+
+    std::list<CombinedRenderGroup> groups;
+
+    for (std::list<RenderQueueItem>::const_iterator it = items->begin(); it != items->end(); ++it) {
+        const AppInstance::RenderWork& work = it->work;
+        bool canCombine = !work.isRestart && !work.writer->isVideoWriter() &&
+                          work.writer->getSequentialPreference() != eSequentialPreferenceOnlySequential;
+        std::set<NodePtr> upstreamNodes;
+        if (canCombine) {
+            work.writer->getNode()->getAllUpstreamNodes(&upstreamNodes);
+        }
+
+        bool combined = false;
+        for (std::list<CombinedRenderGroup>::iterator group = groups.begin(); canCombine && group != groups.end(); ++group) {
+            const AppInstance::RenderWork& groupWork = group->item.work;
+            if ( !group->canCombine || (groupWork.firstFrame != work.firstFrame) || (groupWork.lastFrame != work.lastFrame) ||
+                 (groupWork.frameStep != work.frameStep) || (groupWork.useRenderStats != work.useRenderStats) ) {
+                continue;
+            }
+            bool sharesNodes = false;
+            for (std::set<NodePtr>::const_iterator node = upstreamNodes.begin(); node != upstreamNodes.end(); ++node) {
+                if ( group->upstreamNodes.find(*node) != group->upstreamNodes.end() ) {
+                    sharesNodes = true;
+                    break;
+                }
+            }
+            if (!sharesNodes) {
+                continue;
+            }
+            group->item.combinedWriters.push_back(work.writer);
+            group->item.sequenceName += QString::fromUtf8(", ") + it->sequenceName;
+            group->upstreamNodes.insert( upstreamNodes.begin(), upstreamNodes.end() );
+            combined = true;
+            break;
+        }
+        if (!combined) {
+            CombinedRenderGroup group;
+            group.item = *it;
+            group.upstreamNodes.swap(upstreamNodes);
+            group.canCombine = canCombine;
+            groups.push_back(group);
+        }
+    }
+
+    items->clear();
+    for (std::list<CombinedRenderGroup>::const_iterator it = groups.begin(); it != groups.end(); ++it) {
+        items->push_back(it->item);
+    }
+} // AppInstancePrivate::combineRenderQueueItems
+
 void
 AppInstancePrivate::getSequenceNameFromWriter(const OutputEffectInstancePtr& writer,
                                               QString* sequenceName)
@@ -1690,6 +1815,10 @@ void
 AppInstancePrivate::startRenderingFullSequence(bool blocking,
                                                const RenderQueueItem& w)
 {
+    if (!w.process) {
+        w.work.writer->setCombinedRenderWriters(w.combinedWriters);
+    }
+
     if (blocking) {
         BlockingBackgroundRender backgroundRender(w.work.writer);
         backgroundRender.blockingRender(w.work.useRenderStats, w.work.firstFrame, w.work.lastFrame, w.work.frameStep); //< doesn't return before rendering is finished
@@ -1710,6 +1839,16 @@ AppInstancePrivate::startRenderingFullSequence(bool blocking,
     }
 }
 
+void
+AppInstance::onRenderFinishedRecordStatus(int retCode)
+{
+    // Called from the render thread
+    if (retCode != 0) {
+        QMutexLocker k(&_imp->failedRendersMutex);
+        ++_imp->failedRendersCount;
+    }
+}
+
 void
 AppInstance::onQueuedRenderFinished(int /*retCode*/)
 {
@@ -143,6 +143,14 @@ public:
 
     void load(const CLArgs& cl, bool makeEmptyInstance);
 
+    /**
+     * @brief Render a job received by a render server (see RenderServer): the project or script given in the arguments
+     * is loaded in this instance, then the Python commands of the job are executed as overrides and the writers rendered.
+     * This is blocking. The caller is responsible for resetting the project afterwards.
+     * Throws an exception if the job could not be rendered or if any of its renders failed or was aborted.
+     **/
+    void renderJob(const CLArgs& cl);
+
 protected:
 
     virtual void loadInternal(const CLArgs& cl, bool makeEmptyInstance);
@@ -497,7 +505,7 @@ public Q_SLOTS:
 
     virtual void redrawAllViewers() {}
 
-    void triggerAutoSave();
+    void triggerAutoSave(const NodePtr& changedNode = NodePtr());
 
     void clearOpenFXPluginsCaches();
 
@@ -511,6 +519,8 @@ public Q_SLOTS:
 
     void onQueuedRenderFinished(int retCode);
 
+    void onRenderFinishedRecordStatus(int retCode);
+
 Q_SIGNALS:
 
     void pluginsPopulated();
@@ -533,6 +543,10 @@ private:
 
     void getWritersWorkForCL(const CLArgs& cl, std::list<AppInstance::RenderWork>& requests);
 
+    void loadProjectFromCommandLine(const CLArgs& cl);
+
+    void renderFromCommandLine(const CLArgs& cl);
+
     bool openFileDialogIfNeeded(const CreateNodeArgsPtr& args);
 
     NodePtr createNodeInternal(const CreateNodeArgsPtr& args);
@@ -104,6 +104,7 @@
 #include "Engine/PrecompNode.h"
 #include "Engine/ReadNode.h"
 #include "Engine/RotoPaint.h"
+#include "Engine/RotoBezierTriangulation.h"
 #include "Engine/RotoShapeRenderNode.h"
 #include "Engine/RotoShapeRenderCairo.h"
 #include "Engine/StandardPaths.h"
@@ -598,6 +599,10 @@ AppManager::~AppManager()
 
 
     _imp->_backgroundIPC.reset();
+    _imp->_renderServer.reset();
+
+    // Stop reading files ahead, the renders are finished
+    _imp->readAheadPool.reset();
 
     try {
         _imp->saveCaches();
@@ -1065,6 +1070,7 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
         _imp->_diskCache.reset( new ImageCache("DiskCache", NATRON_CACHE_VERSION, maxDiskCacheNode, 0.) );
         _imp->_viewerCache.reset( new FrameEntryCache("ViewerCache", NATRON_CACHE_VERSION, viewerCacheSize, 0.) );
         _imp->setViewerCacheTileSize();
+        _imp->readAheadPool.reset( new ReadAheadIOPool() );
     } catch (std::logic_error) {
         // ignore
     }
@@ -1109,9 +1115,21 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
         _imp->initProcessInputChannel( cl.getIPCPipeName() );
     }
 
+    if ( isBackground() && !cl.getRenderServerName().isEmpty() ) {
+        _imp->_renderServer.reset( new RenderServer( cl.getRenderServerName() ) );
+        if ( !_imp->_renderServer->isListening() ) {
+            _imp->_renderServer.reset();
+            qApp->quit();
+
+            return false;
+        }
+    }
+
 
     if ( cl.isInterpreterMode() ) {
         _imp->_appType = eAppTypeInterpreter;
+    } else if (_imp->_renderServer) {
+        _imp->_appType = eAppTypeRenderServer;
     } else if ( isBackground() ) {
         if ( !cl.getScriptFilename().isEmpty() ) {
             if ( !cl.getIPCPipeName().isEmpty() ) {
@@ -1146,9 +1164,15 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
     } else {
         onLoadCompleted();
 
+        if (_imp->_appType == eAppTypeRenderServer) {
+            // Does not return until the server is asked to quit
+            _imp->runRenderServer(mainInstance);
+        }
+
         ///In background project auto-run the rendering is finished at this point, just exit the instance
         if ( ( (_imp->_appType == eAppTypeBackgroundAutoRun) ||
                ( _imp->_appType == eAppTypeBackgroundAutoRunLaunchedFromGui) ||
+               ( _imp->_appType == eAppTypeRenderServer) ||
                ( _imp->_appType == eAppTypeInterpreter) ) && mainInstance ) {
             bool wasKilled = true;
             const AppInstanceVec& instances = appPTR->getAppInstances();
@@ -1396,6 +1420,7 @@ AppManager::clearAllCaches()
 
     clearDiskCache();
     clearNodeCache();
+    RotoBezierTriangulation::clearTrianglesCache();
 
 
     ///for each app instance clear all its nodes cache
@@ -1465,6 +1490,9 @@ AppManager::writeToOutputPipe(const QString & longMessage,
                               const QString & shortMessage,
                               bool printIfNoChannel)
 {
+    if ( _imp->_renderServer && _imp->_renderServer->writeToClient(shortMessage) ) {
+        return true;
+    }
     if (!_imp->_backgroundIPC) {
         if (printIfNoChannel) {
             QMutexLocker k(&_imp->errorLogMutex);
@@ -2477,6 +2505,30 @@ AppManager::removeAllCacheEntriesForPlugin(const std::string& pluginID)
     _imp->_viewerCache->removeAllEntriesForPluginPublic(pluginID, false);
 }
 
+void
+AppManager::reservePlaybackCache(const void* owner,
+                                 int firstFrame,
+                                 int lastFrame,
+                                 std::size_t bytes)
+{
+    _imp->_nodeCache->pinTimeRange(owner, firstFrame, lastFrame);
+    _imp->_viewerCache->pinTimeRange(owner, firstFrame, lastFrame);
+    _imp->_viewerCache->reserveMemory(owner, bytes);
+}
+
+void
+AppManager::releasePlaybackCache(const void* owner)
+{
+    _imp->_nodeCache->unpinTimeRange(owner);
+    _imp->_viewerCache->unpinTimeRange(owner);
+    _imp->_viewerCache->releaseReservedMemory(owner);
+
+    // The images and textures of the play range are no longer needed by the playback
+    _imp->_nodeCache->lowerCachePriority(eCacheEntryPriorityPlayback);
+    _imp->_diskCache->lowerCachePriority(eCacheEntryPriorityPlayback);
+    _imp->_viewerCache->lowerCachePriority(eCacheEntryPriorityPlayback);
+}
+
 void
 AppManager::queueEntriesForDeletion(const std::list<ImagePtr>& images)
 {
@@ -2541,6 +2593,36 @@ AppManager::printCacheMemoryStats() const
     reportStr += printAsRAM(totalRam);
     reportStr += QLatin1String(" Disk: ");
     reportStr += printAsRAM(totalDisk);
+    reportStr += QLatin1String("\n");
+
+    // Cache effectiveness of each node: the time saved per byte of cache used tells which nodes are worth caching
+    reportStr += QLatin1String("-------------------------------\n");
+    const AppInstanceVec& instances = getAppInstances();
+    for (AppInstanceVec::const_iterator it = instances.begin(); it != instances.end(); ++it) {
+        NodesList nodes;
+        (*it)->getProject()->getNodes_recursive(nodes, false);
+        for (NodesList::iterator it2 = nodes.begin(); it2 != nodes.end(); ++it2) {
+            NodeCacheStats stats;
+            (*it2)->getCacheStats(&stats);
+            if ( (stats.hits == 0) && (stats.misses == 0) ) {
+                continue;
+            }
+            reportStr += QString::fromUtf8( (*it2)->getFullyQualifiedName().c_str() );
+            reportStr += QLatin1String("--> ");
+            reportStr += tr("Hit rate: %1%").arg(100. * stats.hits / (stats.hits + stats.misses), 0, 'f', 1);
+            reportStr += QLatin1String(" ");
+            reportStr += tr("Saved: %1 s").arg(stats.savedTime, 0, 'f', 3);
+            reportStr += QLatin1String(" ");
+            reportStr += tr("Saved per MB cached: %1 ms").arg(stats.cachedBytes > 0 ? stats.savedTime * 1000. * 1024. * 1024. / stats.cachedBytes : 0., 0, 'f', 3);
+            reportStr += QLatin1String(" ");
+            reportStr += tr("Render cost per MB: %1 ms").arg(stats.getRenderCostPerByte() * 1000. * 1024. * 1024., 0, 'f', 3);
+            if ( (*it2)->isCheapToRender() ) {
+                reportStr += QLatin1String(" ");
+                reportStr += tr("(not cached)");
+            }
+            reportStr += QLatin1String("\n");
+        }
+    }
 
 
     appPTR->writeToErrorLog_mt_safe(tr("Cache Report"), QDateTime::currentDateTime(), reportStr);
@@ -3574,6 +3656,12 @@ AppManager::getPluginContextAndDescribe(OFX::Host::ImageEffect::ImageEffectPlugi
     return _imp->ofxHost->getPluginContextAndDescribe(plugin, ctx);
 }
 
+OFX::Host::ImageEffect::ImageEffectPlugin*
+AppManager::getOfxPlugin(const PluginPtr& plugin)
+{
+    return _imp->ofxHost->getOfxPlugin(plugin);
+}
+
 std::list<std::string>
 AppManager::getNatronPath()
 {
@@ -3794,6 +3882,12 @@ AppManager::getGPUContextPool() const
     return _imp->renderingContextPool.get();
 }
 
+ReadAheadIOPool*
+AppManager::getReadAheadIOPool() const
+{
+    return _imp->readAheadPool.get();
+}
+
 void
 AppManager::refreshOpenGLRenderingFlagOnAllInstances()
 {
@@ -108,6 +108,8 @@ public:
 
         eAppTypeBackgroundAutoRunLaunchedFromGui, //same as eAppTypeBackgroundAutoRun but a bg process launched by GUI of a main process
 
+        eAppTypeRenderServer, //< a background AppInstance that renders the jobs received over a local socket until asked to quit
+
         eAppTypeInterpreter, //< running in Python interpreter mode
 
         eAppTypeGui //< a GUI AppInstance, the end-user can interact with it.
@@ -248,6 +250,20 @@ public:
      **/
     void removeAllCacheEntriesForPlugin(const std::string& pluginID);
 
+    /**
+     * @brief Protects the play range of a viewer from the renders of a lower priority (previews, analysis...):
+     * the images and textures rendered for the viewer in [firstFrame, lastFrame] are pinned and the given amount
+     * of memory is reserved for the textures of playback in the viewer cache.
+     * Calling it again replaces what was reserved by the same owner.
+     **/
+    void reservePlaybackCache(const void* owner, int firstFrame, int lastFrame, std::size_t bytes);
+
+    /**
+     * @brief Releases what was reserved by reservePlaybackCache(). The entries the playback raised to the
+     * playback priority class go back to the class they had before.
+     **/
+    void releasePlaybackCache(const void* owner);
+
 
     /**
      * @brief Adds images to delete in a separate thread
@@ -512,9 +528,15 @@ public:
 
     OFX::Host::ImageEffect::Descriptor* getPluginContextAndDescribe(OFX::Host::ImageEffect::ImageEffectPlugin* plugin,
                                                                     ContextEnum* ctx);
+
+    /**
+     * @brief Returns the OpenFX plug-in corresponding to the given plug-in, loading the OpenFX plug-ins cache if needed.
+     **/
+    OFX::Host::ImageEffect::ImageEffectPlugin* getOfxPlugin(const PluginPtr& plugin);
     AppTLS* getAppTLS() const;
     const OfxHost* getOFXHost() const;
     GPUContextPool* getGPUContextPool() const;
+    ReadAheadIOPool* getReadAheadIOPool() const;
 
 
     /**
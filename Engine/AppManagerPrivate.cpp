@@ -49,6 +49,7 @@
 #include "Global/ProcInfo.h"
 #include "Global/StrUtils.h"
 
+#include "Engine/AppInstance.h"
 #include "Engine/FStreamsSupport.h"
 #include "Engine/CLArgs.h"
 #include "Engine/ExistenceCheckThread.h"
@@ -57,8 +58,10 @@
 #include "Engine/Image.h"
 #include "Engine/OfxHost.h"
 #include "Engine/OSGLContext.h"
-#include "Engine/ProcessHandler.h" // ProcessInputChannel
+#include "Engine/ProcessHandler.h" // ProcessInputChannel, RenderServer
+#include "Engine/Project.h"
 #include "Engine/StandardPaths.h"
+#include "Engine/Timer.h"
 
 #include "Serialization/CacheSerialization.h"
 #include "Serialization/CacheSerializationImpl.h"
@@ -86,9 +89,11 @@ AppManagerPrivate::AppManagerPrivate()
     , _nodeCache()
     , _diskCache()
     , _viewerCache()
+    , readAheadPool()
     , diskCachesLocationMutex()
     , diskCachesLocation()
     , _backgroundIPC()
+    , _renderServer()
     , _loaded(false)
     , _binaryPath()
     , _nodesGlobalMemoryUse(0)
@@ -216,6 +221,36 @@ AppManagerPrivate::initProcessInputChannel(const QString & mainProcessServerName
     _backgroundIPC.reset( new ProcessInputChannel(mainProcessServerName) );
 }
 
+void
+AppManagerPrivate::runRenderServer(const AppInstancePtr& instance)
+{
+    assert(_renderServer);
+    QStringList jobArgs;
+    while ( _renderServer->waitForJob(&jobArgs) ) {
+        TimeLapse timer;
+        CLArgs job(jobArgs, true);
+        if ( job.getError() != 0 ) {
+            _renderServer->writeToClient( QString::fromUtf8(kRenderServerJobFailedShort) + tr("Invalid job arguments: %1").arg( jobArgs.join( QString::fromUtf8(" ") ) ) );
+            continue;
+        }
+        try {
+            instance->renderJob(job);
+            _renderServer->writeToClient( QString::fromUtf8(kRenderServerJobDoneShort) );
+            std::cout << tr("Job done in %1 seconds.").arg( timer.getTimeElapsedReset() ).toStdString() << std::endl;
+        } catch (const std::exception& e) {
+            _renderServer->writeToClient( QString::fromUtf8(kRenderServerJobFailedShort) + QString::fromUtf8( e.what() ) );
+            std::cerr << e.what() << std::endl;
+        }
+
+        // Leave the instance as if it was just created for the next job, plug-ins and caches stay loaded
+        try {
+            instance->getProject()->reset(false /*aboutToQuit*/, true /*blocking*/);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+}
+
 void
 AppManagerPrivate::loadBuiltinFormats()
 {
@@ -67,6 +67,7 @@ GCC_DIAG_ON(deprecated)
 #include "Engine/FrameEntry.h"
 #include "Engine/Image.h"
 #include "Engine/GPUContextPool.h"
+#include "Engine/ReadAheadIOPool.h"
 #include "Engine/GenericSchedulerThreadWatcher.h"
 #include "Engine/EngineFwd.h"
 #include "Engine/TLSHolder.h"
@@ -95,10 +96,12 @@ public:
     ImageCachePtr  _nodeCache; //< Images cache
     ImageCachePtr  _diskCache; //< Images disk cache (used by DiskCache nodes)
     FrameEntryCachePtr _viewerCache; //< Viewer textures cache
+    boost::scoped_ptr<ReadAheadIOPool> readAheadPool; //< I/O threads reading image sequences ahead of the renders
     mutable QMutex diskCachesLocationMutex;
     QString diskCachesLocation;
     boost::scoped_ptr<ProcessInputChannel> _backgroundIPC; //< object used to communicate with the main app
     //if this app is background, see the ProcessInputChannel def
+    boost::scoped_ptr<RenderServer> _renderServer; //< non-null when running with --render-server
     bool _loaded; //< true when the first instance is completly loaded.
     QString _binaryPath; //< the path to the application's binary
     U64 _nodesGlobalMemoryUse; //< how much memory all the nodes are using (besides the cache)
@@ -202,6 +205,12 @@ public:
 
     void initProcessInputChannel(const QString & mainProcessServerName);
 
+    /**
+     * @brief Render the jobs received by the render server with the given instance until the server is asked to quit.
+     * The project of the instance is reset after each job, plug-ins and caches stay loaded.
+     **/
+    void runRenderServer(const AppInstancePtr& instance);
+
     void loadBuiltinFormats();
 
     void saveCaches();
@@ -2793,11 +2793,29 @@ Bezier::getBoundingBox(double time) const
     }
 #endif
 
+    // The hash cache is logically const
+    Bezier* hashedBezier = const_cast<Bezier*>(this);
+
     RectD bbox;
     bool bboxSet = false;
     for (double t = startTime; t <= endTime; t += mbFrameStep) {
         RectD pointsBbox;
 
+        U64 hash = hashedBezier->computeHash(t, ViewIdx(0));
+        {
+            QMutexLocker k(&_imp->bboxCacheMutex);
+            std::map<double, std::pair<U64, RectD> >::const_iterator found = _imp->bboxCache.find(t);
+            if ( (found != _imp->bboxCache.end()) && (found->second.first == hash) ) {
+                if (!bboxSet) {
+                    bboxSet = true;
+                    bbox = found->second.second;
+                } else {
+                    bbox.merge(found->second.second);
+                }
+                continue;
+            }
+        }
+
         Transform::Matrix3x3 transform;
         getTransformAtTime(t, &transform);
 
@@ -2826,6 +2844,10 @@ Bezier::getBoundingBox(double time) const
             pointsBbox.y1 -= halfBrushSize;
             pointsBbox.y2 += halfBrushSize;
         }
+        {
+            QMutexLocker k(&_imp->bboxCacheMutex);
+            _imp->bboxCache[t] = std::make_pair(hash, pointsBbox);
+        }
         if (!bboxSet) {
             bboxSet = true;
             bbox = pointsBbox;
@@ -2837,6 +2859,16 @@ Bezier::getBoundingBox(double time) const
     return bbox;
 } // Bezier::getBoundingBox
 
+void
+Bezier::invalidateHashCache(bool invalidateParent)
+{
+    {
+        QMutexLocker k(&_imp->bboxCacheMutex);
+        _imp->bboxCache.clear();
+    }
+    RotoDrawableItem::invalidateHashCache(invalidateParent);
+}
+
 const std::list< BezierCPPtr > &
 Bezier::getControlPoints() const
 {
@@ -644,6 +644,8 @@ public:
 
     virtual void appendToHash(double time, ViewIdx view, Hash64* hash) OVERRIDE FINAL;
 
+    virtual void invalidateHashCache(bool invalidateParent = true) OVERRIDE;
+
 Q_SIGNALS:
 
     void aboutToClone();
@@ -58,6 +58,7 @@ public:
     std::list<std::string> pythonCommands;
     bool isBackground;
     QString ipcPipe;
+    QString renderServerName;
     int error;
     bool isInterpreterMode;
     std::list<std::pair<int, std::pair<int, int> > > frameRanges;
@@ -82,6 +83,7 @@ public:
         , pythonCommands()
         , isBackground(false)
         , ipcPipe()
+        , renderServerName()
         , error(0)
         , isInterpreterMode(false)
         , frameRanges()
@@ -216,6 +218,7 @@ CLArgs::operator=(const CLArgs& other)
     _imp->pythonCommands = other._imp->pythonCommands;
     _imp->isBackground = other._imp->isBackground;
     _imp->ipcPipe = other._imp->ipcPipe;
+    _imp->renderServerName = other._imp->renderServerName;
     _imp->error = other._imp->error;
     _imp->isInterpreterMode = other._imp->isInterpreterMode;
     _imp->frameRanges = other._imp->frameRanges;
@@ -272,6 +275,14 @@ CLArgs::printUsage(const std::string& programName)
         "    script: it must be started explicitely.\n"
         "    %1Renderer and %1 do the same thing in this mode, only the\n"
         "    init.py script is loaded.\n"
+        "  --render-server <server name>\n"
+        "    Start a render server listening on a local socket with the given name.\n"
+        "    Plug-ins and caches are loaded once and kept warm between jobs.\n"
+        "    Each job is a single line starting with -j, followed by the command\n"
+        "    line arguments of the render separated by tabulations (project path,\n"
+        "    -w writers and frame ranges, -i readers, -c overrides). The -c Python\n"
+        "    commands of a job are run after its project is loaded. The project is\n"
+        "    reset after each job. Send -a to abort the current job and -q to quit.\n"
         "\n"
         /* Text must hold in 80 columns ************************************************/
         "Options for the execution of %1 projects:\n"
@@ -468,6 +479,12 @@ CLArgs::getIPCPipeName() const
     return _imp->ipcPipe;
 }
 
+const QString&
+CLArgs::getRenderServerName() const
+{
+    return _imp->renderServerName;
+}
+
 bool
 CLArgs::areRenderStatsEnabled() const
 {
@@ -848,6 +865,23 @@ CLArgsPrivate::parse()
         }
     }
 
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("render-server"), QString() );
+        if ( it != args.end() ) {
+            ++it;
+            if ( it != args.end() ) {
+                renderServerName = *it;
+                isBackground = true;
+                args.erase(it);
+            } else {
+                std::cout << tr("You must specify the render server name").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+        }
+    }
+
     {
         QStringList::iterator it = hasToken( QString::fromUtf8("onload"), QString::fromUtf8("l") );
         if ( it != args.end() ) {
@@ -126,6 +126,12 @@ public:
     const QString& getDefaultOnProjectLoadedScript() const;
     const QString& getIPCPipeName() const;
 
+    /*
+     * @brief Non empty if the process was launched with --render-server: it then listens on a local
+     * server with this name for render jobs instead of rendering a single project.
+     */
+    const QString& getRenderServerName() const;
+
     bool isPythonScript() const;
 
     bool areRenderStatsEnabled() const;
@@ -32,9 +32,11 @@
 #include <fstream>
 #include <functional>
 #include <list>
+#include <map>
 #include <set>
 #include <cstddef>
 #include <utility>
+#include <limits>
 #include <algorithm> // min, max
 
 #include "Global/GlobalDefines.h"
@@ -58,6 +60,7 @@ GCC_DIAG_ON(deprecated)
 #include "Engine/AppManager.h" //for access to settings
 #include "Engine/Settings.h"
 #include "Engine/CacheEntry.h"
+#include "Engine/CacheEvictionPolicy.h"
 #include "Engine/LRUHashTable.h"
 #include "Engine/StandardPaths.h"
 #include "Engine/ImageLocker.h"
@@ -65,9 +68,6 @@ GCC_DIAG_ON(deprecated)
 #include "Engine/EngineFwd.h"
 
 
-//Beyond that percentage of occupation, the cache will start evicting LRU entries
-#define NATRON_CACHE_LIMIT_PERCENT 0.9
-
 #define NATRON_TILE_CACHE_FILE_SIZE_BYTES 2000000000
 
 ///When defined, number of opened files, memory size and disk size of the cache are printed whenever there's activity.
@@ -475,7 +475,7 @@ private:
      */
     mutable std::size_t _memoryCacheSize;     // current size of the cache in bytes
     mutable std::size_t _diskCacheSize;
-    mutable QMutex _sizeLock; // protects _memoryCacheSize & _diskCacheSize & _maximumInMemorySize & _maximumCacheSize
+    mutable QMutex _sizeLock; // protects _memoryCacheSize & _diskCacheSize & _maximumInMemorySize & _maximumCacheSize & _reservedBytesInUse
     mutable QMutex _lock; //protects _memoryCache & _diskCache
     mutable QMutex _getLock;  //prevents get() and getOrCreate() to be called simultaneously
 
@@ -513,6 +513,17 @@ private:
     // When set these are used for fast search of a free tile
     boost::weak_ptr<TileCacheFile> _nextAvailableCacheFile;
     int _nextAvailableCacheFileIndex;
+
+    // Time ranges pinned by their owner, protected by _lock
+    std::map<const void*, std::pair<double, double> > _pinnedTimeRanges;
+
+    // Memory reserved for playback by each owner and their sum, protected by _lock
+    std::map<const void*, std::size_t> _reservedMemory;
+    std::size_t _reservedMemorySize;
+
+    // Bytes of the entries of the in-memory portion the reserved memory is for, protected by _sizeLock.
+    // Kept up to date by the entries, @see CacheEntryHelper::setReservedMemoryState
+    mutable std::size_t _reservedBytesInUse;
 public:
 
 
@@ -546,6 +557,10 @@ public:
         , _cacheFiles()
         , _nextAvailableCacheFile()
         , _nextAvailableCacheFileIndex(-1)
+        , _pinnedTimeRanges()
+        , _reservedMemory()
+        , _reservedMemorySize(0)
+        , _reservedBytesInUse(0)
     {
     }
 
@@ -554,6 +569,13 @@ public:
         QMutexLocker locker(&_lock);
 
         _tearingDown = true;
+        // Entries still in use somewhere must not notify this cache anymore
+        for (CacheIterator it = _memoryCache.begin(); it != _memoryCache.end(); ++it) {
+            const std::list<EntryTypePtr> & entries = getValueFromIterator(it);
+            for (typename std::list<EntryTypePtr>::const_iterator it2 = entries.begin(); it2 != entries.end(); ++it2) {
+                setEntryInMemoryPortion(*it2, false);
+            }
+        }
         _memoryCache.clear();
         _diskCache.clear();
     }
@@ -821,6 +843,7 @@ private:
 
                 occupationPercentage = (double)memoryCacheSize / maximumInMemorySize;
             }
+            evictForReservedMemory(memoryCacheSize, maximumInMemorySize, &entriesToBeDeleted);
 
             if ( !entriesToBeDeleted.empty() ) {
                 ///Launch a separate thread whose function will be to delete all the entries to be deleted
@@ -917,12 +940,14 @@ public:
             std::list<EntryTypePtr> & ret = getValueFromIterator(memoryCached);
             for (typename std::list<EntryTypePtr>::iterator it = ret.begin(); it != ret.end(); ++it) {
                 if ( ( (*it)->getKey() == key ) && ( (*it)->getParams() == entryToBeEvicted->getParams() ) ) {
+                    setEntryInMemoryPortion(*it, false);
                     ret.erase(it);
                     break;
                 }
             }
             ///Append it
             ret.push_back(newEntry);
+            setEntryInMemoryPortion(newEntry, true);
         } else {
             ///Look in disk cache
             CacheIterator diskCached = _diskCache(hash);
@@ -938,6 +963,7 @@ public:
             }
             ///Insert in mem cache
             _memoryCache.insert(hash, newEntry);
+            setEntryInMemoryPortion(newEntry, true);
         }
     }
 
@@ -1020,6 +1046,7 @@ public:
         QMutexLocker locker(&_lock);
         std::pair<hash_type, EntryTypePtr> evictedFromMemory = _memoryCache.evict();
         while (evictedFromMemory.second) {
+            setEntryInMemoryPortion(evictedFromMemory.second, false);
             if ( !_isTiled && evictedFromMemory.second->isStoredOnDisk() ) {
                 evictedFromMemory.second->removeAnyBackingFile();
             }
@@ -1079,6 +1106,7 @@ public:
         QMutexLocker locker(&_lock);
         std::pair<hash_type, EntryTypePtr> evictedFromMemory = _memoryCache.evict();
         while (evictedFromMemory.second) {
+            setEntryInMemoryPortion(evictedFromMemory.second, false);
             // Move back the entry on disk if it can be store on disk
             // For tiled caches, the tile is sharing the same file with other entries
             // so we cannot close it, just remove the entry
@@ -1158,6 +1186,7 @@ public:
                 }
                 occupationPercentage = (double)memoryCacheSize / maximumInMemorySize;
             }
+            evictForReservedMemory(memoryCacheSize, maximumInMemorySize, &entriesToBeDeleted);
 
             U64 diskCacheSize, maximumDiskCacheSize;
             {
@@ -1316,6 +1345,19 @@ public:
         _signalEmitter->emitRemovedEntry(time, (int)storage);
     }
 
+    virtual void notifyReservedBytesInUseChanged(std::size_t bytes,
+                                                 bool added) const OVERRIDE FINAL
+    {
+        QMutexLocker k(&_sizeLock);
+
+        if (added) {
+            _reservedBytesInUse += bytes;
+        } else {
+            ///Avoid overflows, like _memoryCacheSize
+            _reservedBytesInUse = bytes > _reservedBytesInUse ? 0 : _reservedBytesInUse - bytes;
+        }
+    }
+
     virtual void notifyMemoryDeallocated() const OVERRIDE FINAL
     {
         QMutexLocker k(&_sizeLock);
@@ -1477,6 +1519,7 @@ public:
                 std::list<EntryTypePtr> & ret = getValueFromIterator(existingEntry);
                 for (typename std::list<EntryTypePtr>::iterator it = ret.begin(); it != ret.end(); ++it) {
                     if ( (*it)->getKey() == entry->getKey() ) {
+                        setEntryInMemoryPortion(*it, false);
                         toRemove.push_back(*it);
                         ret.erase(it);
                         break;
@@ -1520,6 +1563,7 @@ public:
             if ( existingEntry != _memoryCache.end() ) {
                 std::list<EntryTypePtr> & ret = getValueFromIterator(existingEntry);
                 for (typename std::list<EntryTypePtr>::iterator it = ret.begin(); it != ret.end(); ++it) {
+                    setEntryInMemoryPortion(*it, false);
                     toRemove.push_back(*it);
                 }
                 _memoryCache.erase(existingEntry);
@@ -1737,6 +1781,86 @@ public:
         }
     }
 
+    /**
+     * @brief Pin the entries of the time range [first, last] that were produced for the viewer (their priority is
+     * eCacheEntryPriorityInteractive or eCacheEntryPriorityPlayback): they are evicted only when no other entry can be.
+     * Each owner pins at most one range, pinning a range replaces the range previously pinned by the same owner.
+     **/
+    void pinTimeRange(const void* owner,
+                      double first,
+                      double last)
+    {
+        QMutexLocker locker(&_lock);
+
+        _pinnedTimeRanges[owner] = std::make_pair(first, last);
+        updatePinnedEntries_locked();
+    }
+
+    void unpinTimeRange(const void* owner)
+    {
+        QMutexLocker locker(&_lock);
+
+        _pinnedTimeRanges.erase(owner);
+        updatePinnedEntries_locked();
+    }
+
+    /**
+     * @brief Reserve memory in the in-memory portion for entries of playback priority: as long as the reserved
+     * memory is not free, entries of a lower priority are evicted to make room for it.
+     * The reservation of an owner replaces its previous one. All reservations together are capped to
+     * NATRON_CACHE_MAX_RESERVED_PERCENT of the in-memory portion.
+     **/
+    void reserveMemory(const void* owner,
+                       std::size_t bytes)
+    {
+        std::list<EntryTypePtr> entriesToBeDeleted;
+        {
+            QMutexLocker locker(&_lock);
+            std::size_t& reserved = _reservedMemory[owner];
+            _reservedMemorySize = _reservedMemorySize - reserved + bytes;
+            reserved = bytes;
+
+            U64 memoryCacheSize, maximumInMemorySize;
+            {
+                QMutexLocker k(&_sizeLock);
+                memoryCacheSize = _memoryCacheSize;
+                maximumInMemorySize = std::max( (std::size_t)1, _maximumInMemorySize );
+            }
+            evictForReservedMemory(memoryCacheSize, maximumInMemorySize, &entriesToBeDeleted);
+        }
+        if ( !entriesToBeDeleted.empty() ) {
+            _deleterThread.appendToQueue(entriesToBeDeleted);
+        }
+    }
+
+    void releaseReservedMemory(const void* owner)
+    {
+        QMutexLocker locker(&_lock);
+        std::map<const void*, std::size_t>::iterator found = _reservedMemory.find(owner);
+
+        if ( found != _reservedMemory.end() ) {
+            _reservedMemorySize -= found->second;
+            _reservedMemory.erase(found);
+        }
+    }
+
+    /**
+     * @brief Called when the renders of the given priority class are finished (e.g: playback stopped): the entries
+     * they raised to that class go back to the class they had before, @see CacheEntryHelper::lowerCachePriority.
+     * Entries of a time range still pinned by another owner keep their priority.
+     **/
+    void lowerCachePriority(CacheEntryPriorityEnum priority)
+    {
+        QMutexLocker locker(&_lock);
+
+        for (CacheIterator it = _memoryCache.begin(); it != _memoryCache.end(); ++it) {
+            lowerCachePriority_locked(getValueFromIterator(it), priority);
+        }
+        for (CacheIterator it = _diskCache.begin(); it != _diskCache.end(); ++it) {
+            lowerCachePriority_locked(getValueFromIterator(it), priority);
+        }
+    }
+
 
 private:
 
@@ -1754,6 +1878,7 @@ private:
 
                     if ( front->getKey().getHolderPluginID() == pluginID ) {
                         for (typename std::list<EntryTypePtr>::iterator it = entries.begin(); it != entries.end(); ++it) {
+                            setEntryInMemoryPortion(*it, false);
                             toDelete.push_back(*it);
                         }
                     } else {
@@ -1861,6 +1986,7 @@ private:
 
                             //put it back into the RAM
                             _memoryCache.insert( (*it)->getHashKey(), *it );
+                            setEntryInMemoryPortion(*it, true);
 
 
                             U64 memoryCacheSize, maximumInMemorySize;
@@ -1929,6 +2055,7 @@ private:
                 /*append to the existing list*/
                 getValueFromIterator(existingEntry).push_back(entry);
             }
+            setEntryInMemoryPortion(entry, true);
         } else {
             CacheIterator existingEntry = _diskCache(hash);
             if ( existingEntry == _diskCache.end() ) {
@@ -1940,15 +2067,167 @@ private:
         }
     }
 
-    bool tryEvictInMemoryEntry(std::list<EntryTypePtr> & entriesToBeDeleted) const
+    /**
+     * @brief Functor used by the LRU tables to score the eviction candidates, @see getEvictionScore
+     **/
+    class EvictionScore
+    {
+        const Cache* _cache;
+        CacheEntryPriorityEnum _maxPriority;
+        bool _evictPinned;
+
+    public:
+
+        EvictionScore(const Cache* cache,
+                      CacheEntryPriorityEnum maxPriority,
+                      bool evictPinned)
+            : _cache(cache)
+            , _maxPriority(maxPriority)
+            , _evictPinned(evictPinned)
+        {
+        }
+
+        double operator()(const EntryTypePtr& entry,
+                          int rank) const
+        {
+            return _cache->getEvictionScore(entry, rank, _maxPriority, _evictPinned);
+        }
+    };
+
+    friend class EvictionScore;
+
+    bool isTimePinned(double time) const
+    {
+        assert( !_lock.tryLock() );
+
+        return CacheEvictionPolicy::isTimePinned(time, _pinnedTimeRanges);
+    }
+
+    /**
+     * @brief Must be called whenever an entry enters or leaves the in-memory portion so that the entry keeps
+     * the bytes it uses of the reserved memory up to date, @see getReservedBytesInUse. _lock must be taken.
+     **/
+    void setEntryInMemoryPortion(const EntryTypePtr& entry,
+                                 bool inMemoryPortion) const
+    {
+        assert( !_lock.tryLock() );
+        entry->setReservedMemoryState( inMemoryPortion, inMemoryPortion && isTimePinned( entry->getTime() ) );
+    }
+
+    /**
+     * @brief The pinned time ranges changed: update the pinned state of the in-memory entries. _lock must be taken.
+     **/
+    void updatePinnedEntries_locked() const
+    {
+        assert( !_lock.tryLock() );
+        for (CacheIterator it = _memoryCache.begin(); it != _memoryCache.end(); ++it) {
+            const std::list<EntryTypePtr> & entries = getValueFromIterator(it);
+            for (typename std::list<EntryTypePtr>::const_iterator it2 = entries.begin(); it2 != entries.end(); ++it2) {
+                setEntryInMemoryPortion(*it2, true);
+            }
+        }
+    }
+
+    void lowerCachePriority_locked(const std::list<EntryTypePtr>& entries,
+                                   CacheEntryPriorityEnum priority) const
+    {
+        assert( !_lock.tryLock() );
+        for (typename std::list<EntryTypePtr>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+            if ( !isTimePinned( (*it)->getTime() ) ) {
+                (*it)->lowerCachePriority(priority);
+            }
+        }
+    }
+
+    bool isEntryPinned(const EntryTypePtr& entry) const
+    {
+        return CacheEvictionPolicy::isPinned( entry->getCachePriority(), isTimePinned( entry->getTime() ) );
+    }
+
+    /**
+     * @brief Returns the eviction score of the entry, @see CacheEvictionPolicy::getEvictionScore
+     **/
+    double getEvictionScore(const EntryTypePtr& entry,
+                            int rank,
+                            CacheEntryPriorityEnum maxPriority,
+                            bool evictPinned) const
+    {
+        // Do not use size() which is 0 for entries that are only on disk
+        return CacheEvictionPolicy::getEvictionScore( entry->getCachePriority(), maxPriority, isEntryPinned(entry), evictPinned,
+                                                      entry->getRenderCost(), entry->getElementsCountFromParams(), rank );
+    }
+
+    /**
+     * @brief Removes from the container the candidate with the lowest eviction score. The entries of a pinned
+     * time range are candidates only if evictPinned is true and no other entry can be evicted.
+     **/
+    std::pair<hash_type, EntryTypePtr> evictLowestScore(CacheContainer& container,
+                                                        CacheEntryPriorityEnum maxPriority,
+                                                        bool evictPinned) const
+    {
+        return CacheEvictionPolicy::evictLowestScore<hash_type, EntryTypePtr>(container, EvictionScore(this, maxPriority, false),
+                                                                              EvictionScore(this, maxPriority, true), evictPinned);
+    }
+
+    /**
+     * @brief Returns the bytes of the in-memory entries the reservation is for: entries of playback priority or of a
+     * pinned time range, @see CacheEvictionPolicy::isUsingReservedMemory
+     **/
+    U64 getReservedBytesInUse() const
+    {
+        QMutexLocker k(&_sizeLock);
+
+        return _reservedBytesInUse;
+    }
+
+    /**
+     * @brief Entries other than playback ones may not use the memory reserved for playback: evict them as long as
+     * the part of the reserved memory not yet filled by playback entries does not fit in the in-memory portion.
+     * Pinned entries are never evicted for the reservation. _lock must be taken.
+     **/
+    void evictForReservedMemory(U64 memoryCacheSize,
+                                U64 maximumInMemorySize,
+                                std::list<EntryTypePtr>* entriesToBeDeleted) const
+    {
+        assert( !_lock.tryLock() );
+        if (_reservedMemorySize == 0) {
+            return;
+        }
+
+        // The evicted entries are neither playback nor pinned ones so this does not change while evicting
+        U64 unfilled = CacheEvictionPolicy::getUnfilledReservedMemory( _reservedMemorySize, getReservedBytesInUse(), maximumInMemorySize );
+        while ( CacheEvictionPolicy::mustEvictForReservedMemory(memoryCacheSize, unfilled, maximumInMemorySize) ) {
+            std::list<EntryTypePtr> deleted;
+            if ( !tryEvictInMemoryEntry(deleted, eCacheEntryPriorityInteractive, false) ) {
+                break;
+            }
+
+            for (typename std::list<EntryTypePtr>::iterator it = deleted.begin(); it != deleted.end(); ++it) {
+                if ( !(*it)->isStoredOnDisk() ) {
+                    memoryCacheSize -= (*it)->size();
+                }
+                entriesToBeDeleted->push_back(*it);
+            }
+        }
+    }
+
+    /**
+     * @brief Evicts from the in-memory portion the candidate with the lowest eviction score, @see getEvictionScore.
+     * Entries whose priority is above maxPriority are not evicted, nor the entries of a pinned time range unless
+     * evictPinned is true and nothing else can be evicted.
+     **/
+    bool tryEvictInMemoryEntry(std::list<EntryTypePtr> & entriesToBeDeleted,
+                               CacheEntryPriorityEnum maxPriority = eCacheEntryPriorityPlayback,
+                               bool evictPinned = true) const
     {
         assert( !_lock.tryLock() );
-        std::pair<hash_type, EntryTypePtr> evicted = _memoryCache.evict();
+        std::pair<hash_type, EntryTypePtr> evicted = evictLowestScore(_memoryCache, maxPriority, evictPinned);
         //if the cache couldn't evict that means all entries are used somewhere and we shall not remove them!
         //we'll let the user of these entries purge the extra entries left in the cache later on
         if (!evicted.second) {
             return false;
         }
+        setEntryInMemoryPortion(evicted.second, false);
 
         // If it is stored on disk, remove it from memory
         // If the cache is tiled, the entry is sharing the same file with other entries so we cannot close the file.
@@ -1974,7 +2253,7 @@ private:
 
             /*before that we need to clear the disk cache if it exceeds the maximum size allowed*/
             while ( ( diskCacheSize  + evicted.second->size() ) >= (maximumCacheSize - maximumInMemorySize) ) {
-                std::pair<hash_type, EntryTypePtr> evictedFromDisk = _diskCache.evict();
+                std::pair<hash_type, EntryTypePtr> evictedFromDisk = evictLowestScore(_diskCache, eCacheEntryPriorityPlayback, true);
                 //if the cache couldn't evict that means all entries are used somewhere and we shall not remove them!
                 //we'll let the user of these entries purge the extra entries left in the cache later on
                 if (!evictedFromDisk.second) {
@@ -2014,7 +2293,7 @@ private:
     {
 
         assert( !_lock.tryLock() );
-        std::pair<hash_type, EntryTypePtr> evicted = _diskCache.evict();
+        std::pair<hash_type, EntryTypePtr> evicted = evictLowestScore(_diskCache, eCacheEntryPriorityPlayback, true);
         //if the cache couldn't evict that means all entries are used somewhere and we shall not remove them!
         //we'll let the user of these entries purge the extra entries left in the cache later on
         if (!evicted.second) {
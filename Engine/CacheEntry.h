@@ -49,6 +49,7 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 #endif
+#include "Engine/CacheEvictionPolicy.h"
 #include "Engine/Hash64.h"
 #include "Engine/MemoryFile.h"
 #include "Engine/NonKeyParams.h"
@@ -232,6 +233,11 @@ public:
      **/
     virtual void notifyMemoryDeallocated() const = 0;
 
+    /**
+     * @brief To be called by a CacheEntry when its bytes start or stop being used by the memory reserved for playback.
+     **/
+    virtual void notifyReservedBytesInUseChanged(size_t bytes, bool added) const = 0;
+
     /**
      * @brief To be called when a backing file has been closed
      **/
@@ -780,6 +786,13 @@ public:
         , _cache()
         , _entryLock(QReadWriteLock::Recursive)
         , _removeBackingFileBeforeDestruction(false)
+        , _evictionInfoMutex()
+        , _cachePriority(eCacheEntryPriorityBackground)
+        , _previousCachePriority(eCacheEntryPriorityAnalysis)
+        , _renderCost(0.)
+        , _inMemoryPortion(false)
+        , _timePinned(false)
+        , _usingReservedMemory(false)
     {
     }
 
@@ -798,11 +811,19 @@ public:
         , _cache(cache)
         , _entryLock(QReadWriteLock::Recursive)
         , _removeBackingFileBeforeDestruction(false)
+        , _evictionInfoMutex()
+        , _cachePriority(eCacheEntryPriorityBackground)
+        , _previousCachePriority(eCacheEntryPriorityAnalysis)
+        , _renderCost(0.)
+        , _inMemoryPortion(false)
+        , _timePinned(false)
+        , _usingReservedMemory(false)
     {
     }
 
     virtual ~CacheEntryHelper()
     {
+        setReservedMemoryState(false, false);
         if (_removeBackingFileBeforeDestruction) {
             removeAnyBackingFile();
         }
@@ -1091,6 +1112,77 @@ public:
         return _key.getTime();
     }
 
+    /**
+     * @brief Raise the priority class of this entry, used by the cache to choose which entry to evict.
+     * An entry used by several renders keeps the highest priority of them.
+     **/
+    void raiseCachePriority(CacheEntryPriorityEnum priority)
+    {
+        QMutexLocker k(&_evictionInfoMutex);
+
+        if (priority > _cachePriority) {
+            _previousCachePriority = _cachePriority;
+            _cachePriority = priority;
+        } else if ( (priority < _cachePriority) && (priority > _previousCachePriority) ) {
+            _previousCachePriority = priority;
+        }
+        updateReservedMemoryUse_locked();
+    }
+
+    /**
+     * @brief Called when the renders of the given priority class are finished: if this entry is in that class,
+     * it goes back to the class it had before they raised it.
+     **/
+    void lowerCachePriority(CacheEntryPriorityEnum priority)
+    {
+        QMutexLocker k(&_evictionInfoMutex);
+
+        if (_cachePriority == priority) {
+            _cachePriority = _previousCachePriority;
+            _previousCachePriority = eCacheEntryPriorityAnalysis;
+        }
+        updateReservedMemoryUse_locked();
+    }
+
+    /**
+     * @brief Called by the cache when this entry enters or leaves its in-memory portion and when the time ranges
+     * it pins change, so that the cache counts the bytes of the reserved memory in use without looking at all its entries.
+     **/
+    void setReservedMemoryState(bool inMemoryPortion,
+                                bool timePinned)
+    {
+        QMutexLocker k(&_evictionInfoMutex);
+
+        _inMemoryPortion = inMemoryPortion;
+        _timePinned = timePinned;
+        updateReservedMemoryUse_locked();
+    }
+
+    CacheEntryPriorityEnum getCachePriority() const
+    {
+        QMutexLocker k(&_evictionInfoMutex);
+
+        return _cachePriority;
+    }
+
+    /**
+     * @brief Accumulates the time (in seconds) spent rendering the content of this entry, i.e: what it would
+     * cost to compute it again if it were evicted.
+     **/
+    void addRenderCost(double timeSpent)
+    {
+        QMutexLocker k(&_evictionInfoMutex);
+
+        _renderCost += timeSpent;
+    }
+
+    double getRenderCost() const
+    {
+        QMutexLocker k(&_evictionInfoMutex);
+
+        return _renderCost;
+    }
+
     boost::shared_ptr<ParamsType> getParams() const WARN_UNUSED_RETURN
     {
         return _params;
@@ -1237,6 +1329,17 @@ private:
      * We must ensure that this function is called ONLY by allocateMemory(), that's why
      * it is private.
      **/
+    void updateReservedMemoryUse_locked()
+    {
+        assert( !_evictionInfoMutex.tryLock() );
+        bool usingReservedMemory = _inMemoryPortion && CacheEvictionPolicy::isUsingReservedMemory(_cachePriority, _timePinned);
+        if ( (usingReservedMemory != _usingReservedMemory) && _cache ) {
+            _usingReservedMemory = usingReservedMemory;
+            // Do not use size() which changes with the allocation
+            _cache->notifyReservedBytesInUseChanged(getElementsCountFromParams(), usingReservedMemory);
+        }
+    }
+
     void restoreBufferFromFile(const std::string & path, std::size_t offset)
     {
 
@@ -1257,6 +1360,19 @@ protected:
     const CacheAPI* _cache;
     mutable QReadWriteLock _entryLock;
     bool _removeBackingFileBeforeDestruction;
+
+    // Protects _cachePriority, _previousCachePriority, _renderCost and the reserved memory state. This is not _entryLock
+    // because the cache reads them while evicting, which must not wait for a render writing to the entry.
+    mutable QMutex _evictionInfoMutex;
+    CacheEntryPriorityEnum _cachePriority;
+    // The highest priority of the renders which used this entry, other than the ones of _cachePriority
+    CacheEntryPriorityEnum _previousCachePriority;
+    double _renderCost;
+    // Set by the cache, @see setReservedMemoryState
+    bool _inMemoryPortion;
+    bool _timePinned;
+    // True if the bytes of this entry are counted by the cache as used by the reserved memory
+    bool _usingReservedMemory;
 };
 
 NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,175 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_CACHEEVICTIONPOLICY_H
+#define NATRON_ENGINE_CACHEEVICTIONPOLICY_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <map>
+#include <utility>
+#include <limits>
+#include <algorithm> // min, max
+
+#include "Global/GlobalDefines.h"
+
+
+//Beyond that percentage of occupation, the cache will start evicting LRU entries
+#define NATRON_CACHE_LIMIT_PERCENT 0.9
+
+//Number of evictable entries, in LRU order, among which the cache picks the one to evict
+#define NATRON_CACHE_EVICTION_CANDIDATES 32
+
+//Maximum portion of the in-memory cache that can be reserved for playback, @see Cache::reserveMemory
+#define NATRON_CACHE_MAX_RESERVED_PERCENT 0.5
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief The rules the cache uses to pick the entry to evict and to make room for the memory reserved for playback,
+ * independent of the entries themselves.
+ **/
+class CacheEvictionPolicy
+{
+public:
+
+    /**
+     * @brief Returns what the cache would lose by evicting an entry: the time (in milliseconds) it would take to render
+     * it again per megabyte freed, weighted by its priority class and by its rank among the candidates in LRU order.
+     * The candidate with the lowest score is evicted.
+     * Returns a negative score if the entry must not be evicted: its priority is above maxPriority, or it belongs to a
+     * pinned time range and evictPinned is false. Pinned entries otherwise score higher than any other.
+     **/
+    static double getEvictionScore(CacheEntryPriorityEnum priority,
+                                   CacheEntryPriorityEnum maxPriority,
+                                   bool pinned,
+                                   bool evictPinned,
+                                   double renderCost,
+                                   U64 bytes,
+                                   int rank)
+    {
+        // Indexed by CacheEntryPriorityEnum
+        static const double priorityWeights[] = { 1., 2., 8., 32. };
+
+        if (priority > maxPriority) {
+            return -1.;
+        }
+        if (pinned) {
+            return evictPinned ? std::numeric_limits<double>::max() : -1.;
+        }
+
+        double megaBytes = std::max( (double)bytes, 1. ) / (1024. * 1024.);
+        double costPerMegaByte = renderCost * 1000. / megaBytes;
+
+        return priorityWeights[priority] * (1. + costPerMegaByte) * (1. + rank);
+    }
+
+    /**
+     * @brief Returns the part of the reserved memory that is not filled yet. The reservation is capped to
+     * NATRON_CACHE_MAX_RESERVED_PERCENT of the in-memory portion. reservedBytesInUse are the bytes of the entries
+     * the reservation is for (playback or pinned ones): they are already counted in the cache size.
+     **/
+    static U64 getUnfilledReservedMemory(U64 reservedMemorySize,
+                                         U64 reservedBytesInUse,
+                                         U64 maximumInMemorySize)
+    {
+        U64 reserved = std::min( reservedMemorySize, (U64)(maximumInMemorySize * NATRON_CACHE_MAX_RESERVED_PERCENT) );
+
+        return reservedBytesInUse >= reserved ? 0 : reserved - reservedBytesInUse;
+    }
+
+    /**
+     * @brief Returns true if entries must be evicted from the in-memory portion so that the unfilled part of the
+     * reserved memory fits in it, @see getUnfilledReservedMemory
+     **/
+    static bool mustEvictForReservedMemory(U64 memoryCacheSize,
+                                           U64 unfilledReservedMemory,
+                                           U64 maximumInMemorySize)
+    {
+        if (unfilledReservedMemory == 0) {
+            return false;
+        }
+
+        return (double)(memoryCacheSize + unfilledReservedMemory) / std::max( maximumInMemorySize, (U64)1 ) > NATRON_CACHE_LIMIT_PERCENT;
+    }
+
+    /**
+     * @brief Returns true if the time belongs to one of the pinned time ranges, given by their owner.
+     **/
+    static bool isTimePinned(double time,
+                             const std::map<const void*, std::pair<double, double> >& pinnedTimeRanges)
+    {
+        for (std::map<const void*, std::pair<double, double> >::const_iterator it = pinnedTimeRanges.begin(); it != pinnedTimeRanges.end(); ++it) {
+            if ( (time >= it->second.first) && (time <= it->second.second) ) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Returns true if an entry of the given priority at a pinned time is pinned: only the entries produced for
+     * the viewer are.
+     **/
+    static bool isPinned(CacheEntryPriorityEnum priority,
+                         bool timePinned)
+    {
+        return timePinned && (priority >= eCacheEntryPriorityInteractive);
+    }
+
+    /**
+     * @brief Returns true if the bytes of an entry of the in-memory portion are the ones the reserved memory is for:
+     * entries of playback priority or pinned ones, @see getUnfilledReservedMemory
+     **/
+    static bool isUsingReservedMemory(CacheEntryPriorityEnum priority,
+                                      bool timePinned)
+    {
+        return (priority == eCacheEntryPriorityPlayback) || isPinned(priority, timePinned);
+    }
+
+    /**
+     * @brief Removes from the LRU container the candidate with the lowest eviction score. score must return a negative
+     * score for pinned entries and scoreEvictingPinned must not, @see getEvictionScore: the entries of a pinned time range
+     * are candidates only if evictPinned is true and no other entry can be evicted.
+     **/
+    template <typename KEY, typename VALUE, typename CONTAINER, typename SCORE>
+    static std::pair<KEY, VALUE> evictLowestScore(CONTAINER& container,
+                                                  const SCORE& score,
+                                                  const SCORE& scoreEvictingPinned,
+                                                  bool evictPinned)
+    {
+        std::pair<KEY, VALUE> evicted = container.evict(score, NATRON_CACHE_EVICTION_CANDIDATES);
+
+        if (!evicted.second && evictPinned) {
+            evicted = container.evict(scoreEvictingPinned, NATRON_CACHE_EVICTION_CANDIDATES);
+        }
+
+        return evicted;
+    }
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_CACHEEVICTIONPOLICY_H
@@ -2135,6 +2135,7 @@ EffectInstance::renderInputImagesForRoI(const FrameViewRequest* request,
                               NodePtr(),
                               0,
                               0,
+                              0,
                               inputImages,
                               &neededComps,
                               useScaleOneInputImages,
@@ -2814,6 +2815,9 @@ EffectInstance::Implementation::renderHandlerPostProcess(const EffectDataTLSPtr&
     double mix = useMaskMix ? _publicInterface->getNode()->getHostMixingValue(actionArgs.time, actionArgs.view) : 1.;
     bool doMask = useMaskMix ? _publicInterface->getNode()->isMaskEnabled(_publicInterface->getMaxInputCount() - 1) : false;
 
+    // The render action rendered all the planes at once: its time is the cost of each of them
+    double timeSpent = timeRecorder->getTimeSinceCreation();
+
     //Check for NaNs, copy to output image and mark for rendered
     for (std::map<ImageComponents, EffectInstance::PlaneToRender>::const_iterator it = outputPlanes.begin(); it != outputPlanes.end(); ++it) {
         bool unPremultRequired = unPremultIfNeeded && it->second.tmpImage->getComponentsCount() == 4 && it->second.renderMappedImage->getComponentsCount() == 3;
@@ -2958,11 +2962,17 @@ EffectInstance::Implementation::renderHandlerPostProcess(const EffectDataTLSPtr&
             } // if (renderFullScaleThenDownscale) {
         } // if (it->second.isAllocatedOnTheFly) {
 
+        it->second.downscaleImage->addRenderCost(timeSpent);
+        it->second.downscaleImage->raiseCachePriority( frameArgs->getCachePriority() );
+        if (it->second.fullscaleImage != it->second.downscaleImage) {
+            it->second.fullscaleImage->addRenderCost(timeSpent);
+            it->second.fullscaleImage->raiseCachePriority( frameArgs->getCachePriority() );
+        }
+
         if ( frameArgs->stats && frameArgs->stats->isInDepthProfilingEnabled() ) {
-            frameArgs->stats->addRenderInfosForNode( _publicInterface->getNode(),  NodePtr(), it->first.getComponentsGlobalName(), actionArgs.roi, timeRecorder->getTimeSinceCreation() );
+            frameArgs->stats->addRenderInfosForNode( _publicInterface->getNode(),  NodePtr(), it->first.getComponentsGlobalName(), actionArgs.roi, timeSpent );
         }
     } // for (std::map<ImageComponents,PlaneToRender>::const_iterator it = outputPlanes.begin(); it != outputPlanes.end(); ++it) {
-
 } // EffectInstance::Implementation::renderHandlerPostProcess
 
 
@@ -2982,9 +2992,8 @@ EffectInstance::Implementation::setupRenderArgs(const EffectDataTLSPtr& tls,
 {
     const ParallelRenderArgsPtr& frameArgs = tls->frameArgs.back();
 
-    if (frameArgs->stats) {
-        timeRecorder->reset( new TimeLapse() );
-    }
+    // The render time is reported to the render statistics and is also the cost of the cached images, @see Cache::getEvictionScore
+    timeRecorder->reset( new TimeLapse() );
 
     const EffectInstance::PlaneToRender & firstPlane = planes.planes.begin()->second;
     const double time = tls->currentRenderArgs.time;
@@ -3138,7 +3147,7 @@ EffectInstance::onSignificantEvaluateAboutToBeCalled(const KnobIPtr& knob, Value
     bool isMT = QThread::currentThread() == qApp->thread();
 
     if ( isMT && ( !knob || knob->getEvaluateOnChange() ) ) {
-        getApp()->triggerAutoSave();
+        getApp()->triggerAutoSave(node);
     }
 
 
@@ -5448,13 +5457,39 @@ EffectInstance::isPaintingOverItselfEnabled() const
 StatusEnum
 EffectInstance::getPreferredMetaDatas_public(NodeMetadata& metadata)
 {
-    StatusEnum stat = getDefaultMetadata(metadata);
+    // The result only depends on the parameters of the node (i.e: its hash) and on the metadata of its inputs:
+    // when scrubbing back and forth, we do not need to call the action again.
+    // The parameters are read at the current view, which may have its own values.
+    ViewIdx view = getCurrentView();
+    U64 hash = computeHash(getCurrentTime(), view);
+    MetadataActionInputs inputs;
+    int nInputs = getMaxInputCount();
 
-    if (stat == eStatusFailed) {
+    inputs.connected.resize(nInputs);
+    inputs.metadatas.resize(nInputs);
+    for (int i = 0; i < nInputs; ++i) {
+        EffectInstancePtr input = getInput(i);
+        inputs.connected[i] = (bool)input;
+        if (input) {
+            QMutexLocker k(&input->_imp->metadatasMutex);
+            inputs.metadatas[i] = input->_imp->metadatas;
+        }
+    }
+
+    StatusEnum stat;
+    if ( _imp->actionsCache->getMetadataResult(hash, view, inputs, &stat, &metadata) ) {
         return stat;
     }
 
-    return getPreferredMetaDatas(metadata);
+    stat = getDefaultMetadata(metadata);
+
+    if (stat != eStatusFailed) {
+        stat = getPreferredMetaDatas(metadata);
+    }
+
+    _imp->actionsCache->setMetadataResult(hash, view, inputs, stat, metadata);
+
+    return stat;
 }
 
 static ImageComponents
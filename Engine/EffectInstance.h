@@ -639,6 +639,7 @@ public:
                                            const NodePtr& callerNode,
                                            const NodePtr & treeRoot,
                                            const RectD & canonicalRenderWindow,
+                                           const RequestPassArena* arena,
                                            FrameRequestMap & requests);
 
     /**
@@ -670,6 +671,7 @@ public:
                                                                const NodePtr & treeRoot,
                                                                FrameRequestMap* requests,          // roi functor specific
                                                                FrameViewRequest* frameViewRequestData,        // roi functor specific
+                                                               const RequestPassArena* arena,        // roi functor specific
                                                                EffectInstance::InputImagesMap* inputImages,         // render functor specific
                                                                const EffectInstance::ComponentsNeededMap* neededComps,         // render functor specific
                                                                bool useScaleOneInputs,         // render functor specific
@@ -35,253 +35,6 @@
 
 NATRON_NAMESPACE_ENTER;
 
-ActionsCache::ActionsCacheInstance::ActionsCacheInstance()
-    : _hash(0)
-    , _timeDomain()
-    , _timeDomainSet(false)
-    , _identityCache()
-    , _rodCache()
-    , _framesNeededCache()
-{
-}
-
-std::list<ActionsCache::ActionsCacheInstance>::iterator
-ActionsCache::createActionCacheInternal(U64 newHash)
-{
-    if (_instances.size() >= _maxInstances) {
-        _instances.pop_front();
-    }
-    ActionsCacheInstance cache;
-    cache._hash = newHash;
-
-    return _instances.insert(_instances.end(), cache);
-}
-
-ActionsCache::ActionsCacheInstance &
-ActionsCache::getOrCreateActionCache(U64 newHash)
-{
-    std::list<ActionsCacheInstance>::iterator found = _instances.end();
-
-    for (std::list<ActionsCacheInstance>::iterator it = _instances.begin(); it != _instances.end(); ++it) {
-        if (it->_hash == newHash) {
-            found = it;
-            break;
-        }
-    }
-    if ( found == _instances.end() ) {
-        found = createActionCacheInternal(newHash);
-    }
-    assert( found != _instances.end() );
-
-    return *found;
-}
-
-ActionsCache::ActionsCache(int maxAvailableHashes)
-    : _cacheMutex()
-    , _instances()
-    , _maxInstances( (std::size_t)maxAvailableHashes )
-{
-}
-
-void
-ActionsCache::clearAll()
-{
-    QMutexLocker l(&_cacheMutex);
-
-    _instances.clear();
-}
-
-void
-ActionsCache::invalidateAll(U64 newHash)
-{
-    QMutexLocker l(&_cacheMutex);
-
-    createActionCacheInternal(newHash);
-}
-
-bool
-ActionsCache::getIdentityResult(U64 hash,
-                                double time,
-                                ViewIdx view,
-                                int* inputNbIdentity,
-                                ViewIdx *inputView,
-                                double* identityTime)
-{
-    QMutexLocker l(&_cacheMutex);
-
-    for (std::list<ActionsCacheInstance>::iterator it = _instances.begin(); it != _instances.end(); ++it) {
-        if (it->_hash == hash) {
-            ActionKey key;
-            key.time = time;
-            key.view = view;
-            key.mipMapLevel = 0;
-
-            IdentityCacheMap::const_iterator found = it->_identityCache.find(key);
-            if ( found != it->_identityCache.end() ) {
-                *inputNbIdentity = found->second.inputIdentityNb;
-                *identityTime = found->second.inputIdentityTime;
-                *inputView = found->second.inputView;
-
-                return true;
-            }
-
-            return false;
-        }
-    }
-
-    return false;
-}
-
-void
-ActionsCache::setIdentityResult(U64 hash,
-                                double time,
-                                ViewIdx view,
-                                int inputNbIdentity,
-                                ViewIdx inputView,
-                                double identityTime)
-{
-    QMutexLocker l(&_cacheMutex);
-    ActionsCacheInstance & cache = getOrCreateActionCache(hash);
-    ActionKey key;
-
-    key.time = time;
-    key.view = view;
-    key.mipMapLevel = 0;
-
-    IdentityResults & v = cache._identityCache[key];
-    v.inputIdentityNb = inputNbIdentity;
-    v.inputIdentityTime = identityTime;
-    v.inputView = inputView;
-}
-
-bool
-ActionsCache::getRoDResult(U64 hash,
-                           double time,
-                           ViewIdx view,
-                           unsigned int mipMapLevel,
-                           RectD* rod)
-{
-    QMutexLocker l(&_cacheMutex);
-
-    for (std::list<ActionsCacheInstance>::iterator it = _instances.begin(); it != _instances.end(); ++it) {
-        if (it->_hash == hash) {
-            ActionKey key;
-            key.time = time;
-            key.view = view;
-            key.mipMapLevel = mipMapLevel;
-
-            RoDCacheMap::const_iterator found = it->_rodCache.find(key);
-            if ( found != it->_rodCache.end() ) {
-                *rod = found->second;
-
-                return true;
-            }
-
-            return false;
-        }
-    }
-
-    return false;
-}
-
-void
-ActionsCache::setRoDResult(U64 hash,
-                           double time,
-                           ViewIdx view,
-                           unsigned int mipMapLevel,
-                           const RectD & rod)
-{
-    QMutexLocker l(&_cacheMutex);
-    ActionsCacheInstance & cache = getOrCreateActionCache(hash);
-    ActionKey key;
-
-    key.time = time;
-    key.view = view;
-    key.mipMapLevel = mipMapLevel;
-
-    cache._rodCache[key] = rod;
-}
-
-bool
-ActionsCache::getFramesNeededResult(U64 hash,
-                                    double time,
-                                    ViewIdx view,
-                                    unsigned int mipMapLevel,
-                                    FramesNeededMap* framesNeeded)
-{
-    QMutexLocker l(&_cacheMutex);
-
-    for (std::list<ActionsCacheInstance>::iterator it = _instances.begin(); it != _instances.end(); ++it) {
-        if (it->_hash == hash) {
-            ActionKey key;
-            key.time = time;
-            key.view = view;
-            key.mipMapLevel = mipMapLevel;
-
-            FramesNeededCacheMap::const_iterator found = it->_framesNeededCache.find(key);
-            if ( found != it->_framesNeededCache.end() ) {
-                *framesNeeded = found->second;
-
-                return true;
-            }
-
-            return false;
-        }
-    }
-
-    return false;
-}
-
-void
-ActionsCache::setFramesNeededResult(U64 hash,
-                                    double time,
-                                    ViewIdx view,
-                                    unsigned int mipMapLevel,
-                                    const FramesNeededMap & framesNeeded)
-{
-    QMutexLocker l(&_cacheMutex);
-    ActionsCacheInstance & cache = getOrCreateActionCache(hash);
-    ActionKey key;
-
-    key.time = time;
-    key.view = view;
-    key.mipMapLevel = mipMapLevel;
-
-    cache._framesNeededCache[key] = framesNeeded;
-}
-
-bool
-ActionsCache::getTimeDomainResult(U64 hash,
-                                  double *first,
-                                  double* last)
-{
-    QMutexLocker l(&_cacheMutex);
-
-    for (std::list<ActionsCacheInstance>::iterator it = _instances.begin(); it != _instances.end(); ++it) {
-        if ( (it->_hash == hash) && it->_timeDomainSet ) {
-            *first = it->_timeDomain.min;
-            *last = it->_timeDomain.max;
-
-            return true;
-        }
-    }
-
-    return false;
-}
-
-void
-ActionsCache::setTimeDomainResult(U64 hash,
-                                  double first,
-                                  double last)
-{
-    QMutexLocker l(&_cacheMutex);
-    ActionsCacheInstance & cache = getOrCreateActionCache(hash);
-
-    cache._timeDomainSet = true;
-    cache._timeDomain.min = first;
-    cache._timeDomain.max = last;
-}
-
 EffectInstance::RenderArgs::RenderArgs()
     : rod()
     , regionOfInterestResults()
@@ -328,7 +81,7 @@ EffectInstance::Implementation::Implementation(EffectInstance* publicInterface)
     , pluginMemoryChunksMutex()
     , pluginMemoryChunks()
     , supportsRenderScale(eSupportsMaybe)
-    , actionsCache(new ActionsCache(appPTR->getHardwareIdealThreadCount() * 2))
+    , actionsCache(new ActionsCache(NATRON_ACTIONS_CACHE_MAX_SIZE_BYTES))
 #if NATRON_ENABLE_TRIMAP
     , imagesBeingRenderedMutex()
     , imagesBeingRendered()
@@ -31,6 +31,7 @@
 
 #include <map>
 #include <list>
+#include <vector>
 #include <string>
 
 #include <QtCore/QCoreApplication>
@@ -39,6 +40,7 @@
 
 #include "Global/GlobalDefines.h"
 
+#include "Engine/ActionsCache.h"
 #include "Engine/Image.h"
 #include "Engine/TLSHolder.h"
 #include "Engine/NodeMetadata.h"
@@ -50,105 +52,6 @@ NATRON_NAMESPACE_ENTER;
 
 typedef std::list<PluginMemoryWPtr> PluginMemoryWPtrList;
 
-struct ActionKey
-{
-    double time;
-    ViewIdx view;
-    unsigned int mipMapLevel;
-};
-
-struct IdentityResults
-{
-    int inputIdentityNb;
-    double inputIdentityTime;
-    ViewIdx inputView;
-};
-
-struct CompareActionsCacheKeys
-{
-    bool operator() (const ActionKey & lhs,
-                     const ActionKey & rhs) const
-    {
-        if (lhs.time < rhs.time) {
-            return true;
-        } else if (lhs.time == rhs.time) {
-            if (lhs.mipMapLevel < rhs.mipMapLevel) {
-                return true;
-            } else if (lhs.mipMapLevel == rhs.mipMapLevel) {
-                if (lhs.view < rhs.view) {
-                    return true;
-                } else {
-                    return false;
-                }
-            } else {
-                return false;
-            }
-        } else {
-            return false;
-        }
-    }
-};
-
-typedef std::map<ActionKey, IdentityResults, CompareActionsCacheKeys> IdentityCacheMap;
-typedef std::map<ActionKey, RectD, CompareActionsCacheKeys> RoDCacheMap;
-typedef std::map<ActionKey, FramesNeededMap, CompareActionsCacheKeys> FramesNeededCacheMap;
-
-/**
- * @brief This class stores all results of the following actions:
-   - getRegionOfDefinition (invalidated on hash change, mapped across time + scale)
-   - getTimeDomain (invalidated on hash change, only 1 value possible
-   - isIdentity (invalidated on hash change,mapped across time + scale)
- * The reason we store them is that the OFX Clip API can potentially call these actions recursively
- * but this is forbidden by the spec:
- * http://openfx.sourceforge.net/Documentation/1.3/ofxProgrammingReference.html#id475585
- **/
-class ActionsCache
-{
-public:
-    ActionsCache(int maxAvailableHashes);
-
-    void clearAll();
-
-    void invalidateAll(U64 newHash);
-
-    bool getIdentityResult(U64 hash, double time, ViewIdx view, int* inputNbIdentity, ViewIdx *inputView, double* identityTime);
-
-    void setIdentityResult(U64 hash, double time, ViewIdx view, int inputNbIdentity, ViewIdx inputView, double identityTime);
-
-    bool getRoDResult(U64 hash, double time, ViewIdx view, unsigned int mipMapLevel, RectD* rod);
-
-    void setRoDResult(U64 hash, double time, ViewIdx view, unsigned int mipMapLevel, const RectD & rod);
-
-    bool getFramesNeededResult(U64 hash, double time, ViewIdx view, unsigned int mipMapLevel, FramesNeededMap* framesNeeded);
-
-    void setFramesNeededResult(U64 hash, double time, ViewIdx view, unsigned int mipMapLevel, const FramesNeededMap & framesNeeded);
-
-    bool getTimeDomainResult(U64 hash, double *first, double* last);
-
-    void setTimeDomainResult(U64 hash, double first, double last);
-
-private:
-    mutable QMutex _cacheMutex; //< protects everything in the cache
-    struct ActionsCacheInstance
-    {
-        U64 _hash;
-        OfxRangeD _timeDomain;
-        bool _timeDomainSet;
-        IdentityCacheMap _identityCache;
-        RoDCacheMap _rodCache;
-        FramesNeededCacheMap _framesNeededCache;
-
-        ActionsCacheInstance();
-    };
-
-    //In  a list to track the LRU
-    std::list<ActionsCacheInstance> _instances;
-    std::size_t _maxInstances;
-    std::list<ActionsCacheInstance>::iterator createActionCacheInternal(U64 newHash);
-    ActionsCacheInstance & getOrCreateActionCache(U64 newHash);
-};
-
-
 class EffectInstance::Implementation
 {
     Q_DECLARE_TR_FUNCTIONS(EffectInstance)
@@ -465,6 +368,11 @@ public:
                                        const boost::scoped_ptr<ImageKey>& key);
 
 
+    /**
+     * @brief Reports to the node the time spent by a render of the plug-in and the bytes it produced, see Node::isCheapToRender
+     **/
+    void reportRenderCost(const ImagePlanesToRenderPtr &planesToRender, double timeSpent);
+
     EffectInstance::RenderRoIStatusEnum renderRoILaunchInternalRender(const RenderRoIArgs & args,
                                                                       const ParallelRenderArgsPtr& frameArgs,
                                                                       const ImagePlanesToRenderPtr &planesToRender,
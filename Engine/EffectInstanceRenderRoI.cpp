@@ -1101,7 +1101,12 @@ EffectInstance::Implementation::renderRoILookupCacheFirstTime(const EffectInstan
         *createInCache = false;
     } else {
         // in Analysis, the node upstream of the analysis node should always cache
-        *createInCache = (frameArgs->isAnalysis && frameArgs->treeRoot->getEffectInstance() == args.caller) ? true : _publicInterface->shouldCacheOutput(isFrameVaryingOrAnimated, args.time, args.view, frameArgs->visitsCount);
+        const bool isCalledByTreeRoot = frameArgs->treeRoot->getEffectInstance() == args.caller;
+        // When a writer encodes frames in order, its input is rendered ahead by the render threads and waits in the scheduler buffer:
+        // cache it so that it is accounted in the cache memory and found again if the writer fetches its input, @see DefaultScheduler::processFrame
+        const bool isRenderedAheadOfOrderedWriter = isCalledByTreeRoot && frameArgs->isSequentialRender && args.caller && args.caller->isWriter() &&
+                                                    args.caller->getSequentialPreference() == eSequentialPreferenceOnlySequential;
+        *createInCache = ( (frameArgs->isAnalysis && isCalledByTreeRoot) || isRenderedAheadOfOrderedWriter ) ? true : _publicInterface->shouldCacheOutput(isFrameVaryingOrAnimated, args.time, args.view, frameArgs->visitsCount);
     }
 
     // Do we want to render the graph upstream at scale 1 or at the requested render scale ? (user setting)
@@ -1183,9 +1188,15 @@ EffectInstance::Implementation::renderRoILookupCacheFirstTime(const EffectInstan
                                                                           glContextLocker,
                                                                           &plane.fullscaleImage);
                     if (plane.fullscaleImage) {
+                        // The image is now also used by this render, e.g: playback reusing an image rendered for a preview
+                        plane.fullscaleImage->raiseCachePriority( frameArgs->getCachePriority() );
                         break;
                     }
                 }
+                if (!args.byPassCache) {
+                    // Measure the cache effectiveness for this node, see Node::isCheapToRender
+                    _publicInterface->getNode()->reportCacheLookup( (bool)plane.fullscaleImage, plane.fullscaleImage ? plane.fullscaleImage->getRenderCost() : 0. );
+                }
             }
 
             if (args.byPassCache) {
@@ -1691,6 +1702,35 @@ EffectInstance::Implementation::renderRoIAllocateOutputPlanes(const RenderRoIArg
 
 } // EffectInstance::Implementation::renderRoIAllocateOutputPlanes
 
+void
+EffectInstance::Implementation::reportRenderCost(const ImagePlanesToRenderPtr &planesToRender,
+                                                 double timeSpent)
+{
+    // Count the bytes of the rectangles rendered by the plug-in in the image it renders to, for all planes,
+    // and the part of them that is held by the cache
+    U64 renderedBytes = 0, cachedBytes = 0;
+
+    for (std::map<ImageComponents, EffectInstance::PlaneToRender>::const_iterator it = planesToRender->planes.begin(); it != planesToRender->planes.end(); ++it) {
+        const ImagePtr& image = it->second.renderMappedImage;
+        if (!image) {
+            continue;
+        }
+        U64 pixelBytes = (U64)image->getComponentsCount() * getSizeOfForBitDepth( image->getBitDepth() );
+        U64 planeBytes = 0;
+        for (std::list<RectToRender>::const_iterator it2 = planesToRender->rectsToRender.begin(); it2 != planesToRender->rectsToRender.end(); ++it2) {
+            if (!it2->isIdentity) {
+                planeBytes += (U64)it2->rect.area() * pixelBytes;
+            }
+        }
+        renderedBytes += planeBytes;
+        if ( !it->second.isAllocatedOnTheFly && image->getCacheAPI() ) {
+            cachedBytes += planeBytes;
+        }
+    }
+
+    _publicInterface->getNode()->reportRenderCost(timeSpent, renderedBytes, cachedBytes);
+}
+
 EffectInstance::RenderRoIStatusEnum
 EffectInstance::Implementation::renderRoILaunchInternalRender(const RenderRoIArgs & args,
                                                               const ParallelRenderArgsPtr& frameArgs,
@@ -1805,6 +1845,7 @@ EffectInstance::Implementation::renderRoILaunchInternalRender(const RenderRoIArg
                 }
             }
             if (attachGLOK) {
+                TimeLapse renderTimer;
                 renderRetCode = _publicInterface->renderRoIInternal(renderInstance,
                                                                     frameViewHash,
                                                                     glRenderContext,
@@ -1824,6 +1865,9 @@ EffectInstance::Implementation::renderRoILaunchInternalRender(const RenderRoIArg
                                                                     outputClipPrefComps,
                                                                     neededComps,
                                                                     processChannels);
+                if (renderRetCode == eRenderRoIStatusImageRendered) {
+                    reportRenderCost( planesToRender, renderTimer.getTimeSinceCreation() );
+                }
                 if (planesToRender->useOpenGL) {
                     // If the plug-in doesn't support concurrent OpenGL renders, release the lock that was taken in the call to attachOpenGLContext_public() above.
                     // For safe plug-ins, we call dettachOpenGLContext_public when the effect is destroyed in Node::deactivate() with the function EffectInstance::dettachAllOpenGLContexts().
@@ -76,6 +76,7 @@ DEPENDPATH += $$PWD/../Global
 
 SOURCES += \
     AbortableRenderInfo.cpp \
+    ActionsCache.cpp \
     AppInstance.cpp \
     AppManager.cpp \
     AppManagerPrivate.cpp \
@@ -170,6 +171,7 @@ SOURCES += \
     PyRoto.cpp \
     PySideCompat.cpp \
     PyTracker.cpp \
+    ReadAheadIOPool.cpp \
     ReadNode.cpp \
     RectD.cpp \
     RectI.cpp \
@@ -184,6 +186,7 @@ SOURCES += \
     RotoShapeRenderNode.cpp \
     RotoShapeRenderNodePrivate.cpp \
     RotoShapeRenderCairo.cpp \
+    RotoShapeRenderCPU.cpp \
     RotoShapeRenderGL.cpp \
     RotoStrokeItem.cpp \
     RotoUndoCommand.cpp \
@@ -271,6 +274,7 @@ SOURCES += \
 
 HEADERS += \
     AbortableRenderInfo.h \
+    ActionsCache.h \
     AfterQuitProcessingI.h \
     AppInstance.h \
     AppManager.h \
@@ -284,6 +288,7 @@ HEADERS += \
     CLArgs.h \
     Cache.h \
     CacheEntry.h \
+    CacheEvictionPolicy.h \
     CoonsRegularization.h \
     ColorParser.h \
     CreateNodeArgs.h \
@@ -387,6 +392,7 @@ HEADERS += \
     PyTracker.h \
     Pyside_Engine_Python.h \
     PyPanelI.h \
+    ReadAheadIOPool.h \
     ReadNode.h \
     RectD.h \
     RectI.h \
@@ -403,6 +409,7 @@ HEADERS += \
     RotoShapeRenderNode.h \
     RotoShapeRenderNodePrivate.h \
     RotoShapeRenderCairo.h \
+    RotoShapeRenderCPU.h \
     RotoShapeRenderGL.h \
     RotoStrokeItem.h \
     RotoUndoCommand.h \
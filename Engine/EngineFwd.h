@@ -96,6 +96,7 @@ class Descriptor;
 
 // SequenceParsing
 namespace SequenceParsing {
+class FileNameContent;
 class SequenceFromFiles;
 typedef boost::shared_ptr<SequenceFromFiles> SequenceFromFilesPtr;
 }
@@ -213,11 +214,14 @@ class ProcessInputChannel;
 class Project;
 class ProjectBeingLoadedInfo;
 class PyPanelI;
+class ReadAheadIOPool;
 class ReadNode;
 class RectD;
 class RectI;
 class RenderEngine;
+class RenderServer;
 class RenderStats;
+class RequestPassArena;
 class RenderingFlagSetter;
 class RotoContext;
 class RotoDrawableItem;
@@ -24,8 +24,10 @@
 
 #include "FileSystemModel.h"
 
+#include <algorithm> // stable_sort, reverse
 #include <vector>
 #include <cassert>
+#include <cctype>
 #include <stdexcept>
 
 #ifdef __NATRON_WIN32__
@@ -41,6 +43,8 @@ CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QFileSystemWatcher>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDateTime>
+#include <QtCore/QDirIterator>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
 #include <QtCore/QUrl>
@@ -50,6 +54,11 @@ CLANG_DIAG_ON(uninitialized)
 
 #include <SequenceParsing.h>
 
+// Interval at which the gatherer publishes the partial contents of a directory
+#define NATRON_FILE_GATHERER_PUBLISH_INTERVAL_MS 200
+
+// Number of directories whose gathered contents are kept by the model
+#define NATRON_FILE_SYSTEM_MODEL_CACHED_DIRECTORIES 32
 
 NATRON_NAMESPACE_ENTER;
 
@@ -93,6 +102,15 @@ getSplitPath(const QString& path)
     return splitPath;
 }
 
+struct DirectoryCacheEntry
+{
+    boost::weak_ptr<FileSystemItem> item;
+    std::vector<FileSystemItemPtr> children;
+    QDateTime lastModified;
+    QString settingsKey;
+    U64 lastUsed;
+};
+
 struct FileSystemModelPrivate
 {
     FileSystemModel* _publicInterface; // can not be a smart ptr
@@ -120,6 +138,10 @@ struct FileSystemModelPrivate
     mutable QMutex mappingMutex;
     std::map<FileSystemItem*, boost::weak_ptr<FileSystemItem> > itemsMap;
 
+    ///The contents of the directories entirely gathered, by absolute path. Only accessed on the main thread
+    std::map<QString, DirectoryCacheEntry> directoriesCache;
+    U64 directoriesCacheAge;
+
 
     FileSystemModelPrivate(FileSystemModel* model)
         : _publicInterface(model)
@@ -140,12 +162,21 @@ struct FileSystemModelPrivate
         , sortMutex()
         , mappingMutex()
         , itemsMap()
+        , directoriesCache()
+        , directoriesCacheAge(0)
     {
     }
 
     void registerItem(const FileSystemItemPtr& item);
     void unregisterItem(FileSystemItem* item);
 
+    /**
+     * @brief Returns a string which differs whenever a setting changing the contents gathered for a directory changes
+     **/
+    QString getGatheringSettingsKey() const;
+
+    void storeInCache(const FileSystemItemPtr& item, const QDateTime& directoryLastModified);
+
 
     FileSystemItemPtr getItemFromPath(const QString &path) const;
 
@@ -359,13 +390,33 @@ void
 FileSystemItem::addChild(const SequenceParsing::SequenceFromFilesPtr& sequence,
                          const QFileInfo& info)
 {
-    FileSystemModelPtr model = _imp->getModel();
+    FileSystemItemPtr child = createChild(sequence, info);
 
-    if (!model) {
+    if (!child) {
         return;
     }
+
     QMutexLocker l(&_imp->childrenMutex);
     ///Does the child exist already ?
+    for (std::vector<FileSystemItemPtr >::iterator it = _imp->children.begin(); it != _imp->children.end(); ++it) {
+        if ( (*it)->fileName() == child->fileName() ) {
+            _imp->children.erase(it);
+            break;
+        }
+    }
+
+    _imp->children.push_back(child);
+}
+
+FileSystemItemPtr
+FileSystemItem::createChild(const SequenceParsing::SequenceFromFilesPtr& sequence,
+                            const QFileInfo& info)
+{
+    FileSystemModelPtr model = _imp->getModel();
+
+    if (!model) {
+        return FileSystemItemPtr();
+    }
     QString filename;
     QString userFriendlyFilename;
     if (!sequence) {
@@ -382,14 +433,6 @@ FileSystemItem::addChild(const SequenceParsing::SequenceFromFilesPtr& sequence,
     }
 
 
-    for (std::vector<FileSystemItemPtr >::iterator it = _imp->children.begin(); it != _imp->children.end(); ++it) {
-        if ( (*it)->fileName() == filename ) {
-            _imp->children.erase(it);
-            break;
-        }
-    }
-
-
     bool isDir = sequence ? false : info.isDir();
     qint64 size;
     if (sequence) {
@@ -401,16 +444,55 @@ FileSystemItem::addChild(const SequenceParsing::SequenceFromFilesPtr& sequence,
 
     ///Create the child
     FileSystemItemPtr child( new FileSystemItem( model,
-                                                                 isDir,
-                                                                 filename,
-                                                                 userFriendlyFilename,
-                                                                 sequence,
-                                                                 info.lastModified(),
-                                                                 size,
-                                                                 shared_from_this() ) );
+                                                 isDir,
+                                                 filename,
+                                                 userFriendlyFilename,
+                                                 sequence,
+                                                 info.lastModified(),
+                                                 size,
+                                                 shared_from_this() ) );
     model->_imp->registerItem(child);
-    _imp->children.push_back(child);
-} // FileSystemItem::addChild
+
+    return child;
+} // FileSystemItem::createChild
+
+std::vector<FileSystemItemPtr>
+FileSystemItem::getChildren() const
+{
+    QMutexLocker l(&_imp->childrenMutex);
+
+    return _imp->children;
+}
+
+void
+FileSystemItem::reorderChildren(const std::vector<int>& newOrder)
+{
+    QMutexLocker l(&_imp->childrenMutex);
+
+    assert( newOrder.size() <= _imp->children.size() );
+    std::vector<FileSystemItemPtr> children;
+    children.reserve( _imp->children.size() );
+    for (std::size_t i = 0; i < newOrder.size(); ++i) {
+        children.push_back(_imp->children[newOrder[i]]);
+    }
+    for (std::size_t i = newOrder.size(); i < _imp->children.size(); ++i) {
+        children.push_back(_imp->children[i]);
+    }
+    _imp->children.swap(children);
+}
+
+void
+FileSystemItem::updateFrom(const FileSystemItem& other)
+{
+    _imp->isDir = other._imp->isDir;
+    _imp->filename = other._imp->filename;
+    _imp->userFriendlySequenceName = other._imp->userFriendlySequenceName;
+    _imp->sequence = other._imp->sequence;
+    _imp->dateModified = other._imp->dateModified;
+    _imp->size = other._imp->size;
+    _imp->fileExtension = other._imp->fileExtension;
+    _imp->absoluteFilePath = other._imp->absoluteFilePath;
+}
 
 void
 FileSystemItem::clearChildren()
@@ -996,6 +1078,10 @@ FileSystemModel::setSequenceModeEnabled(bool sequenceMode)
 void
 FileSystemModel::resetCompletly(bool rebuild)
 {
+    if (_imp->gatherer) {
+        _imp->gatherer->cancelFetch();
+    }
+    _imp->directoriesCache.clear();
     {
         QMutexLocker k(&_imp->mappingMutex);
         _imp->itemsMap.clear();
@@ -1208,7 +1294,11 @@ FileSystemModel::setRootPath(const QString& path)
         beginResetModel();
         endResetModel();
 
-        _imp->populateItem(item);
+        if ( populateItemFromCache(item) ) {
+            Q_EMIT directoryLoaded(path);
+        } else {
+            _imp->populateItem(item);
+        }
     } else {
         Q_EMIT directoryLoaded(path);
     }
@@ -1224,7 +1314,7 @@ FileSystemModel::initGatherer()
     if (!_imp->gatherer) {
         _imp->gatherer.reset( new FileGathererThread( shared_from_this() ) );
         assert(_imp->gatherer);
-        QObject::connect( _imp->gatherer.get(), SIGNAL(directoryLoaded(QString)), this, SLOT(onDirectoryLoadedByGatherer(QString)) );
+        QObject::connect( _imp->gatherer.get(), SIGNAL(contentsGathered()), this, SLOT(onContentsGatheredByGatherer()) );
     }
 }
 
@@ -1232,31 +1322,193 @@ void
 FileSystemModelPrivate::populateItem(const FileSystemItemPtr &item)
 {
     ///We do it in a separate thread because it might be expensive,
-    ///the directoryLoaded signal will be emitted when it is finished
+    ///the contentsGathered signal will be emitted regularly until it is finished
     assert(gatherer);
     gatherer->fetchDirectory(item);
 }
 
+QString
+FileSystemModelPrivate::getGatheringSettingsKey() const
+{
+    QString key;
+    {
+        QMutexLocker k(&filtersMutex);
+        key += QString::number( (int)filters );
+        key += QLatin1Char('|');
+        key += encodedRegexps;
+    }
+    {
+        QMutexLocker k(&sequenceModeEnabledMutex);
+        key += QLatin1Char('|');
+        key += QString::number( (int)sequenceModeEnabled );
+    }
+    {
+        QMutexLocker k(&sortMutex);
+        key += QLatin1Char('|');
+        key += QString::number(sortSection);
+        key += QLatin1Char('|');
+        key += QString::number( (int)ordering );
+    }
+
+    return key;
+}
+
 void
-FileSystemModel::onDirectoryLoadedByGatherer(const QString& directory)
+FileSystemModelPrivate::storeInCache(const FileSystemItemPtr& item,
+                                     const QDateTime& directoryLastModified)
+{
+    DirectoryCacheEntry& entry = directoriesCache[item->absoluteFilePath()];
+
+    entry.item = item;
+    entry.children = item->getChildren();
+    entry.lastModified = directoryLastModified;
+    entry.settingsKey = getGatheringSettingsKey();
+    entry.lastUsed = ++directoriesCacheAge;
+
+    // Forget the least recently used directory
+    if (directoriesCache.size() > NATRON_FILE_SYSTEM_MODEL_CACHED_DIRECTORIES) {
+        std::map<QString, DirectoryCacheEntry>::iterator oldest = directoriesCache.begin();
+        for (std::map<QString, DirectoryCacheEntry>::iterator it = directoriesCache.begin(); it != directoriesCache.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed) {
+                oldest = it;
+            }
+        }
+        directoriesCache.erase(oldest);
+    }
+}
+
+bool
+FileSystemModel::populateItemFromCache(const FileSystemItemPtr& item)
 {
-    ///Get the item corresponding to the directory
-    FileSystemItemPtr item = _imp->getItemFromPath(directory);
+    std::map<QString, DirectoryCacheEntry>::iterator found = _imp->directoriesCache.find( item->absoluteFilePath() );
 
-    if (!item) {
-        qDebug() << "FileSystemModel failed to load the following requested directory: " << directory;
+    if ( found == _imp->directoriesCache.end() ) {
+        return false;
+    }
+    if ( ( found->second.item.lock() != item ) ||
+         ( found->second.settingsKey != _imp->getGatheringSettingsKey() ) ||
+         ( found->second.lastModified != QFileInfo( item->absoluteFilePath() ).lastModified() ) ) {
+        _imp->directoriesCache.erase(found);
+
+        return false;
+    }
+    found->second.lastUsed = ++_imp->directoriesCacheAge;
+
+    // The directory previously requested is no longer wanted
+    assert(_imp->gatherer);
+    _imp->gatherer->cancelFetch();
+
+    if ( item->getChildren() != found->second.children ) {
+        setItemChildren(item, found->second.children);
+    }
+
+    return true;
+}
+
+void
+FileSystemModel::setItemChildren(const FileSystemItemPtr& item,
+                                 const std::vector<FileSystemItemPtr>& children)
+{
+    QModelIndex idx = index(item.get(), 0);
+
+    if ( !idx.isValid() ) {
+        return;
+    }
+    int count = item->childCount();
+    if (count > 0) {
+        beginRemoveRows(idx, 0, count - 1);
+        item->clearChildren();
+        endRemoveRows();
+    }
+    if ( !children.empty() ) {
+        beginInsertRows(idx, 0, (int)children.size() - 1);
+        for (std::size_t i = 0; i < children.size(); ++i) {
+            item->addChild(children[i]);
+        }
+        endInsertRows();
+    }
+}
+
+void
+FileSystemModel::onContentsGatheredByGatherer()
+{
+    FileSystemGatheredContents contents;
+
+    if ( !_imp->gatherer || !_imp->gatherer->takeGatheredContents(&contents) || !contents.item ) {
+        return;
+    }
+
+    const FileSystemItemPtr& item = contents.item;
+    QModelIndex idx = index(item.get(), 0);
+    if ( !idx.isValid() ) {
+        qDebug() << "FileSystemModel failed to load the following requested directory: " << item->absoluteFilePath();
 
         return;
     }
 
-    if (directory != _imp->currentRootPath) {
+    if (contents.first) {
+        ///Remove the children of a previous visit of the directory
+        int count = item->childCount();
+        if (count > 0) {
+            beginRemoveRows(idx, 0, count - 1);
+            item->clearChildren();
+            endRemoveRows();
+        }
+    }
+
+    ///Update the children which changed since the previous results, e.g: a sequence which got more frames
+    int count = item->childCount();
+    int nChildren = (int)contents.children.size();
+    for (int i = 0; i < std::min(count, nChildren); ++i) {
+        if (contents.children[i]) {
+            FileSystemItemPtr child = item->childAt(i);
+            assert(child);
+            child->updateFrom(*contents.children[i]);
+            Q_EMIT dataChanged( index(i, 0, idx), index(i, (int)EndSections - 1, idx) );
+        }
+    }
+
+    ///Append the new ones
+    int nNewChildren = count;
+    while (nNewChildren < nChildren && contents.children[nNewChildren]) {
+        ++nNewChildren;
+    }
+    assert(nNewChildren == nChildren);
+    if (nNewChildren > count) {
+        beginInsertRows(idx, count, nNewChildren - 1);
+        for (int i = count; i < nNewChildren; ++i) {
+            item->addChild(contents.children[i]);
+        }
+        endInsertRows();
+    }
+
+    if (!contents.complete) {
         return;
     }
 
+    ///Sort the children, keeping the persistent indexes (e.g: the selection) on their items
+    if ( !contents.sortedOrder.empty() && ( (int)contents.sortedOrder.size() <= item->childCount() ) ) {
+        Q_EMIT layoutAboutToBeChanged();
+        item->reorderChildren(contents.sortedOrder);
+        QModelIndexList persistentIndexes = persistentIndexList();
+        for (QModelIndexList::const_iterator it = persistentIndexes.begin(); it != persistentIndexes.end(); ++it) {
+            FileSystemItemPtr persistentItem = getSharedItemPtr( getFileSystemItem(*it) );
+            if ( persistentItem && (persistentItem->getParentItem() == item) ) {
+                changePersistentIndex( *it, createIndex( persistentItem->indexInParent(), it->column(), persistentItem.get() ) );
+            }
+        }
+        Q_EMIT layoutChanged();
+    }
+
+    _imp->storeInCache(item, contents.directoryLastModified);
+
+    if (item->absoluteFilePath() != _imp->currentRootPath) {
+        return;
+    }
 
     ///Finally notify the client that the directory is ready for use
-    Q_EMIT directoryLoaded(directory);
-}
+    Q_EMIT directoryLoaded( item->absoluteFilePath() );
+} // FileSystemModel::onContentsGatheredByGatherer
 
 void
 FileSystemModel::onWatchedDirectoryChanged(const QString& directory)
@@ -1310,6 +1562,8 @@ FileSystemModel::cleanAndRefreshItem(const FileSystemItemPtr& item)
     if (!item) {
         return;
     }
+    _imp->directoriesCache.erase( item->absoluteFilePath() );
+
     QModelIndex idx = index(item.get(), 0);
     if ( idx.isValid() ) {
         int count = item->childCount();
@@ -1355,6 +1609,15 @@ struct FileGathererThreadPrivate
     mutable QMutex startCountMutex;
     QWaitCondition startCountCond;
     FileSystemItemPtr requestedItem, itemBeingFetched;
+
+    // Incremented by each request, so that the thread knows when the directory it is gathering is no longer wanted
+    U64 requestID;
+
+    // The results published and not taken yet by the model
+    FileSystemGatheredContents publishedContents;
+    bool hasPublishedContents;
+
+    // Protects requestedItem, requestID and the published contents
     QMutex requestedDirMutex;
 
     FileGathererThreadPrivate(const FileSystemModelPtr& model)
@@ -1372,10 +1635,30 @@ struct FileGathererThreadPrivate
         , startCountCond()
         , requestedItem()
         , itemBeingFetched()
+        , requestID(0)
+        , publishedContents()
+        , hasPublishedContents(false)
         , requestedDirMutex()
     {
     }
 
+    bool isRequestObsolete(U64 id)
+    {
+        QMutexLocker k(&requestedDirMutex);
+
+        return id != requestID;
+    }
+
+    void setRequest_locked(const FileSystemItemPtr& item)
+    {
+        requestedItem = item;
+        ++requestID;
+        publishedContents = FileSystemGatheredContents();
+        hasPublishedContents = false;
+    }
+
+    bool publishContents(const FileSystemGatheredContents& contents, U64 id);
+
     bool checkForExit()
     {
         QMutexLocker l(&mustQuitMutex);
@@ -1499,14 +1782,16 @@ FileGathererThread::run()
                 return;
             }
 
+            U64 requestID;
             {
                 QMutexLocker k(&_imp->requestedDirMutex);
                 _imp->itemBeingFetched = _imp->requestedItem;
                 _imp->requestedItem.reset();
+                requestID = _imp->requestID;
             }
 
             ///Doesn't need to be protected under requestedDirMutex since it is written to only by this thread
-            gatheringKernel(_imp->itemBeingFetched);
+            gatheringKernel(_imp->itemBeingFetched, requestID);
             _imp->itemBeingFetched.reset();
         } //WorkingSetter
 
@@ -1545,136 +1830,257 @@ isVideoFileExtension(const std::string& ext)
     return false;
 }
 
-typedef std::list< std::pair< SequenceParsing::SequenceFromFilesPtr, QFileInfo > > FileSequences;
+/**
+ * @brief A file, directory or sequence found by the gatherer
+ **/
+struct GatheredEntry
+{
+    // The sequence being filled by the gatherer, never shared with the model
+    SequenceParsing::SequenceFromFilesPtr sequence;
+    QFileInfo info;
+
+    // True if the entry was already published and did not change since
+    bool upToDate;
+
+    GatheredEntry(const SequenceParsing::SequenceFromFilesPtr& sequence,
+                  const QFileInfo& info)
+        : sequence(sequence)
+        , info(info)
+        , upToDate(false)
+    {
+    }
+};
+
+/**
+ * @brief Sorts the gathered entries like QDir::entryInfoList would, directories first
+ **/
+class GatheredEntriesCompare
+{
+    const std::vector<GatheredEntry>* _entries;
+    FileSystemModel::Sections _section;
+
+public:
+
+    GatheredEntriesCompare(const std::vector<GatheredEntry>* entries,
+                           FileSystemModel::Sections section)
+        : _entries(entries)
+        , _section(section)
+    {
+    }
+
+    bool operator()(int a,
+                    int b) const
+    {
+        const QFileInfo& infoA = (*_entries)[a].info;
+        const QFileInfo& infoB = (*_entries)[b].info;
+        bool isDirA = !(*_entries)[a].sequence && infoA.isDir();
+        bool isDirB = !(*_entries)[b].sequence && infoB.isDir();
+
+        if (isDirA != isDirB) {
+            return isDirA;
+        }
+        switch (_section) {
+        case FileSystemModel::Size:
+            if ( infoA.size() != infoB.size() ) {
+                return infoA.size() > infoB.size();
+            }
+            break;
+        case FileSystemModel::Type: {
+            int c = QString::compare(infoA.suffix(), infoB.suffix(), Qt::CaseInsensitive);
+            if (c != 0) {
+                return c < 0;
+            }
+            break;
+        }
+        case FileSystemModel::DateModified:
+            if ( infoA.lastModified() != infoB.lastModified() ) {
+                return infoA.lastModified() > infoB.lastModified();
+            }
+            break;
+        default:
+            break;
+        }
+
+        return QString::compare(infoA.fileName(), infoB.fileName(), Qt::CaseInsensitive) < 0;
+    }
+};
+
+bool
+FileGathererThreadPrivate::publishContents(const FileSystemGatheredContents& contents,
+                                           U64 id)
+{
+    QMutexLocker k(&requestedDirMutex);
+
+    if (id != requestID) {
+        return false;
+    }
+    if (!hasPublishedContents) {
+        publishedContents = contents;
+        hasPublishedContents = true;
+
+        return true;
+    }
+
+    // The previous results were not taken yet: merge them, the children that did not change since are NULL
+    assert(publishedContents.item == contents.item);
+    assert( publishedContents.children.size() <= contents.children.size() );
+    publishedContents.children.resize( contents.children.size() );
+    for (std::size_t i = 0; i < contents.children.size(); ++i) {
+        if (contents.children[i]) {
+            publishedContents.children[i] = contents.children[i];
+        }
+    }
+    publishedContents.first = publishedContents.first || contents.first;
+    publishedContents.complete = contents.complete;
+    publishedContents.sortedOrder = contents.sortedOrder;
+    publishedContents.directoryLastModified = contents.directoryLastModified;
 
-#define KERNEL_INCR() \
-    switch (viewOrder) \
-    { \
-    case Qt::AscendingOrder: \
-        ++i; \
-        break; \
-    case Qt::DescendingOrder: \
-        --i; \
-        break; \
+    return true;
+}
+
+/**
+ * @brief Creates the items of the entries which changed since they were last published.
+ * The sequences are copied since the gatherer keeps on filling them.
+ **/
+static void
+makeGatheredContents(const FileSystemItemPtr& item,
+                     std::vector<GatheredEntry>* entries,
+                     FileSystemGatheredContents* contents)
+{
+    contents->item = item;
+    contents->children.resize( entries->size() );
+    for (std::size_t i = 0; i < entries->size(); ++i) {
+        GatheredEntry& entry = (*entries)[i];
+        if (entry.upToDate) {
+            continue;
+        }
+        SequenceParsing::SequenceFromFilesPtr sequence;
+        if (entry.sequence) {
+            sequence.reset( new SequenceParsing::SequenceFromFiles(*entry.sequence) );
+        }
+        contents->children[i] = item->createChild(sequence, entry.info);
+        entry.upToDate = true;
     }
+}
 
 void
-FileGathererThread::gatheringKernel(const FileSystemItemPtr& item)
+FileGathererThread::gatheringKernel(const FileSystemItemPtr& item,
+                                    U64 requestID)
 {
     if (!item) {
         return;
     }
-    QDir dir( item->absoluteFilePath() );
     FileSystemModelPtr model = _imp->getModel();
     if (!model) {
         return;
     }
 
+    const QString directoryPath = item->absoluteFilePath();
+    QDateTime directoryLastModified = QFileInfo(directoryPath).lastModified();
     Qt::SortOrder viewOrder = model->sortIndicatorOrder();
     FileSystemModel::Sections sortSection = (FileSystemModel::Sections)model->sortIndicatorSection();
-    QDir::SortFlags sort;
-    switch (sortSection) {
-    case FileSystemModel::Name:
-        sort = QDir::Name;
-        break;
-    case FileSystemModel::Size:
-        sort = QDir::Size;
-        break;
-    case FileSystemModel::Type:
-        sort = QDir::Type;
-        break;
-    case FileSystemModel::DateModified:
-        sort = QDir::Time;
-        break;
-    default:
-        break;
-    }
-    sort |= QDir::IgnoreCase;
-    sort |= QDir::DirsFirst;
+    bool sequenceMode = model->isSequenceModeEnabled();
 
-    ///All entries in the directory
-    QFileInfoList all = dir.entryInfoList(model->filter(), sort);
+    ///All entries found so far, in the order of the directory
+    std::vector<GatheredEntry> entries;
 
-    ///List of all possible file sequences in the directory or directories
-    FileSequences sequences;
-    int start = 0;
-    int end = 0;
-    switch (viewOrder) {
-    case Qt::AscendingOrder:
-        start = 0;
-        end = all.size();
-        break;
-    case Qt::DescendingOrder:
-        start = all.size() - 1;
-        end = -1;
-        break;
-    }
+    ///The sequences found so far and the index of their entry
+    FileSequencesIndex sequencesIndex(true);
+    std::map<const SequenceParsing::SequenceFromFiles*, std::size_t> sequencesEntries;
 
-    int i = start;
-    while (i != end) {
+    ///The entries are read one by one instead of listing the whole directory so that the partial results
+    ///can be shown and the gathering cancelled quickly on slow file systems
+    QDirIterator it( directoryPath, model->filter() );
+    QElapsedTimer publishTimer;
+    publishTimer.start();
+    bool first = true;
+
+    while ( it.hasNext() ) {
         ///If we must abort we do it now
-        if ( _imp->checkForAbort() ) {
+        if ( _imp->checkForAbort() || _imp->isRequestObsolete(requestID) ) {
             return;
         }
 
-        if ( all[i].isDir() ) {
+        it.next();
+        QFileInfo info = it.fileInfo();
+
+        if ( info.isDir() ) {
             ///This is a directory
-            sequences.push_back( std::make_pair(SequenceParsing::SequenceFromFilesPtr(), all[i]) );
+            entries.push_back( GatheredEntry(SequenceParsing::SequenceFromFilesPtr(), info) );
         } else {
-            QString filename = all[i].fileName();
+            QString filename = info.fileName();
             /// If the item does not match the filter regexp set by the user, discard it
             if ( !model->isAcceptedByRegexps(filename) ) {
-                KERNEL_INCR();
                 continue;
             }
 
             /// If file sequence fetching is disabled, accept it
-            if ( !model->isSequenceModeEnabled() ) {
-                sequences.push_back( std::make_pair(SequenceParsing::SequenceFromFilesPtr(), all[i]) );
-                KERNEL_INCR();
-                continue;
-            }
-
-            std::string absoluteFilePath = generateChildAbsoluteName(item.get(), filename).toStdString();
-            bool foundMatchingSequence = false;
-
-            /// If we reach here, this is a valid file and we need to determine if it belongs to another sequence or we need
-            /// to create a new one
-            SequenceParsing::FileNameContent fileContent(absoluteFilePath);
-
-            if ( !isVideoFileExtension( fileContent.getExtension() ) ) {
-                ///Note that we use a reverse iterator because we have more chance to find a match in the last recently added entries
-                for (FileSequences::reverse_iterator it = sequences.rbegin(); it != sequences.rend(); ++it) {
-                    if ( it->first && it->first->tryInsertFile(fileContent, false) ) {
-                        foundMatchingSequence = true;
-                        break;
+            if (!sequenceMode) {
+                entries.push_back( GatheredEntry(SequenceParsing::SequenceFromFilesPtr(), info) );
+            } else {
+                std::string absoluteFilePath = generateChildAbsoluteName(item.get(), filename).toStdString();
+
+                /// If we reach here, this is a valid file and we need to determine if it belongs to another sequence or we need
+                /// to create a new one
+                SequenceParsing::FileNameContent fileContent(absoluteFilePath);
+
+                if ( isVideoFileExtension( fileContent.getExtension() ) ) {
+                    SequenceParsing::SequenceFromFilesPtr newSequence( new SequenceParsing::SequenceFromFiles(fileContent, true) );
+                    entries.push_back( GatheredEntry(newSequence, info) );
+                } else {
+                    bool created;
+                    SequenceParsing::SequenceFromFilesPtr sequence = sequencesIndex.insertFile(absoluteFilePath, fileContent, false, &created);
+                    if (created) {
+                        sequencesEntries[sequence.get()] = entries.size();
+                        entries.push_back( GatheredEntry(sequence, info) );
+                    } else {
+                        assert( sequencesEntries.find( sequence.get() ) != sequencesEntries.end() );
+                        entries[sequencesEntries[sequence.get()]].upToDate = false;
                     }
                 }
             }
+        }
 
-            if (!foundMatchingSequence) {
-                SequenceParsing::SequenceFromFilesPtr newSequence( new SequenceParsing::SequenceFromFiles(fileContent, true) );
-                sequences.push_back( std::make_pair(newSequence, all[i]) );
+        if (publishTimer.elapsed() >= NATRON_FILE_GATHERER_PUBLISH_INTERVAL_MS) {
+            FileSystemGatheredContents contents;
+            makeGatheredContents(item, &entries, &contents);
+            contents.first = first;
+            contents.directoryLastModified = directoryLastModified;
+            if ( _imp->publishContents(contents, requestID) ) {
+                Q_EMIT contentsGathered();
             }
+            first = false;
+            publishTimer.restart();
         }
-        KERNEL_INCR();
     }
 
-    ///Now iterate through the sequences and create the children as necessary
-    for (FileSequences::iterator it = sequences.begin(); it != sequences.end(); ++it) {
-        item->addChild(it->first, it->second);
+    ///Now sort the entries
+    FileSystemGatheredContents contents;
+    makeGatheredContents(item, &entries, &contents);
+    contents.first = first;
+    contents.complete = true;
+    contents.directoryLastModified = directoryLastModified;
+    contents.sortedOrder.resize( entries.size() );
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        contents.sortedOrder[i] = (int)i;
+    }
+    std::stable_sort( contents.sortedOrder.begin(), contents.sortedOrder.end(), GatheredEntriesCompare(&entries, sortSection) );
+    if (viewOrder == Qt::DescendingOrder) {
+        std::reverse( contents.sortedOrder.begin(), contents.sortedOrder.end() );
     }
 
-    Q_EMIT directoryLoaded( item->absoluteFilePath() );
+    if ( _imp->publishContents(contents, requestID) ) {
+        Q_EMIT contentsGathered();
+    }
 } // FileGathererThread::gatheringKernel
 
 void
 FileGathererThread::fetchDirectory(const FileSystemItemPtr& item)
 {
-    abortGathering();
+    ///The directory being gathered, if any, is cancelled by the new request: there is no need to wait for it
     {
         QMutexLocker l(&_imp->requestedDirMutex);
-        _imp->requestedItem = item;
+        _imp->setRequest_locked(item);
     }
 
     if ( isRunning() ) {
@@ -1686,6 +2092,88 @@ FileGathererThread::fetchDirectory(const FileSystemItemPtr& item)
     }
 }
 
+void
+FileGathererThread::cancelFetch()
+{
+    QMutexLocker l(&_imp->requestedDirMutex);
+
+    _imp->setRequest_locked( FileSystemItemPtr() );
+}
+
+bool
+FileGathererThread::takeGatheredContents(FileSystemGatheredContents* contents)
+{
+    QMutexLocker l(&_imp->requestedDirMutex);
+
+    if (!_imp->hasPublishedContents) {
+        return false;
+    }
+    *contents = _imp->publishedContents;
+    _imp->publishedContents = FileSystemGatheredContents();
+    _imp->hasPublishedContents = false;
+
+    return true;
+}
+
+////////////////////////// FileSequencesIndex
+
+FileSequencesIndex::FileSequencesIndex(bool enableSizeEstimation)
+    : _enableSizeEstimation(enableSizeEstimation)
+    , _sequencesByKey()
+{
+}
+
+std::string
+FileSequencesIndex::getSequenceKey(const std::string& filePath)
+{
+    std::string key;
+
+    key.reserve( filePath.size() );
+
+    std::size_t i = 0;
+    while ( i < filePath.size() ) {
+        bool isSign = filePath[i] == '-' && ( i + 1 < filePath.size() ) && std::isdigit( (unsigned char)filePath[i + 1] );
+        if ( isSign || std::isdigit( (unsigned char)filePath[i] ) ) {
+            if (isSign) {
+                ++i;
+            }
+            while ( i < filePath.size() && std::isdigit( (unsigned char)filePath[i] ) ) {
+                ++i;
+            }
+            key.push_back('#');
+        } else {
+            key.push_back(filePath[i]);
+            ++i;
+        }
+    }
+
+    return key;
+}
+
+SequenceParsing::SequenceFromFilesPtr
+FileSequencesIndex::insertFile(const std::string& filePath,
+                               const SequenceParsing::FileNameContent& file,
+                               bool checkPath,
+                               bool* created)
+{
+    std::vector<SequenceParsing::SequenceFromFilesPtr>& sequences = _sequencesByKey[getSequenceKey(filePath)];
+
+    ///Note that we use a reverse iterator because we have more chance to find a match in the last recently added entries
+    for (std::vector<SequenceParsing::SequenceFromFilesPtr>::reverse_iterator it = sequences.rbegin(); it != sequences.rend(); ++it) {
+        if ( (*it)->tryInsertFile(file, checkPath) ) {
+            *created = false;
+
+            return *it;
+        }
+    }
+
+    SequenceParsing::SequenceFromFilesPtr newSequence( new SequenceParsing::SequenceFromFiles(file, _enableSizeEstimation) );
+    sequences.push_back(newSequence);
+    *created = true;
+
+    return newSequence;
+}
+
 bool
 FileSystemModel::filesListFromPattern(const std::string& pattern, SequenceParsing::SequenceFromPattern* sequence)
 {
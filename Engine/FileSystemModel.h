@@ -28,6 +28,8 @@
 #include "Global/Macros.h"
 
 #include <map>
+#include <string>
+#include <vector>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
@@ -38,6 +40,7 @@
 #include <QtCore/QThread>
 #include <QtCore/QAbstractItemModel>
 #include <QtCore/QDir>
+#include <QtCore/QDateTime>
 
 
 
@@ -124,6 +127,29 @@ public:
     void addChild(const SequenceParsing::SequenceFromFilesPtr& sequence,
                   const QFileInfo& info);
 
+    /**
+     * @brief Creates a child item for the given file or sequence but does not add it, MT-safe
+     **/
+    FileSystemItemPtr createChild(const SequenceParsing::SequenceFromFilesPtr& sequence,
+                                  const QFileInfo& info);
+
+    /**
+     * @brief Returns a copy of the children, MT-safe
+     **/
+    std::vector<FileSystemItemPtr> getChildren() const;
+
+    /**
+     * @brief Reorders the children so that the i-th child becomes the child which was at position newOrder[i].
+     * Children beyond newOrder.size() are left at the end. MT-safe
+     **/
+    void reorderChildren(const std::vector<int>& newOrder);
+
+    /**
+     * @brief Copies the description of the file (name, sequence, size, date) of the other item.
+     * The parent and children are left untouched.
+     **/
+    void updateFrom(const FileSystemItem& other);
+
     /**
      * @brief Remove all children, MT-safe
      **/
@@ -142,6 +168,74 @@ private:
     boost::scoped_ptr<FileSystemItemPrivate> _imp;
 };
 
+/**
+ * @brief Groups files into sequences incrementally. The sequences are indexed by the name of their files
+ * with the digits removed: since only files differing by their numbers may belong to the same sequence,
+ * a file is only tried against the few sequences sharing its key instead of all the sequences found so far.
+ **/
+class FileSequencesIndex
+{
+public:
+
+    FileSequencesIndex(bool enableSizeEstimation);
+
+    /**
+     * @brief Adds the file to the sequence it belongs to, or creates a new sequence for it.
+     * @param filePath The path the file content was made from
+     * @param checkPath If true, files of different directories never belong to the same sequence
+     * @param created Set to true if a new sequence was created
+     **/
+    SequenceParsing::SequenceFromFilesPtr insertFile(const std::string& filePath,
+                                                     const SequenceParsing::FileNameContent& file,
+                                                     bool checkPath,
+                                                     bool* created);
+
+    /**
+     * @brief Returns the key of the given file in the index: its path where the runs of digits, with their sign,
+     * are replaced by a single character.
+     **/
+    static std::string getSequenceKey(const std::string& filePath);
+
+private:
+
+    bool _enableSizeEstimation;
+    std::map<std::string, std::vector<SequenceParsing::SequenceFromFilesPtr> > _sequencesByKey;
+};
+
+/**
+ * @brief The children of a directory gathered so far by the FileGathererThread
+ **/
+struct FileSystemGatheredContents
+{
+    FileSystemItemPtr item;
+
+    // The children, in the order in which they were found. A child is NULL if it did not change
+    // since the previous results taken for the same directory.
+    std::vector<FileSystemItemPtr> children;
+
+    // True if this is the first result for the directory: the previous children of the item must be removed
+    bool first;
+
+    // True if the directory was entirely gathered
+    bool complete;
+
+    // If complete, the i-th child in the sorted order is children[sortedOrder[i]]
+    std::vector<int> sortedOrder;
+
+    // The modification date of the directory when it started being gathered
+    QDateTime directoryLastModified;
+
+    FileSystemGatheredContents()
+        : item()
+        , children()
+        , first(false)
+        , complete(false)
+        , sortedOrder()
+        , directoryLastModified()
+    {
+    }
+};
+
 class FileSystemModel;
 struct FileGathererThreadPrivate;
 class FileGathererThread
@@ -161,18 +255,38 @@ public:
 
     void quitGatherer();
 
+    /**
+     * @brief Starts gathering the given directory. This does not wait for the directory being gathered, if any:
+     * it is cancelled and its results are discarded.
+     **/
     void fetchDirectory(const FileSystemItemPtr& item);
 
+    /**
+     * @brief Cancels the directory being gathered, if any, without waiting for the thread.
+     **/
+    void cancelFetch();
+
     bool isWorking() const;
+
+    /**
+     * @brief Returns the latest results published by the thread for the directory currently requested, if any.
+     * The results of a cancelled request are never returned.
+     **/
+    bool takeGatheredContents(FileSystemGatheredContents* contents);
+
 Q_SIGNALS:
 
-    void directoryLoaded(QString);
+    /**
+     * @brief Emitted regularly while a directory is being gathered and once it is complete,
+     * the results can be retrieved with takeGatheredContents()
+     **/
+    void contentsGathered();
 
 private:
 
     virtual void run() OVERRIDE FINAL;
 
-    void gatheringKernel(const FileSystemItemPtr& item);
+    void gatheringKernel(const FileSystemItemPtr& item, U64 requestID);
 
     boost::scoped_ptr<FileGathererThreadPrivate> _imp;
 };
@@ -333,7 +447,7 @@ public:
 
 public Q_SLOTS:
 
-    void onDirectoryLoadedByGatherer(const QString& directory);
+    void onContentsGatheredByGatherer();
 
     void onWatchedDirectoryChanged(const QString& directory);
 
@@ -357,6 +471,15 @@ private:
 
     void cleanAndRefreshItem(const FileSystemItemPtr& item);
 
+    /**
+     * @brief Sets the children of the item to the ones gathered the last time the directory was visited,
+     * if it was not modified since and the filters and sorting did not change.
+     * @returns True if the item was populated from the cache
+     **/
+    bool populateItemFromCache(const FileSystemItemPtr& item);
+
+    void setItemChildren(const FileSystemItemPtr& item, const std::vector<FileSystemItemPtr>& children);
+
     friend class FileSystemItem;
 
     boost::scoped_ptr<FileSystemModelPrivate> _imp;
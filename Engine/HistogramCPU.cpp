@@ -26,10 +26,19 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring> // memcpy
+#include <map>
 #include <stdexcept>
 
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/bind.hpp>
+#endif
+
 #include <QtCore/QMutex>
 #include <QtCore/QWaitCondition>
+#include <QtCore/QThreadPool>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
 
 #include "Engine/Image.h"
 #include "Engine/Smooth1D.h"
@@ -100,6 +109,32 @@ struct FinishedHistogram
     }
 };
 
+// The histograms are computed with this many more bins, smoothed and then downsampled
+#define NATRON_HISTOGRAM_UPSCALE 5
+
+typedef boost::shared_ptr<ScopeTile> ScopeTilePtr;
+
+struct RectICompareLess
+{
+    bool operator() (const RectI& lhs,
+                     const RectI& rhs) const
+    {
+        if (lhs.x1 != rhs.x1) {
+            return lhs.x1 < rhs.x1;
+        }
+        if (lhs.y1 != rhs.y1) {
+            return lhs.y1 < rhs.y1;
+        }
+        if (lhs.x2 != rhs.x2) {
+            return lhs.x2 < rhs.x2;
+        }
+
+        return lhs.y2 < rhs.y2;
+    }
+};
+
+typedef std::map<RectI, ScopeTilePtr, RectICompareLess> ScopeTilesMap;
+
 struct HistogramCPUPrivate
 {
     QWaitCondition requestCond;
@@ -111,6 +146,13 @@ struct HistogramCPUPrivate
     QMutex mustQuitMutex;
     bool mustQuit;
 
+    // The tiles binned for the last request. The next request with the same bins reuses the bins of a tile
+    // at the same place if its pixels have the same hash, whichever image they come from: during playback
+    // only the tiles that changed from one frame to the next are binned again.
+    // Only accessed by the HistogramCPU thread.
+    HistogramRequest tilesRequest;
+    ScopeTilesMap tiles;
+
     HistogramCPUPrivate()
         : requestCond()
         , requestMutex()
@@ -120,8 +162,12 @@ struct HistogramCPUPrivate
         , mustQuitCond()
         , mustQuitMutex()
         , mustQuit(false)
+        , tilesRequest()
+        , tiles()
     {
     }
+
+    void computeScopes(const HistogramRequest & request, FinishedHistogram* ret);
 };
 
 HistogramCPU::HistogramCPU()
@@ -218,148 +264,285 @@ HistogramCPU::getMostRecentlyProducedHistogram(std::vector<float>* histogram1,
     return true;
 }
 
-///putting these in an anonymous namespace will yield this error on gcc 4.2:
-///"function has not external linkage"
-struct pix_red
+// Arguments shared by all the tiles of a request
+struct ScopeBinningArgs
 {
-    static float val(const float *pix)
-    {
-        return pix[0];
-    }
-};
+    int mode;
 
-struct pix_green
-{
-    static float val(const float *pix)
-    {
-        return pix[1];
-    }
-};
+    // The pixels of the image, starting at the bottom left corner of its bounds
+    const float* pixels;
+    RectI bounds;
+    int rowStride;
+    int nComps;
 
-struct pix_blue
-{
-    static float val(const float *pix)
-    {
-        return pix[2];
-    }
+    // The portion of the image binned
+    RectI rect;
+
+    // For histograms the number of (upscaled) bins, for the waveform the number of columns
+    int nBins;
+    double vmin, vmax;
 };
 
-struct pix_alpha
+static int
+getScopeChannelsCount(int mode)
 {
-    static float val(const float *pix)
-    {
-        return pix[3];
-    }
-};
+    return (mode == eScopeModeRGB || mode == eScopeModeWaveform) ? 3 : 1;
+}
 
-struct pix_lum
+template <int mode>
+static inline float
+getScopeValue(const float* pix,
+              int channel)
 {
-    static float val(const float *pix)
-    {
-        return 0.299 * pix[0] + 0.587 * pix[1] + 0.114 * pix[2];
-    }
-};
+    switch (mode) {
+    case eScopeModeRGB:
+    case eScopeModeWaveform:
 
+        return pix[channel];
+    case eScopeModeA:
 
-template <float pix_func(const float*)>
-void
-computeHisto(const HistogramRequest & request,
-             int upscale,
-             std::vector<float> *histo)
-{
-    assert(histo);
-    histo->resize(request.binsCount * upscale);
-    std::fill(histo->begin(), histo->end(), 0.f);
-    double binSize = (request.vmax - request.vmin) / histo->size();
+        return pix[3];
+    case eScopeModeY:
 
-    ///Images come from the viewer which is in float.
-    assert(request.image->getBitDepth() == eImageBitDepthFloat);
+        return 0.299f * pix[0] + 0.587f * pix[1] + 0.114f * pix[2];
+    case eScopeModeR:
 
-    Image::ReadAccess acc = request.image->getReadRights();
+        return pix[0];
+    case eScopeModeG:
 
-    for (int y = request.rect.bottom(); y < request.rect.top(); ++y) {
-        for (int x = request.rect.left(); x < request.rect.right(); ++x) {
-            const float *pix = (const float*)acc.pixelAt(x, y);
-            float v = pix_func(pix);
-            if ( (request.vmin <= v) && (v < request.vmax) ) {
-                int index = (int)( (v - request.vmin) / binSize );
-                assert( 0 <= index && index < (int)histo->size() );
-                (*histo)[index] += 1.f;
-            }
-        }
-    }
-}
+        return pix[1];
+    case eScopeModeB:
 
+        return pix[2];
+    default:
 
+        return 0.f;
+    }
+}
 
+template <int mode>
 static void
-computeHistogramStatic(const HistogramRequest & request,
-                       boost::shared_ptr<FinishedHistogram> ret,
-                       int histogramIndex)
+binScopeTileForMode(const float* pixels,
+                    int rowStride,
+                    int nComps,
+                    const RectI& rect,
+                    int nBins,
+                    double vmin_d,
+                    double vmax_d,
+                    ScopeTile* tile)
 {
-    const int upscale = 5;
-    std::vector<float> *histo = 0;
+    const RectI& r = tile->rect;
+    const int width = r.width();
+    const int nChannels = getScopeChannelsCount(mode);
+    const float vmin = (float)vmin_d;
+    const float vmax = (float)vmax_d;
 
-    switch (histogramIndex) {
-    case 1:
-        histo = &ret->histogram1;
-        break;
-    case 2:
-        histo = &ret->histogram2;
-        break;
-    case 3:
-        histo = &ret->histogram3;
-        break;
-    default:
-        break;
+    // Number of bins along the value axis
+    const int valueBins = mode == eScopeModeWaveform ? NATRON_SCOPE_WAVEFORM_ROWS : nBins;
+    const float scale = (float)valueBins / (vmax - vmin);
+
+    std::vector<int> columns;
+    int binsCount;
+    if (mode == eScopeModeWaveform) {
+        columns.resize(width);
+        for (int x = 0; x < width; ++x) {
+            columns[x] = (int)( (double)(r.x1 + x - rect.x1) * nBins / rect.width() );
+        }
+        tile->firstColumn = columns.front();
+        tile->nColumns = columns.back() - columns.front() + 1;
+        binsCount = tile->nColumns * NATRON_SCOPE_WAVEFORM_ROWS;
+    } else if (mode == eScopeModeVectorscope) {
+        binsCount = NATRON_SCOPE_VECTORSCOPE_SIZE * NATRON_SCOPE_VECTORSCOPE_SIZE;
+    } else {
+        binsCount = nBins;
     }
-    assert(histo);
-    if (!histo) {
-        return;
+    for (int c = 0; c < nChannels; ++c) {
+        tile->bins[c].assign(binsCount, 0.f);
     }
 
-    /// keep the mode parameter in sync with Histogram::DisplayModeEnum
-
-    int mode = request.mode;
+    std::vector<int> indices(width * nChannels);
+    int* idx = &indices.front();
+    for (int y = r.y1; y < r.y2; ++y) {
+        const float* pix = pixels + (std::size_t)(y - r.y1) * rowStride;
+
+        // First compute the bin of every value of the row: the iterations of these loops are independent
+        // so that the compiler can vectorize them. The bins are then accumulated in a scalar loop: incrementing
+        // bins is a scatter, which SSE2 cannot do, so hand written intrinsics would not speed it up.
+        if (mode == eScopeModeVectorscope) {
+            const float n = (float)NATRON_SCOPE_VECTORSCOPE_SIZE;
+            for (int x = 0; x < width; ++x) {
+                const float* p = pix + x * nComps;
+                // Rec. 709 chroma
+                const float cb = -0.1146f * p[0] - 0.3854f * p[1] + 0.5f * p[2];
+                const float cr = 0.5f * p[0] - 0.4542f * p[1] - 0.0458f * p[2];
+                const float fx = (cb + 0.5f) * n;
+                const float fy = (cr + 0.5f) * n;
+                const bool inside = fx >= 0.f && fx < n && fy >= 0.f && fy < n;
+                const int ix = (int)std::max( 0.f, std::min(fx, n - 1.f) );
+                const int iy = (int)std::max( 0.f, std::min(fy, n - 1.f) );
+                idx[x] = inside ? iy * NATRON_SCOPE_VECTORSCOPE_SIZE + ix : -1;
+            }
+        } else {
+            for (int c = 0; c < nChannels; ++c) {
+                int* cidx = idx + c * width;
+                for (int x = 0; x < width; ++x) {
+                    const float v = getScopeValue<mode>(pix + x * nComps, c);
+                    const bool inside = v >= vmin && v < vmax;
+                    // Clamp before converting to int: this also takes care of NaNs and infinities
+                    const int bin = (int)std::max( 0.f, std::min( (v - vmin) * scale, (float)(valueBins - 1) ) );
+                    cidx[x] = inside ? bin : -1;
+                }
+            }
+        }
 
-    ///if the mode is RGB, adjust the mode to either R,G or B depending on the histogram index
-    if (mode == 0) {
-        mode = histogramIndex + 2;
+        for (int c = 0; c < nChannels; ++c) {
+            float* bins = &tile->bins[c].front();
+            const int* cidx = idx + c * width;
+            if (mode == eScopeModeWaveform) {
+                for (int x = 0; x < width; ++x) {
+                    if (cidx[x] >= 0) {
+                        bins[cidx[x] * tile->nColumns + columns[x] - tile->firstColumn] += 1.f;
+                    }
+                }
+            } else {
+                for (int x = 0; x < width; ++x) {
+                    if (cidx[x] >= 0) {
+                        bins[cidx[x]] += 1.f;
+                    }
+                }
+            }
+        }
     }
+} // binScopeTileForMode
+
+void
+HistogramCPU::binScopeTile(int mode,
+                           const float* pixels,
+                           int rowStride,
+                           int nComps,
+                           const RectI& rect,
+                           int nBins,
+                           double vmin,
+                           double vmax,
+                           ScopeTile* tile)
+{
+    void (*tileFunc)(const float*, int, int, const RectI&, int, double, double, ScopeTile*) = 0;
 
-    ret->pixelsCount = request.rect.area();
-    // a histogram with upscale more bins
-    std::vector<float> histo_upscaled;
     switch (mode) {
-    case 1:     //< A
-        computeHisto<&pix_alpha::val>(request, upscale, &histo_upscaled);
+    case eScopeModeRGB:
+        tileFunc = &binScopeTileForMode<eScopeModeRGB>;
         break;
-    case 2:     //<Y
-        computeHisto<&pix_lum::val>(request, upscale, &histo_upscaled);
+    case eScopeModeA:
+        tileFunc = &binScopeTileForMode<eScopeModeA>;
         break;
-    case 3:     //< R
-        computeHisto<&pix_red::val>(request, upscale, &histo_upscaled);
+    case eScopeModeY:
+        tileFunc = &binScopeTileForMode<eScopeModeY>;
         break;
-    case 4:     //< G
-        computeHisto<&pix_green::val>(request, upscale, &histo_upscaled);
+    case eScopeModeR:
+        tileFunc = &binScopeTileForMode<eScopeModeR>;
         break;
-    case 5:     //< B
-        computeHisto<&pix_blue::val>(request, upscale, &histo_upscaled);
+    case eScopeModeG:
+        tileFunc = &binScopeTileForMode<eScopeModeG>;
         break;
-
-    default:
-        assert(false);
+    case eScopeModeB:
+        tileFunc = &binScopeTileForMode<eScopeModeB>;
+        break;
+    case eScopeModeWaveform:
+        tileFunc = &binScopeTileForMode<eScopeModeWaveform>;
+        break;
+    case eScopeModeVectorscope:
+        tileFunc = &binScopeTileForMode<eScopeModeVectorscope>;
         break;
+    default:
+        assert(false);     //< unknown case.
+
+        return;
     }
-    double sigma = upscale;
-    if (request.smoothingKernelSize > 1) {
-        sigma *= request.smoothingKernelSize;
+    tileFunc(pixels, rowStride, nComps, rect, nBins, vmin, vmax, tile);
+}
+
+U64
+HistogramCPU::hashScopeTilePixels(const float* pixels,
+                                  int rowStride,
+                                  int nComps,
+                                  const RectI& rect)
+{
+    // FNV-1a on the bits of the values, on 4 independent lanes so that the multiplications of consecutive values overlap
+    const U64 prime = 1099511628211ULL;
+    U64 lanes[4];
+
+    for (int k = 0; k < 4; ++k) {
+        lanes[k] = 14695981039346656037ULL + k;
+    }
+    const int rowSize = rect.width() * nComps;
+    for (int y = 0; y < rect.height(); ++y) {
+        const float* row = pixels + (std::size_t)y * rowStride;
+        int x = 0;
+        for (; x + 4 <= rowSize; x += 4) {
+            for (int k = 0; k < 4; ++k) {
+                U32 bits;
+                std::memcpy( &bits, row + x + k, sizeof(bits) );
+                lanes[k] = (lanes[k] ^ bits) * prime;
+            }
+        }
+        for (; x < rowSize; ++x) {
+            U32 bits;
+            std::memcpy( &bits, row + x, sizeof(bits) );
+            lanes[0] = (lanes[0] ^ bits) * prime;
+        }
+    }
+
+    U64 hash = lanes[0];
+    for (int k = 1; k < 4; ++k) {
+        hash = (hash ^ lanes[k]) * prime;
+    }
+
+    return hash;
+}
+
+// A tile of the grid to bin for the current request
+struct ScopeTileJob
+{
+    RectI rect;
+
+    // The tile binned for the previous request at the same place, if any
+    ScopeTilePtr previous;
+
+    // The previous tile if its pixels did not change, otherwise a newly binned tile
+    ScopeTilePtr result;
+};
+
+static void
+processScopeTile(const ScopeBinningArgs* args,
+                 ScopeTileJob& job)
+{
+    const float* pixels = args->pixels + (std::size_t)(job.rect.y1 - args->bounds.y1) * args->rowStride + (std::size_t)(job.rect.x1 - args->bounds.x1) * args->nComps;
+    U64 hash = HistogramCPU::hashScopeTilePixels(pixels, args->rowStride, args->nComps, job.rect);
+
+    if ( job.previous && (job.previous->contentHash == hash) ) {
+        job.result = job.previous;
+
+        return;
     }
+    job.result.reset(new ScopeTile);
+    job.result->rect = job.rect;
+    job.result->contentHash = hash;
+    HistogramCPU::binScopeTile(args->mode, pixels, args->rowStride, args->nComps, args->rect, args->nBins, args->vmin, args->vmax, job.result.get());
+}
+
+static void
+smoothAndDownsampleHistogram(std::vector<float>& histo_upscaled,
+                             int smoothingKernelSize,
+                             int binsCount,
+                             std::vector<float>* histo)
+{
+    const int upscale = NATRON_HISTOGRAM_UPSCALE;
+
     // smooth the upscaled histogram
-    Smooth1D::iir_gaussianFilter1D(histo_upscaled, request.smoothingKernelSize);
+    Smooth1D::iir_gaussianFilter1D(histo_upscaled, smoothingKernelSize);
 
     // downsample to obtain the final histogram
-    histo->resize(request.binsCount);
+    histo->resize(binsCount);
     assert(histo_upscaled.size() == histo->size() * upscale);
     std::vector<float>::const_iterator it_in = histo_upscaled.begin();
     std::advance(it_in, (upscale - 1) / 2);
@@ -371,7 +554,146 @@ computeHistogramStatic(const HistogramRequest & request,
             std::advance (it_in, upscale);
         }
     }
-} // computeHistogramStatic
+}
+
+static bool
+isSameScopeRequest(const HistogramRequest& a,
+                   const HistogramRequest& b)
+{
+    if ( (a.mode != b.mode) || (a.binsCount != b.binsCount) || (a.vmin != b.vmin) || (a.vmax != b.vmax) ) {
+        return false;
+    }
+
+    // The columns of the waveform depend on the whole rectangle
+    return a.mode != eScopeModeWaveform || a.rect == b.rect;
+}
+
+void
+HistogramCPUPrivate::computeScopes(const HistogramRequest & request,
+                                   FinishedHistogram* ret)
+{
+    const int mode = request.mode;
+    if ( (mode < eScopeModeRGB) || (mode > eScopeModeVectorscope) ) {
+        assert(false);     //< unknown case.
+
+        return;
+    }
+    const bool isHistogram = mode != eScopeModeWaveform && mode != eScopeModeVectorscope;
+    const int nChannels = getScopeChannelsCount(mode);
+
+    ///Images come from the viewer which is in float.
+    assert(request.image->getBitDepth() == eImageBitDepthFloat);
+    assert(request.image->getComponentsCount() == 4);
+
+    ScopeBinningArgs args;
+    args.mode = mode;
+    args.pixels = 0;
+    args.bounds = request.image->getBounds();
+    if ( !request.rect.intersect(args.bounds, &args.rect) ) {
+        args.rect.clear();
+    }
+    args.nComps = request.image->getComponentsCount();
+    args.rowStride = args.bounds.width() * args.nComps;
+    args.nBins = isHistogram ? request.binsCount * NATRON_HISTOGRAM_UPSCALE : request.binsCount;
+    args.vmin = request.vmin;
+    args.vmax = request.vmax;
+    ret->pixelsCount = (int)args.rect.area();
+
+    // Forget the tiles binned for a previous request if the bins changed.
+    // The columns of the waveform depend on the rectangle actually binned, i.e: clipped to the image bounds
+    HistogramRequest binnedRequest = request;
+    binnedRequest.image.reset();
+    binnedRequest.rect = args.rect;
+    if ( !isSameScopeRequest(tilesRequest, binnedRequest) ) {
+        tiles.clear();
+    }
+    tilesRequest = binnedRequest;
+
+    // Only bin the tiles of the grid whose pixels changed
+    std::vector<ScopeTileJob> jobs;
+    if ( !args.rect.isNull() && (args.nBins > 0) && (request.vmax > request.vmin) ) {
+        const int tileSize = NATRON_SCOPE_TILE_SIZE;
+        const int firstX = (int)std::floor( (double)args.rect.x1 / tileSize ) * tileSize;
+        const int firstY = (int)std::floor( (double)args.rect.y1 / tileSize ) * tileSize;
+        for (int y = firstY; y < args.rect.y2; y += tileSize) {
+            for (int x = firstX; x < args.rect.x2; x += tileSize) {
+                RectI tileRect( std::max(x, args.rect.x1), std::max(y, args.rect.y1),
+                                std::min(x + tileSize, args.rect.x2), std::min(y + tileSize, args.rect.y2) );
+                ScopeTileJob job;
+                job.rect = tileRect;
+                ScopeTilesMap::iterator found = tiles.find(tileRect);
+                if ( found != tiles.end() ) {
+                    job.previous = found->second;
+                }
+                jobs.push_back(job);
+            }
+        }
+    }
+
+    ScopeTilesMap visibleTiles;
+    if ( !jobs.empty() ) {
+        Image::ReadAccess acc = request.image->getReadRights();
+        args.pixels = (const float*)acc.pixelAt(args.bounds.x1, args.bounds.y1);
+        assert(args.pixels);
+
+        bool runInCurrentThread = jobs.size() <= 1 || QThreadPool::globalInstance()->activeThreadCount() >= QThreadPool::globalInstance()->maxThreadCount();
+        if (runInCurrentThread) {
+            for (std::vector<ScopeTileJob>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+                processScopeTile(&args, *it);
+            }
+        } else {
+            QtConcurrent::map( jobs, boost::bind(&processScopeTile, &args, _1) ).waitForFinished();
+        }
+        args.pixels = 0;
+        for (std::vector<ScopeTileJob>::const_iterator it = jobs.begin(); it != jobs.end(); ++it) {
+            visibleTiles.insert( std::make_pair(it->rect, it->result) );
+        }
+    }
+    tiles.swap(visibleTiles);
+
+    // Merge the bins of all tiles
+    std::size_t binsCount;
+    if (mode == eScopeModeWaveform) {
+        binsCount = (std::size_t)args.nBins * NATRON_SCOPE_WAVEFORM_ROWS;
+    } else if (mode == eScopeModeVectorscope) {
+        binsCount = NATRON_SCOPE_VECTORSCOPE_SIZE * NATRON_SCOPE_VECTORSCOPE_SIZE;
+    } else {
+        binsCount = args.nBins;
+    }
+    std::vector<float> bins[3];
+    for (int c = 0; c < nChannels; ++c) {
+        bins[c].assign(binsCount, 0.f);
+    }
+    for (ScopeTilesMap::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+        const ScopeTile& tile = *it->second;
+        for (int c = 0; c < nChannels; ++c) {
+            const float* src = &tile.bins[c].front();
+            float* dst = &bins[c].front();
+            if (mode == eScopeModeWaveform) {
+                for (int row = 0; row < NATRON_SCOPE_WAVEFORM_ROWS; ++row) {
+                    float* dstRow = dst + (std::size_t)row * args.nBins + tile.firstColumn;
+                    const float* srcRow = src + (std::size_t)row * tile.nColumns;
+                    for (int col = 0; col < tile.nColumns; ++col) {
+                        dstRow[col] += srcRow[col];
+                    }
+                }
+            } else {
+                for (std::size_t i = 0; i < binsCount; ++i) {
+                    dst[i] += src[i];
+                }
+            }
+        }
+    }
+
+    std::vector<float>* outputs[3] = { &ret->histogram1, &ret->histogram2, &ret->histogram3 };
+    for (int c = 0; c < nChannels; ++c) {
+        if (isHistogram) {
+            smoothAndDownsampleHistogram(bins[c], request.smoothingKernelSize, request.binsCount, outputs[c]);
+        } else {
+            outputs[c]->swap(bins[c]);
+        }
+    }
+} // HistogramCPUPrivate::computeScopes
 
 void
 HistogramCPU::run()
@@ -408,25 +730,7 @@ HistogramCPU::run()
         ret->vmax = request.vmax;
         ret->mipMapLevel = request.image->getMipMapLevel();
 
-
-        switch (request.mode) {
-        case 0:     //< RGB
-            computeHistogramStatic(request, ret, 1);
-            computeHistogramStatic(request, ret, 2);
-            computeHistogramStatic(request, ret, 3);
-            break;
-        case 1:
-        case 2:
-        case 3:
-        case 4:
-        case 5:
-            computeHistogramStatic(request, ret, 1);
-            break;
-        default:
-            assert(false);     //< unknown case.
-            break;
-        }
-
+        _imp->computeScopes( request, ret.get() );
 
         {
             QMutexLocker l(&_imp->producedMutex);
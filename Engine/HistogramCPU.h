@@ -36,10 +36,71 @@
 #include <boost/scoped_ptr.hpp>
 #endif
 
+#include "Global/GlobalDefines.h"
+
+#include "Engine/RectI.h"
 #include "Engine/EngineFwd.h"
 
+// Number of value rows of the waveform scope
+#define NATRON_SCOPE_WAVEFORM_ROWS 256
+
+// Width and height of the vectorscope
+#define NATRON_SCOPE_VECTORSCOPE_SIZE 256
+
+// The image is binned by tiles of this size aligned on a grid, in parallel.
+// The bins of each tile are kept along with a hash of its pixels until the parameters of the request change:
+// the next image, e.g: the next frame during playback, only bins again the tiles whose pixels changed.
+#define NATRON_SCOPE_TILE_SIZE 256
+
 NATRON_NAMESPACE_ENTER;
 
+// The modes, keep in sync with Histogram::DisplayModeEnum
+enum ScopeModeEnum
+{
+    eScopeModeRGB = 0,
+    eScopeModeA,
+    eScopeModeY,
+    eScopeModeR,
+    eScopeModeG,
+    eScopeModeB,
+    eScopeModeWaveform,
+    eScopeModeVectorscope
+};
+
+/**
+ * @brief The bins of a tile of the image, @see HistogramCPU::binScopeTile
+ **/
+struct ScopeTile
+{
+    RectI rect;
+
+    // Hash of the pixels of the tile, @see HistogramCPU::hashScopeTilePixels
+    U64 contentHash;
+
+    // For the waveform, the tile only holds the columns it covers
+    int firstColumn;
+    int nColumns;
+    std::vector<float> bins[3];
+
+    ScopeTile()
+        : rect()
+        , contentHash(0)
+        , firstColumn(0)
+        , nColumns(0)
+    {
+    }
+};
+
+/**
+ * @brief Computes histograms and scopes of the images displayed by the viewer in a separate thread.
+ * The mode corresponds to Histogram::DisplayModeEnum:
+ * - For histograms (RGB, A, Y, R, G, B), histogram1..3 have binsCount bins.
+ * - For the waveform, histogram1..3 hold the R, G and B waveforms: binsCount columns by NATRON_SCOPE_WAVEFORM_ROWS
+ * rows covering [vmin, vmax], stored row by row.
+ * - For the vectorscope, histogram1 holds NATRON_SCOPE_VECTORSCOPE_SIZE^2 bins covering the Cb, Cr plane in [-0.5, 0.5],
+ * stored row by row.
+ * All channels are computed in a single pass over the image.
+ **/
 struct HistogramCPUPrivate;
 
 class HistogramCPU
@@ -83,6 +144,32 @@ public:
 
     void quitAnyComputation();
 
+    /**
+     * @brief Bins the pixels of tile->rect for the given mode (ScopeModeEnum) into tile->bins.
+     * pixels points to the first pixel of tile->rect in a float image with nComps components, whose rows are rowStride floats apart.
+     * rect is the whole portion of the image being binned: for the waveform, it maps the pixels to the nBins columns.
+     * For histograms nBins is the number of bins covering [vmin, vmax): values outside of this range are not counted.
+     * For the waveform the NATRON_SCOPE_WAVEFORM_ROWS rows cover [vmin, vmax).
+     **/
+    static void binScopeTile(int mode,
+                             const float* pixels,
+                             int rowStride,
+                             int nComps,
+                             const RectI& rect,
+                             int nBins,
+                             double vmin,
+                             double vmax,
+                             ScopeTile* tile);
+
+    /**
+     * @brief Returns a hash of the pixels of the given rectangle, with the same conventions as binScopeTile.
+     * Tiles with the same hash are assumed to have the same pixels and thus the same bins.
+     **/
+    static U64 hashScopeTilePixels(const float* pixels,
+                                   int rowStride,
+                                   int nComps,
+                                   const RectI& rect);
+
 Q_SIGNALS:
 
     void histogramProduced();
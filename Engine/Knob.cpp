@@ -3591,6 +3591,11 @@ KnobHelper::slaveToInternal(int dimension,
         masterKnob->addListener( false, dimension, otherDimension, shared_from_this() );
     }
 
+    KnobHolderPtr holder = getHolder();
+    if (holder) {
+        holder->invalidateTimeDependentKnobs();
+    }
+
     return true;
 } // KnobHelper::slaveTo
 
@@ -4008,6 +4013,11 @@ KnobHelper::cloneOneCurve(const KnobIPtr& other,
         }
     }
     checkAnimationLevel(ViewIdx(0), dimension);
+
+    // The curve was replaced without notifying individual keyframes: let the editors refresh their copy of it
+    if (_signalSlotHandler) {
+        _signalSlotHandler->s_redrawGuiCurve(eCurveChangeReasonInternal, ViewIdx(0), dimension);
+    }
 }
 
 void
@@ -5439,6 +5449,13 @@ struct KnobHolder::KnobHolderPrivate
     bool knobsFrozen;
     mutable QMutex hasAnimationMutex;
     bool hasAnimation;
+
+    // Index of the knobs whose value may change with the time: animated, driven by an expression, slaved or
+    // evaluated on time changes. Rebuilt lazily when timeDependentKnobsAge differs from timeDependentKnobsBuiltAge
+    mutable QMutex timeDependentKnobsMutex;
+    std::vector<KnobIWPtr> timeDependentKnobs;
+    U64 timeDependentKnobsAge;
+    U64 timeDependentKnobsBuiltAge;
     DockablePanelI* settingsPanel;
 
     std::list<KnobIWPtr> overlaySlaves;
@@ -5467,6 +5484,10 @@ struct KnobHolder::KnobHolderPrivate
         , knobsFrozen(false)
         , hasAnimationMutex()
         , hasAnimation(false)
+        , timeDependentKnobsMutex()
+        , timeDependentKnobs()
+        , timeDependentKnobsAge(1)
+        , timeDependentKnobsBuiltAge(0)
         , settingsPanel(0)
 
     {
@@ -5495,6 +5516,10 @@ struct KnobHolder::KnobHolderPrivate
     , knobsFrozen(false)
     , hasAnimationMutex()
     , hasAnimation(other.hasAnimation)
+    , timeDependentKnobsMutex()
+    , timeDependentKnobs()
+    , timeDependentKnobsAge(1)
+    , timeDependentKnobsBuiltAge(0)
     , settingsPanel(other.settingsPanel)
     {
 
@@ -5639,6 +5664,8 @@ KnobHolder::addKnob(const KnobIPtr& k)
         }
     }
     _imp->knobs.push_back(k);
+    kk.unlock();
+    invalidateTimeDependentKnobs();
 }
 
 void
@@ -5661,6 +5688,8 @@ KnobHolder::insertKnob(int index,
         std::advance(it, index);
         _imp->knobs.insert(it, k);
     }
+    kk.unlock();
+    invalidateTimeDependentKnobs();
 }
 
 void
@@ -5671,6 +5700,8 @@ KnobHolder::removeKnobFromList(const KnobIConstPtr& knob)
     for (KnobsVec::iterator it = _imp->knobs.begin(); it != _imp->knobs.end(); ++it) {
         if (*it == knob) {
             _imp->knobs.erase(it);
+            kk.unlock();
+            invalidateTimeDependentKnobs();
 
             return;
         }
@@ -5746,6 +5777,7 @@ KnobHolder::deleteKnob(const KnobIPtr& knob,
             }
         }
     }
+    invalidateTimeDependentKnobs();
 
     if (sharedKnob && alsoDeleteGui && _imp->settingsPanel) {
         _imp->settingsPanel->deleteKnobGui(sharedKnob);
@@ -6596,21 +6628,100 @@ KnobHolder::refreshAfterTimeChange(bool isPlayback,
     if ( !app || app->isGuiFrozen() ) {
         return;
     }
-    for (std::size_t i = 0; i < _imp->knobs.size(); ++i) {
-        _imp->knobs[i]->onTimeChanged(isPlayback, time);
+    KnobsVec knobs = getTimeDependentKnobs();
+    for (std::size_t i = 0; i < knobs.size(); ++i) {
+        knobs[i]->onTimeChanged(isPlayback, time);
+    }
+    refreshExtraStateAfterTimeChanged(isPlayback, time);
+}
+
+bool
+KnobHolder::refreshAfterTimeChange(bool isPlayback,
+                                   double time,
+                                   const KnobPagePtr& visiblePage)
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    AppInstancePtr app = getApp();
+    if ( !app || app->isGuiFrozen() ) {
+        return false;
+    }
+    bool hasSkippedKnobs = false;
+    KnobsVec knobs = getTimeDependentKnobs();
+    for (std::size_t i = 0; i < knobs.size(); ++i) {
+        // Knobs evaluated on time changes must be notified even if not visible since the plug-in relies on them
+        if ( knobs[i]->evaluateValueChangeOnTimeChange() ||
+             ( visiblePage && (knobs[i]->getTopLevelPage() == visiblePage) ) ) {
+            knobs[i]->onTimeChanged(isPlayback, time);
+        } else {
+            hasSkippedKnobs = true;
+        }
     }
     refreshExtraStateAfterTimeChanged(isPlayback, time);
+
+    return hasSkippedKnobs;
 }
 
 void
 KnobHolder::refreshAfterTimeChangeOnlyKnobsWithTimeEvaluation(double time)
 {
     assert( QThread::currentThread() == qApp->thread() );
-    for (std::size_t i = 0; i < _imp->knobs.size(); ++i) {
-        if ( _imp->knobs[i]->evaluateValueChangeOnTimeChange() ) {
-            _imp->knobs[i]->onTimeChanged(false, time);
+    KnobsVec knobs = getTimeDependentKnobs();
+    for (std::size_t i = 0; i < knobs.size(); ++i) {
+        if ( knobs[i]->evaluateValueChangeOnTimeChange() ) {
+            knobs[i]->onTimeChanged(false, time);
+        }
+    }
+}
+
+void
+KnobHolder::invalidateTimeDependentKnobs()
+{
+    QMutexLocker k(&_imp->timeDependentKnobsMutex);
+
+    ++_imp->timeDependentKnobsAge;
+}
+
+KnobsVec
+KnobHolder::getTimeDependentKnobs() const
+{
+    U64 age;
+    {
+        QMutexLocker k(&_imp->timeDependentKnobsMutex);
+        if (_imp->timeDependentKnobsBuiltAge == _imp->timeDependentKnobsAge) {
+            KnobsVec ret;
+            ret.reserve( _imp->timeDependentKnobs.size() );
+            for (std::vector<KnobIWPtr>::const_iterator it = _imp->timeDependentKnobs.begin(); it != _imp->timeDependentKnobs.end(); ++it) {
+                KnobIPtr knob = it->lock();
+                if (knob) {
+                    ret.push_back(knob);
+                }
+            }
+
+            return ret;
+        }
+        age = _imp->timeDependentKnobsAge;
+    }
+
+    KnobsVec ret;
+    KnobsVec knobs = getKnobs_mt_safe();
+    for (KnobsVec::const_iterator it = knobs.begin(); it != knobs.end(); ++it) {
+        bool isTimeDependent = (*it)->evaluateValueChangeOnTimeChange() || (*it)->hasAnimation();
+        for (int i = 0; i < (*it)->getDimension() && !isTimeDependent; ++i) {
+            isTimeDependent = !(*it)->getExpression(i).empty() || (*it)->getMaster(i).second;
         }
+        if (isTimeDependent) {
+            ret.push_back(*it);
+        }
+    }
+
+    QMutexLocker k(&_imp->timeDependentKnobsMutex);
+    // Do not store the index if it was invalidated while being built
+    if (age == _imp->timeDependentKnobsAge) {
+        _imp->timeDependentKnobs.assign( ret.begin(), ret.end() );
+        _imp->timeDependentKnobsBuiltAge = age;
     }
+
+    return ret;
 }
 
 
@@ -6892,9 +7003,12 @@ KnobHolder::getHasAnimation() const
 void
 KnobHolder::setHasAnimation(bool hasAnimation)
 {
-    QMutexLocker k(&_imp->hasAnimationMutex);
+    {
+        QMutexLocker k(&_imp->hasAnimationMutex);
 
-    _imp->hasAnimation = hasAnimation;
+        _imp->hasAnimation = hasAnimation;
+    }
+    invalidateTimeDependentKnobs();
 }
 
 void
@@ -6911,9 +7025,12 @@ KnobHolder::updateHasAnimation()
             }
         }
     }
-    QMutexLocker k(&_imp->hasAnimationMutex);
+    {
+        QMutexLocker k(&_imp->hasAnimationMutex);
 
-    _imp->hasAnimation = hasAnimation;
+        _imp->hasAnimation = hasAnimation;
+    }
+    invalidateTimeDependentKnobs();
 }
 
 void
@@ -2451,6 +2451,13 @@ public:
 
     void refreshAfterTimeChange(bool isPlayback, double time);
 
+    /**
+     * @brief Same as refreshAfterTimeChange but only the knobs on the given page, which is the one visible in the
+     * settings panel, are refreshed (along with the knobs evaluated on time changes). If visiblePage is NULL, none are.
+     * @returns True if some knobs needing a refresh were skipped: the caller should refresh them when they become visible.
+     **/
+    bool refreshAfterTimeChange(bool isPlayback, double time, const KnobPagePtr& visiblePage);
+
     /**
      * @brief Same as refreshAfterTimeChange but refreshes only the knobs
      * whose function evaluateValueChangeOnTimeChange() return true so that
@@ -2458,6 +2465,18 @@ public:
      **/
     void refreshAfterTimeChangeOnlyKnobsWithTimeEvaluation(double time);
 
+    /**
+     * @brief Returns the knobs whose value may change with the time: the ones that are animated, driven by an expression,
+     * slaved to another knob or evaluated on time changes. This is the set of knobs refreshed when the time changes.
+     * The index is rebuilt lazily after invalidateTimeDependentKnobs() was called.
+     **/
+    KnobsVec getTimeDependentKnobs() const WARN_UNUSED_RETURN;
+
+    /**
+     * @brief Called when a knob gains or loses animation, expressions or master, or when knobs are added or removed
+     **/
+    void invalidateTimeDependentKnobs();
+
     void setIsInitializingKnobs(bool b);
     bool isInitializingKnobs() const;
 
@@ -1774,6 +1774,9 @@ Knob<T>::unSlaveInternal(int dimension,
             _signalSlotHandler->s_knobSlaved(dimension, false);
         }
     }
+    if ( getHolder() ) {
+        getHolder()->invalidateTimeDependentKnobs();
+    }
     if (getHolder() && _signalSlotHandler) {
         getHolder()->onKnobSlaved( shared_from_this(), master.second, dimension, false );
     }
@@ -219,6 +219,54 @@ public:
         return std::make_pair( key_type(), V() );
     }
 
+    // Purge, among the maxCandidates first elements that can be purged in least-recently-used order, the one
+    // with the lowest score. SCORE is a functor called with a value and its rank among the candidates which
+    // returns the score of the value, or a negative score if the value must not be purged.
+    template <typename SCORE>
+    std::pair<key_type, V> evict(const SCORE & score,
+                                 int maxCandidates)
+    {
+        typename key_to_value_type::iterator best = _key_to_value.end();
+        typename std::list<V>::iterator bestValue;
+        double bestScore = 0.;
+        int nCandidates = 0;
+
+        for (typename key_tracker_type::iterator k = _key_tracker.begin(); k != _key_tracker.end() && nCandidates < maxCandidates; ++k) {
+            const typename key_to_value_type::iterator it = _key_to_value.find(*k);
+            for (typename std::list<V>::iterator it2 = it->second.first.begin();
+                 it2 != it->second.first.end() && nCandidates < maxCandidates;
+                 ++it2) {
+                if ( (*it2).use_count() != 1 ) {
+                    continue;
+                }
+                double s = score(*it2, nCandidates);
+                if (s < 0) {
+                    continue;
+                }
+                ++nCandidates;
+                if ( ( best == _key_to_value.end() ) || (s < bestScore) ) {
+                    best = it;
+                    bestValue = it2;
+                    bestScore = s;
+                }
+            }
+        }
+
+        if ( best == _key_to_value.end() ) {
+            return std::make_pair( key_type(), V() );
+        }
+
+        std::pair<key_type, V> ret = std::make_pair(best->first, *bestValue);
+        if (best->second.first.size() == 1) {
+            // Erase both elements to completely purge record
+            erase(best);
+        } else {
+            best->second.first.erase(bestValue);
+        }
+
+        return ret;
+    }
+
     unsigned int size()
     {
         return _container.size();
@@ -332,6 +380,50 @@ public:
         return std::make_pair( key_type(), V() );
     }
 
+    // Purge, among the maxCandidates first elements that can be purged in least-recently-used order, the one
+    // with the lowest score. SCORE is a functor called with a value and its rank among the candidates which
+    // returns the score of the value, or a negative score if the value must not be purged.
+    template <typename SCORE>
+    std::pair<key_type, V> evict(const SCORE & score,
+                                 int maxCandidates)
+    {
+        typename container_type::right_iterator best = _container.right.end();
+        typename std::list<V>::iterator bestValue;
+        double bestScore = 0.;
+        int nCandidates = 0;
+
+        for (typename container_type::right_iterator it = _container.right.begin(); it != _container.right.end() && nCandidates < maxCandidates; ++it) {
+            for (typename std::list<V>::iterator it2 = it->first.begin(); it2 != it->first.end() && nCandidates < maxCandidates; ++it2) {
+                if ( (*it2).use_count() != 1 ) {
+                    continue;
+                }
+                double s = score(*it2, nCandidates);
+                if (s < 0) {
+                    continue;
+                }
+                ++nCandidates;
+                if ( ( best == _container.right.end() ) || (s < bestScore) ) {
+                    best = it;
+                    bestValue = it2;
+                    bestScore = s;
+                }
+            }
+        }
+
+        if ( best == _container.right.end() ) {
+            return std::make_pair( key_type(), V() );
+        }
+
+        std::pair<key_type, V> ret = std::make_pair(best->second, *bestValue);
+        if (best->first.size() == 1) {
+            _container.right.erase(best);
+        } else {
+            best->first.erase(bestValue);
+        }
+
+        return ret;
+    }
+
     unsigned int size()
     {
         return _container.size();
@@ -453,6 +545,54 @@ public:
         return std::make_pair( key_type(), V() );
     }
 
+    // Purge, among the maxCandidates first elements that can be purged in least-recently-used order, the one
+    // with the lowest score. SCORE is a functor called with a value and its rank among the candidates which
+    // returns the score of the value, or a negative score if the value must not be purged.
+    template <typename SCORE>
+    std::pair<key_type, V> evict(const SCORE & score,
+                                 int maxCandidates)
+    {
+        typename key_to_value_type::iterator best = _key_to_value.end();
+        typename std::list<V>::iterator bestValue;
+        double bestScore = 0.;
+        int nCandidates = 0;
+
+        for (typename key_tracker_type::iterator k = _key_tracker.begin(); k != _key_tracker.end() && nCandidates < maxCandidates; ++k) {
+            const typename key_to_value_type::iterator it = _key_to_value.find(*k);
+            for (typename std::list<V>::iterator it2 = it->second.first.begin();
+                 it2 != it->second.first.end() && nCandidates < maxCandidates;
+                 ++it2) {
+                if ( (*it2).use_count() != 1 ) {
+                    continue;
+                }
+                double s = score(*it2, nCandidates);
+                if (s < 0) {
+                    continue;
+                }
+                ++nCandidates;
+                if ( ( best == _key_to_value.end() ) || (s < bestScore) ) {
+                    best = it;
+                    bestValue = it2;
+                    bestScore = s;
+                }
+            }
+        }
+
+        if ( best == _key_to_value.end() ) {
+            return std::make_pair( key_type(), V() );
+        }
+
+        std::pair<key_type, V> ret = std::make_pair(best->first, *bestValue);
+        if (best->second.first.size() == 1) {
+            // Erase both elements to completely purge record
+            erase(best);
+        } else {
+            best->second.first.erase(bestValue);
+        }
+
+        return ret;
+    }
+
     unsigned int size()
     {
         return _key_to_value.size();
@@ -560,6 +700,50 @@ public:
         return std::make_pair( key_type(), V() );
     }
 
+    // Purge, among the maxCandidates first elements that can be purged in least-recently-used order, the one
+    // with the lowest score. SCORE is a functor called with a value and its rank among the candidates which
+    // returns the score of the value, or a negative score if the value must not be purged.
+    template <typename SCORE>
+    std::pair<key_type, V> evict(const SCORE & score,
+                                 int maxCandidates)
+    {
+        typename container_type::right_iterator best = _container.right.end();
+        typename std::list<V>::iterator bestValue;
+        double bestScore = 0.;
+        int nCandidates = 0;
+
+        for (typename container_type::right_iterator it = _container.right.begin(); it != _container.right.end() && nCandidates < maxCandidates; ++it) {
+            for (typename std::list<V>::iterator it2 = it->first.begin(); it2 != it->first.end() && nCandidates < maxCandidates; ++it2) {
+                if ( (*it2).use_count() != 1 ) {
+                    continue;
+                }
+                double s = score(*it2, nCandidates);
+                if (s < 0) {
+                    continue;
+                }
+                ++nCandidates;
+                if ( ( best == _container.right.end() ) || (s < bestScore) ) {
+                    best = it;
+                    bestValue = it2;
+                    bestScore = s;
+                }
+            }
+        }
+
+        if ( best == _container.right.end() ) {
+            return std::make_pair( key_type(), V() );
+        }
+
+        std::pair<key_type, V> ret = std::make_pair(best->second, *bestValue);
+        if (best->first.size() == 1) {
+            _container.right.erase(best);
+        } else {
+            best->first.erase(bestValue);
+        }
+
+        return ret;
+    }
+
     unsigned int size()
     {
         return _container.size();
@@ -662,6 +846,50 @@ public:
         return std::make_pair( key_type(), V() );
     }
 
+    // Purge, among the maxCandidates first elements that can be purged in least-recently-used order, the one
+    // with the lowest score. SCORE is a functor called with a value and its rank among the candidates which
+    // returns the score of the value, or a negative score if the value must not be purged.
+    template <typename SCORE>
+    std::pair<key_type, V> evict(const SCORE & score,
+                                 int maxCandidates)
+    {
+        typename container_type::right_iterator best = _container.right.end();
+        typename std::list<V>::iterator bestValue;
+        double bestScore = 0.;
+        int nCandidates = 0;
+
+        for (typename container_type::right_iterator it = _container.right.begin(); it != _container.right.end() && nCandidates < maxCandidates; ++it) {
+            for (typename std::list<V>::iterator it2 = it->first.begin(); it2 != it->first.end() && nCandidates < maxCandidates; ++it2) {
+                if ( (*it2).use_count() != 1 ) {
+                    continue;
+                }
+                double s = score(*it2, nCandidates);
+                if (s < 0) {
+                    continue;
+                }
+                ++nCandidates;
+                if ( ( best == _container.right.end() ) || (s < bestScore) ) {
+                    best = it;
+                    bestValue = it2;
+                    bestScore = s;
+                }
+            }
+        }
+
+        if ( best == _container.right.end() ) {
+            return std::make_pair( key_type(), V() );
+        }
+
+        std::pair<key_type, V> ret = std::make_pair(best->second, *bestValue);
+        if (best->first.size() == 1) {
+            _container.right.erase(best);
+        } else {
+            best->first.erase(bestValue);
+        }
+
+        return ret;
+    }
+
     unsigned int size()
     {
         return _container.size();
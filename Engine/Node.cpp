@@ -29,6 +29,7 @@
 #include <algorithm> // min, max
 #include <bitset>
 #include <cassert>
+#include <cstdlib> // abs
 #include <stdexcept>
 
 #include "Global/Macros.h"
@@ -119,6 +120,19 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 ///at most every...
 #define NATRON_RENDER_GRAPHS_HINTS_REFRESH_RATE_SECONDS 1
 
+///Below this render time in seconds per byte produced by a render thread (1 GB per second), weighted by the re-use of
+///its images, a node is considered cheaper to render again than to cache, see Node::isCheapToRender
+#define NATRON_CACHE_ADMISSION_MIN_COST_PER_BYTE 1e-9
+
+///Number of renders to measure before a node may be considered cheap
+#define NATRON_CACHE_ADMISSION_MIN_SAMPLES 4
+
+///Weight of the previous renders in the render cost average and in the re-use measure of a node
+#define NATRON_CACHE_ADMISSION_COST_DECAY 0.9
+
+///A node that is cheap to render still has one render out of this number cached, to keep measuring the re-use of its images
+#define NATRON_CACHE_ADMISSION_SAMPLING_PERIOD 8
+
 
 NATRON_NAMESPACE_ENTER;
 
@@ -3050,6 +3064,9 @@ Node::setNameInternal(const std::string& name,
     }
     std::string fullySpecifiedName = getFullyQualifiedName();
 
+    if ( !oldName.empty() ) {
+        getApp()->getProject()->onNodeScriptNameChanged();
+    }
 
     if (collection) {
         if ( !oldName.empty() ) {
@@ -3320,7 +3337,8 @@ Node::createNodePage(const KnobPagePtr& settingsPage)
     fCaching->setIsPersistent(true);
     fCaching->setEvaluateOnChange(false);
     fCaching->setHintToolTip( tr("When checked, the output of this node will always be kept in the RAM cache for fast access of already computed "
-                                 "images.") );
+                                 "images. Otherwise a node that is measured as cheap to render is not cached, so that its images do not push "
+                                 "the images of expensive nodes out of the cache.") );
     _imp->forceCaching = fCaching;
     settingsPage->addKnob(fCaching);
 
@@ -5255,6 +5273,20 @@ Node::isNodeUpstream(const NodeConstPtr& input) const
     return isNodeUpstreamInternal(input, markedNodes);
 }
 
+void
+Node::getAllUpstreamNodes(std::set<NodePtr>* nodes) const
+{
+    int maxInputs = getMaxInputCount();
+
+    for (int i = 0; i < maxInputs; ++i) {
+        NodePtr input = getInput(i);
+        // The set also marks the nodes already visited
+        if ( input && nodes->insert(input).second ) {
+            input->getAllUpstreamNodes(nodes);
+        }
+    }
+}
+
 
 static Node::CanConnectInputReturnValue
 checkCanConnectNoMultiRes(const Node* output,
@@ -6468,6 +6500,109 @@ renderPreviewForDepth(const Image & srcImg,
     }
 }     // renderPreviewForDepth
 
+/**
+ * @brief Returns among the images of the node in the RAM cache for the given hash and time the one that is fully rendered
+ * and whose mipmap level is the closest to the given one, or NULL if there is none. Full resolution and draft renders
+ * are both acceptable for a preview. The image key does not include the plane, hence only images of the color plane
+ * with the given components are considered: the cache may also hold other planes of the node, e.g: motion vectors.
+ **/
+ImagePtr
+getClosestCachedImageForPreview(const NodePtr& node,
+                                U64 nodeHash,
+                                double time,
+                                unsigned int mipMapLevel,
+                                const ImageComponents& components)
+{
+    const std::string pluginID = node->getPluginID();
+    ImageList cachedImages;
+
+    for (int i = 0; i < 2; ++i) {
+        const bool draft = (i == 1);
+        if ( draft && !node->isDraftModeUsed() ) {
+            break;
+        }
+        ImageKey key(pluginID, nodeHash, time, ViewIdx(0), draft);
+        ImageList images;
+        if ( appPTR->getImage(key, &images) ) {
+            cachedImages.insert( cachedImages.end(), images.begin(), images.end() );
+        }
+    }
+
+    ImagePtr ret;
+    int bestDistance = 0;
+    for (ImageList::iterator it = cachedImages.begin(); it != cachedImages.end(); ++it) {
+        const ImagePtr& img = *it;
+        if ( img->getStorageMode() != eStorageModeRAM ) {
+            continue;
+        }
+        const ImageComponents& imgComps = img->getComponents();
+        if ( !imgComps.isColorPlane() || (imgComps != components) ) {
+            continue;
+        }
+        ImageBitDepthEnum depth = img->getBitDepth();
+        if ( (depth != eImageBitDepthByte) && (depth != eImageBitDepthShort) && (depth != eImageBitDepthFloat) ) {
+            continue;
+        }
+
+        // The viewer may have rendered only a portion of the image: the preview shows the whole region of definition
+        const unsigned int imgMipMapLevel = img->getMipMapLevel();
+        RectI rodPixel;
+        img->getRoD().toPixelEnclosing( imgMipMapLevel, img->getPixelAspectRatio(), &rodPixel );
+        const RectI bounds = img->getBounds();
+        if ( rodPixel.isNull() || !bounds.contains(rodPixel) ) {
+            continue;
+        }
+        std::list<RectI> restToRender;
+        img->getRestToRender(rodPixel, restToRender);
+        if ( !restToRender.empty() ) {
+            continue;
+        }
+
+        // Prefer the finer level when 2 levels are as close, it is downscaled anyway
+        int distance = std::abs( (int)imgMipMapLevel - (int)mipMapLevel );
+        if ( !ret || (distance < bestDistance) || ( (distance == bestDistance) && ( imgMipMapLevel < ret->getMipMapLevel() ) ) ) {
+            ret = img;
+            bestDistance = distance;
+        }
+    }
+
+    return ret;
+} // getClosestCachedImageForPreview
+
+void
+renderPreviewFromImage(const AppInstancePtr& app,
+                       const Image& img,
+                       int *width,
+                       int *height,
+                       unsigned int* buf)
+{
+    const ImageComponents& components = img.getComponents();
+    int elemCount = components.getNumComponents();
+
+    ///we convert only when input is Linear.
+    //Rec709 and srGB is acceptable for preview
+    bool convertToSrgb = app->getDefaultColorSpaceForBitDepth( img.getBitDepth() ) == eViewerColorSpaceLinear;
+
+    switch ( img.getBitDepth() ) {
+    case eImageBitDepthByte: {
+        renderPreviewForDepth<unsigned char, 255>(img, elemCount, width, height, convertToSrgb, buf);
+        break;
+    }
+    case eImageBitDepthShort: {
+        renderPreviewForDepth<unsigned short, 65535>(img, elemCount, width, height, convertToSrgb, buf);
+        break;
+    }
+    case eImageBitDepthHalf:
+        break;
+    case eImageBitDepthFloat: {
+        renderPreviewForDepth<float, 1>(img, elemCount, width, height, convertToSrgb, buf);
+        break;
+    }
+    case eImageBitDepthNone:
+        break;
+    }
+}
+
 NATRON_NAMESPACE_ANONYMOUS_EXIT
 
 
@@ -6475,7 +6610,8 @@ bool
 Node::makePreviewImage(SequenceTime time,
                        int *width,
                        int *height,
-                       unsigned int* buf)
+                       unsigned int* buf,
+                       bool allowRender)
 {
     if (!isNodeCreated()) {
         return false;
@@ -6502,7 +6638,7 @@ Node::makePreviewImage(SequenceTime time,
     if (isGroup) {
         NodePtr outputNode = isGroup->getOutputNodeInput(false);
         if (outputNode) {
-            return outputNode->makePreviewImage(time, width, height, buf);
+            return outputNode->makePreviewImage(time, width, height, buf, allowRender);
         }
         return false;
     } else {
@@ -6579,6 +6715,23 @@ Node::makePreviewImage(SequenceTime time,
         scale.y = scale.x;
 
 
+        // If the viewer already rendered this node, do not render it again
+        const ImageComponents outputComps = effect->getComponents(-1);
+        ImagePtr cachedImage = getClosestCachedImageForPreview(thisNode, nodeHash, time, mipMapLevel, outputComps);
+        if (cachedImage) {
+            renderPreviewFromImage(getApp(), *cachedImage, width, height, buf);
+            frameRenderArgs.reset();
+            appPTR->getAppTLS()->cleanupTLSForThread();
+
+            return true;
+        }
+        if (!allowRender) {
+            frameRenderArgs.reset();
+            appPTR->getAppTLS()->cleanupTLSForThread();
+
+            return false;
+        }
+
         RectI renderWindow;
         rod.toPixelEnclosing(mipMapLevel, par, &renderWindow);
 
@@ -6589,7 +6742,7 @@ Node::makePreviewImage(SequenceTime time,
 
         std::list<ImageComponents> requestedComps;
         ImageBitDepthEnum depth = effect->getBitDepth(-1);
-        requestedComps.push_back( effect->getComponents(-1) );
+        requestedComps.push_back(outputComps);
 
 
         // Exceptions are caught because the program can run without a preview,
@@ -6622,32 +6775,7 @@ Node::makePreviewImage(SequenceTime time,
             return false;
         }
 
-        const ImagePtr& img = planes.begin()->second;
-        const ImageComponents& components = img->getComponents();
-        int elemCount = components.getNumComponents();
-
-        ///we convert only when input is Linear.
-        //Rec709 and srGB is acceptable for preview
-        bool convertToSrgb = getApp()->getDefaultColorSpaceForBitDepth( img->getBitDepth() ) == eViewerColorSpaceLinear;
-
-        switch ( img->getBitDepth() ) {
-        case eImageBitDepthByte: {
-            renderPreviewForDepth<unsigned char, 255>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthShort: {
-            renderPreviewForDepth<unsigned short, 65535>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthHalf:
-            break;
-        case eImageBitDepthFloat: {
-            renderPreviewForDepth<float, 1>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthNone:
-            break;
-        }
+        renderPreviewFromImage(getApp(), *planes.begin()->second, width, height, buf);
     } // ParallelRenderArgsSetter
 
     ///Exit of the thread
@@ -9647,7 +9775,7 @@ bool
 Node::shouldCacheOutput(bool isFrameVaryingOrAnimated,
                         double time,
                         ViewIdx view,
-                        int /*visitsCount*/) const
+                        int visitsCount) const
 {
     /*
      * Here is a list of reasons when caching is enabled for a node:
@@ -9662,6 +9790,10 @@ Node::shouldCacheOutput(bool isFrameVaryingOrAnimated,
      * - The node is not frame varying, meaning it will always produce the same image at any time
      * - The node is a roto node and it is being edited
      * - The node does not support tiles
+     *
+     * Otherwise, unless caching is forced (by the user or by one of the reasons that do not depend on the node outputs),
+     * a node with a single output that is measured as cheap to render is not cached: its images are streamed so that
+     * they do not push the images of expensive nodes out of the cache.
      */
 
     std::list<NodeConstPtr> outputs;
@@ -9676,6 +9808,11 @@ Node::shouldCacheOutput(bool isFrameVaryingOrAnimated,
         return true;
     } else {
         if (sz == 1) {
+            // Even a cheap node is cached when the render visits it several times, so that it is rendered once
+            if ( (visitsCount <= 1) && isCheapRenderNotCached() ) {
+                return false;
+            }
+
             NodeConstPtr output = outputs.front();
             ViewerNodePtr isViewer = output->isEffectViewerNode();
             if (isViewer) {
@@ -9763,6 +9900,127 @@ Node::shouldCacheOutput(bool isFrameVaryingOrAnimated,
     return false;
 } // Node::shouldCacheOutput
 
+bool
+Node::isCheapRenderNotCached() const
+{
+    // These reasons to cache do not depend on how expensive the node is
+    if ( isForceCachingEnabled() ||
+         appPTR->isAggressiveCachingEnabled() ||
+         (_imp->effect->getRecursionLevel() > 0) ||
+         !_imp->effect->supportsTiles() ||
+         _imp->effect->doesTemporalClipAccess() ||
+         isRotoPaintingNode() ||
+         _imp->paintStroke.lock() ) {
+        return false;
+    }
+    NodeGroupPtr parentIsGroup = toNodeGroup( getGroup() );
+    if ( parentIsGroup && parentIsGroup->getNode()->isForceCachingEnabled() && (parentIsGroup->getOutputNodeInput(false).get() == this) ) {
+        return false;
+    }
+
+    QMutexLocker k(&_imp->cacheStatsMutex);
+
+    return _imp->cacheStats.isCheapToRender() && !_imp->cacheStats.admitCheapRenderSample();
+}
+
+void
+Node::reportRenderCost(double timeSpent,
+                       U64 renderedBytes,
+                       U64 cachedBytes)
+{
+    QMutexLocker k(&_imp->cacheStatsMutex);
+
+    _imp->cacheStats.addRender(timeSpent, renderedBytes, cachedBytes);
+}
+
+void
+Node::reportCacheLookup(bool found,
+                        double savedTime)
+{
+    QMutexLocker k(&_imp->cacheStatsMutex);
+
+    _imp->cacheStats.addLookup(found, savedTime);
+}
+
+void
+Node::getCacheStats(NodeCacheStats* stats) const
+{
+    QMutexLocker k(&_imp->cacheStatsMutex);
+
+    *stats = _imp->cacheStats;
+}
+
+bool
+Node::isCheapToRender() const
+{
+    QMutexLocker k(&_imp->cacheStatsMutex);
+
+    return _imp->cacheStats.isCheapToRender();
+}
+
+void
+NodeCacheStats::addRender(double timeSpent,
+                          U64 renderedBytes,
+                          U64 cachedBytes)
+{
+    if (renderedBytes == 0) {
+        return;
+    }
+
+    // Decay the previous measures so that they follow changes of the node parameters and of how its images are used
+    renderTimeSum = renderTimeSum * NATRON_CACHE_ADMISSION_COST_DECAY + timeSpent;
+    renderedBytesSum = renderedBytesSum * NATRON_CACHE_ADMISSION_COST_DECAY + (double)renderedBytes;
+    recentHits *= NATRON_CACHE_ADMISSION_COST_DECAY;
+    recentCachedRenders *= NATRON_CACHE_ADMISSION_COST_DECAY;
+    if (cachedBytes > 0) {
+        recentCachedRenders += 1.;
+    }
+    ++nRenderSamples;
+    this->cachedBytes += cachedBytes;
+}
+
+void
+NodeCacheStats::addLookup(bool found,
+                          double savedTime)
+{
+    if (found) {
+        ++hits;
+        recentHits += 1.;
+        this->savedTime += savedTime;
+    } else {
+        ++misses;
+    }
+}
+
+double
+NodeCacheStats::getRenderCostPerByte() const
+{
+    return renderedBytesSum > 0 ? renderTimeSum / renderedBytesSum : 0.;
+}
+
+bool
+NodeCacheStats::isCheapToRender() const
+{
+    if (nRenderSamples < NATRON_CACHE_ADMISSION_MIN_SAMPLES) {
+        return false;
+    }
+
+    // An image that was re-used n times from the cache saved n renders: weight the cost accordingly
+    double reuse = recentHits / std::max(recentCachedRenders, 1.);
+
+    return getRenderCostPerByte() * (1. + reuse) < NATRON_CACHE_ADMISSION_MIN_COST_PER_BYTE;
+}
+
+bool
+NodeCacheStats::admitCheapRenderSample()
+{
+    if (++nCheapRendersNotCached < NATRON_CACHE_ADMISSION_SAMPLING_PERIOD) {
+        return false;
+    }
+    nCheapRendersNotCached = 0;
+
+    return true;
+}
 
 bool
 Node::refreshMaskEnabledNess(int inputNb)
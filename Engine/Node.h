@@ -31,6 +31,7 @@
 #include <string>
 #include <map>
 #include <list>
+#include <set>
 #include <bitset>
 
 CLANG_DIAG_OFF(deprecated)
@@ -137,6 +138,80 @@ CLANG_DIAG_ON(deprecated)
 
 NATRON_NAMESPACE_ENTER;
 
+/**
+ * @brief Measures of the effectiveness of the cache for the images produced by a node, see Node::getCacheStats.
+ * They decide whether the node is cheaper to render again than to cache, see isCheapToRender.
+ **/
+struct NodeCacheStats
+{
+    // Number of cache lookups of the node images that found/did not find the image
+    U64 hits, misses;
+
+    // Render time in seconds that was saved by the hits
+    double savedTime;
+
+    // Bytes that were rendered by the node and stored in the cache
+    U64 cachedBytes;
+
+    // Sums of the render time in seconds and of the bytes produced, decayed at each render so recent renders weigh more
+    double renderTimeSum, renderedBytesSum;
+
+    // Hits and renders whose images were stored in the cache, decayed at each render like the sums above
+    double recentHits, recentCachedRenders;
+
+    // Number of renders that were measured
+    int nRenderSamples;
+
+    // Number of renders not cached because the node is cheap, since the last one that was cached anyway
+    int nCheapRendersNotCached;
+
+    NodeCacheStats()
+    : hits(0)
+    , misses(0)
+    , savedTime(0)
+    , cachedBytes(0)
+    , renderTimeSum(0)
+    , renderedBytesSum(0)
+    , recentHits(0)
+    , recentCachedRenders(0)
+    , nRenderSamples(0)
+    , nCheapRendersNotCached(0)
+    {
+    }
+
+    /**
+     * @brief Records a render of the node that took timeSpent seconds to produce renderedBytes, of which cachedBytes
+     * were written to the cache.
+     **/
+    void addRender(double timeSpent, U64 renderedBytes, U64 cachedBytes);
+
+    /**
+     * @brief Records a lookup of an image of the node in the cache.
+     * @param savedTime If the image was found, the time in seconds it took to render it
+     **/
+    void addLookup(bool found, double savedTime);
+
+    /**
+     * @brief Average render time in seconds per byte produced by the node, recent renders weighing more
+     **/
+    double getRenderCostPerByte() const;
+
+    /**
+     * @brief Returns true if the render cost per byte, weighted by how many times each cached image was re-used,
+     * is so low that it is cheaper to render the images again than to take memory from the cache.
+     * Returns false until enough renders were measured.
+     * The re-use is measured on the images that were cached: the lookups of the images that were not cached
+     * because the node was cheap always miss and would keep it cheap forever.
+     **/
+    bool isCheapToRender() const;
+
+    /**
+     * @brief Called when a render is not cached because the node is cheap. Returns true if the render must be cached
+     * anyway: a few renders are always cached so that the re-use of the images keeps being measured.
+     **/
+    bool admitCheapRenderSample();
+};
+
 struct NodePrivate;
 class Node
     : public QObject
@@ -744,6 +819,33 @@ public:
 
     bool shouldCacheOutput(bool isFrameVaryingOrAnimated, double time, ViewIdx view, int visitsCount) const;
 
+    /**
+     * @brief Called after a render of the node, see NodeCacheStats::addRender
+     **/
+    void reportRenderCost(double timeSpent, U64 renderedBytes, U64 cachedBytes);
+
+    /**
+     * @brief Called after a lookup of an image of this node in the cache, see NodeCacheStats::addLookup
+     **/
+    void reportCacheLookup(bool found, double savedTime);
+
+    void getCacheStats(NodeCacheStats* stats) const;
+
+    /**
+     * @brief Returns true if the node is cheaper to render again than to cache, see NodeCacheStats::isCheapToRender
+     **/
+    bool isCheapToRender() const;
+
+private:
+
+    /**
+     * @brief Used by shouldCacheOutput(): returns true if the render must not be cached because the node is cheap to
+     * render and caching is not forced. A few of these renders are cached anyway, see NodeCacheStats::admitCheapRenderSample
+     **/
+    bool isCheapRenderNotCached() const;
+
+public:
+
     /**
      * @brief If the session is a GUI session, then this function sets the position of the node on the nodegraph.
      **/
@@ -921,8 +1023,13 @@ public:
      *
      * The width and height might be modified by the function, so their value can
      * be queried at the end of the function
+     *
+     * The preview is made from the image of the color plane of this node in the cache, with the output components
+     * of the node and at the closest mipmap level, if there is one, e.g: if the viewer displayed it.
+     * Otherwise the node is rendered if allowRender is true. If it is false, nothing is rendered and the function
+     * returns false.
      **/
-    bool makePreviewImage(SequenceTime time, int *width, int *height, unsigned int* buf);
+    bool makePreviewImage(SequenceTime time, int *width, int *height, unsigned int* buf, bool allowRender);
 
     /**
      * @brief Returns true if the node is currently rendering a preview image.
@@ -1463,6 +1570,11 @@ public:
 
     bool isNodeUpstream(const NodeConstPtr& input) const;
 
+    /**
+     * @brief Inserts in nodes all the nodes connected upstream of this node, recursively.
+     **/
+    void getAllUpstreamNodes(std::set<NodePtr>* nodes) const;
+
 private:
 
 
@@ -318,4 +318,29 @@ NodeMetadata::getOutputFormat() const
     return _imp->outputFormat;
 }
 
+static std::size_t
+getComponentsSizeInBytes(const ImageComponents& components)
+{
+    std::size_t size = components.getLayerName().size() + components.getPairedLayerName().size() + components.getComponentsGlobalName().size();
+    const std::vector<std::string>& names = components.getComponentsNames();
+
+    for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+        size += sizeof(std::string) + it->size();
+    }
+
+    return size;
+}
+
+std::size_t
+NodeMetadata::getSizeInBytes() const
+{
+    std::size_t size = sizeof(NodeMetadata) + sizeof(NodeMetadataPrivate) + getComponentsSizeInBytes(_imp->outputData.components);
+
+    for (std::vector<PerInputData>::const_iterator it = _imp->inputsData.begin(); it != _imp->inputsData.end(); ++it) {
+        size += sizeof(PerInputData) + getComponentsSizeInBytes(it->components);
+    }
+
+    return size;
+}
+
 NATRON_NAMESPACE_EXIT;
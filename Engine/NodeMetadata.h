@@ -27,6 +27,8 @@
 
 #include "Global/Macros.h"
 
+#include <cstddef>
+
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/scoped_ptr.hpp>
 #endif
@@ -99,6 +101,11 @@ public:
 
     const RectI& getOutputFormat() const;
 
+    /**
+     * @brief Returns the approximate memory used by this object, in bytes.
+     **/
+    std::size_t getSizeInBytes() const;
+
 private:
 
     boost::scoped_ptr<NodeMetadataPrivate> _imp;
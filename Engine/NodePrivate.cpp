@@ -148,6 +148,8 @@ NodePrivate::NodePrivate(Node* publicInterface,
 , isLoadingPreset(false)
 , presetKnobs()
 , hostChannelSelectorEnabled(false)
+, cacheStatsMutex()
+, cacheStats()
 {
     nodePositionCoords[0] = nodePositionCoords[1] = INT_MIN;
     nodeSize[0] = nodeSize[1] = -1;
@@ -384,6 +384,10 @@ public:
     std::list<KnobIWPtr> presetKnobs;
 
     bool hostChannelSelectorEnabled;
+
+    // Cache admission statistics, see Node::isCheapToRender
+    mutable QMutex cacheStatsMutex;
+    NodeCacheStats cacheStats;
 };
 
 class RefreshingInputData_RAII
@@ -314,7 +314,8 @@ OfxEffectInstance::initializeDataAfterCreate()
     PluginPtr natronPlugin = getNode()->getPlugin();
     assert(natronPlugin);
 
-    OFX::Host::ImageEffect::ImageEffectPlugin* ofxPlugin = (OFX::Host::ImageEffect::ImageEffectPlugin*)natronPlugin->getProperty<void*>(kNatronPluginPropOpenFXPluginPtr);
+    // The OpenFX plug-in may not be loaded yet if the plug-ins were registered from the binary cache
+    OFX::Host::ImageEffect::ImageEffectPlugin* ofxPlugin = appPTR->getOfxPlugin(natronPlugin);
     assert(ofxPlugin);
     if (!ofxPlugin) {
         throw std::logic_error("OfxEffectInstance::initializeDataAfterCreate kNatronPluginPropOpenFXPluginPtr is NULL");
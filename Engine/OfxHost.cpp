@@ -34,6 +34,7 @@
 #include <algorithm> // transform, min, max
 #include <string>
 #include <cstring> // for std::memcpy, std::memset, std::strcmp
+#include <iostream>
 
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
@@ -41,6 +42,7 @@ CLANG_DIAG_OFF(deprecated-register) //'register' storage class specifier is depr
 CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QDateTime>
 #include <QtCore/QDir>
+#include <QtCore/QFileInfo>
 #include <QtCore/QMutex>
 #include <QtCore/QThreadPool>
 #include <QtCore/QCoreApplication>
@@ -97,6 +99,7 @@ CLANG_DIAG_ON(unknown-pragmas)
 #include "Engine/CreateNodeArgs.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/LibraryBinary.h"
+#include "Engine/MemoryFile.h"
 #include "Engine/Node.h"
 #include "Engine/FStreamsSupport.h"
 #include "Engine/OfxEffectInstance.h"
@@ -109,6 +112,7 @@ CLANG_DIAG_ON(unknown-pragmas)
 #include "Engine/StandardPaths.h"
 #include "Engine/TLSHolder.h"
 #include "Engine/ThreadPool.h"
+#include "Engine/Timer.h"
 
 #include "Serialization/NodeSerialization.h"
 
@@ -162,6 +166,25 @@ struct OfxHostPrivate
     int loadingPluginVersionMajor;
     int loadingPluginVersionMinor;
 
+    // Protects ofxPluginsCacheLoaded, bundlesBinaries & lazyLoadedBinaries
+    QMutex ofxPluginsCacheMutex;
+
+    // True once the OpenFX plug-ins cache was read and the plug-in directories scanned. This is not done
+    // at startup if the plug-ins could be registered from the binary cache.
+    bool ofxPluginsCacheLoaded;
+
+    // When registered from the binary cache: the binaries of each bundle, so that only the bundle of a plug-in
+    // is loaded when it is first instantiated. Bundles are removed from the map once loaded.
+    std::map<std::string, std::list<std::string> > bundlesBinaries;
+
+    // The binaries loaded on demand, they are not part of the OpenFX plug-ins cache which does not own them
+    std::list<OFX::Host::PluginBinary*> lazyLoadedBinaries;
+
+    // Startup-time instrumentation: time spent in loadingStatus() for each plug-in ID and time of each loading step
+    TimeLapse loadingTimer;
+    std::map<std::string, double> pluginsLoadingTime;
+    std::list<std::pair<std::string, double> > pluginsLoadReport;
+
     OfxHostPrivate()
         : imageEffectPluginCache()
         , tlsData( new TLSHolder<OfxHost::OfxHostTLSData>() )
@@ -172,6 +195,13 @@ struct OfxHostPrivate
         , loadingPluginID()
         , loadingPluginVersionMajor(0)
         , loadingPluginVersionMinor(0)
+        , ofxPluginsCacheMutex()
+        , ofxPluginsCacheLoaded(false)
+        , bundlesBinaries()
+        , lazyLoadedBinaries()
+        , loadingTimer()
+        , pluginsLoadingTime()
+        , pluginsLoadReport()
     {
     }
 };
@@ -186,6 +216,9 @@ OfxHost::~OfxHost()
 {
     //Clean up, to be polite.
     OFX::Host::PluginCache::clearPluginCache();
+    for (std::list<OFX::Host::PluginBinary*>::iterator it = _imp->lazyLoadedBinaries.begin(); it != _imp->lazyLoadedBinaries.end(); ++it) {
+        delete *it;
+    }
 
 #ifdef MULTI_THREAD_SUITE_USES_THREAD_SAFE_MUTEX_ALLOCATION
     delete _imp->pluginsMutexesLock;
@@ -801,9 +834,548 @@ getPluginShortcuts(const OFX::Host::ImageEffect::Descriptor& desc, std::list<Plu
     }
 }
 
+///Return the binary cache file holding the Natron plug-in descriptions of the OpenFX plug-ins
+static QString
+getBinaryCacheFilePath()
+{
+    QString ofxCachePath = getOFXCacheDirPath() + QLatin1Char('/');
+    QString ofxCacheFilePath = ofxCachePath + QString::fromUtf8("OFXDescCache_") +
+                               QString::fromUtf8(NATRON_VERSION_STRING) + QString::fromUtf8("_") +
+                               QString::fromUtf8(NATRON_DEVELOPMENT_STATUS) + QString::fromUtf8("_") +
+                               QString::number(NATRON_BUILD_NUMBER) + QString::fromUtf8(".bin");
+
+    return ofxCacheFilePath;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Identifies a binary cache file, the version must be incremented whenever the layout below changes
+#define kOfxBinaryCacheMagic "NatronOFXDescCache"
+#define kOfxBinaryCacheVersion 1
+
+// Maximum depth of sub-directories explored in a plug-in search path, to avoid looping on symbolic links
+#define kOfxBundleSearchMaxDepth 8
+
+// Set this environment variable to print the time spent loading each plug-in bundle at startup
+#define NATRON_OFX_LOAD_REPORT_ENV_VAR "NATRON_OFX_LOAD_REPORT"
+
+/**
+ * @brief A plug-in binary found on disk. The binary cache is valid only if the same binaries, with the same
+ * modification time and size, are found on disk.
+ **/
+struct OfxBundleCacheEntry
+{
+    std::string bundlePath;
+    std::string binaryPath;
+    qint64 modificationTime;
+    qint64 fileSize;
+
+    OfxBundleCacheEntry()
+        : bundlePath()
+        , binaryPath()
+        , modificationTime(0)
+        , fileSize(0)
+    {
+    }
+
+    bool operator==(const OfxBundleCacheEntry& other) const
+    {
+        return bundlePath == other.bundlePath && binaryPath == other.binaryPath &&
+               modificationTime == other.modificationTime && fileSize == other.fileSize;
+    }
+};
+
+/**
+ * @brief Everything needed to register an OpenFX plug-in in Natron without loading the plug-in binary
+ * nor the OpenFX plug-in cache.
+ **/
+struct OfxPluginCacheEntry
+{
+    std::string openfxId;
+    std::string pluginLabel;
+    std::string grouping;
+    std::string bundlePath;
+    std::string iconFileName;
+    std::string description;
+    int versionMajor, versionMinor;
+    bool isDescMarkdown;
+    bool isDeprecated;
+    bool isReader, isWriter;
+    int renderSafety;
+    int glSupport;
+    std::vector<std::string> formats;
+    double evaluation;
+    std::list<PluginActionShortcut> shortcuts;
+
+    OfxPluginCacheEntry()
+        : openfxId()
+        , pluginLabel()
+        , grouping()
+        , bundlePath()
+        , iconFileName()
+        , description()
+        , versionMajor(0)
+        , versionMinor(0)
+        , isDescMarkdown(false)
+        , isDeprecated(false)
+        , isReader(false)
+        , isWriter(false)
+        , renderSafety( (int)eRenderSafetyUnsafe )
+        , glSupport( (int)ePluginOpenGLRenderSupportNone )
+        , formats()
+        , evaluation(0)
+        , shortcuts()
+    {
+    }
+};
+
+class OfxBinaryCacheWriter
+{
+    std::string _buf;
+
+public:
+
+    OfxBinaryCacheWriter()
+        : _buf()
+    {
+    }
+
+    const std::string& buffer() const
+    {
+        return _buf;
+    }
+
+    template <typename T>
+    void writePOD(T value)
+    {
+        _buf.append( (const char*)&value, sizeof(T) );
+    }
+
+    void writeString(const std::string& str)
+    {
+        writePOD<quint32>( (quint32)str.size() );
+        _buf.append(str);
+    }
+};
+
+class OfxBinaryCacheReader
+{
+    const char* _ptr;
+    const char* _end;
+
+public:
+
+    OfxBinaryCacheReader(const char* data,
+                         std::size_t size)
+        : _ptr(data)
+        , _end(data + size)
+    {
+    }
+
+    template <typename T>
+    T readPOD()
+    {
+        if ( _ptr + sizeof(T) > _end ) {
+            throw std::runtime_error("Truncated OpenFX binary cache");
+        }
+        T ret;
+        std::memcpy(&ret, _ptr, sizeof(T));
+        _ptr += sizeof(T);
+
+        return ret;
+    }
+
+    std::string readString()
+    {
+        quint32 size = readPOD<quint32>();
+        if ( (std::size_t)(_end - _ptr) < size ) {
+            throw std::runtime_error("Truncated OpenFX binary cache");
+        }
+        std::string ret(_ptr, size);
+        _ptr += size;
+
+        return ret;
+    }
+};
+
 void
-OfxHost::loadOFXPlugins(IOPluginsMap* readersMap,
-                        IOPluginsMap* writersMap)
+findOFXBundles(const QString& dirPath,
+               int depth,
+               std::list<OfxBundleCacheEntry>* bundles)
+{
+    QDir dir(dirPath);
+    QStringList entries = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+
+    Q_FOREACH(const QString &entry, entries) {
+        QString path = dir.absoluteFilePath(entry);
+
+        if ( !entry.endsWith( QString::fromUtf8(".ofx.bundle") ) ) {
+            if (depth < kOfxBundleSearchMaxDepth) {
+                findOFXBundles(path, depth + 1, bundles);
+            }
+            continue;
+        }
+
+        // Binaries are located in Contents/<architecture>/. Record all of them, whatever the architecture,
+        // to avoid duplicating the architecture detection of the OpenFX host support library.
+        OfxBundleCacheEntry bundle;
+        bundle.bundlePath = path.toStdString();
+        bundles->push_back(bundle);
+
+        QDir contentsDir( path + QString::fromUtf8("/Contents") );
+        QStringList archs = contentsDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        Q_FOREACH(const QString &arch, archs) {
+            QDir archDir( contentsDir.absoluteFilePath(arch) );
+            QFileInfoList binaries = archDir.entryInfoList(QStringList( QString::fromUtf8("*.ofx") ), QDir::Files);
+            Q_FOREACH(const QFileInfo &binary, binaries) {
+                OfxBundleCacheEntry b;
+                b.bundlePath = bundle.bundlePath;
+                b.binaryPath = binary.absoluteFilePath().toStdString();
+                b.modificationTime = binary.lastModified().toMSecsSinceEpoch();
+                b.fileSize = binary.size();
+                bundles->push_back(b);
+            }
+        }
+    }
+} // findOFXBundles
+
+void
+writeBinaryOFXCache(const QString& filePath,
+                    const std::list<std::string>& searchPaths,
+                    const std::list<OfxBundleCacheEntry>& bundles,
+                    const std::list<OfxPluginCacheEntry>& plugins)
+{
+    OfxBinaryCacheWriter w;
+
+    w.writeString(kOfxBinaryCacheMagic);
+    w.writePOD<qint32>(kOfxBinaryCacheVersion);
+
+    w.writePOD<quint32>( (quint32)searchPaths.size() );
+    for (std::list<std::string>::const_iterator it = searchPaths.begin(); it != searchPaths.end(); ++it) {
+        w.writeString(*it);
+    }
+
+    w.writePOD<quint32>( (quint32)bundles.size() );
+    for (std::list<OfxBundleCacheEntry>::const_iterator it = bundles.begin(); it != bundles.end(); ++it) {
+        w.writeString(it->bundlePath);
+        w.writeString(it->binaryPath);
+        w.writePOD<qint64>(it->modificationTime);
+        w.writePOD<qint64>(it->fileSize);
+    }
+
+    w.writePOD<quint32>( (quint32)plugins.size() );
+    for (std::list<OfxPluginCacheEntry>::const_iterator it = plugins.begin(); it != plugins.end(); ++it) {
+        w.writeString(it->openfxId);
+        w.writeString(it->pluginLabel);
+        w.writeString(it->grouping);
+        w.writeString(it->bundlePath);
+        w.writeString(it->iconFileName);
+        w.writeString(it->description);
+        w.writePOD<qint32>(it->versionMajor);
+        w.writePOD<qint32>(it->versionMinor);
+        w.writePOD<quint8>(it->isDescMarkdown);
+        w.writePOD<quint8>(it->isDeprecated);
+        w.writePOD<quint8>(it->isReader);
+        w.writePOD<quint8>(it->isWriter);
+        w.writePOD<qint32>(it->renderSafety);
+        w.writePOD<qint32>(it->glSupport);
+        w.writePOD<quint32>( (quint32)it->formats.size() );
+        for (std::size_t i = 0; i < it->formats.size(); ++i) {
+            w.writeString(it->formats[i]);
+        }
+        w.writePOD<double>(it->evaluation);
+        w.writePOD<quint32>( (quint32)it->shortcuts.size() );
+        for (std::list<PluginActionShortcut>::const_iterator it2 = it->shortcuts.begin(); it2 != it->shortcuts.end(); ++it2) {
+            w.writeString(it2->actionID);
+            w.writeString(it2->actionLabel);
+            w.writePOD<qint32>( (int)it2->key );
+            w.writePOD<qint32>( (int)it2->modifiers );
+        }
+    }
+
+    // Write to a temporary file first so that another process never maps a half-written cache
+    QString tmpFilePath = filePath + QString::fromUtf8(".tmp");
+    const std::string& buf = w.buffer();
+    {
+        MemoryFile file(tmpFilePath.toStdString(), buf.size(), MemoryFile::eFileOpenModeEnumIfExistsTruncateElseCreate);
+        std::memcpy( file.data(), buf.data(), buf.size() );
+        file.flush(MemoryFile::eFlushTypeSync, NULL, 0);
+    }
+    if ( QFile::exists(filePath) ) {
+        QFile::remove(filePath);
+    }
+    QFile::rename(tmpFilePath, filePath);
+} // writeBinaryOFXCache
+
+/**
+ * @brief Reads the binary cache and returns true if it is still valid, i.e: it was written for the same
+ * search paths and the plug-in binaries on disk did not change.
+ **/
+bool
+readBinaryOFXCache(const QString& filePath,
+                   const std::list<std::string>& searchPaths,
+                   const std::list<OfxBundleCacheEntry>& bundles,
+                   std::list<OfxPluginCacheEntry>* plugins)
+{
+    if ( !QFile::exists(filePath) ) {
+        return false;
+    }
+    try {
+        MemoryFile file(filePath.toStdString(), MemoryFile::eFileOpenModeEnumIfExistsKeepElseFail);
+        if ( !file.data() ) {
+            return false;
+        }
+        OfxBinaryCacheReader r( file.data(), file.size() );
+
+        if ( (r.readString() != kOfxBinaryCacheMagic) || (r.readPOD<qint32>() != kOfxBinaryCacheVersion) ) {
+            return false;
+        }
+
+        quint32 nPaths = r.readPOD<quint32>();
+        if ( nPaths != searchPaths.size() ) {
+            return false;
+        }
+        for (std::list<std::string>::const_iterator it = searchPaths.begin(); it != searchPaths.end(); ++it) {
+            if (r.readString() != *it) {
+                return false;
+            }
+        }
+
+        quint32 nBundles = r.readPOD<quint32>();
+        if ( nBundles != bundles.size() ) {
+            return false;
+        }
+        for (std::list<OfxBundleCacheEntry>::const_iterator it = bundles.begin(); it != bundles.end(); ++it) {
+            OfxBundleCacheEntry b;
+            b.bundlePath = r.readString();
+            b.binaryPath = r.readString();
+            b.modificationTime = r.readPOD<qint64>();
+            b.fileSize = r.readPOD<qint64>();
+            if ( !(b == *it) ) {
+                return false;
+            }
+        }
+
+        quint32 nPlugins = r.readPOD<quint32>();
+        for (quint32 i = 0; i < nPlugins; ++i) {
+            OfxPluginCacheEntry p;
+            p.openfxId = r.readString();
+            p.pluginLabel = r.readString();
+            p.grouping = r.readString();
+            p.bundlePath = r.readString();
+            p.iconFileName = r.readString();
+            p.description = r.readString();
+            p.versionMajor = r.readPOD<qint32>();
+            p.versionMinor = r.readPOD<qint32>();
+            p.isDescMarkdown = (bool)r.readPOD<quint8>();
+            p.isDeprecated = (bool)r.readPOD<quint8>();
+            p.isReader = (bool)r.readPOD<quint8>();
+            p.isWriter = (bool)r.readPOD<quint8>();
+            p.renderSafety = r.readPOD<qint32>();
+            p.glSupport = r.readPOD<qint32>();
+            quint32 nFormats = r.readPOD<quint32>();
+            for (quint32 k = 0; k < nFormats; ++k) {
+                p.formats.push_back( r.readString() );
+            }
+            p.evaluation = r.readPOD<double>();
+            quint32 nShortcuts = r.readPOD<quint32>();
+            for (quint32 k = 0; k < nShortcuts; ++k) {
+                PluginActionShortcut s;
+                s.actionID = r.readString();
+                s.actionLabel = r.readString();
+                s.key = (Key)r.readPOD<qint32>();
+                s.modifiers = KeyboardModifiers( r.readPOD<qint32>() );
+                p.shortcuts.push_back(s);
+            }
+            plugins->push_back(p);
+        }
+    } catch (const std::exception& e) {
+        appPTR->writeToErrorLog_mt_safe( QLatin1String("OpenFX"), QDateTime::currentDateTime(),
+                                         OfxHost::tr("Failure to read OpenFX plug-ins binary cache: %1").arg( QString::fromUtf8( e.what() ) ) );
+        plugins->clear();
+
+        return false;
+    }
+
+    return true;
+} // readBinaryOFXCache
+
+void
+makeCacheEntryFromOfxPlugin(OFX::Host::ImageEffect::ImageEffectPlugin* p,
+                            OfxPluginCacheEntry* entry)
+{
+    entry->openfxId = p->getIdentifier();
+    entry->grouping = p->getDescriptor().getPluginGrouping();
+    assert( p->getBinary() );
+    entry->bundlePath = p->getBinary()->getBundlePath();
+    entry->pluginLabel = OfxEffectInstance::makePluginLabel( p->getDescriptor().getShortLabel(),
+                                                             p->getDescriptor().getLabel(),
+                                                             p->getDescriptor().getLongLabel() );
+    entry->versionMajor = p->getVersionMajor();
+    entry->versionMinor = p->getVersionMinor();
+
+    {
+        try {
+            // kOfxPropIcon is normally only defined for parameter desctriptors
+            // (see <http://openfx.sourceforge.net/Documentation/1.3/ofxProgrammingReference.html#ParameterProperties>)
+            // but let's assume it may also be defained on the plugin descriptor.
+            entry->iconFileName = p->getDescriptor().getProps().getStringProperty(kOfxPropIcon, 1); // dimension 1 is PNG icon
+        } catch (OFX::Host::Property::Exception) {
+        }
+
+        if ( entry->iconFileName.empty() ) {
+            // no icon defined by kOfxPropIcon, use the plug-in id value
+            entry->iconFileName = entry->openfxId + ".png";
+        }
+    }
+
+    RenderSafetyEnum renderSafety;
+    {
+        std::string safety = p->getDescriptor().getRenderThreadSafety();
+        if (safety == kOfxImageEffectRenderUnsafe) {
+            renderSafety =  eRenderSafetyUnsafe;
+        } else if (safety == kOfxImageEffectRenderInstanceSafe) {
+            renderSafety = eRenderSafetyInstanceSafe;
+        } else if (safety == kOfxImageEffectRenderFullySafe) {
+            if ( p->getDescriptor().getHostFrameThreading() ) {
+                renderSafety = eRenderSafetyFullySafeFrame;
+            } else {
+                renderSafety = eRenderSafetyFullySafe;
+            }
+        } else {
+            qDebug() << "Unknown thread safety level: " << safety.c_str();
+            renderSafety = eRenderSafetyUnsafe;
+        }
+    }
+    entry->renderSafety = (int)renderSafety;
+
+    PluginOpenGLRenderSupport glSupport = ePluginOpenGLRenderSupportNone;
+    {
+        const std::string& str = p->getDescriptor().getProps().getStringProperty(kOfxImageEffectPropOpenGLRenderSupported);
+        if (str == "false") {
+            glSupport = ePluginOpenGLRenderSupportNone;
+        } else if (str == "needed") {
+            glSupport = ePluginOpenGLRenderSupportNeeded;
+        } else if (str == "true") {
+            glSupport = ePluginOpenGLRenderSupportYes;
+        }
+    }
+    entry->glSupport = (int)glSupport;
+
+    const std::set<std::string> & contexts = p->getContexts();
+    entry->isReader = contexts.find(kOfxImageEffectContextReader) != contexts.end();
+    entry->isWriter = contexts.find(kOfxImageEffectContextWriter) != contexts.end();
+    entry->isDeprecated = p->getDescriptor().isDeprecated();
+    entry->description = p->getDescriptor().getProps().getStringProperty(kOfxPropPluginDescription);
+    entry->isDescMarkdown = (bool)p->getDescriptor().getProps().getIntProperty(kNatronOfxPropDescriptionIsMarkdown);
+
+    getPluginShortcuts(p->getDescriptor(), &entry->shortcuts);
+
+    ///if this plugin's descriptor has the kTuttleOfxImageEffectPropSupportedExtensions property,
+    ///use it to fill the readersMap and writersMap
+    int formatsCount = p->getDescriptor().getProps().getDimension(kTuttleOfxImageEffectPropSupportedExtensions);
+    entry->formats.resize(formatsCount);
+    for (int k = 0; k < formatsCount; ++k) {
+        entry->formats[k] = p->getDescriptor().getProps().getStringProperty(kTuttleOfxImageEffectPropSupportedExtensions, k);
+        std::transform(entry->formats[k].begin(), entry->formats[k].end(), entry->formats[k].begin(), ::tolower);
+    }
+
+    entry->evaluation = p->getDescriptor().getProps().getDoubleProperty(kTuttleOfxImageEffectPropEvaluation);
+} // makeCacheEntryFromOfxPlugin
+
+/**
+ * @brief Registers the plug-in in Natron. The OpenFX plug-in may be NULL if it was not loaded yet, in which case
+ * it will be looked up on first instantiation (see OfxHost::getOfxPlugin).
+ **/
+void
+registerPluginFromCacheEntry(const OfxPluginCacheEntry& entry,
+                             OFX::Host::ImageEffect::ImageEffectPlugin* p,
+                             IOPluginsMap* readersMap,
+                             IOPluginsMap* writersMap)
+{
+    const std::string& openfxId = entry.openfxId;
+    std::vector<std::string> groups = OfxEffectInstance::makePluginGrouping(openfxId,
+                                                                            entry.versionMajor, entry.versionMinor,
+                                                                            entry.pluginLabel, entry.grouping);
+    std::string resourcesPath = entry.bundlePath + "/Contents/Resources/";
+    std::string groupIconFilename;
+
+    if (groups.size() > 0) {
+        groupIconFilename = resourcesPath;
+        // the plugin grouping has no descriptor, just try the default filename.
+        groupIconFilename.append(groups[0]);
+        groupIconFilename.append(".png");
+    } else {
+        //Use default Misc group when the plug-in doesn't belong to a group
+        groups.push_back(PLUGIN_GROUP_DEFAULT);
+    }
+    std::vector<std::string> groupIcons;
+    groupIcons.push_back(groupIconFilename);
+    for (std::size_t i = 1; i < groups.size(); ++i) {
+        std::string groupIconPath = resourcesPath;
+        for (std::size_t j = 0; j <= i; ++j) {
+            groupIconPath += groups[j];
+            if (j < i) {
+                groupIconPath += '/';
+            } else {
+                groupIconPath.append(".png");
+            }
+        }
+        groupIcons.push_back(groupIconPath);
+    }
+
+    PluginPtr natronPlugin = Plugin::create((void*)OfxEffectInstance::create, openfxId, entry.pluginLabel, entry.versionMajor, entry.versionMinor, groups, groupIcons);
+    natronPlugin->setProperty<std::string>(kNatronPluginPropDescription, entry.description);
+    natronPlugin->setProperty<bool>(kNatronPluginPropDescriptionIsMarkdown, entry.isDescMarkdown);
+    natronPlugin->setProperty<std::string>(kNatronPluginPropResourcesPath, resourcesPath);
+    natronPlugin->setProperty<std::string>(kNatronPluginPropIconFilePath, entry.iconFileName);
+    natronPlugin->setProperty<int>(kNatronPluginPropRenderSafety, entry.renderSafety);
+    natronPlugin->setProperty<bool>(kNatronPluginPropIsDeprecated, entry.isDeprecated);
+    natronPlugin->setProperty<int>(kNatronPluginPropOpenGLSupport, entry.glSupport);
+    natronPlugin->setProperty<void*>(kNatronPluginPropOpenFXPluginPtr, (void*)p);
+
+    for (std::list<PluginActionShortcut>::const_iterator it = entry.shortcuts.begin(); it != entry.shortcuts.end(); ++it) {
+        natronPlugin->addActionShortcut(*it);
+    }
+
+    Key symbol = (Key)0;
+    KeyboardModifiers mods = eKeyboardModifierNone;
+    if (openfxId == PLUGINID_OFX_TRANSFORM) {
+        symbol = Key_T;
+    } else if (openfxId == PLUGINID_OFX_MERGE) {
+        symbol = Key_M;
+    } else if (openfxId == PLUGINID_OFX_GRADE) {
+        symbol = Key_G;
+    } else if (openfxId == PLUGINID_OFX_COLORCORRECT) {
+        symbol = Key_C;
+    } else if (openfxId == PLUGINID_OFX_BLURCIMG) {
+        symbol = Key_B;
+    }
+
+    natronPlugin->setProperty<int>(kNatronPluginPropShortcut, (int)symbol, 0);
+    natronPlugin->setProperty<int>(kNatronPluginPropShortcut, (int)mods, 1);
+
+    if (!entry.isDeprecated && entry.isReader && !entry.formats.empty() && readersMap) {
+        ///we're safe to assume that this plugin is a reader
+        for (std::size_t k = 0; k < entry.formats.size(); ++k) {
+            IOPluginSetForFormat& evalForFormat = (*readersMap)[entry.formats[k]];
+            evalForFormat.insert( IOPluginEvaluation(openfxId, entry.evaluation) );
+        }
+    } else if (!entry.isDeprecated && entry.isWriter && !entry.formats.empty() && writersMap) {
+        ///we're safe to assume that this plugin is a writer.
+        for (std::size_t k = 0; k < entry.formats.size(); ++k) {
+            IOPluginSetForFormat& evalForFormat = (*writersMap)[entry.formats[k]];
+            evalForFormat.insert( IOPluginEvaluation(openfxId, entry.evaluation) );
+        }
+    }
+
+    appPTR->registerPlugin(natronPlugin);
+} // registerPluginFromCacheEntry
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+void
+OfxHost::setupPluginCache()
 {
     assert( OFX::Host::PluginCache::getPluginCache() );
     /// set the version label in the global cache
@@ -838,7 +1410,11 @@ OfxHost::loadOFXPlugins(IOPluginsMap* readersMap,
     } catch (std::logic_error) {
         // ignore
     }
+} // OfxHost::setupPluginCache
 
+void
+OfxHost::loadOFXPluginsCache()
+{
     // The cache location depends on the OS.
     // On OSX, it will be ~/Library/Caches/<organization>/<application>/OFXLoadCache/
     //on Linux ~/.cache/<organization>/<application>/OFXLoadCache/
@@ -858,18 +1434,65 @@ OfxHost::loadOFXPlugins(IOPluginsMap* readersMap,
         }
     }
     OFX::Host::PluginCache::getPluginCache()->scanPluginFiles();
-    _imp->loadingPluginID.clear(); // finished loading plugins
+    loadingStatus(false, std::string(), 0, 0); // finished loading plugins
 
     // write the cache NOW (it won't change anyway)
     /// flush out the current cache
     writeOFXCache();
 
+    _imp->ofxPluginsCacheLoaded = true;
+} // OfxHost::loadOFXPluginsCache
+
+void
+OfxHost::loadOFXPlugins(IOPluginsMap* readersMap,
+                        IOPluginsMap* writersMap)
+{
+    TimeLapse timer;
+
+    setupPluginCache();
+
+    const std::list<std::string>& searchPaths = OFX::Host::PluginCache::getPluginCache()->getPluginPath();
+    std::list<OfxBundleCacheEntry> bundles;
+    for (std::list<std::string>::const_iterator it = searchPaths.begin(); it != searchPaths.end(); ++it) {
+        findOFXBundles(QString::fromUtf8( it->c_str() ), 0, &bundles);
+    }
+
+    // Fast path: if no plug-in binary changed since the last run, register the plug-ins from the binary cache.
+    // The OpenFX plug-in cache is only read (and the binaries loaded) when a plug-in is first instantiated.
+    QString binaryCacheFilePath = getBinaryCacheFilePath();
+    std::list<OfxPluginCacheEntry> cachedPlugins;
+    if ( readBinaryOFXCache(binaryCacheFilePath, searchPaths, bundles, &cachedPlugins) ) {
+        for (std::list<OfxBundleCacheEntry>::const_iterator it = bundles.begin(); it != bundles.end(); ++it) {
+            if ( !it->binaryPath.empty() ) {
+                _imp->bundlesBinaries[it->bundlePath].push_back(it->binaryPath);
+            }
+        }
+        for (std::list<OfxPluginCacheEntry>::const_iterator it = cachedPlugins.begin(); it != cachedPlugins.end(); ++it) {
+            registerPluginFromCacheEntry(*it, 0, readersMap, writersMap);
+        }
+        _imp->pluginsLoadReport.push_back( std::make_pair(std::string("<binary cache>"), timer.getTimeElapsedReset() ) );
+        printPluginsLoadReport();
+
+        return;
+    }
+
+    loadOFXPluginsCache();
+    {
+        // The time spent loading each binary is accounted for in its bundle below
+        double scanTime = timer.getTimeElapsedReset();
+        for (std::map<std::string, double>::const_iterator it = _imp->pluginsLoadingTime.begin(); it != _imp->pluginsLoadingTime.end(); ++it) {
+            scanTime -= it->second;
+        }
+        _imp->pluginsLoadReport.push_back( std::make_pair( std::string("<OpenFX cache and scan>"), std::max(0., scanTime) ) );
+    }
+
     /*Filling node name list and plugin grouping*/
     typedef std::map<OFX::Host::ImageEffect::MajorPlugin, OFX::Host::ImageEffect::ImageEffectPlugin *> PMap;
     const PMap& ofxPlugins =
         _imp->imageEffectPluginCache->getPluginsByIDMajor();
 
-
+    // Time spent describing and registering the plug-ins of each bundle
+    std::map<std::string, double> bundlesTime;
     for (PMap::const_iterator it = ofxPlugins.begin();
          it != ofxPlugins.end(); ++it) {
         OFX::Host::ImageEffect::ImageEffectPlugin* p = it->second;
@@ -878,159 +1501,133 @@ OfxHost::loadOFXPlugins(IOPluginsMap* readersMap,
             continue;
         }
 
-        std::string openfxId = p->getIdentifier();
-        const std::string & grouping = p->getDescriptor().getPluginGrouping();
-        const std::string & bundlePath = p->getBinary()->getBundlePath();
-        std::string pluginLabel = OfxEffectInstance::makePluginLabel( p->getDescriptor().getShortLabel(),
-                                                                      p->getDescriptor().getLabel(),
-                                                                      p->getDescriptor().getLongLabel() );
-        std::vector<std::string> groups = OfxEffectInstance::makePluginGrouping(p->getIdentifier(),
-                                                                   p->getVersionMajor(), p->getVersionMinor(),
-                                                                   pluginLabel, grouping);
-
-        assert( p->getBinary() );
-        std::string resourcesPath = bundlePath+ "/Contents/Resources/";
-        std::string iconFileName;
-        {
-            try {
-                // kOfxPropIcon is normally only defined for parameter desctriptors
-                // (see <http://openfx.sourceforge.net/Documentation/1.3/ofxProgrammingReference.html#ParameterProperties>)
-                // but let's assume it may also be defained on the plugin descriptor.
-                iconFileName = p->getDescriptor().getProps().getStringProperty(kOfxPropIcon, 1); // dimension 1 is PNG icon
-            } catch (OFX::Host::Property::Exception) {
-            }
+        OfxPluginCacheEntry entry;
+        makeCacheEntryFromOfxPlugin(p, &entry);
+        registerPluginFromCacheEntry(entry, p, readersMap, writersMap);
+        cachedPlugins.push_back(entry);
 
-            if ( iconFileName.empty() ) {
-                // no icon defined by kOfxPropIcon, use the plug-in id value
-                iconFileName = openfxId + ".png";
-            }
-        }
-        std::string groupIconFilename;
-        if (groups.size() > 0) {
-            groupIconFilename = resourcesPath;
-            // the plugin grouping has no descriptor, just try the default filename.
-            groupIconFilename.append(groups[0]);
-            groupIconFilename.append(".png");
-        } else {
-            //Use default Misc group when the plug-in doesn't belong to a group
-            groups.push_back(PLUGIN_GROUP_DEFAULT);
-        }
-        std::vector<std::string> groupIcons;
-        groupIcons.push_back(groupIconFilename);
-        for (std::size_t i = 1; i < groups.size(); ++i) {
-            std::string groupIconPath = resourcesPath;
-            for (std::size_t j = 0; j <= i; ++j) {
-                groupIconPath += groups[j];
-                if (j < i) {
-                    groupIconPath += '/';
-                } else {
-                    groupIconPath.append(".png");
-                }
-            }
-            groupIcons.push_back(groupIconPath);
+        double loadTime = timer.getTimeElapsedReset();
+        std::map<std::string, double>::const_iterator foundLoadTime = _imp->pluginsLoadingTime.find( p->getRawIdentifier() );
+        if ( foundLoadTime != _imp->pluginsLoadingTime.end() ) {
+            loadTime += foundLoadTime->second;
         }
+        bundlesTime[entry.bundlePath] += loadTime;
+    }
+    for (std::map<std::string, double>::const_iterator it = bundlesTime.begin(); it != bundlesTime.end(); ++it) {
+        _imp->pluginsLoadReport.push_back(*it);
+    }
 
-        RenderSafetyEnum renderSafety;
-        {
-            std::string safety = p->getDescriptor().getRenderThreadSafety();
-            if (safety == kOfxImageEffectRenderUnsafe) {
-                renderSafety =  eRenderSafetyUnsafe;
-            } else if (safety == kOfxImageEffectRenderInstanceSafe) {
-                renderSafety = eRenderSafetyInstanceSafe;
-            } else if (safety == kOfxImageEffectRenderFullySafe) {
-                if ( p->getDescriptor().getHostFrameThreading() ) {
-                    renderSafety = eRenderSafetyFullySafeFrame;
-                } else {
-                    renderSafety = eRenderSafetyFullySafe;
-                }
-            } else {
-                qDebug() << "Unknown thread safety level: " << safety.c_str();
-                renderSafety = eRenderSafetyUnsafe;
-            }
-        }
+    try {
+        QDir().mkpath( getOFXCacheDirPath() );
+        writeBinaryOFXCache(binaryCacheFilePath, searchPaths, bundles, cachedPlugins);
+    } catch (const std::exception& e) {
+        appPTR->writeToErrorLog_mt_safe( QLatin1String("OpenFX"), QDateTime::currentDateTime(),
+                                         tr("Failure to write OpenFX plug-ins binary cache: %1").arg( QString::fromUtf8( e.what() ) ) );
+    }
+    printPluginsLoadReport();
+} // loadOFXPlugins
 
-        PluginOpenGLRenderSupport glSupport = ePluginOpenGLRenderSupportNone;
-        {
-            const std::string& str = p->getDescriptor().getProps().getStringProperty(kOfxImageEffectPropOpenGLRenderSupported);
-            if (str == "false") {
-                glSupport = ePluginOpenGLRenderSupportNone;
-            } else if (str == "needed") {
-                glSupport = ePluginOpenGLRenderSupportNeeded;
-            } else if (str == "true") {
-                glSupport = ePluginOpenGLRenderSupportYes;
-            }
-        }
+void
+OfxHost::printPluginsLoadReport() const
+{
+    if ( qgetenv(NATRON_OFX_LOAD_REPORT_ENV_VAR).isEmpty() ) {
+        return;
+    }
 
-        const std::set<std::string> & contexts = p->getContexts();
-        std::set<std::string>::const_iterator foundReader = contexts.find(kOfxImageEffectContextReader);
-        std::set<std::string>::const_iterator foundWriter = contexts.find(kOfxImageEffectContextWriter);
-        const bool isDeprecated = p->getDescriptor().isDeprecated();
-        std::string description = p->getDescriptor().getProps().getStringProperty(kOfxPropPluginDescription);
-
-        bool isDescMarkdown = (bool)p->getDescriptor().getProps().getIntProperty(kNatronOfxPropDescriptionIsMarkdown);
-
-        PluginPtr natronPlugin = Plugin::create((void*)OfxEffectInstance::create, openfxId, pluginLabel, p->getVersionMajor(), p->getVersionMinor(), groups, groupIcons);
-        natronPlugin->setProperty<std::string>(kNatronPluginPropDescription, description);
-        natronPlugin->setProperty<bool>(kNatronPluginPropDescriptionIsMarkdown, isDescMarkdown);
-        natronPlugin->setProperty<std::string>(kNatronPluginPropResourcesPath, resourcesPath);
-        natronPlugin->setProperty<std::string>(kNatronPluginPropIconFilePath, iconFileName);
-        natronPlugin->setProperty<int>(kNatronPluginPropRenderSafety, renderSafety);
-        natronPlugin->setProperty<bool>(kNatronPluginPropIsDeprecated, isDeprecated);
-        natronPlugin->setProperty<int>(kNatronPluginPropOpenGLSupport, (int)glSupport);
-        natronPlugin->setProperty<void*>(kNatronPluginPropOpenFXPluginPtr, (void*)p);
-
-        std::list<PluginActionShortcut> shortcuts;
-        getPluginShortcuts(p->getDescriptor(), &shortcuts);
-        for (std::list<PluginActionShortcut>::iterator it = shortcuts.begin(); it!=shortcuts.end(); ++it) {
-            natronPlugin->addActionShortcut(*it);
-        }
+    // Slowest first
+    std::vector<std::pair<double, std::string> > sorted;
+    double total = 0.;
+    for (std::list<std::pair<std::string, double> >::const_iterator it = _imp->pluginsLoadReport.begin(); it != _imp->pluginsLoadReport.end(); ++it) {
+        sorted.push_back( std::make_pair(it->second, it->first) );
+        total += it->second;
+    }
+    std::sort( sorted.begin(), sorted.end() );
+    std::cout << "OpenFX plug-ins loading report (" << total * 1000. << " ms total):" << std::endl;
+    for (std::vector<std::pair<double, std::string> >::reverse_iterator it = sorted.rbegin(); it != sorted.rend(); ++it) {
+        std::cout << "    " << it->first * 1000. << " ms\t" << it->second << std::endl;
+    }
+}
 
-        Key symbol = (Key)0;
-        KeyboardModifiers mods = eKeyboardModifierNone;
-        if (openfxId == PLUGINID_OFX_TRANSFORM) {
-            symbol = Key_T;
-        } else if (openfxId == PLUGINID_OFX_MERGE) {
-            symbol = Key_M;
-        } else if (openfxId == PLUGINID_OFX_GRADE) {
-            symbol = Key_G;
-        } else if (openfxId == PLUGINID_OFX_COLORCORRECT) {
-            symbol = Key_C;
-        } else if (openfxId == PLUGINID_OFX_BLURCIMG) {
-            symbol = Key_B;
-        }
+OFX::Host::ImageEffect::ImageEffectPlugin*
+OfxHost::getOfxPlugin(const PluginPtr& plugin)
+{
+    OFX::Host::ImageEffect::ImageEffectPlugin* ret = (OFX::Host::ImageEffect::ImageEffectPlugin*)plugin->getProperty<void*>(kNatronPluginPropOpenFXPluginPtr);
 
-        natronPlugin->setProperty<int>(kNatronPluginPropShortcut, (int)symbol, 0);
-        natronPlugin->setProperty<int>(kNatronPluginPropShortcut, (int)mods, 1);
+    if (ret) {
+        return ret;
+    }
 
-        ///if this plugin's descriptor has the kTuttleOfxImageEffectPropSupportedExtensions property,
-        ///use it to fill the readersMap and writersMap
-        int formatsCount = p->getDescriptor().getProps().getDimension(kTuttleOfxImageEffectPropSupportedExtensions);
-        std::vector<std::string> formats(formatsCount);
-        for (int k = 0; k < formatsCount; ++k) {
-            formats[k] = p->getDescriptor().getProps().getStringProperty(kTuttleOfxImageEffectPropSupportedExtensions, k);
-            std::transform(formats[k].begin(), formats[k].end(), formats[k].begin(), ::tolower);
+    // The plug-in was registered from the binary cache: load only the binaries of its bundle, the OpenFX plug-ins cache
+    // is read and the plug-in directories scanned only if the plug-in cannot be found there.
+    QMutexLocker k(&_imp->ofxPluginsCacheMutex);
+    OFX::Host::ImageEffect::MajorPlugin key( plugin->getPluginID(), plugin->getMajorVersion() );
+    typedef std::map<OFX::Host::ImageEffect::MajorPlugin, OFX::Host::ImageEffect::ImageEffectPlugin *> PMap;
+    const PMap& ofxPlugins = _imp->imageEffectPluginCache->getPluginsByIDMajor();
+    PMap::const_iterator found = ofxPlugins.find(key);
+
+    if ( ( found == ofxPlugins.end() ) && !_imp->ofxPluginsCacheLoaded ) {
+        // The resources path is <bundle>/Contents/Resources/
+        QDir bundleDir( QString::fromUtf8( plugin->getProperty<std::string>(kNatronPluginPropResourcesPath).c_str() ) );
+        bundleDir.cdUp();
+        bundleDir.cdUp();
+        std::string bundlePath = bundleDir.absolutePath().toStdString();
+
+        std::map<std::string, std::list<std::string> >::iterator foundBundle = _imp->bundlesBinaries.find(bundlePath);
+        if ( foundBundle != _imp->bundlesBinaries.end() ) {
+            TimeLapse timer;
+            loadOFXBundleBinaries(foundBundle->first, foundBundle->second);
+            _imp->pluginsLoadReport.push_back( std::make_pair(bundlePath + " (deferred)", timer.getTimeElapsedReset() ) );
+            _imp->bundlesBinaries.erase(foundBundle);
+            printPluginsLoadReport();
+            found = ofxPlugins.find(key);
         }
+    }
 
-        double evaluation = p->getDescriptor().getProps().getDoubleProperty(kTuttleOfxImageEffectPropEvaluation);
+    if ( ( found == ofxPlugins.end() ) && !_imp->ofxPluginsCacheLoaded ) {
+        // Should not happen unless the bundle was modified since startup
+        TimeLapse timer;
+        loadOFXPluginsCache();
+        _imp->pluginsLoadReport.push_back( std::make_pair(std::string("<OpenFX cache and scan (deferred)>"), timer.getTimeElapsedReset() ) );
+        printPluginsLoadReport();
+        found = ofxPlugins.find(key);
+    }
 
+    if ( found != ofxPlugins.end() ) {
+        ret = found->second;
+        plugin->setProperty<void*>(kNatronPluginPropOpenFXPluginPtr, (void*)ret);
+    }
 
-        if (!isDeprecated && ( foundReader != contexts.end() ) && (formatsCount > 0) && readersMap) {
-            ///we're safe to assume that this plugin is a reader
-            for (std::size_t k = 0; k < formats.size(); ++k) {
-                IOPluginSetForFormat& evalForFormat = (*readersMap)[formats[k]];
-                evalForFormat.insert( IOPluginEvaluation(openfxId, evaluation) );
-            }
-        } else if (!isDeprecated && ( foundWriter != contexts.end() ) && (formatsCount > 0) && writersMap) {
-            ///we're safe to assume that this plugin is a writer.
-            for (std::size_t k = 0; k < formats.size(); ++k) {
-                IOPluginSetForFormat& evalForFormat = (*writersMap)[formats[k]];
-                evalForFormat.insert( IOPluginEvaluation(openfxId, evaluation) );
+    return ret;
+} // OfxHost::getOfxPlugin
+
+void
+OfxHost::loadOFXBundleBinaries(const std::string& bundlePath,
+                               const std::list<std::string>& binaries)
+{
+    OFX::Host::PluginCache* pluginCache = OFX::Host::PluginCache::getPluginCache();
+
+    // Binaries of all architectures were recorded: those that cannot be loaded on this architecture have no plug-in
+    for (std::list<std::string>::const_iterator it = binaries.begin(); it != binaries.end(); ++it) {
+        OFX::Host::PluginBinary* pb = new OFX::Host::PluginBinary(*it, bundlePath, pluginCache);
+        if ( pb->getNPlugins() == 0 ) {
+            delete pb;
+            continue;
+        }
+        _imp->lazyLoadedBinaries.push_back(pb);
+
+        // Same as what OFX::Host::PluginCache::scanPluginFiles() does for a new binary
+        for (int j = 0; j < pb->getNPlugins(); ++j) {
+            OFX::Host::Plugin* plug = &pb->getPlugin(j);
+            const OFX::Host::APICache::PluginAPICacheEntry& api = plug->getApiHandler();
+            api.loadFromPlugin(plug);
+            std::string reason;
+            if ( api.pluginSupported(plug, reason) ) {
+                api.confirmPlugin(plug);
             }
         }
-
-        appPTR->registerPlugin(natronPlugin);
     }
-} // loadOFXPlugins
+    loadingStatus(false, std::string(), 0, 0);
+} // OfxHost::loadOFXBundleBinaries
 
 void
 OfxHost::writeOFXCache()
@@ -1083,6 +1680,12 @@ OfxHost::loadingStatus(bool loading,
                        int versionMajor,
                        int versionMinor)
 {
+    // Accumulate the time spent loading the previous plug-in for the startup report
+    double elapsed = _imp->loadingTimer.getTimeElapsedReset();
+    if ( !_imp->loadingPluginID.empty() ) {
+        _imp->pluginsLoadingTime[_imp->loadingPluginID] += elapsed;
+    }
+
     // set the pluginID in case the plug-in tries to fetch the hostname property
     _imp->loadingPluginID = pluginId;
     _imp->loadingPluginVersionMajor = versionMajor;
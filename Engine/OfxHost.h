@@ -154,6 +154,13 @@ public:
 
     void clearPluginsLoadedCache();
 
+    /**
+     * @brief Returns the OpenFX plug-in corresponding to the given plug-in. If the plug-ins were registered
+     * from the binary cache at startup, this loads the binaries of the plug-in bundle the first time one of its
+     * plug-ins is instantiated.
+     **/
+    OFX::Host::ImageEffect::ImageEffectPlugin* getOfxPlugin(const PluginPtr& plugin);
+
     void setThreadAsActionCaller(OfxImageEffectInstance* instance, bool actionCaller);
 
     OFX::Host::ImageEffect::Descriptor* getPluginContextAndDescribe(OFX::Host::ImageEffect::ImageEffectPlugin* plugin,
@@ -188,6 +195,21 @@ private:
        the OFX plugin cache. (called by the destructor) */
     void writeOFXCache();
 
+    /*Sets the OpenFX plug-ins search paths*/
+    void setupPluginCache();
+
+    /*Reads the OpenFX plug-ins cache and scan the plug-ins directories,
+       loading the binaries that changed*/
+    void loadOFXPluginsCache();
+
+    /*Loads and describes the plug-ins of the given binaries of a bundle
+       without reading the OpenFX plug-ins cache*/
+    void loadOFXBundleBinaries(const std::string& bundlePath, const std::list<std::string>& binaries);
+
+    /*Prints the time spent loading each plug-in bundle if
+       the NATRON_OFX_LOAD_REPORT environment variable is set*/
+    void printPluginsLoadReport() const;
+
     // get the virutals for viewport size, pixel scale, background colour
     const std::string &getStringProperty(const std::string &name, int n) const OFX_EXCEPTION_SPEC OVERRIDE;
     boost::scoped_ptr<OfxHostPrivate> _imp;
@@ -86,6 +86,8 @@ OutputEffectInstance::OutputEffectInstance(const NodePtr& node)
     : EffectInstance(node)
     , _outputEffectDataLock()
     , _renderSequenceRequests()
+    , _nextCombinedRenderWriters()
+    , _combinedRenderWriters()
     , _engine()
 {
 }
@@ -94,6 +96,8 @@ OutputEffectInstance::OutputEffectInstance(const OutputEffectInstance& other)
 : EffectInstance(other)
 , _outputEffectDataLock()
 , _renderSequenceRequests()
+, _nextCombinedRenderWriters()
+, _combinedRenderWriters()
 , _engine(other._engine)
 {
 }
@@ -161,6 +165,13 @@ OutputEffectInstance::renderFullSequence(bool isBlocking,
                                          int last,
                                          int frameStep)
 {
+    // The combined writers only apply to this sequence
+    std::list<OutputEffectInstancePtr> combinedWriters;
+    {
+        QMutexLocker k(&_outputEffectDataLock);
+        combinedWriters.swap(_nextCombinedRenderWriters);
+    }
+
     int viewsCount = getApp()->getProject()->getProjectViewsCount();
     const ViewIdx mainView(0);
     std::vector<ViewIdx> viewsToRender(viewsCount);
@@ -309,6 +320,7 @@ OutputEffectInstance::renderFullSequence(bool isBlocking,
         args.useStats = enableRenderStats;
         args.blocking = isBlocking;
         args.viewsToRender = viewsToRender;
+        args.combinedWriters = combinedWriters;
         _renderSequenceRequests.push_back(args);
         if (_renderSequenceRequests.size() > 1) {
             //The node is already rendering a sequence, queue it and dequeue it in notifyRenderFinished()
@@ -318,10 +330,33 @@ OutputEffectInstance::renderFullSequence(bool isBlocking,
     launchRenderSequence(args);
 } // OutputEffectInstance::renderFullSequence
 
+void
+OutputEffectInstance::setCombinedRenderWriters(const std::list<OutputEffectInstancePtr>& writers)
+{
+    QMutexLocker k(&_outputEffectDataLock);
+
+    _nextCombinedRenderWriters = writers;
+}
+
+std::list<OutputEffectInstancePtr>
+OutputEffectInstance::getCombinedRenderWriters() const
+{
+    QMutexLocker k(&_outputEffectDataLock);
+
+    return _combinedRenderWriters;
+}
+
 void
 OutputEffectInstance::launchRenderSequence(const RenderSequenceArgs& args)
 {
     createWriterPath();
+    for (std::list<OutputEffectInstancePtr>::const_iterator it = args.combinedWriters.begin(); it != args.combinedWriters.end(); ++it) {
+        (*it)->createWriterPath();
+    }
+    {
+        QMutexLocker k(&_outputEffectDataLock);
+        _combinedRenderWriters = args.combinedWriters;
+    }
 
     ///If you want writers to render backward (from last to first), just change the flag in parameter here
     _engine->renderFrameRange(args.blocking,
@@ -447,6 +482,7 @@ OutputEffectInstance::reportStats(int time,
     for (std::map<NodePtr, NodeRenderStats >::const_iterator it = stats.begin(); it != stats.end(); ++it) {
         ofile << "------------------------------- " << it->first->getScriptName_mt_safe() << "------------------------------- " << std::endl;
         ofile << "Time spent rendering: " << Timer::printAsTime(it->second.getTotalTimeSpentRendering(), false).toStdString() << std::endl;
+        ofile << "Time spent preparing the render: " << Timer::printAsTime(it->second.getTotalTimeSpentInRequestPass(), false).toStdString() << std::endl;
         const RectD & rod = it->second.getRoD();
         ofile << "Region of definition: x1 = " << rod.x1  << " y1 = " << rod.y1 << " x2 = " << rod.x2 << " y2 = " << rod.y2 << std::endl;
         ofile << "Is Identity to Effect? ";
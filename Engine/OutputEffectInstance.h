@@ -62,10 +62,14 @@ private:
         int frameStep;
         bool useStats;
         bool blocking;
+        std::list<OutputEffectInstancePtr> combinedWriters;
     };
 
     mutable QMutex _outputEffectDataLock;
     std::list<RenderSequenceArgs> _renderSequenceRequests;
+
+    // Writers to render with the next sequence and with the current one, @see setCombinedRenderWriters
+    std::list<OutputEffectInstancePtr> _nextCombinedRenderWriters, _combinedRenderWriters;
     RenderEnginePtr _engine;
 
 protected: // derives from EffectInstance, parent of AbstractOfxEffectInstance, OfxEffectInstance, DiskCacheNode, NodeGroup, NoOpBase, ViewerInstance
@@ -106,6 +110,18 @@ public:
      **/
     void renderFullSequence(bool isBlocking, bool enableRenderStats, BlockingBackgroundRender* renderController, int first, int last, int frameStep);
 
+    /**
+     * @brief Set the writers to render together with this one by the next call to renderFullSequence: each frame is rendered
+     * by this writer then by each of them, the images of the nodes they have in common upstream being kept in the cache
+     * until the last writer using them has rendered the frame. They must render the same frame range and views.
+     **/
+    void setCombinedRenderWriters(const std::list<OutputEffectInstancePtr>& writers);
+
+    /**
+     * @brief Returns the writers rendered together with this one by the current sequential render
+     **/
+    std::list<OutputEffectInstancePtr> getCombinedRenderWriters() const;
+
     void notifyRenderFinished();
 
     void renderCurrentFrame(bool canAbort);
@@ -26,6 +26,7 @@
 
 #include <iostream>
 #include <set>
+#include <map>
 #include <list>
 #include <algorithm> // min, max
 #include <cassert>
@@ -51,6 +52,7 @@
 #include "Engine/AppInstance.h"
 #include "Engine/EffectInstance.h"
 #include "Engine/Image.h"
+#include "Engine/ImageKey.h"
 #include "Engine/KnobFile.h"
 #include "Engine/Node.h"
 #include "Engine/OpenGLViewerI.h"
@@ -89,6 +91,15 @@
 
 #define NATRON_SCHEDULER_ABORT_AFTER_X_UNSUCCESSFUL_ITERATIONS 5000
 
+/*
+   Maximum amount of RAM held by the frames waiting in the buffer to be processed in order, as a fraction of the system RAM.
+   When reached, render threads which rendered a frame ahead wait for the scheduler to process the frames before it.
+ */
+#define NATRON_SCHEDULER_BUFFER_MAX_RAM_FRACTION 0.125
+
+// Interval at which the render threads waiting for room in the buffer check if the render was aborted
+#define NATRON_SCHEDULER_BUFFER_FULL_WAIT_MS 50
+
 NATRON_NAMESPACE_ENTER;
 
 
@@ -178,11 +189,54 @@ isBufferFull(int nbBufferedElement,
 
 #endif
 
+/**
+ * @brief Returns the effect actually writing the frames of the given output: the embedded writer of a Write node
+ **/
+static EffectInstancePtr
+getActiveWriter(const OutputEffectInstancePtr& output)
+{
+    WriteNodePtr isWrite = toWriteNode(output);
+
+    if (isWrite) {
+        NodePtr embeddedWriter = isWrite->getEmbeddedWriter();
+        if (embeddedWriter) {
+            return embeddedWriter->getEffectInstance();
+        }
+    }
+
+    return output;
+}
+
+/**
+ * @brief Returns the effects that want the begin/endSequenceRender actions for the render of the given output:
+ * the active writers of the output and of the writers rendered together with it which prefer a sequential render.
+ **/
+static void
+getSequentialRenderEffects(const OutputEffectInstancePtr& output,
+                           std::list<EffectInstancePtr>* effects)
+{
+    if (!output) {
+        return;
+    }
+    std::list<OutputEffectInstancePtr> outputs = output->getCombinedRenderWriters();
+    outputs.push_front(output);
+    for (std::list<OutputEffectInstancePtr>::iterator it = outputs.begin(); it != outputs.end(); ++it) {
+        EffectInstancePtr writer = getActiveWriter(*it);
+        SequentialPreferenceEnum pref = writer->getSequentialPreference();
+        if ( (pref == eSequentialPreferenceOnlySequential) || (pref == eSequentialPreferencePreferSequential) ) {
+            effects->push_back(writer);
+        }
+    }
+}
+
 struct OutputSchedulerThreadPrivate
 {
     FrameBuffer buf; //the frames rendered by the worker threads that needs to be rendered in order by the output device
     QWaitCondition bufEmptyCondition;
     mutable QMutex bufMutex;
+    std::size_t bufBytes; // the RAM held by the frames in buf, protected by bufMutex
+    std::size_t bufMaxBytes; // the render threads wait in bufNotFullCondition until bufBytes is below this
+    QWaitCondition bufNotFullCondition;
 
     //doesn't need any protection since it never changes and is set in the constructor
     OutputSchedulerThread::ProcessFrameModeEnum mode; //is the frame to be processed on the main-thread (i.e OpenGL rendering) or on the scheduler thread
@@ -246,6 +300,9 @@ struct OutputSchedulerThreadPrivate
         : buf()
         , bufEmptyCondition()
         , bufMutex()
+        , bufBytes(0)
+        , bufMaxBytes( (std::size_t)(getSystemTotalRAM_conditionnally() * NATRON_SCHEDULER_BUFFER_MAX_RAM_FRACTION) )
+        , bufNotFullCondition()
         , mode(mode)
         , timer(new Timer)
         , renderTimer()
@@ -302,6 +359,30 @@ struct OutputSchedulerThreadPrivate
         value.frame = image;
         value.stats = stats;
         buf.insert( std::make_pair(key, value) );
+        if (image) {
+            bufBytes += image->sizeInRAM();
+        }
+    }
+
+    /**
+     * @brief Returns true if a frame of the given size cannot be added to the buffer without exceeding bufMaxBytes.
+     * An empty buffer always accepts a frame.
+     **/
+    bool isBufferFull_locked(std::size_t frameBytes) const
+    {
+        ///Private, shouldn't lock
+        assert( !bufMutex.tryLock() );
+
+        return !buf.empty() && (bufBytes + frameBytes > bufMaxBytes);
+    }
+
+    void clearBuffer_locked()
+    {
+        ///Private, shouldn't lock
+        assert( !bufMutex.tryLock() );
+        buf.clear();
+        bufBytes = 0;
+        bufNotFullCondition.wakeAll();
     }
 
     struct ViewUniqueIDPair
@@ -367,6 +448,8 @@ struct OutputSchedulerThreadPrivate
                 if (alreadyRetrievedIndex.second) {
                     frames.push_back(it->second);
                     keepInBuf = false;
+                    std::size_t frameBytes = it->second.frame->sizeInRAM();
+                    bufBytes -= std::min(bufBytes, frameBytes);
                 }
             }
 
@@ -379,6 +462,10 @@ struct OutputSchedulerThreadPrivate
             buf.erase(range.first, range.second);
             buf.insert( toKeep.begin(), toKeep.end() );
         }
+        if ( !frames.empty() ) {
+            // Some room was made for the render threads waiting to append their frame
+            bufNotFullCondition.wakeAll();
+        }
     }
 
     void appendRunnable(RenderThreadTask* runnable)
@@ -1070,19 +1157,12 @@ OutputSchedulerThread::startRender()
     QMutexLocker l(&_imp->renderThreadsMutex);
 
 
-    ///If the output effect is sequential (only WriteFFMPEG for now)
-    EffectInstancePtr effect = _imp->outputEffect.lock();
-    WriteNodePtr isWrite = toWriteNode( effect );
-    if (isWrite) {
-        NodePtr embeddedWriter = isWrite->getEmbeddedWriter();
-        if (embeddedWriter) {
-            effect = embeddedWriter->getEffectInstance();
-        }
-    }
-    SequentialPreferenceEnum pref = effect->getSequentialPreference();
-    if ( (pref == eSequentialPreferenceOnlySequential) || (pref == eSequentialPreferencePreferSequential) ) {
+    ///If the output effects are sequential (only WriteFFMPEG for now)
+    std::list<EffectInstancePtr> sequentialEffects;
+    getSequentialRenderEffects(_imp->outputEffect.lock(), &sequentialEffects);
+    for (std::list<EffectInstancePtr>::iterator it = sequentialEffects.begin(); it != sequentialEffects.end(); ++it) {
         RenderScale scaleOne(1.);
-        if (effect->beginSequenceRender_public( firstFrame, lastFrame,
+        if ( (*it)->beginSequenceRender_public( firstFrame, lastFrame,
                                                 frameStep,
                                                 false,
                                                 scaleOne, true,
@@ -1090,7 +1170,7 @@ OutputSchedulerThread::startRender()
                                                 false,
                                                 ViewIdx(0),
                                                 false /*useOpenGL*/,
-                                                EffectOpenGLContextDataPtr() ) == eStatusFailed) {
+                                                EffectOpenGLContextDataPtr() ) == eStatusFailed ) {
             l.unlock();
 
 
@@ -1156,24 +1236,17 @@ OutputSchedulerThread::stopRender()
 #endif
     _imp->waitForRenderThreadsToQuit();
 
-    ///If the output effect is sequential (only WriteFFMPEG for now)
-    EffectInstancePtr effect = _imp->outputEffect.lock();
-    WriteNodePtr isWrite = toWriteNode( effect );
-    if (isWrite) {
-        NodePtr embeddedWriter = isWrite->getEmbeddedWriter();
-        if (embeddedWriter) {
-            effect = embeddedWriter->getEffectInstance();
-        }
-    }
-    SequentialPreferenceEnum pref = effect->getSequentialPreference();
-    if ( (pref == eSequentialPreferenceOnlySequential) || (pref == eSequentialPreferencePreferSequential) ) {
+    ///If the output effects are sequential (only WriteFFMPEG for now)
+    std::list<EffectInstancePtr> sequentialEffects;
+    getSequentialRenderEffects(_imp->outputEffect.lock(), &sequentialEffects);
+    for (std::list<EffectInstancePtr>::iterator it = sequentialEffects.begin(); it != sequentialEffects.end(); ++it) {
         int firstFrame, lastFrame;
         boost::shared_ptr<OutputSchedulerThreadStartArgs> args = _imp->runArgs.lock();
         firstFrame = args->firstFrame;
         lastFrame = args->lastFrame;
 
         RenderScale scaleOne(1.);
-        ignore_result( effect->endSequenceRender_public( firstFrame, lastFrame,
+        ignore_result( (*it)->endSequenceRender_public( firstFrame, lastFrame,
                                                          1,
                                                          !appPTR->isBackground(),
                                                          scaleOne, true,
@@ -1196,7 +1269,7 @@ OutputSchedulerThread::stopRender()
 
     {
         QMutexLocker k(&_imp->bufMutex);
-        _imp->buf.clear();
+        _imp->clearBuffer_locked();
     }
 
     _imp->renderTimer.reset();
@@ -1609,6 +1682,10 @@ OutputSchedulerThread::notifyFrameRendered(int frame,
         }
         //renderingIsFinished = _imp->renderFinished;
     } else {
+        if (isLastView) {
+            QMutexLocker l(&_imp->renderFinishedMutex);
+            ++_imp->nFramesRendered;
+        }
         nbTotalFrames = std::floor( (double)(runArgs->lastFrame - runArgs->firstFrame + 1) / runArgs->frameStep );
         if (runArgs->processTimelineDirection == eRenderDirectionForward) {
             nbFramesRendered = (frame - runArgs->firstFrame) / runArgs->frameStep;
@@ -1739,9 +1816,24 @@ OutputSchedulerThread::appendToBuffer_internal(double time,
             processFrame(frames);
         }
     } else {
-        ///Called by the scheduler thread when an image is rendered
+        ///Called by the render threads when an image is rendered
+        std::size_t frameBytes = frame ? frame->sizeInRAM() : 0;
 
         QMutexLocker l(&_imp->bufMutex);
+
+        // The frames are processed in order: if the output device is slower than the render threads, do not let them fill
+        // the RAM with frames rendered ahead. The frame expected by the scheduler is always accepted otherwise the render would stall.
+        while ( frame && _imp->isBufferFull_locked(frameBytes) && !isBeingAborted() && !mustQuitThread() ) {
+            int expectedTime;
+            {
+                QMutexLocker k(&_imp->framesToRenderMutex);
+                expectedTime = _imp->expectFrameToRender;
+            }
+            if ( (int)time == expectedTime ) {
+                break;
+            }
+            _imp->bufNotFullCondition.wait(&_imp->bufMutex, NATRON_SCHEDULER_BUFFER_FULL_WAIT_MS);
+        }
         _imp->appendBufferedFrame(time, view, stats, frame);
         if (wakeThread) {
             ///Wake up the scheduler thread that an image is available if it is asleep so it can process it.
@@ -2122,12 +2214,25 @@ RenderThreadTask::notifyIsRunning(bool running)
 //////////////////////// DefaultScheduler ////////////
 
 
+/**
+ * @brief Writers which can only receive the frames in order (e.g: movie encoders) are called by the scheduler thread
+ * in the order of the sequence, while the render threads render their input ahead in parallel.
+ **/
+static bool
+isOrderedWriter(const EffectInstancePtr& writer)
+{
+    return writer && writer->getSequentialPreference() == eSequentialPreferenceOnlySequential;
+}
+
 DefaultScheduler::DefaultScheduler(RenderEngine* engine,
                                    const OutputEffectInstancePtr& effect)
     : OutputSchedulerThread(engine, effect, eProcessFrameBySchedulerThread)
     , _effect(effect)
     , _currentTimeMutex()
     , _currentTime(0)
+    , _combinedRenderMutex()
+    , _combinedWriters()
+    , _combinedSharedNodes()
 {
     engine->setPlaybackMode(ePlaybackModeOnce);
 }
@@ -2136,6 +2241,71 @@ DefaultScheduler::~DefaultScheduler()
 {
 }
 
+void
+DefaultScheduler::getCombinedRender(std::vector<OutputEffectInstancePtr>* writers,
+                                    std::list<CombinedRenderSharedNode>* sharedNodes) const
+{
+    QMutexLocker k(&_combinedRenderMutex);
+
+    *writers = _combinedWriters;
+    *sharedNodes = _combinedSharedNodes;
+}
+
+void
+DefaultScheduler::initializeCombinedRender()
+{
+    OutputEffectInstancePtr effect = _effect.lock();
+    std::vector<OutputEffectInstancePtr> writers;
+
+    writers.push_back(effect);
+    std::list<OutputEffectInstancePtr> combinedWriters = effect->getCombinedRenderWriters();
+    writers.insert( writers.end(), combinedWriters.begin(), combinedWriters.end() );
+
+    // For each node upstream, the writers using it
+    typedef std::map<NodePtr, std::set<std::size_t> > NodeConsumersMap;
+    NodeConsumersMap consumers;
+    if (writers.size() > 1) {
+        for (std::size_t i = 0; i < writers.size(); ++i) {
+            std::set<NodePtr> upstream;
+            NodePtr writerNode = writers[i]->getNode();
+            writerNode->getAllUpstreamNodes(&upstream);
+            upstream.insert(writerNode);
+            for (std::set<NodePtr>::iterator it = upstream.begin(); it != upstream.end(); ++it) {
+                consumers[*it].insert(i);
+            }
+        }
+    }
+
+    // Only pin the nodes where the graph branches to different writers: the nodes above them are not needed
+    // once their image is rendered
+    std::list<CombinedRenderSharedNode> sharedNodes;
+    std::set<NodePtr> pinnedNodes;
+    for (NodeConsumersMap::iterator it = consumers.begin(); it != consumers.end(); ++it) {
+        int maxInputs = it->first->getMaxInputCount();
+        for (int i = 0; i < maxInputs; ++i) {
+            NodePtr input = it->first->getInput(i);
+            if (!input) {
+                continue;
+            }
+            NodeConsumersMap::iterator foundInput = consumers.find(input);
+            assert( foundInput != consumers.end() );
+            if ( ( foundInput->second.size() < 2 ) || ( foundInput->second.size() == it->second.size() ) ) {
+                continue;
+            }
+            if ( pinnedNodes.insert(input).second ) {
+                CombinedRenderSharedNode shared;
+                shared.node = input;
+                shared.lastWriterIndex = *foundInput->second.rbegin();
+                sharedNodes.push_back(shared);
+            }
+        }
+    }
+
+    QMutexLocker k(&_combinedRenderMutex);
+    _combinedWriters = writers;
+    _combinedSharedNodes = sharedNodes;
+} // DefaultScheduler::initializeCombinedRender
+
 class DefaultRenderFrameRunnable
     : public RenderThreadTask
 {
@@ -2144,18 +2314,20 @@ public:
 
 #ifndef NATRON_PLAYBACK_USES_THREAD_POOL
     DefaultRenderFrameRunnable(const OutputEffectInstancePtr& writer,
-                               OutputSchedulerThread* scheduler)
+                               DefaultScheduler* scheduler)
         : RenderThreadTask(writer, scheduler)
+        , _scheduler(scheduler)
     {
     }
 
 #else
     DefaultRenderFrameRunnable(const OutputEffectInstancePtr& writer,
-                               OutputSchedulerThread* scheduler,
+                               DefaultScheduler* scheduler,
                                const int time,
                                const bool useRenderStats,
                                const std::vector<int>& viewsToRender)
         : RenderThreadTask(writer, scheduler, time, useRenderStats, viewsToRender)
+        , _scheduler(scheduler)
     {
     }
 
@@ -2223,6 +2395,9 @@ private:
     }
 
 
+    // The images pinned in the cache for the writers rendered together, by the index of the last writer using them
+    typedef std::map<std::size_t, ImageList> PinnedImagesMap;
+
     virtual void renderFrame(int time,
                              const std::vector<ViewIdx>& viewsToRender,
                              bool enableRenderStats)
@@ -2235,16 +2410,87 @@ private:
             return;
         }
 
-        AbortableThread* isAbortableThread = dynamic_cast<AbortableThread*>( QThread::currentThread() );
-
         // Even if enableRenderStats is false, we at least profile the time spent rendering the frame when rendering with a Write node.
         // Though we don't enable render stats for sequential renders (e.g: WriteFFMPEG) since this is 1 file.
         RenderStatsPtr stats( new RenderStats(enableRenderStats) );
 
-        NodePtr outputNode = output->getNode();
+        // When writers are rendered together, they render this frame in turn so that the nodes they share upstream
+        // are rendered once, @see OutputEffectInstance::setCombinedRenderWriters
+        std::vector<OutputEffectInstancePtr> writers;
+        std::list<DefaultScheduler::CombinedRenderSharedNode> sharedNodes;
+        _scheduler->getCombinedRender(&writers, &sharedNodes);
+        if ( writers.empty() ) {
+            writers.push_back(output);
+        }
+
+        PinnedImagesMap pinnedImages;
+        bool renderAheadOfWriter = false;
+        for (std::size_t i = 0; i < writers.size(); ++i) {
+            // Notify we start rendering a frame to Python
+            runBeforeFrameRenderCallback( time, writers[i]->getNode() );
+
+            if ( !renderWriterFrame(time, viewsToRender, writers[i], i, sharedNodes, stats, &pinnedImages, &renderAheadOfWriter) ) {
+                return;
+            }
+
+            // The writers after this one do not use these images
+            pinnedImages.erase(i);
+        }
 
-        // Notify we start rendering a frame to Python
-        runBeforeFrameRenderCallback(time, outputNode);
+        // If the writer needs the frames in order, the scheduler notifies the frame once it is processed
+        if (!renderAheadOfWriter) {
+            for (std::size_t view = 0; view < viewsToRender.size(); ++view) {
+                _imp->scheduler->notifyFrameRendered(time, viewsToRender[view], viewsToRender, stats, eSchedulingPolicyFFA);
+            }
+        }
+    } // renderFrame
+
+    /**
+     * @brief Keeps in the cache the images of the shared nodes rendered by the given writer that are used by the writers after it.
+     * Must be called while the render args of the frame are set on the tree of the writer.
+     **/
+    void pinSharedNodesImages(double time,
+                              ViewIdx view,
+                              std::size_t writerIndex,
+                              const std::list<DefaultScheduler::CombinedRenderSharedNode>& sharedNodes,
+                              PinnedImagesMap* pinnedImages)
+    {
+        for (std::list<DefaultScheduler::CombinedRenderSharedNode>::const_iterator it = sharedNodes.begin(); it != sharedNodes.end(); ++it) {
+            if (it->lastWriterIndex <= writerIndex) {
+                continue;
+            }
+            NodePtr node = it->node.lock();
+            if (!node) {
+                continue;
+            }
+            U64 hash;
+            if ( !node->getEffectInstance()->getRenderHash(time, view, &hash) ) {
+                continue;
+            }
+            ImageKey key(node->getPluginID(), hash, time, view, false);
+            ImageList images;
+            if ( appPTR->getImage(key, &images) ) {
+                // A cache entry referenced outside of the cache is not evicted
+                ImageList& pinned = (*pinnedImages)[it->lastWriterIndex];
+                pinned.insert( pinned.end(), images.begin(), images.end() );
+            }
+        }
+    }
+
+    /**
+     * @brief Renders all views of the frame for the given writer. Returns false if the render failed, in which case
+     * the scheduler was notified.
+     **/
+    bool renderWriterFrame(int time,
+                           const std::vector<ViewIdx>& viewsToRender,
+                           const OutputEffectInstancePtr& output,
+                           std::size_t writerIndex,
+                           const std::list<DefaultScheduler::CombinedRenderSharedNode>& sharedNodes,
+                           const RenderStatsPtr& stats,
+                           PinnedImagesMap* pinnedImages,
+                           bool* renderAheadOfWriter)
+    {
+        AbortableThread* isAbortableThread = dynamic_cast<AbortableThread*>( QThread::currentThread() );
 
         try {
             // Writers always render at scale 1 (for now)
@@ -2253,20 +2499,25 @@ private:
 
             RectD rod;
 
-            EffectInstancePtr activeInputToRender = output;
-
             // If the output is a Write node, actually write is the internal write node encoder
-            WriteNodePtr isWrite = toWriteNode(output);
-            if (isWrite) {
-                NodePtr embeddedWriter = isWrite->getEmbeddedWriter();
-                if (embeddedWriter) {
-                    activeInputToRender = embeddedWriter->getEffectInstance();
+            EffectInstancePtr activeInputToRender = getActiveWriter(output);
+            assert(activeInputToRender);
+
+            // If the writer needs the frames in order, render only its input here: the scheduler thread calls the writer
+            // in order with the images appended to its buffer
+            *renderAheadOfWriter = isOrderedWriter(activeInputToRender);
+            EffectInstancePtr effectToRender = activeInputToRender;
+            if (*renderAheadOfWriter) {
+                effectToRender = activeInputToRender->getInput(0);
+                if (!effectToRender) {
+                    _imp->scheduler->notifyRenderFailure("Writer has no input");
+
+                    return false;
                 }
             }
-            assert(activeInputToRender);
 
             NodePtr activeInputNode = activeInputToRender->getNode();
-            const double par = activeInputToRender->getAspectRatio(-1);
+            const double par = effectToRender->getAspectRatio(-1);
             const bool isRenderDueToRenderInteraction = false;
             const bool isSequentialRender = true;
 
@@ -2300,22 +2551,49 @@ private:
                 } catch (...) {
                     _imp->scheduler->notifyRenderFailure("Error caught while rendering");
 
-                    return;
-
+                    return false;
                 }
 
                 // Get the hash now that we applied TLS
-                U64 activeInputHash;
-                bool gotHash = activeInputToRender->getRenderHash(time, tlsArgs->view, &activeInputHash);
+                U64 effectToRenderHash;
+                bool gotHash = effectToRender->getRenderHash(time, tlsArgs->view, &effectToRenderHash);
                 assert(gotHash);
                 (void)gotHash;
                 
                 // Call getRoD to know where to render
-                StatusEnum stat = activeInputToRender->getRegionOfDefinition_public(activeInputHash, time, scale, viewsToRender[view], &rod);
+                StatusEnum stat = effectToRender->getRegionOfDefinition_public(effectToRenderHash, time, scale, viewsToRender[view], &rod);
                 if (stat == eStatusFailed) {
                     _imp->scheduler->notifyRenderFailure("Error caught while rendering");
 
-                    return;
+                    return false;
+                }
+
+                // The region written is the RoD of the writer. When rendering ahead, only render the region of the input
+                // that the writer reads to write it, which may be smaller than the RoD of the input.
+                RectD writerRod = rod;
+                RectD renderRect = rod;
+                if (*renderAheadOfWriter) {
+                    U64 writerHash;
+                    gotHash = activeInputToRender->getRenderHash(time, tlsArgs->view, &writerHash);
+                    assert(gotHash);
+                    stat = activeInputToRender->getRegionOfDefinition_public(writerHash, time, scale, viewsToRender[view], &writerRod);
+                    if (stat == eStatusFailed) {
+                        _imp->scheduler->notifyRenderFailure("Error caught while rendering");
+
+                        return false;
+                    }
+                    RoIMap inputsRoi;
+                    activeInputToRender->getRegionsOfInterest_public(time, scale, writerRod, writerRod, viewsToRender[view], &inputsRoi);
+                    RoIMap::const_iterator foundRoI = inputsRoi.find(effectToRender);
+                    if ( ( foundRoI != inputsRoi.end() ) && !foundRoI->second.intersect(rod, &renderRect) ) {
+                        // The writer does not read anything from its input
+                        renderRect.clear();
+                    }
+                    if ( renderRect.isNull() ) {
+                        _imp->scheduler->notifyRenderFailure("Writer has nothing to write");
+
+                        return false;
+                    }
                 }
 
 
@@ -2334,30 +2612,31 @@ private:
 
 
                 //Retrieve bitdepth only
-                imageDepth = activeInputToRender->getBitDepth(-1);
+                imageDepth = activeInputToRender->getBitDepth(*renderAheadOfWriter ? 0 : -1);
                 components.clear();
 
-                EffectInstance::ComponentsNeededMap::iterator foundOutput = neededComps.find(-1);
+                // When rendering ahead, render the layers the writer needs from its input
+                EffectInstance::ComponentsNeededMap::iterator foundOutput = neededComps.find(*renderAheadOfWriter ? 0 : -1);
                 if ( foundOutput != neededComps.end() ) {
                     for (std::size_t j = 0; j < foundOutput->second.size(); ++j) {
                         components.push_back(foundOutput->second[j]);
                     }
                 }
 
-                // The render window is the RoD in pixel coordinates in our case
+                // The render window is the RoD (or the region read by the writer) in pixel coordinates in our case
                 RectI renderWindow;
-                rod.toPixelEnclosing(scale, par, &renderWindow);
+                renderRect.toPixelEnclosing(scale, par, &renderWindow);
 
-                // Optimize roi
-                stat = frameRenderArgs->computeRequestPass(mipMapLevel, rod);
+                // Optimize roi, the request pass starts from the writer
+                stat = frameRenderArgs->computeRequestPass(mipMapLevel, writerRod);
                 if (stat == eStatusFailed) {
                     _imp->scheduler->notifyRenderFailure("Error caught while rendering");
 
-                    return;
+                    return false;
                 }
 
                 // Launch render
-                RenderingFlagSetter flagIsRendering( activeInputToRender->getNode() );
+                RenderingFlagSetter flagIsRendering( effectToRender->getNode() );
                 std::map<ImageComponents, ImagePtr> planes;
                 boost::scoped_ptr<EffectInstance::RenderRoIArgs> renderArgs( new EffectInstance::RenderRoIArgs(time, //< the time at which to render
                                                                                                                scale, //< the scale at which to render
@@ -2373,7 +2652,7 @@ private:
                                                                                                                eStorageModeRAM,
                                                                                                                time) );
 
-                EffectInstance::RenderRoIRetCode retCode = activeInputToRender->renderRoI(*renderArgs, &planes);
+                EffectInstance::RenderRoIRetCode retCode = effectToRender->renderRoI(*renderArgs, &planes);
 
                 if (retCode != EffectInstance::eRenderRoIRetCodeOk) {
                     if (retCode == EffectInstance::eRenderRoIRetCodeAborted) {
@@ -2382,16 +2661,34 @@ private:
                         _imp->scheduler->notifyRenderFailure("Error caught while rendering");
                     }
 
-                    return;
+                    return false;
                 }
 
                 // If we need sequential rendering, pass the image to the output scheduler that will ensure the sequential ordering
-                _imp->scheduler->notifyFrameRendered(time, viewsToRender[view], viewsToRender, stats, eSchedulingPolicyFFA);
+                if (*renderAheadOfWriter) {
+                    if ( planes.empty() ) {
+                        _imp->scheduler->notifyRenderFailure("Error caught while rendering");
+
+                        return false;
+                    }
+                    // This may block until the scheduler has processed enough frames to make room in its buffer
+                    _imp->scheduler->appendToBuffer(time, viewsToRender[view], stats, planes.begin()->second);
+                }
+
+                if ( !sharedNodes.empty() ) {
+                    pinSharedNodesImages(time, viewsToRender[view], writerIndex, sharedNodes, pinnedImages);
+                }
             }
         } catch (const std::exception& e) {
             _imp->scheduler->notifyRenderFailure( std::string("Error while rendering: ") + e.what() );
+
+            return false;
         }
-    } // renderFrame
+
+        return true;
+    } // renderWriterFrame
+
+    DefaultScheduler* _scheduler;
 };
 
 #ifndef NATRON_PLAYBACK_USES_THREAD_POOL
@@ -2421,29 +2718,29 @@ DefaultScheduler::createRunnable(int frame,
  * or by the application's main-thread (typically to do OpenGL rendering).
  **/
 void
-DefaultScheduler::processFrame(const BufferedFrames& /*frames*/)
+DefaultScheduler::processFrame(const BufferedFrames& frames)
 {
-    // We don't have anymore writer that need to process things in order. WriteFFMPEG is doing it for us
-#if 0
-    assert(false);
+    // Writers which accept frames out of order are rendered directly by the render threads, @see DefaultRenderFrameRunnable::renderFrame
+    OutputEffectInstancePtr output = _effect.lock();
+    EffectInstancePtr effect = getActiveWriter(output);
 
-    assert( !frames.empty() );
-    //Only consider the first frame, we shouldn't have multiple view here anyway.
-    const BufferedFrame& frame = frames.front();
+    if ( !isOrderedWriter(effect) ) {
+        return;
+    }
 
     ///Writers render to scale 1 always
     RenderScale scale(1.);
-    OutputEffectInstancePtr effect = _effect.lock();
-    RectD rod;
-    RectI roi;
-    std::list<ImageComponents> components;
-    components.push_back( effect->getComponents(-1) );
-    ImageBitDepthEnum imageDepth = effect->getBitDepth(-1);
     const double par = effect->getAspectRatio(-1);
     const bool isRenderDueToRenderInteraction = false;
     const bool isSequentialRender = true;
 
     for (BufferedFrames::const_iterator it = frames.begin(); it != frames.end(); ++it) {
+        // The fake frame appended to wake-up the scheduler has no image
+        ImagePtr inputImage = boost::dynamic_pointer_cast<Image>(it->frame);
+        if (!inputImage) {
+            continue;
+        }
+
         AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
 
         setAbortInfo(isRenderDueToRenderInteraction, abortInfo, effect);
@@ -2467,23 +2764,48 @@ DefaultScheduler::processFrame(const BufferedFrames& /*frames*/)
         try {
             frameRenderArgs.reset(new ParallelRenderArgsSetter(tlsArgs));
         } catch (...) {
-            continue;
+            notifyRenderFailure("Error caught while rendering");
+
+            return;
         }
 
+        U64 hash;
+        bool gotHash = effect->getRenderHash(it->time, it->view, &hash);
+        assert(gotHash);
+        (void)gotHash;
 
-        U64 hash = effect->getRenderHash(it->time, it->view);
+        RectD rod;
+        StatusEnum stat = effect->getRegionOfDefinition_public(hash, it->time, scale, it->view, &rod);
+        if (stat == eStatusFailed) {
+            notifyRenderFailure("Error caught while rendering");
 
-        ignore_result( effect->getRegionOfDefinition_public(hash, it->time, scale, it->view, &rod) );
+            return;
+        }
+        RectI roi;
         rod.toPixelEnclosing(0, par, &roi);
 
+        std::list<ImageComponents> components;
+        {
+            EffectInstance::ComponentsNeededMap neededComps;
+            bool processAll;
+            SequenceTime ptTime;
+            int ptView;
+            std::bitset<4> processChannels;
+            NodePtr ptInput;
+            effect->getComponentsNeededAndProduced_public(true, true, it->time, it->view, &neededComps, &processAll, &ptTime, &ptView, &processChannels, &ptInput);
+            EffectInstance::ComponentsNeededMap::iterator foundOutput = neededComps.find(-1);
+            if ( foundOutput != neededComps.end() ) {
+                components.insert( components.end(), foundOutput->second.begin(), foundOutput->second.end() );
+            }
+        }
+        ImageBitDepthEnum imageDepth = effect->getBitDepth(-1);
 
         RenderingFlagSetter flagIsRendering( effect->getNode() );
-        ImagePtr inputImage = boost::dynamic_pointer_cast<Image>(it->frame);
-        assert(inputImage);
 
+        // The input was rendered ahead by the render threads: give it to the writer so it does not render it again
         EffectInstance::InputImagesMap inputImages;
         inputImages[0].push_back(inputImage);
-        boost::scoped_ptr<EffectInstance::RenderRoIArgs> renderArgs( new EffectInstance::RenderRoIArgs(frame.time,
+        boost::scoped_ptr<EffectInstance::RenderRoIArgs> renderArgs( new EffectInstance::RenderRoIArgs(it->time,
                                                                                                        scale, 0,
                                                                                                        it->view,
                                                                                                        true, // for writers, always by-pass cache for the write node only @see renderRoiInternal
@@ -2494,20 +2816,26 @@ DefaultScheduler::processFrame(const BufferedFrames& /*frames*/)
                                                                                                        false,
                                                                                                        effect,
                                                                                                        eStorageModeRAM,
-                                                                                                       frame.time,
+                                                                                                       it->time,
                                                                                                        inputImages) );
         try {
             std::map<ImageComponents, ImagePtr> planes;
-            EffectInstance::RenderRoIRetCode retCode;
-            retCode = effect->renderRoI(*renderArgs, &planes);
+            EffectInstance::RenderRoIRetCode retCode = effect->renderRoI(*renderArgs, &planes);
             if (retCode != EffectInstance::eRenderRoIRetCodeOk) {
-                notifyRenderFailure("");
+                if (retCode == EffectInstance::eRenderRoIRetCodeAborted) {
+                    notifyRenderFailure("Render aborted");
+                } else {
+                    notifyRenderFailure("Error caught while rendering");
+                }
+
+                return;
             }
         } catch (const std::exception& e) {
-            notifyRenderFailure( e.what() );
+            notifyRenderFailure( std::string("Error while rendering: ") + e.what() );
+
+            return;
         }
     }
-#endif
 } // DefaultScheduler::processFrame
 
 void
@@ -2559,12 +2887,13 @@ DefaultScheduler::handleRenderFailure(const std::string& errorMessage)
 SchedulingPolicyEnum
 DefaultScheduler::getSchedulingPolicy() const
 {
-    /*SequentialPreferenceEnum sequentiallity = _effect.lock()->getSequentialPreference();
-       if (sequentiallity == eSequentialPreferenceNotSequential) {*/
-    return eSchedulingPolicyFFA;
-    /*} else {
+    // Writers that can only encode frames in order (e.g: movie encoders) have their input rendered in parallel ahead
+    // and are called in order by the scheduler thread in processFrame
+    if ( isOrderedWriter( getActiveWriter( _effect.lock() ) ) ) {
         return eSchedulingPolicyOrdered;
-       }*/
+    }
+
+    return eSchedulingPolicyFFA;
 }
 
 void
@@ -2596,6 +2925,28 @@ DefaultScheduler::aboutToStartRender()
         isWrite->onSequenceRenderStarted();
     }
 
+    // The writers rendered together with this one do not start their own render engine
+    initializeCombinedRender();
+    std::list<OutputEffectInstancePtr> combinedWriters = effect->getCombinedRenderWriters();
+    for (std::list<OutputEffectInstancePtr>::iterator it = combinedWriters.begin(); it != combinedWriters.end(); ++it) {
+        if (!isBackGround) {
+            (*it)->setKnobsFrozen(true);
+        }
+        WriteNodePtr isCombinedWrite = toWriteNode(*it);
+        if (isCombinedWrite) {
+            isCombinedWrite->onSequenceRenderStarted();
+        }
+    }
+
+    runBeforeRenderCallback(effect);
+    for (std::list<OutputEffectInstancePtr>::iterator it = combinedWriters.begin(); it != combinedWriters.end(); ++it) {
+        runBeforeRenderCallback(*it);
+    }
+} // DefaultScheduler::aboutToStartRender
+
+void
+DefaultScheduler::runBeforeRenderCallback(const OutputEffectInstancePtr& effect)
+{
     std::string cb = effect->getNode()->getBeforeRenderCallback();
     if ( !cb.empty() ) {
         std::vector<std::string> args;
@@ -2642,7 +2993,7 @@ DefaultScheduler::aboutToStartRender()
             notifyRenderFailure( e.what() );
         }
     }
-} // DefaultScheduler::aboutToStartRender
+} // DefaultScheduler::runBeforeRenderCallback
 
 void
 DefaultScheduler::onRenderStopped(bool aborted)
@@ -2654,6 +3005,22 @@ DefaultScheduler::onRenderStopped(bool aborted)
         effect->setKnobsFrozen(false);
     }
 
+    std::list<OutputEffectInstancePtr> combinedWriters = effect->getCombinedRenderWriters();
+    {
+        for (std::list<OutputEffectInstancePtr>::iterator it = combinedWriters.begin(); it != combinedWriters.end(); ++it) {
+            if (!isBackGround) {
+                (*it)->setKnobsFrozen(false);
+            }
+            WriteNodePtr isCombinedWrite = toWriteNode(*it);
+            if (isCombinedWrite) {
+                isCombinedWrite->onSequenceRenderFinished();
+            }
+        }
+        QMutexLocker k(&_combinedRenderMutex);
+        _combinedWriters.clear();
+        _combinedSharedNodes.clear();
+    }
+
     {
         QString longText = QString::fromUtf8( effect->getScriptName_mt_safe().c_str() ) + tr(" ==> Rendering finished");
         appPTR->writeToOutputPipe(longText, QString::fromUtf8(kRenderingFinishedStringShort), true);
@@ -2661,6 +3028,16 @@ DefaultScheduler::onRenderStopped(bool aborted)
 
     effect->notifyRenderFinished();
 
+    runAfterRenderCallback(effect, aborted);
+    for (std::list<OutputEffectInstancePtr>::iterator it = combinedWriters.begin(); it != combinedWriters.end(); ++it) {
+        runAfterRenderCallback(*it, aborted);
+    }
+} // DefaultScheduler::onRenderStopped
+
+void
+DefaultScheduler::runAfterRenderCallback(const OutputEffectInstancePtr& effect,
+                                         bool aborted)
+{
     std::string cb = effect->getNode()->getAfterRenderCallback();
     if ( !cb.empty() ) {
         std::vector<std::string> args;
@@ -2713,7 +3090,7 @@ DefaultScheduler::onRenderStopped(bool aborted)
             //Ignore expcetions in callback since the render is finished anyway
         }
     }
-} // DefaultScheduler::onRenderStopped
+} // DefaultScheduler::runAfterRenderCallback
 
 ////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////
@@ -2724,11 +3101,41 @@ ViewerDisplayScheduler::ViewerDisplayScheduler(RenderEngine* engine,
                                                const boost::shared_ptr<ViewerInstance>& viewer)
     : OutputSchedulerThread(engine, viewer, eProcessFrameByMainThread) //< OpenGL rendering is done on the main-thread
     , _viewer(viewer)
+    , _playbackCacheMutex()
+    , _playbackCacheReserved(false)
+    , _playbackFirstFrame(0)
+    , _playbackLastFrame(0)
+    , _playbackFrameBytes(0)
 {
 }
 
 ViewerDisplayScheduler::~ViewerDisplayScheduler()
 {
+    QMutexLocker k(&_playbackCacheMutex);
+
+    if (_playbackCacheReserved) {
+        appPTR->releasePlaybackCache(this);
+    }
+}
+
+void
+ViewerDisplayScheduler::reservePlaybackCache_locked()
+{
+    assert( !_playbackCacheMutex.tryLock() );
+    // Until a frame is displayed, only the play range is pinned
+    std::size_t nFrames = (std::size_t)std::max(_playbackLastFrame - _playbackFirstFrame + 1, 1);
+    appPTR->reservePlaybackCache(this, _playbackFirstFrame, _playbackLastFrame, nFrames * _playbackFrameBytes);
+}
+
+void
+ViewerDisplayScheduler::aboutToStartRender()
+{
+    // Previews and analysis renders must not evict the frames about to be played
+    QMutexLocker k(&_playbackCacheMutex);
+
+    getFrameRangeToRender(_playbackFirstFrame, _playbackLastFrame);
+    _playbackCacheReserved = true;
+    reservePlaybackCache_locked();
 }
 
 /**
@@ -2747,12 +3154,23 @@ ViewerDisplayScheduler::processFrame(const BufferedFrames& frames)
         viewer->aboutToUpdateTextures();
     }
     if ( !frames.empty() ) {
+        std::size_t frameBytes = 0;
         for (BufferedFrames::const_iterator it = frames.begin(); it != frames.end(); ++it) {
             boost::shared_ptr<UpdateViewerParams> params = boost::dynamic_pointer_cast<UpdateViewerParams>(it->frame);
             assert(params);
+            frameBytes += params->sizeInRAM();
             viewer->updateViewer(params);
         }
         viewer->redrawViewerNow();
+
+        // Reserve enough memory in the viewer cache for all frames of the play range
+        QMutexLocker k(&_playbackCacheMutex);
+        if (frameBytes > _playbackFrameBytes) {
+            _playbackFrameBytes = frameBytes;
+            if (_playbackCacheReserved) {
+                reservePlaybackCache_locked();
+            }
+        }
     } else {
         viewer->redrawViewer();
     }
@@ -2952,6 +3370,12 @@ ViewerDisplayScheduler::handleRenderFailure(const std::string& /*errorMessage*/)
 void
 ViewerDisplayScheduler::onRenderStopped(bool /*/aborted*/)
 {
+    {
+        QMutexLocker k(&_playbackCacheMutex);
+        _playbackCacheReserved = false;
+        appPTR->releasePlaybackCache(this);
+    }
+
     ///Refresh all previews in the tree
     boost::shared_ptr<ViewerInstance> viewer = _viewer.lock();
 
@@ -3395,6 +3819,19 @@ RenderEngine::getDesiredFPS() const
     return _imp->scheduler ? _imp->scheduler->getDesiredFPS() : 24;
 }
 
+RenderDirectionEnum
+RenderEngine::getPlaybackDirection() const
+{
+    RenderDirectionEnum direction = eRenderDirectionForward;
+
+    if (_imp->scheduler) {
+        std::vector<ViewIdx> views;
+        _imp->scheduler->getLastRunArgs(&direction, &views);
+    }
+
+    return direction;
+}
+
 void
 RenderEngine::notifyFrameProduced(const BufferableObjectList& frames,
                                   const RenderStatsPtr& stats,
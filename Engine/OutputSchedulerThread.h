@@ -28,6 +28,7 @@
 #include "Global/Macros.h"
 
 #include <vector>
+#include <list>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
@@ -485,8 +486,30 @@ public:
 
     virtual ~DefaultScheduler();
 
+    /**
+     * @brief A node whose image is used by several of the writers rendered together: the image of each frame is kept
+     * in the cache until the last writer using it, given by its index in the writers, has rendered the frame.
+     **/
+    struct CombinedRenderSharedNode
+    {
+        NodeWPtr node;
+        std::size_t lastWriterIndex;
+    };
+
+    /**
+     * @brief Returns the writers to render for each frame, starting with the output of this scheduler,
+     * and the nodes they share, @see OutputEffectInstance::setCombinedRenderWriters
+     **/
+    void getCombinedRender(std::vector<OutputEffectInstancePtr>* writers, std::list<CombinedRenderSharedNode>* sharedNodes) const;
+
 private:
 
+    void initializeCombinedRender();
+
+    void runBeforeRenderCallback(const OutputEffectInstancePtr& effect);
+
+    void runAfterRenderCallback(const OutputEffectInstancePtr& effect, bool aborted);
+
     virtual void processFrame(const BufferedFrames& frames) OVERRIDE FINAL;
     virtual void timelineStepOne(RenderDirectionEnum direction) OVERRIDE FINAL;
     virtual void timelineGoTo(int time) OVERRIDE FINAL;
@@ -506,6 +529,11 @@ private:
     boost::weak_ptr<OutputEffectInstance> _effect;
     mutable QMutex _currentTimeMutex;
     int _currentTime;
+
+    // Protects _combinedWriters and _combinedSharedNodes which are set when a render starts
+    mutable QMutex _combinedRenderMutex;
+    std::vector<OutputEffectInstancePtr> _combinedWriters;
+    std::list<CombinedRenderSharedNode> _combinedSharedNodes;
 };
 
 
@@ -540,8 +568,20 @@ private:
     virtual SchedulingPolicyEnum getSchedulingPolicy() const OVERRIDE FINAL { return eSchedulingPolicyOrdered; }
 
     virtual int getLastRenderedTime() const OVERRIDE FINAL WARN_UNUSED_RETURN;
+    virtual void aboutToStartRender() OVERRIDE FINAL;
     virtual void onRenderStopped(bool aborted) OVERRIDE FINAL;
+
+    void reservePlaybackCache_locked();
+
     boost::weak_ptr<ViewerInstance> _viewer;
+
+    // Protects the fields below which are used to reserve cache for the play range, @see AppManager::reservePlaybackCache
+    QMutex _playbackCacheMutex;
+    bool _playbackCacheReserved;
+    int _playbackFirstFrame, _playbackLastFrame;
+
+    // Size of the textures of the largest frame displayed so far
+    std::size_t _playbackFrameBytes;
 };
 
 /**
@@ -694,6 +734,11 @@ public:
      **/
     double getDesiredFPS() const;
 
+    /**
+     * @brief Returns the direction of the last playback or sequential render started by the internal scheduler
+     **/
+    RenderDirectionEnum getPlaybackDirection() const;
+
     /**
      * @brief Quit all processing, making sure all threads are finished, this is not blocking
      **/
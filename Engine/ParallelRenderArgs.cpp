@@ -25,9 +25,20 @@
 #include "ParallelRenderArgs.h"
 
 #include <cassert>
+#include <set>
 #include <stdexcept>
+#include <vector>
 
+#if !defined(SBK_RUN) && !defined(Q_MOC_RUN)
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
+// /usr/local/include/boost/bind/arg.hpp:37:9: warning: unused typedef 'boost_static_assert_typedef_37' [-Wunused-local-typedef]
+#include <boost/bind.hpp>
 #include <boost/scoped_ptr.hpp>
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
+#endif
+
+#include <QtCore/QThread>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
 
 #include "Engine/AppInstance.h"
 #include "Engine/AbortableRenderInfo.h"
@@ -40,9 +51,12 @@
 #include "Engine/NodeGroup.h"
 #include "Engine/GPUContextPool.h"
 #include "Engine/OSGLContext.h"
+#include "Engine/RenderStats.h"
 #include "Engine/RotoContext.h"
 #include "Engine/RotoPaint.h"
 #include "Engine/RotoStrokeItem.h"
+#include "Engine/Timer.h"
+#include "Engine/TLSHolder.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/ViewerInstance.h"
 
@@ -107,6 +121,7 @@ EffectInstance::treeRecurseFunctor(bool isRenderFunctor,
                                    const NodePtr& treeRoot,
                                    FrameRequestMap* requests,  // roi functor specific
                                    FrameViewRequest* frameViewRequestData, // roi functor specific
+                                   const RequestPassArena* arena, // roi functor specific
                                    EffectInstance::InputImagesMap* inputImages, // render functor specific
                                    const EffectInstance::ComponentsNeededMap* neededComps, // render functor specific
                                    bool useScaleOneInputs, // render functor specific
@@ -241,6 +256,7 @@ EffectInstance::treeRecurseFunctor(bool isRenderFunctor,
                                                                                    node,
                                                                                    treeRoot,
                                                                                    roi,
+                                                                                   arena,
                                                                                    *requests);
 
                             if (stat == eStatusFailed) {
@@ -344,6 +360,7 @@ EffectInstance::getInputsRoIsFunctor(bool useTransforms,
                                      const NodePtr& /*callerNode*/,
                                      const NodePtr& treeRoot,
                                      const RectD& canonicalRenderWindow,
+                                     const RequestPassArena* arena,
                                      FrameRequestMap& requests)
 {
     NodeFrameRequestPtr nodeRequest;
@@ -435,8 +452,17 @@ EffectInstance::getInputsRoIsFunctor(bool useTransforms,
         double rodTime = time; //fvRequest->globalData.isIdentity ? fvRequest->globalData.inputIdentityTime : time;
         ViewIdx rodView = view; //fvRequest->globalData.isIdentity ? fvRequest->globalData.identityView : view;
 
+        // The actions that do not depend on the RoI were most likely evaluated by the pre-pass
+        const FrameViewActionsResults* prefetched = arena ? arena->getResults(node, time, view) : 0;
+
         // Get the RoD
-        StatusEnum stat = effect->getRegionOfDefinition_public(frameViewHash, rodTime, nodeRequest->mappedScale, rodView, &fvRequest->globalData.rod);
+        StatusEnum stat;
+        if (prefetched) {
+            stat = prefetched->rodStatus;
+            fvRequest->globalData.rod = prefetched->rod;
+        } else {
+            stat = effect->getRegionOfDefinition_public(frameViewHash, rodTime, nodeRequest->mappedScale, rodView, &fvRequest->globalData.rod);
+        }
         // If failed it should have failed earlier
         if ( (stat == eStatusFailed) && !fvRequest->globalData.rod.isNull() ) {
             return stat;
@@ -445,14 +471,22 @@ EffectInstance::getInputsRoIsFunctor(bool useTransforms,
 
         // Concatenate transforms if needed
         if (useTransforms) {
-            fvRequest->globalData.transforms.reset(new InputMatrixMap);
-            effect->tryConcatenateTransforms( time, view, nodeRequest->mappedScale, fvRequest->globalData.transforms.get() );
+            if (prefetched && prefetched->transforms) {
+                fvRequest->globalData.transforms = prefetched->transforms;
+            } else {
+                fvRequest->globalData.transforms.reset(new InputMatrixMap);
+                effect->tryConcatenateTransforms( time, view, nodeRequest->mappedScale, fvRequest->globalData.transforms.get() );
+            }
         }
 
         // Get the frame/views needed for this frame/view.
         // This is cached because we computed the hash in the ParallelRenderArgs constructor before.
-        U64 hash;
-        fvRequest->globalData.frameViewsNeeded = effect->getFramesNeeded_public(time, view, &hash);
+        if (prefetched && prefetched->hasFramesNeeded) {
+            fvRequest->globalData.frameViewsNeeded = prefetched->frameViewsNeeded;
+        } else {
+            U64 hash;
+            fvRequest->globalData.frameViewsNeeded = effect->getFramesNeeded_public(time, view, &hash);
+        }
     } // if (foundFrameView != nodeRequest->frames.end()) {
 
     assert(fvRequest);
@@ -484,6 +518,7 @@ EffectInstance::getInputsRoIsFunctor(bool useTransforms,
                                                    node,
                                                    treeRoot,
                                                    canonicalRenderWindow,
+                                                   arena,
                                                    requests);
 
             return stat;
@@ -505,6 +540,7 @@ EffectInstance::getInputsRoIsFunctor(bool useTransforms,
                                                    node,
                                                    treeRoot,
                                                    canonicalRenderWindow,
+                                                   arena,
                                                    requests);
 
             return stat;
@@ -567,6 +603,7 @@ EffectInstance::getInputsRoIsFunctor(bool useTransforms,
                                                               treeRoot,
                                                               &requests,
                                                               fvRequest,
+                                                              arena,
                                                               0,
                                                               0,
                                                               false,
@@ -578,6 +615,217 @@ EffectInstance::getInputsRoIsFunctor(bool useTransforms,
     return eStatusOK;
 } // EffectInstance::getInputsRoIsFunctor
 
+namespace {
+
+// The frame/views of a node evaluated by a wave of the pre-pass
+struct PrefetchNodeTask
+{
+    NodePtr node;
+    std::vector<FrameViewPair> frameViews;
+    std::vector<FrameViewActionsResults> results;
+    std::vector<char> succeeded;
+};
+
+typedef std::set<FrameViewPair, FrameView_compare_less> FrameViewSet;
+typedef std::map<NodePtr, FrameViewSet> PrefetchWave;
+
+void
+evaluateActionsForPrefetch(QThread* spawnerThread,
+                           unsigned int originalMipMapLevel,
+                           bool useTransforms,
+                           const RenderStatsPtr& stats,
+                           PrefetchNodeTask& task)
+{
+    QThread* curThread = QThread::currentThread();
+
+    if (spawnerThread != curThread) {
+        // The actions need the render TLS that was set on the thread running the request pass
+        appPTR->getAppTLS()->copyTLS(spawnerThread, curThread);
+    }
+
+    TimeLapse timer;
+    EffectInstancePtr effect = task.node->getEffectInstance();
+    unsigned int mappedLevel = effect->supportsRenderScale() ? originalMipMapLevel : 0;
+    RenderScale mappedScale( Image::getScaleFromMipMapLevel(mappedLevel) );
+
+    task.results.resize( task.frameViews.size() );
+    task.succeeded.resize(task.frameViews.size(), 0);
+    for (std::size_t i = 0; i < task.frameViews.size(); ++i) {
+        const FrameViewPair& fv = task.frameViews[i];
+        FrameViewActionsResults& results = task.results[i];
+        try {
+            U64 frameViewHash;
+            bool gotHash = effect->getRenderHash(fv.time, fv.view, &frameViewHash);
+            (void)gotHash;
+
+            results.rodStatus = effect->getRegionOfDefinition_public(frameViewHash, fv.time, mappedScale, fv.view, &results.rod);
+
+            // A disabled or identity node only needs its identity input: do not fetch the other inputs.
+            // The identity is evaluated over the region of definition, the request pass evaluates it again
+            // over the render window.
+            if ( (fv.view != 0) && (effect->isViewInvariant() == eViewInvarianceAllViewsInvariant) ) {
+                results.isIdentity = true;
+                results.identityInputNb = -2;
+                results.identityTime = fv.time;
+                results.identityView = ViewIdx(0);
+            } else if (results.rodStatus == eStatusOK) {
+                RectI rodPixel;
+                results.rod.toPixelEnclosing(mappedLevel, effect->getAspectRatio(-1), &rodPixel);
+                results.isIdentity = effect->isIdentity_public(true, frameViewHash, fv.time, mappedScale, rodPixel, fv.view, &results.identityTime, &results.identityView, &results.identityInputNb);
+            }
+
+            if (!results.isIdentity) {
+                if (useTransforms) {
+                    results.transforms.reset(new InputMatrixMap);
+                    effect->tryConcatenateTransforms( fv.time, fv.view, mappedScale, results.transforms.get() );
+                }
+                U64 hash;
+                results.frameViewsNeeded = effect->getFramesNeeded_public(fv.time, fv.view, &hash);
+                results.hasFramesNeeded = true;
+            }
+            task.succeeded[i] = 1;
+        } catch (...) {
+            // The request pass calls the actions again and reports the failure
+        }
+    }
+
+    if ( stats && stats->isInDepthProfilingEnabled() ) {
+        stats->addRequestPassInfosForNode( task.node, timer.getTimeElapsedReset() );
+    }
+
+    if (spawnerThread != curThread) {
+        appPTR->getAppTLS()->cleanupTLSForThread();
+    }
+}
+
+} // anon namespace
+
+void
+RequestPassArena::prefetch(double time,
+                           ViewIdx view,
+                           unsigned int mipMapLevel,
+                           bool useTransforms,
+                           const NodePtr& treeRoot,
+                           const RenderStatsPtr& stats)
+{
+    QThread* curThread = QThread::currentThread();
+    PrefetchWave wave;
+    {
+        FrameViewPair rootFrameView = {time, view};
+        wave[treeRoot].insert(rootFrameView);
+    }
+
+    while ( !wave.empty() ) {
+        // Nodes of a wave are independent from each other and evaluated concurrently. The frame/views of a
+        // single node are evaluated in sequence, so that instance safe plug-ins are never called concurrently.
+        // Unsafe plug-ins are evaluated on this thread.
+        std::vector<PrefetchNodeTask> concurrentTasks, unsafeTasks;
+        for (PrefetchWave::const_iterator it = wave.begin(); it != wave.end(); ++it) {
+            EffectInstancePtr effect = it->first->getEffectInstance();
+            if ( !effect || (effect->supportsRenderScaleMaybe() == EffectInstance::eSupportsMaybe) ) {
+                // Let the request pass fail on this node
+                continue;
+            }
+            PrefetchNodeTask task;
+            task.node = it->first;
+            task.frameViews.assign( it->second.begin(), it->second.end() );
+            if (effect->getCurrentRenderThreadSafety() == eRenderSafetyUnsafe) {
+                unsafeTasks.push_back(task);
+            } else {
+                concurrentTasks.push_back(task);
+            }
+        }
+        wave.clear();
+
+        if (concurrentTasks.size() > 1) {
+            QtConcurrent::blockingMap( concurrentTasks, boost::bind(&evaluateActionsForPrefetch, curThread, mipMapLevel, useTransforms, stats, _1) );
+        } else if ( !concurrentTasks.empty() ) {
+            evaluateActionsForPrefetch(curThread, mipMapLevel, useTransforms, stats, concurrentTasks.front());
+        }
+        for (std::vector<PrefetchNodeTask>::iterator it = unsafeTasks.begin(); it != unsafeTasks.end(); ++it) {
+            evaluateActionsForPrefetch(curThread, mipMapLevel, useTransforms, stats, *it);
+        }
+        concurrentTasks.insert( concurrentTasks.end(), unsafeTasks.begin(), unsafeTasks.end() );
+
+        // Record the results and build the next wave from the frame/views needed in input
+        for (std::vector<PrefetchNodeTask>::const_iterator it = concurrentTasks.begin(); it != concurrentTasks.end(); ++it) {
+            FrameViewsResults& nodeResults = _nodes[it->node];
+            EffectInstancePtr effect = it->node->getEffectInstance();
+            for (std::size_t i = 0; i < it->frameViews.size(); ++i) {
+                if (!it->succeeded[i]) {
+                    continue;
+                }
+                const FrameViewActionsResults& results = it->results[i];
+                nodeResults[it->frameViews[i]] = results;
+
+                if (results.isIdentity) {
+                    NodePtr identityNode;
+                    if (results.identityInputNb == -2) {
+                        identityNode = it->node;
+                    } else if (results.identityInputNb >= 0) {
+                        EffectInstancePtr identityInput = effect->getInput(results.identityInputNb);
+                        if (identityInput) {
+                            identityNode = identityInput->getNode();
+                        }
+                    }
+                    // Same as treeRecurseFunctor: non integer frames are not pre-rendered
+                    if ( identityNode && (results.identityTime == (int)results.identityTime) &&
+                         !getResults(identityNode, results.identityTime, results.identityView) ) {
+                        FrameViewPair identityFrameView = {results.identityTime, results.identityView};
+                        if ( (identityNode != it->node) || (identityFrameView.time != it->frameViews[i].time) || (identityFrameView.view != it->frameViews[i].view) ) {
+                            wave[identityNode].insert(identityFrameView);
+                        }
+                    }
+                    continue;
+                }
+
+                for (FramesNeededMap::const_iterator it2 = results.frameViewsNeeded.begin(); it2 != results.frameViewsNeeded.end(); ++it2) {
+                    EffectInstancePtr inputEffect = EffectInstance::resolveInputEffectForFrameNeeded(it2->first, effect.get(), results.transforms);
+                    if (!inputEffect) {
+                        continue;
+                    }
+                    NodePtr inputNode = inputEffect->getNode();
+                    for (FrameRangesMap::const_iterator viewIt = it2->second.begin(); viewIt != it2->second.end(); ++viewIt) {
+                        for (std::size_t range = 0; range < viewIt->second.size(); ++range) {
+                            // Same as treeRecurseFunctor: non integer ranges are not pre-rendered
+                            const RangeD& r = viewIt->second[range];
+                            if ( (r.min != (int)r.min) || (r.max != (int)r.max) ) {
+                                continue;
+                            }
+                            for (double f = r.min; f <= r.max; f += 1.) {
+                                if ( getResults(inputNode, f, viewIt->first) ) {
+                                    continue;
+                                }
+                                FrameViewPair inputFrameView = {f, viewIt->first};
+                                wave[inputNode].insert(inputFrameView);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+} // RequestPassArena::prefetch
+
+const FrameViewActionsResults*
+RequestPassArena::getResults(const NodePtr& node,
+                             double time,
+                             ViewIdx view) const
+{
+    NodesResults::const_iterator foundNode = _nodes.find(node);
+
+    if ( foundNode == _nodes.end() ) {
+        return 0;
+    }
+    FrameViewPair frameView = {time, view};
+    FrameViewsResults::const_iterator foundFrameView = foundNode->second.find(frameView);
+    if ( foundFrameView == foundNode->second.end() ) {
+        return 0;
+    }
+
+    return &foundFrameView->second;
+}
+
 StatusEnum
 EffectInstance::computeRequestPass(double time,
                                    ViewIdx view,
@@ -587,6 +835,19 @@ EffectInstance::computeRequestPass(double time,
                                    FrameRequestMap& request)
 {
     bool doTransforms = appPTR->getCurrentSettings()->isTransformConcatenationEnabled();
+
+    RenderStatsPtr stats;
+    {
+        ParallelRenderArgsPtr frameArgs = treeRoot->getEffectInstance()->getParallelRenderArgsTLS();
+        if (frameArgs) {
+            stats = frameArgs->stats;
+        }
+    }
+    // Evaluate the actions of independent branches concurrently first, the recursion below
+    // then only has to compute the regions of interest
+    RequestPassArena arena;
+    arena.prefetch(time, view, mipMapLevel, doTransforms, treeRoot, stats);
+
     StatusEnum stat = getInputsRoIsFunctor(doTransforms,
                                            time,
                                            view,
@@ -595,6 +856,7 @@ EffectInstance::computeRequestPass(double time,
                                            treeRoot,
                                            treeRoot,
                                            renderWindow,
+                                           &arena,
                                            request);
 
     if (stat == eStatusFailed) {
@@ -1105,4 +1367,18 @@ ParallelRenderArgs::getFrameViewHash(double time, ViewIdx view, U64* hash) const
     return findFrameViewHash(time, view, frameViewHash, hash);
 }
 
+CacheEntryPriorityEnum
+ParallelRenderArgs::getCachePriority() const
+{
+    if (isAnalysis) {
+        return eCacheEntryPriorityAnalysis;
+    }
+    if ( !treeRoot || !treeRoot->isEffectViewerInstance() ) {
+        // Previews, writers...
+        return eCacheEntryPriorityBackground;
+    }
+
+    return isSequentialRender ? eCacheEntryPriorityPlayback : eCacheEntryPriorityInteractive;
+}
+
 NATRON_NAMESPACE_EXIT;
@@ -202,6 +202,11 @@ public:
     bool isCurrentFrameRenderNotAbortable() const;
 
     bool getFrameViewHash(double time, ViewIdx view, U64* hash) const;
+
+    /**
+     * @brief Returns the priority class of the cache entries produced by this render, depending on who is waiting for it
+     **/
+    CacheEntryPriorityEnum getCachePriority() const;
 };
 
 
@@ -266,6 +271,71 @@ public:
 
 typedef std::map<NodePtr, NodeFrameRequestPtr > FrameRequestMap;
 
+/**
+ * @brief Results of the actions that do not depend on the region of interest for a frame/view of a node.
+ **/
+struct FrameViewActionsResults
+{
+    InputMatrixMapPtr transforms;
+    FramesNeededMap frameViewsNeeded;
+    RectD rod;
+    StatusEnum rodStatus;
+
+    // False if the node was identity (or disabled) over its region of definition: the frames needed and transforms
+    // were not evaluated since only the identity input will be rendered
+    bool hasFramesNeeded;
+
+    // The identity computed over the region of definition, only valid if isIdentity is true
+    bool isIdentity;
+    int identityInputNb;
+    double identityTime;
+    ViewIdx identityView;
+
+    FrameViewActionsResults()
+        : transforms()
+        , frameViewsNeeded()
+        , rod()
+        , rodStatus(eStatusOK)
+        , hasFramesNeeded(false)
+        , isIdentity(false)
+        , identityInputNb(-1)
+        , identityTime(0)
+        , identityView(0)
+    {
+    }
+};
+
+/**
+ * @brief Per-render arena holding the results of the actions evaluated by the pre-pass of EffectInstance::computeRequestPass.
+ * The pre-pass visits the tree breadth-first: the nodes of a wave are evaluated concurrently and the frame/views
+ * they need in input make up the next wave. The recursion computing the regions of interest then reads the results
+ * from here instead of calling the actions one node after the other.
+ * The arena only lives for the duration of the request pass and is only modified by the thread running it.
+ **/
+class RequestPassArena
+{
+    typedef std::map<FrameViewPair, FrameViewActionsResults, FrameView_compare_less> FrameViewsResults;
+    typedef std::map<NodePtr, FrameViewsResults> NodesResults;
+
+    NodesResults _nodes;
+
+public:
+
+    RequestPassArena()
+        : _nodes()
+    {
+    }
+
+    void prefetch(double time,
+                  ViewIdx view,
+                  unsigned int mipMapLevel,
+                  bool useTransforms,
+                  const NodePtr& treeRoot,
+                  const RenderStatsPtr& stats);
+
+    const FrameViewActionsResults* getResults(const NodePtr& node, double time, ViewIdx view) const;
+};
+
 
 /**
  * @brief Setup thread local storage through a render tree starting from the tree root.
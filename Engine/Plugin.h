@@ -163,6 +163,8 @@
 /**
  * @brief x1 pointer property (optional) indicating for an OpenFX plug-in the pointer to the internal
  * OFX::Host::ImageEffect::ImageEffectPlugin structure.
+ * This may be NULL until the plug-in is first instantiated if it was registered from the
+ * OpenFX binary cache: use AppManager::getOfxPlugin to retrieve it.
  * Default value - NULL
  **/
 #define kNatronPluginPropOpenFXPluginPtr "NatronPluginPropOpenFXPluginPtr"
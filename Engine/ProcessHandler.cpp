@@ -25,6 +25,7 @@
 #include "ProcessHandler.h"
 
 #include <cassert>
+#include <cstring>
 #include <stdexcept>
 
 #include <QtCore/QProcess>
@@ -424,6 +425,200 @@ ProcessInputChannel::onOutputPipeConnectionMade()
     qDebug() << "The output channel was successfully created and connected.";
 }
 
+RenderServer::RenderServer(const QString & serverName)
+    : QThread()
+    , _serverName(serverName)
+    , _listening(false)
+    , _server(0)
+    , _client(0)
+    , _clientMutex()
+    , _hasClient(false)
+    , _pendingMessages()
+    , _jobsMutex()
+    , _jobsCond()
+    , _jobs()
+    , _quitRequested(false)
+    , _mustQuit(false)
+{
+    _server = new QLocalServer();
+    // A stale socket may remain if a previous server crashed
+    QLocalServer::removeServer(_serverName);
+    _listening = _server->listen(_serverName);
+    if (!_listening) {
+        std::cerr << "Error: Unable to start the render server on " << _serverName.toStdString() << ": "
+                  << _server->errorString().toStdString() << std::endl;
+    } else {
+        std::cout << "Render server listening on " << _server->fullServerName().toStdString() << std::endl;
+    }
+    _server->moveToThread(this);
+    start();
+}
+
+RenderServer::~RenderServer()
+{
+    {
+        QMutexLocker k(&_jobsMutex);
+        _mustQuit = true;
+        _jobsCond.wakeAll();
+    }
+    wait();
+    delete _server;
+}
+
+bool
+RenderServer::isListening() const
+{
+    return _listening;
+}
+
+bool
+RenderServer::waitForJob(QStringList* args)
+{
+    QMutexLocker k(&_jobsMutex);
+
+    while ( _jobs.empty() && !_quitRequested && !_mustQuit && isRunning() ) {
+        _jobsCond.wait(&_jobsMutex, 100);
+    }
+    if ( _jobs.empty() || _quitRequested || _mustQuit ) {
+        return false;
+    }
+    *args = _jobs.front();
+    _jobs.pop_front();
+
+    return true;
+}
+
+bool
+RenderServer::writeToClient(const QString & message)
+{
+    QMutexLocker k(&_clientMutex);
+
+    if (!_hasClient) {
+        return false;
+    }
+    _pendingMessages.push_back(message);
+
+    return true;
+}
+
+void
+RenderServer::writePendingMessages()
+{
+    assert(QThread::currentThread() == this);
+    QStringList messages;
+    {
+        QMutexLocker k(&_clientMutex);
+        messages.swap(_pendingMessages);
+    }
+    if ( !_client || messages.isEmpty() ) {
+        return;
+    }
+    for (QStringList::const_iterator it = messages.begin(); it != messages.end(); ++it) {
+        _client->write( ( *it + QLatin1Char('\n') ).toUtf8() );
+    }
+    _client->flush();
+}
+
+void
+RenderServer::onClientMessageReceived(const QString & message)
+{
+    if ( message.startsWith( QString::fromUtf8(kRenderServerJobShort) ) ) {
+        QStringList args = message.mid( std::strlen(kRenderServerJobShort) ).split( QLatin1Char('\t'), QString::SkipEmptyParts );
+        // CLArgs expects the program name first
+        args.push_front( QString::fromUtf8(NATRON_APPLICATION_NAME) );
+        QMutexLocker k(&_jobsMutex);
+        _jobs.push_back(args);
+        _jobsCond.wakeOne();
+    } else if ( message.startsWith( QString::fromUtf8(kAbortRenderingStringShort) ) ) {
+        qDebug() << "Aborting render!";
+        appPTR->abortAnyProcessing();
+    } else if ( message.startsWith( QString::fromUtf8(kRenderServerQuitShort) ) ) {
+        // The server thread is stopped by the destructor, once the main thread is done with the current job
+        QMutexLocker k(&_jobsMutex);
+        _quitRequested = true;
+        _jobsCond.wakeAll();
+    } else {
+        std::cerr << "Error: Unable to interpret message: " << message.toStdString() << std::endl;
+    }
+}
+
+void
+RenderServer::run()
+{
+    // The socket is only accessed from this thread: messages from the render threads are queued by writeToClient()
+    // and written here
+    for (;; ) {
+        {
+            QMutexLocker k(&_jobsMutex);
+            if (_mustQuit) {
+                break;
+            }
+        }
+
+        if (!_listening) {
+            break;
+        }
+
+        if (!_client) {
+            // Serve 1 client at a time
+            if ( _server->waitForNewConnection(100) ) {
+                _client = _server->nextPendingConnection();
+                QMutexLocker k(&_clientMutex);
+                _hasClient = _client != 0;
+            }
+            continue;
+        }
+
+        writePendingMessages();
+
+        QStringList messages;
+        if ( _client->waitForReadyRead(100) || _client->canReadLine() ) {
+            while ( _client->canReadLine() ) {
+                QString str = QString::fromUtf8( _client->readLine() );
+                while ( str.endsWith( QChar::fromLatin1('\n') ) || str.endsWith( QChar::fromLatin1('\r') ) ) {
+                    str.chop(1);
+                }
+                if ( !str.isEmpty() ) {
+                    messages.push_back(str);
+                }
+            }
+        } else if (_client->state() != QLocalSocket::ConnectedState) {
+            qDebug() << "Render server client disconnected.";
+            {
+                QMutexLocker k(&_clientMutex);
+                _hasClient = false;
+                _pendingMessages.clear();
+            }
+            // There is no event loop in this thread, deleteLater() would never delete the socket
+            delete _client;
+            _client = 0;
+        }
+        for (QStringList::const_iterator it = messages.begin(); it != messages.end(); ++it) {
+            onClientMessageReceived(*it);
+        }
+    }
+
+    if (_client) {
+        // Send the last messages, e.g: the status of the last job
+        writePendingMessages();
+        _client->waitForBytesWritten(1000);
+        _client->disconnectFromServer();
+        delete _client;
+        _client = 0;
+    }
+    {
+        QMutexLocker k(&_clientMutex);
+        _hasClient = false;
+        _pendingMessages.clear();
+    }
+    _server->close();
+
+    // Wake up the main thread in case it is waiting for a job
+    QMutexLocker k2(&_jobsMutex);
+    _mustQuit = true;
+    _jobsCond.wakeAll();
+} // RenderServer::run
+
 NATRON_NAMESPACE_EXIT;
 
 NATRON_NAMESPACE_USING;
@@ -27,6 +27,8 @@
 
 #include "Global/Macros.h"
 
+#include <list>
+
 CLANG_DIAG_OFF(deprecated)
 #include <QtCore/QProcess>
 #include <QtCore/QThread>
@@ -257,6 +259,72 @@ private:
     bool _mustQuit;
 };
 
+/**
+ * @brief A local server used by NatronRenderer when launched with --render-server. Instead of loading
+ * a single project and exiting, the process stays alive with all plug-ins and caches loaded and renders
+ * the jobs submitted by a client over this server.
+ * The protocol uses the same 1 line messages as the ProcessHandler/ProcessInputChannel pair:
+ * - The client sends kRenderServerJobShort followed by the command-line arguments of the job separated by tabulations.
+ * - While rendering, the server reports to the client the same messages as a background process would to its
+ * ProcessHandler (kRenderingStartedShort, kFrameRenderedStringShort, kRenderingFinishedStringShort...)
+ * - When a job is done, the server replies kRenderServerJobDoneShort, or kRenderServerJobFailedShort followed by the error
+ * if the job could not be loaded or if any of its renders failed or was aborted.
+ * - kAbortRenderingStringShort aborts the current job, kRenderServerQuitShort makes the server exit once the current job is done.
+ * Only one client is served at a time, jobs are queued and rendered in order on the main thread.
+ **/
+class RenderServer
+    : public QThread
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Creates the server listening on serverName and starts its thread.
+     **/
+    RenderServer(const QString & serverName);
+
+    virtual ~RenderServer();
+
+    /**
+     * @brief Returns true if the server is listening.
+     **/
+    bool isListening() const;
+
+    /**
+     * @brief Blocks until a job is received. Returns false if the server was asked to quit, in which case args is left untouched.
+     * The returned arguments can be given to the CLArgs constructor, the first argument is the program name.
+     **/
+    bool waitForJob(QStringList* args);
+
+    /**
+     * @brief Queue a message to the connected client, if any. Returns false if no client is connected.
+     * This can be called from any thread: the message is written by the server thread which owns the socket.
+     **/
+    bool writeToClient(const QString & message);
+
+private:
+
+    virtual void run();
+
+    void onClientMessageReceived(const QString & message);
+
+    void writePendingMessages();
+
+    QString _serverName;
+    bool _listening;
+    QLocalServer* _server; // lives in the server thread
+    QLocalSocket* _client; // only accessed by the server thread
+    mutable QMutex _clientMutex; // protects _hasClient and _pendingMessages
+    bool _hasClient;
+    QStringList _pendingMessages;
+    QMutex _jobsMutex; // protects _jobs, _quitRequested and _mustQuit
+    QWaitCondition _jobsCond;
+    std::list<QStringList> _jobs;
+    bool _quitRequested; // the client asked to quit, no more jobs are accepted but the server keeps running to report the current job status
+    bool _mustQuit; // the server thread must exit
+};
+
 NATRON_NAMESPACE_EXIT;
 
 #endif // PROCESSHANDLER_H
@@ -216,6 +216,7 @@ Project::loadProject(const QString & path,
                 }
                 if ( (ret == eStandardButtonNo) || (ret == eStandardButtonEscape) ) {
                     QFile::remove(realPath + autosaveFileName);
+                    QFile::remove( ProjectPrivate::getAutoSaveJournalFilePath(realPath + autosaveFileName) );
                 } else {
                     realName = autosaveFileName;
                     isAutoSave = true;
@@ -317,6 +318,11 @@ Project::loadProjectInternal(const QString & pathIn,
         _imp->lastProjectLoaded.reset(new SERIALIZATION_NAMESPACE::ProjectSerialization);
         appPTR->loadProjectFromFileFunction(ifile, getApp(), _imp->lastProjectLoaded.get());
 
+        if (isAutoSave) {
+            // Replay the changes recorded by incremental auto-saves on top of the base auto-save
+            ProjectPrivate::applyAutoSaveJournal(filePathOut, _imp->lastProjectLoaded.get());
+        }
+
         {
             FlagSetter __raii_loadingProjectInternal__(true, &_imp->isLoadingProjectInternal, &_imp->isLoadingProjectMutex);
             ret = load(*_imp->lastProjectLoaded, nameIn, pathIn);
@@ -619,13 +625,97 @@ Project::autoSave()
         return;
     }
 
+    // Take the changes accumulated since the last auto-save
+    std::set<std::string> dirtyNodes;
+    bool fullSaveRequired;
+    {
+        QMutexLocker k(&_imp->autoSaveJournalMutex);
+        dirtyNodes.swap(_imp->autoSaveDirtyNodes);
+        fullSaveRequired = _imp->autoSaveFullRequired;
+        _imp->autoSaveFullRequired = false;
+    }
+
+    if (!fullSaveRequired) {
+        if ( autoSaveIncremental(dirtyNodes) ) {
+            return;
+        }
+    }
+
     QString path = QString::fromUtf8( _imp->getProjectPath().c_str() );
     QString name = QString::fromUtf8( _imp->getProjectFilename().c_str() );
     saveProject_imp(path, name, true, true, 0);
-}
+
+    // The journal of the previous auto-save was removed along with it in removeLastAutosave()
+    QMutexLocker k(&_imp->autoSaveJournalMutex);
+    _imp->autoSaveJournalEntriesCount = 0;
+} // autoSave
+
+bool
+Project::autoSaveIncremental(const std::set<std::string>& dirtyNodes)
+{
+    {
+        QMutexLocker l(&_imp->isLoadingProjectMutex);
+        if (_imp->isLoadingProject) {
+            // Put back the nodes so they get saved by the next auto-save once the project is loaded
+            QMutexLocker k(&_imp->autoSaveJournalMutex);
+            _imp->autoSaveDirtyNodes.insert( dirtyNodes.begin(), dirtyNodes.end() );
+
+            return true;
+        }
+    }
+
+    {
+        QMutexLocker l(&_imp->isSavingProjectMutex);
+        if (_imp->isSavingProject) {
+            // Another save is in progress: put back the nodes so they get saved by the next auto-save
+            QMutexLocker k(&_imp->autoSaveJournalMutex);
+            _imp->autoSaveDirtyNodes.insert( dirtyNodes.begin(), dirtyNodes.end() );
+
+            return true;
+        }
+        _imp->isSavingProject = true;
+    }
+
+    bool ret = true;
+    try {
+        int nEntries = _imp->appendToAutoSaveJournal(dirtyNodes);
+        if (nEntries < 0) {
+            // No base auto-save to append to or the journal could not be written
+            ret = false;
+        } else if (nEntries > 0) {
+            int journalSize;
+            {
+                QMutexLocker k(&_imp->autoSaveJournalMutex);
+                _imp->autoSaveJournalEntriesCount += nEntries;
+                journalSize = _imp->autoSaveJournalEntriesCount;
+            }
+
+            if (journalSize >= NATRON_AUTOSAVE_JOURNAL_MAX_ENTRIES) {
+                // We are already in a separate thread: merge the journal into the base file here, this
+                // only reads and writes files and does not access the nodes.
+                _imp->compactAutoSaveJournal( getLastAutoSaveFilePath() );
+                QMutexLocker k(&_imp->autoSaveJournalMutex);
+                _imp->autoSaveJournalEntriesCount = 0;
+            }
+
+            QMutexLocker l(&_imp->projectLock);
+            _imp->lastAutoSave = QDateTime::currentDateTime();
+        }
+    } catch (const std::exception & e) {
+        qDebug() << "Auto-save journal failure: " << e.what();
+        ret = false;
+    }
+
+    {
+        QMutexLocker l(&_imp->isSavingProjectMutex);
+        _imp->isSavingProject = false;
+    }
+
+    return ret;
+} // autoSaveIncremental
 
 void
-Project::triggerAutoSave()
+Project::triggerAutoSave(const NodePtr& changedNode)
 {
     ///Should only be called in the main-thread, that is upon user interaction.
     assert( QThread::currentThread() == qApp->thread() );
@@ -634,6 +724,21 @@ Project::triggerAutoSave()
         return;
     }
 
+    {
+        QMutexLocker k(&_imp->autoSaveJournalMutex);
+        if (changedNode) {
+            // Only the top-level node is journaled: a group is saved along with all its children
+            std::string fullyQualifiedName = changedNode->getFullyQualifiedName();
+            std::size_t foundDot = fullyQualifiedName.find('.');
+            if (foundDot != std::string::npos) {
+                fullyQualifiedName = fullyQualifiedName.substr(0, foundDot);
+            }
+            _imp->autoSaveDirtyNodes.insert(fullyQualifiedName);
+        } else {
+            _imp->autoSaveFullRequired = true;
+        }
+    }
+
     if ( !hasProjectBeenSavedByUser() && !appPTR->getCurrentSettings()->isAutoSaveEnabledForUnsavedProjects() ) {
         return;
     }
@@ -648,6 +753,13 @@ Project::triggerAutoSave()
     _imp->autoSaveTimer->start( appPTR->getCurrentSettings()->getAutoSaveDelayMS() );
 }
 
+void
+Project::onNodeScriptNameChanged()
+{
+    QMutexLocker k(&_imp->autoSaveJournalMutex);
+    _imp->autoSaveFullRequired = true;
+}
+
 void
 Project::onAutoSaveTimerTriggered()
 {
@@ -704,7 +816,8 @@ Project::findAutoSaveForProject(const QString& projectPath,
         QString autosaveSuffix( QString::fromUtf8(".autosave") );
         searchStr.append(autosaveSuffix);
         int suffixPos = entry.indexOf(searchStr);
-        if ( (suffixPos == -1) || entry.contains( QString::fromUtf8("RENDER_SAVE") ) ) {
+        if ( (suffixPos == -1) || entry.contains( QString::fromUtf8("RENDER_SAVE") ) ||
+             entry.endsWith( QString::fromUtf8(NATRON_AUTOSAVE_JOURNAL_SUFFIX) ) ) {
             continue;
         }
         QString filename = projectPath + entry.left( suffixPos + ntpExt.size() );
@@ -1754,6 +1867,7 @@ Project::removeLastAutosave()
 
     if ( !filepath.isEmpty() ) {
         QFile::remove(filepath);
+        QFile::remove( ProjectPrivate::getAutoSaveJournalFilePath(filepath) );
     }
 
     /*
@@ -1767,6 +1881,10 @@ Project::removeLastAutosave()
     if ( QFile::exists(autoSaveFilePath) ) {
         QFile::remove(autoSaveFilePath);
     }
+    QString journalFilePath = ProjectPrivate::getAutoSaveJournalFilePath(autoSaveFilePath);
+    if ( QFile::exists(journalFilePath) ) {
+        QFile::remove(journalFilePath);
+    }
 }
 
 void
@@ -1919,6 +2037,12 @@ Project::doResetEnd(bool aboutToQuit)
             _imp->autoSaveTimer->stop();
             _imp->additionalFormats.clear();
         }
+        {
+            QMutexLocker k(&_imp->autoSaveJournalMutex);
+            _imp->autoSaveDirtyNodes.clear();
+            _imp->autoSaveFullRequired = true;
+            _imp->autoSaveJournalEntriesCount = 0;
+        }
         getApp()->removeAllKeyframesIndicators();
 
         Q_EMIT projectNameChanged(QString::fromUtf8(NATRON_PROJECT_UNTITLED), false);
@@ -2750,20 +2874,8 @@ Project::toSerialization(SERIALIZATION_NAMESPACE::SerializationObjectBase* seria
         NodesList nodes;
         getActiveNodes(&nodes);
         for (NodesList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
-            if ( (*it)->isPersistent() ) {
-                
-                SERIALIZATION_NAMESPACE::NodeSerializationPtr state;
-                StubNodePtr isStub = toStubNode((*it)->getEffectInstance());
-                if (isStub) {
-                    state = isStub->getNodeSerialization();
-                    if (!state) {
-                        continue;
-                    }
-                } else {
-                    state.reset( new SERIALIZATION_NAMESPACE::NodeSerialization );
-                    (*it)->toSerialization(state.get());
-                }
-                
+            SERIALIZATION_NAMESPACE::NodeSerializationPtr state = ProjectPrivate::serializeNode(*it);
+            if (state) {
                 serialization->_nodes.push_back(state);
             }
         }
@@ -28,6 +28,7 @@
 #include "Global/Macros.h"
 
 #include <map>
+#include <set>
 #include <vector>
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/noncopyable.hpp>
@@ -114,14 +115,25 @@ public:
     /**
      * @brief Same as saveProject except that it will save the project in a temporary file
      * so it doesn't overwrite the project.
+     * If only some nodes changed since the last auto-save, only those are serialized and appended
+     * to the journal of the last auto-save file (see autoSaveIncremental()).
      **/
     void autoSave();
 
 
     /**
      * @brief Same as autoSave() but the auto-save is run in a separate thread instead.
+     * @param changedNode If set, only this node changed since the last call and the auto-save
+     * may be incremental. Otherwise the whole project is saved again.
      **/
-    void triggerAutoSave();
+    void triggerAutoSave(const NodePtr& changedNode = NodePtr());
+
+    /**
+     * @brief Called when a node script-name changed. The journal of the incremental auto-save refers to nodes by
+     * script-name and the other nodes refer to the renamed node in their inputs and expressions: the next auto-save
+     * must save the whole project again.
+     **/
+    void onNodeScriptNameChanged();
 
     /**
      * @brief Returns the path to where the auto save files are stored on disk.
@@ -405,6 +417,13 @@ private:
 
     bool loadProjectInternal(const QString & path, const QString & name, bool isAutoSave, bool isUntitledAutosave);
 
+    /**
+     * @brief Appends the given top-level nodes to the journal of the last auto-save, compacting it
+     * if it grew too much.
+     * @returns False if the project must be fully saved instead
+     **/
+    bool autoSaveIncremental(const std::set<std::string>& dirtyNodes);
+
     QString saveProjectInternal(const QString & path, const QString & name, bool autosave, bool updateProjectProperties);
 
 
@@ -26,6 +26,7 @@
 
 #include <list>
 #include <cassert>
+#include <sstream>
 #include <stdexcept>
 
 #include <QtCore/QDebug>
@@ -35,24 +36,29 @@
 #include <QtCore/QDir>
 
 #include "Global/QtCompat.h"
+#include "Global/StrUtils.h"
 
 #include "Engine/AppInstance.h"
 #include "Engine/AppManager.h"
 #include "Engine/AppManager.h"
 #include "Engine/CreateNodeArgs.h"
 #include "Engine/EffectInstance.h"
+#include "Engine/FStreamsSupport.h"
 #include "Engine/FileSystemModel.h"
 #include "Engine/Node.h"
 #include "Engine/OfxEffectInstance.h"
 #include "Engine/Project.h"
 #include "Engine/RotoLayer.h"
 #include "Engine/Settings.h"
+#include "Engine/StandardPaths.h"
+#include "Engine/StubNode.h"
 #include "Engine/TimeLine.h"
 #include "Engine/ViewerNode.h"
 #include "Engine/ViewerInstance.h"
 
 #include "Serialization/NodeSerialization.h"
 #include "Serialization/ProjectSerialization.h"
+#include "Serialization/SerializationIO.h"
 
 
 NATRON_NAMESPACE_ENTER;
@@ -93,6 +99,11 @@ ProjectPrivate::ProjectPrivate(Project* project)
     , isSavingProjectMutex()
     , isSavingProject(false)
     , autoSaveTimer( new QTimer() )
+    , autoSaveFutures()
+    , autoSaveJournalMutex()
+    , autoSaveDirtyNodes()
+    , autoSaveFullRequired(true)
+    , autoSaveJournalEntriesCount(0)
     , projectClosing(false)
     , tlsData( new TLSHolder<Project::ProjectTLSData>() )
 
@@ -520,4 +531,183 @@ ProjectPrivate::getProjectPath() const
     return projectPath->getValue();
 }
 
+SERIALIZATION_NAMESPACE::NodeSerializationPtr
+ProjectPrivate::serializeNode(const NodePtr& node)
+{
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr state;
+    if ( !node->isPersistent() ) {
+        return state;
+    }
+    StubNodePtr isStub = toStubNode( node->getEffectInstance() );
+    if (isStub) {
+        state = isStub->getNodeSerialization();
+    } else {
+        state.reset( new SERIALIZATION_NAMESPACE::NodeSerialization );
+        node->toSerialization( state.get() );
+    }
+
+    return state;
+}
+
+QString
+ProjectPrivate::getAutoSaveJournalFilePath(const QString& autoSaveFilePath)
+{
+    return autoSaveFilePath + QString::fromUtf8(NATRON_AUTOSAVE_JOURNAL_SUFFIX);
+}
+
+int
+ProjectPrivate::appendToAutoSaveJournal(const std::set<std::string>& nodeScriptNames)
+{
+    QString autoSaveFilePath;
+    {
+        QMutexLocker l(&projectLock);
+        autoSaveFilePath = lastAutoSaveFilePath;
+    }
+    if ( autoSaveFilePath.isEmpty() || !QFile::exists(autoSaveFilePath) ) {
+        return -1;
+    }
+
+    // Serialize the nodes first so that we do not leave the journal half-written if a node fails to serialize
+    int currentFrame = timeline->currentFrame();
+    std::list<SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization> entries;
+    for (std::set<std::string>::const_iterator it = nodeScriptNames.begin(); it != nodeScriptNames.end(); ++it) {
+        SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization entry;
+        entry._nodeScriptName = *it;
+        entry._timelineCurrent = currentFrame;
+
+        NodePtr node = _publicInterface->getNodeByName(*it);
+        if ( !node || !node->isActivated() ) {
+            entry._type = SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization::eJournalEntryTypeNodeRemoved;
+        } else {
+            entry._type = SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization::eJournalEntryTypeNodeChanged;
+            entry._node = serializeNode(node);
+            if (!entry._node) {
+                continue;
+            }
+        }
+        entries.push_back(entry);
+    }
+
+    if ( entries.empty() ) {
+        return 0;
+    }
+
+    if ( !writeAutoSaveJournalEntries(getAutoSaveJournalFilePath(autoSaveFilePath), entries) ) {
+        return -1;
+    }
+
+    return (int)entries.size();
+} // ProjectPrivate::appendToAutoSaveJournal
+
+bool
+ProjectPrivate::writeAutoSaveJournalEntries(const QString& journalFilePath,
+                                            const std::list<SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization>& entries)
+{
+    FStreamsSupport::ofstream ofile;
+    FStreamsSupport::open( &ofile, journalFilePath.toStdString(), std::ios_base::out | std::ios_base::app );
+    if (!ofile) {
+        return false;
+    }
+
+    // Each record is a separate YAML document so that a record truncated by a crash does not invalidate the previous ones
+    for (std::list<SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+        ofile << "---\n";
+        SERIALIZATION_NAMESPACE::write(ofile, *it);
+        ofile << '\n';
+    }
+    ofile.flush();
+
+    return (bool)ofile;
+} // ProjectPrivate::writeAutoSaveJournalEntries
+
+void
+ProjectPrivate::applyAutoSaveJournal(const QString& autoSaveFilePath,
+                                     SERIALIZATION_NAMESPACE::ProjectSerialization* serialization)
+{
+    QString journalFilePath = getAutoSaveJournalFilePath(autoSaveFilePath);
+    if ( !QFile::exists(journalFilePath) ) {
+        return;
+    }
+
+    FStreamsSupport::ifstream ifile;
+    FStreamsSupport::open( &ifile, journalFilePath.toStdString() );
+    if (!ifile) {
+        return;
+    }
+
+    std::list<std::string> documents;
+    {
+        std::string line;
+        std::string* cur = 0;
+        while ( std::getline(ifile, line) ) {
+            if (line == "---") {
+                documents.push_back( std::string() );
+                cur = &documents.back();
+                continue;
+            }
+            if (cur) {
+                cur->append(line);
+                cur->push_back('\n');
+            }
+        }
+    }
+
+    for (std::list<std::string>::const_iterator it = documents.begin(); it != documents.end(); ++it) {
+        SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization entry;
+        try {
+            std::stringstream ss(*it);
+            SERIALIZATION_NAMESPACE::read(ss, &entry);
+        } catch (...) {
+            // The last record may have been truncated if we crashed while writing it: everything before is still valid
+            qDebug() << "Auto-save journal" << journalFilePath << "is damaged, ignoring remaining records";
+            break;
+        }
+        entry.applyTo(serialization);
+    }
+} // ProjectPrivate::applyAutoSaveJournal
+
+void
+ProjectPrivate::compactAutoSaveJournal(const QString& autoSaveFilePath)
+{
+    QString journalFilePath = getAutoSaveJournalFilePath(autoSaveFilePath);
+    if ( !QFile::exists(journalFilePath) ) {
+        return;
+    }
+
+    SERIALIZATION_NAMESPACE::ProjectSerialization serialization;
+    {
+        FStreamsSupport::ifstream ifile;
+        FStreamsSupport::open( &ifile, autoSaveFilePath.toStdString() );
+        if (!ifile) {
+            throw std::runtime_error( tr("Failed to open %1").arg(autoSaveFilePath).toStdString() );
+        }
+        SERIALIZATION_NAMESPACE::read(ifile, &serialization);
+    }
+    applyAutoSaveJournal(autoSaveFilePath, &serialization);
+
+    ///Use a temporary file to save, so if Natron crashes it doesn't corrupt the base auto-save.
+    QString tmpFilename = StandardPaths::writableLocation(StandardPaths::eStandardLocationTemp);
+    StrUtils::ensureLastPathSeparator(tmpFilename);
+    tmpFilename.append( QString::number( QDateTime::currentDateTime().toMSecsSinceEpoch() ) );
+    tmpFilename.append( QString::fromUtf8(NATRON_AUTOSAVE_JOURNAL_SUFFIX) );
+    {
+        FStreamsSupport::ofstream ofile;
+        FStreamsSupport::open( &ofile, tmpFilename.toStdString() );
+        if (!ofile) {
+            throw std::runtime_error( tr("Failed to open file ").toStdString() + tmpFilename.toStdString() );
+        }
+        SERIALIZATION_NAMESPACE::write(ofile, serialization);
+    }
+
+    QFile::remove(autoSaveFilePath);
+    if ( !QFile::copy(tmpFilename, autoSaveFilePath) ) {
+        QFile::remove(tmpFilename);
+        throw std::runtime_error( "Failed to save to " + autoSaveFilePath.toStdString() );
+    }
+    QFile::remove(tmpFilename);
+
+    // Records are idempotent: if we crash before removing the journal it will just be applied again on the compacted file
+    QFile::remove(journalFilePath);
+} // ProjectPrivate::compactAutoSaveJournal
+
 NATRON_NAMESPACE_EXIT;
@@ -29,6 +29,7 @@
 
 #include <map>
 #include <list>
+#include <set>
 
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
@@ -105,6 +106,10 @@ public:
     bool isSavingProject; //< true when the project is saving
     boost::shared_ptr<QTimer> autoSaveTimer;
     std::list<boost::shared_ptr<QFutureWatcher<void> > > autoSaveFutures;
+    mutable QMutex autoSaveJournalMutex; //< protects autoSaveDirtyNodes, autoSaveFullRequired & autoSaveJournalEntriesCount
+    std::set<std::string> autoSaveDirtyNodes; //< script-names of the top-level nodes modified since the last auto-save
+    bool autoSaveFullRequired; //< a change that cannot be journaled (e.g: graph edition) happened since the last auto-save
+    int autoSaveJournalEntriesCount; //< number of records in the journal of the last auto-save file
     mutable QMutex projectClosingMutex;
     bool projectClosing;
     boost::shared_ptr<TLSHolder<Project::ProjectTLSData> > tlsData;
@@ -133,6 +138,42 @@ public:
 
     void runOnProjectCloseCallback();
 
+    /**
+     * @brief Returns the serialization of the given node as written in the project file, or NULL if the node
+     * should not be saved.
+     **/
+    static SERIALIZATION_NAMESPACE::NodeSerializationPtr serializeNode(const NodePtr& node);
+
+    /**
+     * @brief Returns the file path of the journal associated to the given auto-save file
+     **/
+    static QString getAutoSaveJournalFilePath(const QString& autoSaveFilePath);
+
+    /**
+     * @brief Serializes the given top-level nodes and append them to the journal of the last auto-save.
+     * Nodes that no longer exist are recorded as removed.
+     * @returns The number of records appended, or -1 on failure.
+     **/
+    int appendToAutoSaveJournal(const std::set<std::string>& nodeScriptNames);
+
+    /**
+     * @brief Appends the given records to the journal file, each record being written as a separate YAML document.
+     * @returns False on failure.
+     **/
+    static bool writeAutoSaveJournalEntries(const QString& journalFilePath, const std::list<SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization>& entries);
+
+    /**
+     * @brief Merges the journal into the base auto-save file and removes the journal.
+     * This only reads the files on disk and does not access the nodes.
+     **/
+    void compactAutoSaveJournal(const QString& autoSaveFilePath);
+
+    /**
+     * @brief If a journal exists next to the given auto-save file, apply all its records onto the
+     * serialization of the base auto-save.
+     **/
+    static void applyAutoSaveJournal(const QString& autoSaveFilePath, SERIALIZATION_NAMESPACE::ProjectSerialization* serialization);
+
     void runOnProjectLoadCallback();
 
     void setProjectFilename(const std::string& filename);
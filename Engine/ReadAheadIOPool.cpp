@@ -0,0 +1,384 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ReadAheadIOPool.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include <QtCore/QMutex>
+#include <QtCore/QFile>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+// Size of the chunks read from the files. The task checks between each chunk if the file is still wanted
+#define NATRON_READ_AHEAD_CHUNK_SIZE (1024 * 1024)
+
+NATRON_NAMESPACE_ENTER;
+
+struct ReadAheadWindow
+{
+    // Files not read yet, from the most urgent to the least
+    std::list<std::string> pending;
+
+    // Files read ahead and not consumed yet with their size in bytes
+    std::map<std::string, U64> readFiles;
+
+    // All the files of the window (pending, in flight or read) with the stamp of the last request that contained them
+    std::map<std::string, U64> requestStamps;
+
+    // The files consumed last by the reader, oldest first, so that a concurrent render thread requesting them
+    // again for an earlier frame does not read them a second time
+    std::list<std::string> consumed;
+    std::set<std::string> consumedSet;
+};
+
+typedef std::map<const void*, ReadAheadWindow> ReadAheadWindowsMap;
+typedef std::set<std::pair<const void*, std::string> > InFlightFilesSet;
+
+struct ReadAheadIOPoolPrivate
+{
+    // Protects all fields below
+    QMutex lock;
+
+    ReadAheadWindowsMap windows;
+
+    // Files currently being read by a task. A file removed from this set while it is read
+    // is no longer wanted and the task stops reading it.
+    InFlightFilesSet inFlight;
+
+    // Sum of the size of the readFiles of all windows
+    U64 bytesReadAhead;
+
+    // The reader that was served last, so that the tasks serve readers in turn
+    const void* lastServedReader;
+
+    // Incremented on each call to mergeReadAheadWindow
+    U64 requestCounter;
+
+    int nActiveTasks;
+    bool quitRequested;
+
+    QThreadPool pool;
+
+    ReadAheadIOPoolPrivate()
+        : lock()
+        , windows()
+        , inFlight()
+        , bytesReadAhead(0)
+        , lastServedReader(0)
+        , requestCounter(0)
+        , nActiveTasks(0)
+        , quitRequested(false)
+        , pool()
+    {
+        pool.setMaxThreadCount(NATRON_READ_AHEAD_IO_THREADS);
+    }
+
+    bool hasPendingFiles_locked() const
+    {
+        for (ReadAheadWindowsMap::const_iterator it = windows.begin(); it != windows.end(); ++it) {
+            if ( !it->second.pending.empty() ) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void startTasks_locked();
+
+    bool popNextFile_locked(const void** readerID, std::string* filename);
+
+    void forgetReadFile_locked(ReadAheadWindow* window, std::map<std::string, U64>::iterator it)
+    {
+        assert(bytesReadAhead >= it->second);
+        bytesReadAhead -= it->second;
+        window->readFiles.erase(it);
+    }
+
+    void forgetFile_locked(const void* readerID, ReadAheadWindow* window, const std::string& filename)
+    {
+        window->pending.remove(filename);
+        inFlight.erase( std::make_pair(readerID, filename) );
+        window->requestStamps.erase(filename);
+        std::map<std::string, U64>::iterator found = window->readFiles.find(filename);
+        if ( found != window->readFiles.end() ) {
+            forgetReadFile_locked(window, found);
+        }
+    }
+
+    bool readFile(const void* readerID, const std::string& filename, U64* nBytes);
+};
+
+class ReadAheadTask
+    : public QRunnable
+{
+    ReadAheadIOPoolPrivate* _imp;
+
+public:
+
+    ReadAheadTask(ReadAheadIOPoolPrivate* imp)
+        : QRunnable()
+        , _imp(imp)
+    {
+        setAutoDelete(true);
+    }
+
+    virtual ~ReadAheadTask()
+    {
+    }
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        for (;;) {
+            const void* readerID;
+            std::string filename;
+            {
+                QMutexLocker k(&_imp->lock);
+                if ( !_imp->popNextFile_locked(&readerID, &filename) ) {
+                    --_imp->nActiveTasks;
+
+                    return;
+                }
+            }
+
+            U64 nBytes = 0;
+            bool ok = _imp->readFile(readerID, filename, &nBytes);
+
+            QMutexLocker k(&_imp->lock);
+            InFlightFilesSet::iterator found = _imp->inFlight.find( std::make_pair(readerID, filename) );
+            if ( found == _imp->inFlight.end() ) {
+                // The file was consumed or left the window while it was read
+                continue;
+            }
+            _imp->inFlight.erase(found);
+            if (!ok) {
+                continue;
+            }
+            ReadAheadWindowsMap::iterator window = _imp->windows.find(readerID);
+            if ( window != _imp->windows.end() ) {
+                window->second.readFiles[filename] = nBytes;
+                _imp->bytesReadAhead += nBytes;
+            }
+        }
+    }
+};
+
+void
+ReadAheadIOPoolPrivate::startTasks_locked()
+{
+    while ( !quitRequested && nActiveTasks < NATRON_READ_AHEAD_IO_THREADS && bytesReadAhead < NATRON_READ_AHEAD_MAX_BYTES && hasPendingFiles_locked() ) {
+        ++nActiveTasks;
+        pool.start( new ReadAheadTask(this) );
+    }
+}
+
+bool
+ReadAheadIOPoolPrivate::popNextFile_locked(const void** readerID,
+                                           std::string* filename)
+{
+    // The budget is checked before starting a file: it may be exceeded by at most one file per thread
+    if ( quitRequested || (bytesReadAhead >= NATRON_READ_AHEAD_MAX_BYTES) || windows.empty() ) {
+        return false;
+    }
+
+    // Start with the reader following the one served last
+    ReadAheadWindowsMap::iterator start = windows.upper_bound(lastServedReader);
+    if ( start == windows.end() ) {
+        start = windows.begin();
+    }
+    ReadAheadWindowsMap::iterator it = start;
+    do {
+        if ( !it->second.pending.empty() ) {
+            *readerID = it->first;
+            *filename = it->second.pending.front();
+            it->second.pending.pop_front();
+            inFlight.insert( std::make_pair(*readerID, *filename) );
+            lastServedReader = it->first;
+
+            return true;
+        }
+        ++it;
+        if ( it == windows.end() ) {
+            it = windows.begin();
+        }
+    } while (it != start);
+
+    return false;
+}
+
+bool
+ReadAheadIOPoolPrivate::readFile(const void* readerID,
+                                 const std::string& filename,
+                                 U64* nBytes)
+{
+    QFile file( QString::fromUtf8( filename.c_str() ) );
+
+    if ( !file.open(QIODevice::ReadOnly) ) {
+        return false;
+    }
+
+    // The data is discarded: reading it is enough to have it in the page cache when the reader opens the file
+    std::vector<char> buffer(NATRON_READ_AHEAD_CHUNK_SIZE);
+    *nBytes = 0;
+    for (;;) {
+        qint64 n = file.read(&buffer.front(), NATRON_READ_AHEAD_CHUNK_SIZE);
+        if (n < 0) {
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        *nBytes += (U64)n;
+
+        QMutexLocker k(&lock);
+        if ( quitRequested || ( inFlight.find( std::make_pair(readerID, filename) ) == inFlight.end() ) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ReadAheadIOPool::ReadAheadIOPool()
+    : _imp( new ReadAheadIOPoolPrivate() )
+{
+}
+
+ReadAheadIOPool::~ReadAheadIOPool()
+{
+    quit();
+}
+
+void
+ReadAheadIOPool::mergeReadAheadWindow(const void* readerID,
+                                      const std::list<std::string>& filenames)
+{
+    QMutexLocker k(&_imp->lock);
+
+    if (_imp->quitRequested) {
+        return;
+    }
+
+    ReadAheadWindow& window = _imp->windows[readerID];
+    const U64 stamp = ++_imp->requestCounter;
+
+    for (std::list<std::string>::const_iterator it = filenames.begin(); it != filenames.end(); ++it) {
+        if ( window.consumedSet.find(*it) != window.consumedSet.end() ) {
+            continue;
+        }
+        std::map<std::string, U64>::iterator found = window.requestStamps.find(*it);
+        if ( found != window.requestStamps.end() ) {
+            // Already pending, in flight or read
+            found->second = stamp;
+            continue;
+        }
+        window.requestStamps[*it] = stamp;
+        window.pending.push_back(*it);
+    }
+
+    // Forget the files requested least recently, e.g: the ones of the other playback direction
+    while (window.requestStamps.size() > NATRON_READ_AHEAD_MAX_WINDOW_FILES) {
+        std::map<std::string, U64>::iterator oldest = window.requestStamps.begin();
+        for (std::map<std::string, U64>::iterator it = window.requestStamps.begin(); it != window.requestStamps.end(); ++it) {
+            if (it->second < oldest->second) {
+                oldest = it;
+            }
+        }
+        std::string filename = oldest->first;
+        _imp->forgetFile_locked(readerID, &window, filename);
+    }
+
+    _imp->startTasks_locked();
+} // mergeReadAheadWindow
+
+void
+ReadAheadIOPool::notifyFileConsumed(const void* readerID,
+                                    const std::string& filename)
+{
+    QMutexLocker k(&_imp->lock);
+
+    if (_imp->quitRequested) {
+        return;
+    }
+
+    // The window is created if needed: the first frame may be consumed before any window was requested
+    ReadAheadWindow& w = _imp->windows[readerID];
+    if ( !w.consumedSet.insert(filename).second ) {
+        return;
+    }
+    w.consumed.push_back(filename);
+    if (w.consumed.size() > NATRON_READ_AHEAD_MAX_WINDOW_FILES) {
+        w.consumedSet.erase( w.consumed.front() );
+        w.consumed.pop_front();
+    }
+
+    _imp->forgetFile_locked(readerID, &w, filename);
+
+    // Some budget may have been released
+    _imp->startTasks_locked();
+}
+
+void
+ReadAheadIOPool::clearReadAheadWindow(const void* readerID)
+{
+    QMutexLocker k(&_imp->lock);
+    ReadAheadWindowsMap::iterator window = _imp->windows.find(readerID);
+
+    if ( window == _imp->windows.end() ) {
+        return;
+    }
+
+    while ( !window->second.readFiles.empty() ) {
+        _imp->forgetReadFile_locked( &window->second, window->second.readFiles.begin() );
+    }
+    for (InFlightFilesSet::iterator it = _imp->inFlight.lower_bound( std::make_pair( readerID, std::string() ) );
+         it != _imp->inFlight.end() && it->first == readerID;) {
+        _imp->inFlight.erase(it++);
+    }
+    _imp->windows.erase(window);
+    if (_imp->lastServedReader == readerID) {
+        _imp->lastServedReader = 0;
+    }
+    _imp->startTasks_locked();
+}
+
+void
+ReadAheadIOPool::quit()
+{
+    {
+        QMutexLocker k(&_imp->lock);
+        _imp->quitRequested = true;
+        _imp->windows.clear();
+        _imp->inFlight.clear();
+        _imp->bytesReadAhead = 0;
+    }
+    _imp->pool.waitForDone();
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,105 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+
+#ifndef READAHEADIOPOOL_H
+#define READAHEADIOPOOL_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <list>
+#include <string>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Global/GlobalDefines.h"
+#include "Engine/EngineFwd.h"
+
+// Number of frames read ahead of the playhead by a Read node during sequential renders
+#define NATRON_READ_AHEAD_FRAMES 8
+
+// Number of threads dedicated to reading files ahead. These threads are I/O bound and do not count in the render threads.
+#define NATRON_READ_AHEAD_IO_THREADS 4
+
+// Maximum number of bytes read ahead that were not consumed yet by a render
+#define NATRON_READ_AHEAD_MAX_BYTES (512ULL * 1024ULL * 1024ULL)
+
+// Maximum number of files in the window of a reader. The windows requested by the render threads of a reader
+// are merged: this leaves room for several concurrent frames, the files requested least recently are dropped first.
+#define NATRON_READ_AHEAD_MAX_WINDOW_FILES (4 * NATRON_READ_AHEAD_FRAMES)
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief An I/O stage which reads the files of the upcoming frames of image sequences on its own thread pool, so that
+ * when the reader plug-in opens them in a render thread their content is already in the operating system page cache.
+ * This overlaps the file system latency (typically network storage) with the rendering of the current frames.
+ * OpenFX readers open files by their name, hence the bytes read are not handed to them: only the amount of data read ahead
+ * and not yet consumed is bounded by NATRON_READ_AHEAD_MAX_BYTES so that the page cache is not thrashed.
+ * This class is thread-safe.
+ **/
+struct ReadAheadIOPoolPrivate;
+class ReadAheadIOPool
+{
+public:
+
+    ReadAheadIOPool();
+
+    ~ReadAheadIOPool();
+
+    /**
+     * @brief Add the files that are going to be needed next by a reader, ordered from the most urgent to the least.
+     * Several render threads of the same reader may call this concurrently for different frames: their files are merged
+     * in a single window rather than replacing each other. Files already consumed are not read again.
+     * When the window holds more than NATRON_READ_AHEAD_MAX_WINDOW_FILES files, the files requested least recently
+     * are forgotten and no longer count in the memory budget, e.g: when the playback direction changed.
+     * @param readerID Identifies the window, each reader has its own window.
+     **/
+    void mergeReadAheadWindow(const void* readerID, const std::list<std::string>& filenames);
+
+    /**
+     * @brief Notify that the given file was opened by the reader: it is no longer accounted in the read ahead budget.
+     **/
+    void notifyFileConsumed(const void* readerID, const std::string& filename);
+
+    /**
+     * @brief Forget the window of the given reader, pending reads of its files are cancelled.
+     **/
+    void clearReadAheadWindow(const void* readerID);
+
+    /**
+     * @brief Cancel all pending reads and wait for the I/O threads to be done.
+     **/
+    void quit();
+
+private:
+
+    boost::scoped_ptr<ReadAheadIOPoolPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // READAHEADIOPOOL_H
@@ -24,6 +24,9 @@
 
 #include "ReadNode.h"
 
+#include <cmath>
+#include <climits>
+
 #include "Global/QtCompat.h"
 
 #if !defined(SBK_RUN) && !defined(Q_MOC_RUN)
@@ -47,8 +50,12 @@ CLANG_DIAG_ON(uninitialized)
 #include "Engine/CreateNodeArgs.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/KnobFile.h"
+#include "Engine/OutputEffectInstance.h"
+#include "Engine/OutputSchedulerThread.h"
+#include "Engine/ParallelRenderArgs.h"
 #include "Engine/Project.h"
 #include "Engine/Plugin.h"
+#include "Engine/ReadAheadIOPool.h"
 #include "Engine/Settings.h"
 
 #include "Serialization/NodeSerialization.h"
@@ -274,6 +281,8 @@ public:
 
     bool checkDecoderCreated(double time, ViewIdx view);
 
+    void readAhead(double time, ViewIdx view);
+
     static QString getFFProbeBinaryPath()
     {
         QString appPath = QCoreApplication::applicationDirPath();
@@ -317,6 +326,10 @@ ReadNode::ReadNode(const NodePtr& n)
 
 ReadNode::~ReadNode()
 {
+    ReadAheadIOPool* pool = appPTR->getReadAheadIOPool();
+    if (pool) {
+        pool->clearReadAheadWindow(this);
+    }
 }
 
 NodePtr
@@ -552,6 +565,65 @@ ReadNodePrivate::checkDecoderCreated(double time,
     return true;
 }
 
+void
+ReadNodePrivate::readAhead(double time,
+                           ViewIdx view)
+{
+    ReadAheadIOPool* pool = appPTR->getReadAheadIOPool();
+    KnobFilePtr fileKnob = inputFileKnob.lock();
+    NodePtr reader = _publicInterface->getEmbeddedReader();
+
+    if (!pool || !fileKnob || !reader) {
+        return;
+    }
+
+    // Only sequential renders (playback, render on disk) have a predictable next frame
+    ParallelRenderArgsPtr frameArgs = _publicInterface->getParallelRenderArgsTLS();
+    if ( !frameArgs || !frameArgs->isSequentialRender ) {
+        return;
+    }
+
+    RenderDirectionEnum direction = eRenderDirectionForward;
+    if (frameArgs->treeRoot) {
+        OutputEffectInstancePtr output = toOutputEffectInstance( frameArgs->treeRoot->getEffectInstance() );
+        RenderEnginePtr engine = output ? output->getRenderEngine() : RenderEnginePtr();
+        if (engine) {
+            direction = engine->getPlaybackDirection();
+        }
+    }
+
+    // Map the render time to the frame in the file sequence like the reader does
+    int timeOffset = 0;
+    KnobIntPtr timeOffsetKnob = toKnobInt( reader->getKnobByName(kParamTimeOffset) );
+    if (timeOffsetKnob) {
+        timeOffset = timeOffsetKnob->getValue();
+    }
+    KnobIntPtr firstFrameKnob = toKnobInt( reader->getKnobByName(kParamFirstFrame) );
+    KnobIntPtr lastFrameKnob = toKnobInt( reader->getKnobByName(kParamLastFrame) );
+    const int firstFrame = firstFrameKnob ? firstFrameKnob->getValue() : INT_MIN;
+    const int lastFrame = lastFrameKnob ? lastFrameKnob->getValue() : INT_MAX;
+
+    const int frame = (int)std::floor(time + 0.5) - timeOffset;
+    const std::string currentFile = fileKnob->getFileName(frame, view);
+    pool->notifyFileConsumed(_publicInterface, currentFile);
+
+    std::list<std::string> nextFiles;
+    const int step = direction == eRenderDirectionForward ? 1 : -1;
+    for (int i = 1; i <= NATRON_READ_AHEAD_FRAMES; ++i) {
+        const int nextFrame = frame + i * step;
+        if ( (nextFrame < firstFrame) || (nextFrame > lastFrame) ) {
+            break;
+        }
+        std::string nextFile = fileKnob->getFileName(nextFrame, view);
+        if ( nextFile.empty() || (nextFile == currentFile) ) {
+            // Not an image sequence: a video file is read by the decoder itself
+            break;
+        }
+        nextFiles.push_back(nextFile);
+    }
+    pool->mergeReadAheadWindow(_publicInterface, nextFiles);
+} // ReadNodePrivate::readAhead
+
 static std::string
 getFileNameFromSerialization(const SERIALIZATION_NAMESPACE::KnobSerializationList& serializations)
 {
@@ -1245,6 +1317,11 @@ ReadNode::endSequenceRender(double first,
                             bool isOpenGLRender,
                             const EffectOpenGLContextDataPtr& glContextData)
 {
+    ReadAheadIOPool* pool = appPTR->getReadAheadIOPool();
+    if (pool) {
+        pool->clearReadAheadWindow(this);
+    }
+
     NodePtr p = getEmbeddedReader();
     if (p) {
         return p->getEffectInstance()->endSequenceRender(first, last, step, interactive, scale, isSequentialRender, isRenderResponseToUserInteraction, draftMode, view, isOpenGLRender, glContextData);
@@ -1260,6 +1337,8 @@ ReadNode::render(const RenderActionArgs& args)
         return eStatusFailed;
     }
 
+    _imp->readAhead(args.time, args.view);
+
     NodePtr p = getEmbeddedReader();
     if (p) {
         return p->getEffectInstance()->render(args);
@@ -42,6 +42,9 @@ struct NodeRenderStatsPrivate
     //The accumulated time spent in the EffectInstance::renderHandler function
     double totalTimeSpentRendering;
 
+    //The accumulated time spent in the actions called by the request pass (RoD, frames needed, transforms)
+    double totalTimeSpentInRequestPass;
+
     //The region of definition of the node for this frame
     RectD rod;
 
@@ -79,6 +82,7 @@ struct NodeRenderStatsPrivate
 
     NodeRenderStatsPrivate()
         : totalTimeSpentRendering(0)
+        , totalTimeSpentInRequestPass(0)
         , rod()
         , isWholeImageIdentity()
         , rectanglesRendered()
@@ -118,6 +122,7 @@ void
 NodeRenderStats::operator=(const NodeRenderStats& other)
 {
     _imp->totalTimeSpentRendering = other._imp->totalTimeSpentRendering;
+    _imp->totalTimeSpentInRequestPass = other._imp->totalTimeSpentInRequestPass;
     _imp->rod = other._imp->rod;
     _imp->isWholeImageIdentity = other._imp->isWholeImageIdentity;
     _imp->rectanglesRendered = other._imp->rectanglesRendered;
@@ -147,6 +152,18 @@ NodeRenderStats::getTotalTimeSpentRendering() const
     return _imp->totalTimeSpentRendering;
 }
 
+void
+NodeRenderStats::addTimeSpentInRequestPass(double time)
+{
+    _imp->totalTimeSpentInRequestPass += time;
+}
+
+double
+NodeRenderStats::getTotalTimeSpentInRequestPass() const
+{
+    return _imp->totalTimeSpentInRequestPass;
+}
+
 const RectD&
 NodeRenderStats::getRoD() const
 {
@@ -435,6 +452,18 @@ RenderStats::addRenderInfosForNode(const NodePtr& node,
     stats.addPlaneRendered(plane);
 }
 
+void
+RenderStats::addRequestPassInfosForNode(const NodePtr& node,
+                                        double timeSpent)
+{
+    QMutexLocker k(&_imp->lock);
+
+    assert(_imp->doNodesProfiling);
+
+    NodeRenderStats& stats = _imp->findOrCreateNodeStats(node);
+    stats.addTimeSpentInRequestPass(timeSpent);
+}
+
 std::map<NodePtr, NodeRenderStats >
 RenderStats::getStats(double *totalTimeSpent) const
 {
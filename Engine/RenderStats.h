@@ -66,6 +66,9 @@ public:
     void addTimeSpentRendering(double time);
     double getTotalTimeSpentRendering() const;
 
+    void addTimeSpentInRequestPass(double time);
+    double getTotalTimeSpentInRequestPass() const;
+
     const RectD& getRoD() const;
     void setRoD(const RectD& rod);
 
@@ -142,6 +145,14 @@ public:
                                const RectI& rectangle,
                                double timeSpent);
 
+    /**
+     * @brief Time spent by the request pass (see EffectInstance::computeRequestPass) evaluating the actions of the node.
+     * The actions of independent nodes are evaluated concurrently, hence the sum over all nodes may exceed
+     * the wall clock time spent preparing the render.
+     **/
+    void addRequestPassInfosForNode(const NodePtr& node,
+                                    double timeSpent);
+
     std::map<NodePtr, NodeRenderStats > getStats(double *totalTimeSpent) const;
 
 private:
@@ -24,8 +24,18 @@
 
 #include "RotoBezierTriangulation.h"
 
+#include <list>
+#include <map>
+
+#include <QtCore/QMutex>
+
+#include "Engine/ViewIdx.h"
+
 #include "libtess.h"
 
+// Maximum amount of memory held by the triangulations cache
+#define NATRON_ROTO_TRIANGULATION_CACHE_MAX_BYTES (64 * 1024 * 1024)
+
 NATRON_NAMESPACE_ENTER;
 
 NATRON_NAMESPACE_ANONYMOUS_ENTER;
@@ -138,6 +148,81 @@ static void tess_intersection_combine_callback(double coords[3], void */*data*/[
     
 }
 
+struct TrianglesCacheKey
+{
+    U64 hash;
+    double time;
+    unsigned int mipmapLevel;
+
+    bool operator<(const TrianglesCacheKey& other) const
+    {
+        if (hash != other.hash) {
+            return hash < other.hash;
+        }
+        if (time != other.time) {
+            return time < other.time;
+        }
+
+        return mipmapLevel < other.mipmapLevel;
+    }
+};
+
+struct TrianglesCacheEntry
+{
+    TrianglesCacheKey key;
+    RotoBezierTriangulation::PolygonDataConstPtr data;
+    std::size_t size;
+};
+
+typedef std::list<TrianglesCacheEntry> TrianglesCacheEntryList;
+
+/**
+ * @brief LRU cache of triangulations. Since entries are keyed by the shape hash, identical shapes share their triangulation
+ * and entries of edited shapes are never hit again: they just age out.
+ **/
+struct TrianglesCache
+{
+    QMutex lock;
+
+    // Most recently used entries first
+    TrianglesCacheEntryList entries;
+    std::map<TrianglesCacheKey, TrianglesCacheEntryList::iterator> entriesByKey;
+    std::size_t bytes;
+
+    TrianglesCache()
+        : lock()
+        , entries()
+        , entriesByKey()
+        , bytes(0)
+    {
+    }
+};
+
+static TrianglesCache trianglesCache;
+
+static std::size_t
+getPolygonDataSize(const RotoBezierTriangulation::PolygonData& data)
+{
+    std::size_t size = sizeof(RotoBezierTriangulation::PolygonData);
+
+    for (std::size_t i = 0; i < data.featherPolygon.size(); ++i) {
+        size += data.featherPolygon[i].size() * sizeof(ParametricPoint);
+    }
+    size += data.bezierPolygonJoined.size() * sizeof(ParametricPoint);
+    size += data.featherMesh.size() * sizeof(RotoBezierTriangulation::RotoFeatherVertex);
+    for (std::size_t i = 0; i < data.internalFans.size(); ++i) {
+        size += data.internalFans[i].indices.size() * sizeof(unsigned int);
+    }
+    for (std::size_t i = 0; i < data.internalTriangles.size(); ++i) {
+        size += data.internalTriangles[i].indices.size() * sizeof(unsigned int);
+    }
+    for (std::size_t i = 0; i < data.internalStrips.size(); ++i) {
+        size += data.internalStrips[i].indices.size() * sizeof(unsigned int);
+    }
+
+    return size;
+}
+
 NATRON_NAMESPACE_ANONYMOUS_EXIT;
 
 void
@@ -393,4 +478,78 @@ RotoBezierTriangulation::computeTriangles(const Bezier * bezier, double time, un
     
 } // RotoBezierTriangulation::computeTriangles
 
+RotoBezierTriangulation::PolygonDataConstPtr
+RotoBezierTriangulation::getTriangles(const Bezier * bezier,
+                                      double time,
+                                      unsigned int mipmapLevel)
+{
+    assert(bezier);
+
+    // The hash cache of the bezier is logically const
+    Bezier* hashedBezier = const_cast<Bezier*>(bezier);
+    TrianglesCacheKey key;
+    key.hash = hashedBezier->computeHash(time, ViewIdx(0));
+    key.time = time;
+    key.mipmapLevel = mipmapLevel;
+
+    {
+        QMutexLocker k(&trianglesCache.lock);
+        std::map<TrianglesCacheKey, TrianglesCacheEntryList::iterator>::iterator found = trianglesCache.entriesByKey.find(key);
+        if ( found != trianglesCache.entriesByKey.end() ) {
+            trianglesCache.entries.splice(trianglesCache.entries.begin(), trianglesCache.entries, found->second);
+
+            return found->second->data;
+        }
+    }
+
+    double featherDist = bezier->getFeatherDistance(time);
+    ///Adjust the feather distance so it takes the mipmap level into account
+    if (mipmapLevel != 0) {
+        featherDist /= (1 << mipmapLevel);
+    }
+
+    boost::shared_ptr<PolygonData> data(new PolygonData);
+    computeTriangles(bezier, time, mipmapLevel, featherDist, data.get());
+
+    // If the shape was edited while we were computing, its hash changed: do not cache a triangulation that may
+    // not correspond to the key
+    if (hashedBezier->computeHash(time, ViewIdx(0)) != key.hash) {
+        return data;
+    }
+
+    TrianglesCacheEntry entry;
+    entry.key = key;
+    entry.data = data;
+    entry.size = getPolygonDataSize(*data);
+
+    QMutexLocker k(&trianglesCache.lock);
+    if ( trianglesCache.entriesByKey.find(key) != trianglesCache.entriesByKey.end() ) {
+        // Another thread computed it concurrently
+        return data;
+    }
+    trianglesCache.entries.push_front(entry);
+    trianglesCache.entriesByKey[key] = trianglesCache.entries.begin();
+    trianglesCache.bytes += entry.size;
+
+    // Evict least recently used entries, but always keep the one we just inserted
+    while (trianglesCache.bytes > NATRON_ROTO_TRIANGULATION_CACHE_MAX_BYTES && trianglesCache.entries.size() > 1) {
+        const TrianglesCacheEntry& last = trianglesCache.entries.back();
+        trianglesCache.bytes -= last.size;
+        trianglesCache.entriesByKey.erase(last.key);
+        trianglesCache.entries.pop_back();
+    }
+
+    return data;
+} // RotoBezierTriangulation::getTriangles
+
+void
+RotoBezierTriangulation::clearTrianglesCache()
+{
+    QMutexLocker k(&trianglesCache.lock);
+
+    trianglesCache.entries.clear();
+    trianglesCache.entriesByKey.clear();
+    trianglesCache.bytes = 0;
+}
+
 NATRON_NAMESPACE_EXIT;
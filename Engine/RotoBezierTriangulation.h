@@ -30,6 +30,7 @@
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #endif
 
 #include <vector>
@@ -100,8 +101,23 @@ public:
         unsigned int error;
     };
 
+    typedef boost::shared_ptr<const PolygonData> PolygonDataConstPtr;
+
     static void computeTriangles(const Bezier * bezier, double time, unsigned int mipmapLevel,  double featherDist, PolygonData* outArgs);
 
+    /**
+     * @brief Same as computeTriangles, with the feather distance of the bezier at the given time, but the result is
+     * looked up in a cache shared by all the roto renderers. Entries are keyed by the hash of the shape, the time and the mipmap level:
+     * editing the shape changes its hash so that a stale triangulation is never returned. The least recently used entries are
+     * evicted once the cache exceeds NATRON_ROTO_TRIANGULATION_CACHE_MAX_BYTES.
+     **/
+    static PolygonDataConstPtr getTriangles(const Bezier * bezier, double time, unsigned int mipmapLevel);
+
+    /**
+     * @brief Removes all entries from the triangulation cache
+     **/
+    static void clearTrianglesCache();
+
 };
 
 NATRON_NAMESPACE_EXIT;
@@ -404,6 +404,11 @@ struct BezierPrivate
     mutable QMutex guiCopyMutex;
     bool mustCopyGui;
 
+    // Bounding box of each motion blur sample computed in getBoundingBox, keyed by time along with the hash of the shape
+    // at that time. Cleared whenever the hash is invalidated.
+    mutable QMutex bboxCacheMutex;
+    mutable std::map<double, std::pair<U64, RectD> > bboxCache;
+
     BezierPrivate(bool isOpenBezier)
         : points()
         , featherPoints()
@@ -416,6 +421,8 @@ struct BezierPrivate
         , isOpenBezier(isOpenBezier)
         , guiCopyMutex()
         , mustCopyGui(false)
+        , bboxCacheMutex()
+        , bboxCache()
     {
     }
 
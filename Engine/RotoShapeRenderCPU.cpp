@@ -0,0 +1,1035 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RotoShapeRenderCPU.h"
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/bind.hpp>
+#endif
+
+#include <QtCore/QThreadPool>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+
+#include "Engine/AppManager.h"
+#include "Engine/Bezier.h"
+#include "Engine/Image.h"
+#include "Engine/KnobTypes.h"
+#include "Engine/RotoBezierTriangulation.h"
+#include "Engine/RotoShapeRenderGL.h"
+#include "Engine/RotoShapeRenderNodePrivate.h"
+#include "Engine/RotoStrokeItem.h"
+
+// Number of entries of the falloff kernel of a dab, indexed by the squared distance to the dab center
+#define NATRON_ROTO_DAB_KERNEL_SIZE 1024
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER;
+
+// A triangle of the feather mesh, with the ramp parameter (1 on the shape, 0 on the feather) at each vertex.
+// The ramp is interpolated with the barycentric coordinates of the pixel center: w_i = dx_i * x + dy_i * y + c_i
+struct RasterFeatherTriangle
+{
+    double a[3];
+    double dx[3], dy[3], c[3];
+    RectD bbox;
+};
+
+struct RasterEdge
+{
+    double x0, y0, x1, y1;
+};
+
+// Geometry of the shape at a single motion blur sample
+struct RasterSample
+{
+    std::vector<RasterEdge> edges;
+    std::vector<RasterFeatherTriangle> featherTriangles;
+    double fallOff;
+    RectD bbox;
+};
+
+struct RasterShape
+{
+    std::vector<RasterSample> samples;
+    RampTypeEnum rampType;
+    double shapeColor[3];
+    double opacity;
+};
+
+
+// Same ramp as the rotoRamp_FragmentShader of the OpenGL renderer
+static inline double
+applyFeatherRamp(double t,
+                 RampTypeEnum type,
+                 double fallOff)
+{
+    switch (type) {
+    case eRampTypeLinear:
+        break;
+    case eRampTypePLinear:
+        t = t * t * t;
+        break;
+    case eRampTypeEaseIn:
+        t = t * t * (2. - t);
+        break;
+    case eRampTypeEaseOut:
+        t = t * (1. + t * (1. - t));
+        break;
+    case eRampTypeSmooth:
+        t = t * t * (3. - 2. * t);
+        break;
+    }
+
+    return std::pow(t, fallOff);
+}
+
+static void
+buildRasterSampleFromPolygon(const std::vector<ParametricPoint>& poly,
+                             const std::vector<RotoBezierTriangulation::RotoFeatherVertex>& featherMesh,
+                             double fallOff,
+                             RasterSample* sample)
+{
+    sample->fallOff = fallOff;
+
+    sample->bbox.setupInfinity();
+    bool bboxSet = false;
+
+    if (poly.size() >= 3) {
+        sample->edges.resize( poly.size() );
+        for (std::size_t i = 0; i < poly.size(); ++i) {
+            const ParametricPoint& p0 = poly[i];
+            const ParametricPoint& p1 = poly[(i + 1) % poly.size()];
+            RasterEdge& e = sample->edges[i];
+            e.x0 = p0.x;
+            e.y0 = p0.y;
+            e.x1 = p1.x;
+            e.y1 = p1.y;
+            if (!bboxSet) {
+                sample->bbox.x1 = sample->bbox.x2 = p0.x;
+                sample->bbox.y1 = sample->bbox.y2 = p0.y;
+                bboxSet = true;
+            }
+            sample->bbox.x1 = std::min(sample->bbox.x1, p0.x);
+            sample->bbox.x2 = std::max(sample->bbox.x2, p0.x);
+            sample->bbox.y1 = std::min(sample->bbox.y1, p0.y);
+            sample->bbox.y2 = std::max(sample->bbox.y2, p0.y);
+        }
+    }
+
+    assert(featherMesh.size() % 3 == 0);
+    sample->featherTriangles.reserve(featherMesh.size() / 3);
+    for (std::size_t i = 0; i + 2 < featherMesh.size(); i += 3) {
+        const RotoBezierTriangulation::RotoFeatherVertex* v[3] = {&featherMesh[i], &featherMesh[i + 1], &featherMesh[i + 2]};
+        double area = (v[1]->x - v[0]->x) * (v[2]->y - v[0]->y) - (v[2]->x - v[0]->x) * (v[1]->y - v[0]->y);
+        if (std::abs(area) < 1e-12) {
+            // Degenerate triangle, e.g: when the feather distance is 0
+            continue;
+        }
+        RasterFeatherTriangle tri;
+        for (int k = 0; k < 3; ++k) {
+            // Edge function of the edge opposite to vertex k, normalized by the triangle area
+            const RotoBezierTriangulation::RotoFeatherVertex* p1 = v[(k + 1) % 3];
+            const RotoBezierTriangulation::RotoFeatherVertex* p2 = v[(k + 2) % 3];
+            tri.dx[k] = (p1->y - p2->y) / area;
+            tri.dy[k] = (p2->x - p1->x) / area;
+            tri.c[k] = (p1->x * p2->y - p2->x * p1->y) / area;
+            tri.a[k] = v[k]->isInner ? 1. : 0.;
+        }
+        tri.bbox.x1 = std::min( v[0]->x, std::min(v[1]->x, v[2]->x) );
+        tri.bbox.x2 = std::max( v[0]->x, std::max(v[1]->x, v[2]->x) );
+        tri.bbox.y1 = std::min( v[0]->y, std::min(v[1]->y, v[2]->y) );
+        tri.bbox.y2 = std::max( v[0]->y, std::max(v[1]->y, v[2]->y) );
+        if (!bboxSet) {
+            sample->bbox = tri.bbox;
+            bboxSet = true;
+        } else {
+            sample->bbox.merge(tri.bbox);
+        }
+        sample->featherTriangles.push_back(tri);
+    }
+    if (!bboxSet) {
+        sample->bbox.clear();
+    }
+} // buildRasterSampleFromPolygon
+
+static void
+buildRasterSample(const Bezier* bezier,
+                  double t,
+                  unsigned int mipmapLevel,
+                  RasterSample* sample)
+{
+    RotoBezierTriangulation::PolygonDataConstPtr dataPtr = RotoBezierTriangulation::getTriangles(bezier, t, mipmapLevel);
+
+    // The interior is rendered from the outline of the discretized bezier rather than from the
+    // libtess triangles: this way the coverage along the shape border is exact.
+    buildRasterSampleFromPolygon(dataPtr->bezierPolygonJoined, dataPtr->featherMesh, bezier->getFeatherFallOff(t), sample);
+}
+
+/**
+ * @brief Accumulates the signed area covered by the edge (x0,y0)-(x1,y1) into the accumulation buffer.
+ * Coordinates are relative to the tile origin and x must lie in [0, width]. Each row of the buffer has
+ * width + 2 cells. Once all edges are accumulated, the running sum of a row gives the exact coverage
+ * of each pixel by the polygon.
+ **/
+static void
+accumulateLine(double x0,
+               double y0,
+               double x1,
+               double y1,
+               int width,
+               int height,
+               float* accumulation)
+{
+    if (y0 == y1) {
+        return;
+    }
+    double dir = 1.;
+    if (y0 > y1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        dir = -1.;
+    }
+    const double dxdy = (x1 - x0) / (y1 - y0);
+    double x = x0;
+    if (y0 < 0.) {
+        x = std::max( 0., std::min(x - y0 * dxdy, (double)width) );
+    }
+    const int rowStart = std::max(0, (int)std::floor(y0));
+    const int rowEnd = std::min(height, (int)std::ceil(y1));
+    const int stride = width + 2;
+
+    for (int y = rowStart; y < rowEnd; ++y) {
+        float* line = accumulation + y * stride;
+        double dy = std::min( (double)(y + 1), y1 ) - std::max( (double)y, y0 );
+        // clamp to guard against rounding errors, the edge is known to lie in [0, width]
+        double xnext = std::max( 0., std::min(x + dxdy * dy, (double)width) );
+        double d = dy * dir;
+        double xa = std::min(x, xnext);
+        double xb = std::max(x, xnext);
+        double xaFloor = std::floor(xa);
+        int xai = (int)xaFloor;
+        double xbCeil = std::ceil(xb);
+        int xbi = (int)xbCeil;
+        assert(xai >= 0 && xbi <= width);
+        if (xbi <= xai + 1) {
+            // The edge stays within a single pixel on this row
+            double xmf = 0.5 * (x + xnext) - xaFloor;
+            line[xai] += d - d * xmf;
+            line[xai + 1] += d * xmf;
+        } else {
+            double s = 1. / (xb - xa);
+            double xaf = xa - xaFloor;
+            double a0 = 0.5 * s * (1. - xaf) * (1. - xaf);
+            double xbf = xb - xbCeil + 1.;
+            double am = 0.5 * s * xbf * xbf;
+            line[xai] += d * a0;
+            if (xbi == xai + 2) {
+                line[xai + 1] += d * (1. - a0 - am);
+            } else {
+                double a1 = s * (1.5 - xaf);
+                line[xai + 1] += d * (a1 - a0);
+                for (int xi = xai + 2; xi < xbi - 1; ++xi) {
+                    line[xi] += d * s;
+                }
+                double a2 = a1 + (xbi - xai - 3) * s;
+                line[xbi - 1] += d * (1. - a2 - am);
+            }
+            line[xbi] += d * am;
+        }
+        x = xnext;
+    }
+} // accumulateLine
+
+/**
+ * @brief Clips the edge horizontally against the tile and accumulates it. The parts of the edge
+ * on the left of the tile are projected on its left border since they fully cover the pixels of the tile
+ * on the same rows, the parts on the right are projected on the extra column which is never read.
+ **/
+static void
+accumulateEdge(const RasterEdge& edge,
+               const RectI& tile,
+               float* accumulation)
+{
+    const int width = tile.width();
+    const int height = tile.height();
+    double x0 = edge.x0 - tile.x1;
+    double y0 = edge.y0 - tile.y1;
+    double x1 = edge.x1 - tile.x1;
+    double y1 = edge.y1 - tile.y1;
+
+    if ( ( std::max(y0, y1) <= 0. ) || ( std::min(y0, y1) >= height ) ) {
+        return;
+    }
+
+    // Split the edge where it crosses the left and right borders of the tile
+    double splits[4];
+    int nSplits = 0;
+    splits[nSplits++] = 0.;
+    if (x0 != x1) {
+        double tLeft = (0. - x0) / (x1 - x0);
+        double tRight = (width - x0) / (x1 - x0);
+        if (tLeft > tRight) {
+            std::swap(tLeft, tRight);
+        }
+        if ( (tLeft > 0.) && (tLeft < 1.) ) {
+            splits[nSplits++] = tLeft;
+        }
+        if ( (tRight > 0.) && (tRight < 1.) ) {
+            splits[nSplits++] = tRight;
+        }
+    }
+    splits[nSplits++] = 1.;
+
+    double prevX = x0;
+    double prevY = y0;
+    for (int i = 1; i < nSplits; ++i) {
+        double nextX = (i == nSplits - 1) ? x1 : x0 + (x1 - x0) * splits[i];
+        double nextY = (i == nSplits - 1) ? y1 : y0 + (y1 - y0) * splits[i];
+        accumulateLine(std::max( 0., std::min(prevX, (double)width) ), prevY,
+                       std::max( 0., std::min(nextX, (double)width) ), nextY,
+                       width, height, accumulation);
+        prevX = nextX;
+        prevY = nextY;
+    }
+}
+
+static void
+rasterizeFeatherTriangle(const RasterFeatherTriangle& tri,
+                         RampTypeEnum rampType,
+                         double fallOff,
+                         const RectI& tile,
+                         float* featherCoverage)
+{
+    // Pixels whose center lies in the triangle
+    int xStart = std::max( tile.x1, (int)std::floor(tri.bbox.x1 - 0.5) );
+    int xEnd = std::min( tile.x2, (int)std::ceil(tri.bbox.x2 + 0.5) );
+    int yStart = std::max( tile.y1, (int)std::floor(tri.bbox.y1 - 0.5) );
+    int yEnd = std::min( tile.y2, (int)std::ceil(tri.bbox.y2 + 0.5) );
+
+    if ( (xStart >= xEnd) || (yStart >= yEnd) ) {
+        return;
+    }
+
+    const double eps = 1e-9;
+    const int width = tile.width();
+    for (int y = yStart; y < yEnd; ++y) {
+        double py = y + 0.5;
+        double px = xStart + 0.5;
+        double w[3];
+        for (int k = 0; k < 3; ++k) {
+            w[k] = tri.dx[k] * px + tri.dy[k] * py + tri.c[k];
+        }
+        float* dst = featherCoverage + (y - tile.y1) * width + (xStart - tile.x1);
+        for (int x = xStart; x < xEnd; ++x, ++dst) {
+            if ( (w[0] >= -eps) && (w[1] >= -eps) && (w[2] >= -eps) ) {
+                double t = w[0] * tri.a[0] + w[1] * tri.a[1] + w[2] * tri.a[2];
+                t = std::max( 0., std::min(1., t) );
+                float value = (float)applyFeatherRamp(t, rampType, fallOff);
+                // Overlapping feather triangles are merged with max, like the GL_MAX blending of the OpenGL renderer
+                if (value > *dst) {
+                    *dst = value;
+                }
+            }
+            w[0] += tri.dx[0];
+            w[1] += tri.dx[1];
+            w[2] += tri.dx[2];
+        }
+    }
+} // rasterizeFeatherTriangle
+
+template <typename PIX, int maxValue, int dstNComps>
+static void
+writeTileToImage(const std::vector<float>& coverage,
+                 const RectI& tile,
+                 const RasterShape& shape,
+                 Image::WriteAccess* acc)
+{
+    const double r = shape.shapeColor[0] * shape.opacity;
+    const double g = shape.shapeColor[1] * shape.opacity;
+    const double b = shape.shapeColor[2] * shape.opacity;
+    const int width = tile.width();
+    const float* src = &coverage[0];
+
+    for (int y = tile.y1; y < tile.y2; ++y) {
+        PIX* dstPix = (PIX*)acc->pixelAt(tile.x1, y);
+        assert(dstPix);
+        for (int x = 0; x < width; ++x, ++src, dstPix += dstNComps) {
+            double value = *src * maxValue;
+            switch (dstNComps) {
+            case 4:
+                dstPix[0] = PIX(value * r);
+                dstPix[1] = PIX(value * g);
+                dstPix[2] = PIX(value * b);
+                dstPix[3] = PIX(value * shape.opacity);
+                break;
+            case 1:
+                dstPix[0] = PIX(value * shape.opacity);
+                break;
+            case 3:
+                dstPix[0] = PIX(value * r);
+                dstPix[1] = PIX(value * g);
+                dstPix[2] = PIX(value * b);
+                break;
+            case 2:
+                dstPix[0] = PIX(value * r);
+                dstPix[1] = PIX(value * g);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+template <typename PIX, int maxValue>
+static void
+writeTileToImageForDepth(const std::vector<float>& coverage,
+                         const RectI& tile,
+                         const RasterShape& shape,
+                         int nComps,
+                         Image::WriteAccess* acc)
+{
+    switch (nComps) {
+    case 1:
+        writeTileToImage<PIX, maxValue, 1>(coverage, tile, shape, acc);
+        break;
+    case 2:
+        writeTileToImage<PIX, maxValue, 2>(coverage, tile, shape, acc);
+        break;
+    case 3:
+        writeTileToImage<PIX, maxValue, 3>(coverage, tile, shape, acc);
+        break;
+    case 4:
+        writeTileToImage<PIX, maxValue, 4>(coverage, tile, shape, acc);
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+writeTileToImageForBitDepth(const std::vector<float>& coverage,
+                            const RectI& tile,
+                            const RasterShape& shape,
+                            ImageBitDepthEnum depth,
+                            int nComps,
+                            Image::WriteAccess* acc)
+{
+    switch (depth) {
+    case eImageBitDepthFloat:
+        writeTileToImageForDepth<float, 1>(coverage, tile, shape, nComps, acc);
+        break;
+    case eImageBitDepthByte:
+        writeTileToImageForDepth<unsigned char, 255>(coverage, tile, shape, nComps, acc);
+        break;
+    case eImageBitDepthShort:
+        writeTileToImageForDepth<unsigned short, 65535>(coverage, tile, shape, nComps, acc);
+        break;
+    case eImageBitDepthHalf:
+    case eImageBitDepthNone:
+        assert(false);
+        break;
+    }
+}
+
+/**
+ * @brief Adds the coverage of a single motion blur sample over the given tile, weighted by sampleWeight.
+ * accumulation and featherCoverage are scratch buffers, reused across samples to avoid reallocations.
+ **/
+static void
+addSampleCoverage(const RasterSample& sample,
+                  RampTypeEnum rampType,
+                  const RectI& tile,
+                  float sampleWeight,
+                  std::vector<float>* accumulation,
+                  std::vector<float>* featherCoverage,
+                  std::vector<float>* coverage)
+{
+    if ( sample.bbox.isNull() || (sample.bbox.x1 >= tile.x2) || (sample.bbox.x2 < tile.x1 - 1) || (sample.bbox.y1 >= tile.y2) || (sample.bbox.y2 < tile.y1 - 1) ) {
+        return;
+    }
+
+    const int width = tile.width();
+    const int height = tile.height();
+    accumulation->assign( (width + 2) * height, 0.f );
+    featherCoverage->assign( width * height, 0.f );
+
+    for (std::vector<RasterEdge>::const_iterator e = sample.edges.begin(); e != sample.edges.end(); ++e) {
+        accumulateEdge(*e, tile, &(*accumulation)[0]);
+    }
+    for (std::vector<RasterFeatherTriangle>::const_iterator t = sample.featherTriangles.begin(); t != sample.featherTriangles.end(); ++t) {
+        rasterizeFeatherTriangle(*t, rampType, sample.fallOff, tile, &(*featherCoverage)[0]);
+    }
+
+    float* dst = &(*coverage)[0];
+    const float* feather = &(*featherCoverage)[0];
+    for (int y = 0; y < height; ++y) {
+        const float* line = &(*accumulation)[y * (width + 2)];
+        float sum = 0.f;
+        for (int x = 0; x < width; ++x, ++dst, ++feather) {
+            sum += line[x];
+            float inside = std::min(std::abs(sum), 1.f);
+            *dst += std::max(inside, *feather) * sampleWeight;
+        }
+    }
+} // addSampleCoverage
+
+/**
+ * @brief Rasterises all motion blur samples of the shape over the given tile and writes the result to the image.
+ * Tiles do not overlap so this may be called concurrently for all tiles of the render window.
+ **/
+static void
+renderTile(const RasterShape* shape,
+           ImageBitDepthEnum depth,
+           int nComps,
+           Image::WriteAccess* acc,
+           const RectI& tile)
+{
+    const int width = tile.width();
+    const int height = tile.height();
+    std::vector<float> coverage(width * height, 0.f);
+
+    if ( !shape->samples.empty() ) {
+        const float sampleWeight = 1.f / shape->samples.size();
+        std::vector<float> accumulation;
+        std::vector<float> featherCoverage;
+
+        for (std::vector<RasterSample>::const_iterator it = shape->samples.begin(); it != shape->samples.end(); ++it) {
+            addSampleCoverage(*it, shape->rampType, tile, sampleWeight, &accumulation, &featherCoverage, &coverage);
+        }
+    }
+
+    writeTileToImageForBitDepth(coverage, tile, *shape, depth, nComps, acc);
+} // renderTile
+
+
+// Radial falloff of a dab for a given brush size and hardness.
+// The opacity is indexed by the squared distance to the dab center normalized by the squared external radius,
+// so that no square root is needed per pixel. The extra last entry is 0 for pixels outside of the dab.
+struct DabKernel
+{
+    double externalRadius;
+    std::vector<float> falloff;
+};
+
+struct StrokeDab
+{
+    double x, y;
+    float alpha;
+    int kernel;
+    RectI bbox;
+};
+
+struct RenderStrokeCPUData
+{
+    double brushSizePixel;
+    double brushSpacing;
+    double brushHardness;
+    bool pressureAffectsOpacity;
+    bool pressureAffectsHardness;
+    bool pressureAffectsSize;
+    bool buildUp;
+    double shapeColor[3];
+    double opacity;
+
+    // Kernels are computed once per pressure level, like the dot patterns of the Cairo renderer
+    std::vector<DabKernel> kernels;
+    std::vector<int> kernelForPressureLevel;
+    std::vector<StrokeDab> dabs;
+};
+
+/**
+ * @brief Samples the radial gradient made of the given opacity stops, exactly like the Cairo renderer does:
+ * the opacity is constant up to the internal radius then linearly interpolated between the stops up to the external radius.
+ **/
+static void
+computeDabKernel(double internalRadius,
+                 double externalRadius,
+                 const std::vector<std::pair<double, double> >& opacityStops,
+                 DabKernel* kernel)
+{
+    kernel->externalRadius = externalRadius;
+    kernel->falloff.resize(NATRON_ROTO_DAB_KERNEL_SIZE + 1);
+    for (int i = 0; i < NATRON_ROTO_DAB_KERNEL_SIZE; ++i) {
+        double value = 1.;
+        if ( !opacityStops.empty() ) {
+            double dist = externalRadius * std::sqrt( (i + 0.5) / NATRON_ROTO_DAB_KERNEL_SIZE );
+            double t = externalRadius > internalRadius ? (dist - internalRadius) / (externalRadius - internalRadius) : 0.;
+            t = std::max( 0., std::min(t, 1.) );
+            value = opacityStops.back().second;
+            for (std::size_t s = 1; s < opacityStops.size(); ++s) {
+                if (t <= opacityStops[s].first) {
+                    const std::pair<double, double>& s0 = opacityStops[s - 1];
+                    const std::pair<double, double>& s1 = opacityStops[s];
+                    double a = s1.first > s0.first ? (t - s0.first) / (s1.first - s0.first) : 0.;
+                    value = s0.second * (1. - a) + s1.second * a;
+                    break;
+                }
+            }
+        }
+        kernel->falloff[i] = (float)value;
+    }
+    kernel->falloff[NATRON_ROTO_DAB_KERNEL_SIZE] = 0.f;
+}
+
+static void
+renderStrokeBegin_cpu(RotoShapeRenderNodePrivate::RenderStrokeDataPtr userData,
+                      double brushSizePixel,
+                      double brushSpacing,
+                      double brushHardness,
+                      bool pressureAffectsOpacity,
+                      bool pressureAffectsHardness,
+                      bool pressureAffectsSize,
+                      bool buildUp,
+                      double shapeColor[3],
+                      double opacity)
+{
+    RenderStrokeCPUData* myData = (RenderStrokeCPUData*)userData;
+
+    myData->brushSizePixel = brushSizePixel;
+    myData->brushSpacing = brushSpacing;
+    myData->brushHardness = brushHardness;
+    myData->pressureAffectsOpacity = pressureAffectsOpacity;
+    myData->pressureAffectsHardness = pressureAffectsHardness;
+    myData->pressureAffectsSize = pressureAffectsSize;
+    myData->buildUp = buildUp;
+    memcpy(myData->shapeColor, shapeColor, sizeof(double) * 3);
+    myData->opacity = opacity;
+    myData->kernelForPressureLevel.assign(ROTO_PRESSURE_LEVELS, -1);
+}
+
+static void
+renderStrokeEnd_cpu(RotoShapeRenderNodePrivate::RenderStrokeDataPtr /*userData*/)
+{
+    // Dabs are splatted all at once by renderStroke_cpu
+}
+
+static bool
+renderStrokeRenderDot_cpu(RotoShapeRenderNodePrivate::RenderStrokeDataPtr userData,
+                          const Point &/*prevCenter*/,
+                          const Point &center,
+                          double pressure,
+                          double* spacing)
+{
+    RenderStrokeCPUData* myData = (RenderStrokeCPUData*)userData;
+
+    double internalDotRadius, externalDotRadius;
+    std::vector<std::pair<double, double> > opacityStops;
+    RotoShapeRenderNodePrivate::getRenderDotParams(1., myData->brushSizePixel, myData->brushHardness, myData->brushSpacing, pressure, false /*pressureAffectsOpacity*/, myData->pressureAffectsSize, myData->pressureAffectsHardness, &internalDotRadius, &externalDotRadius, spacing, &opacityStops);
+
+    // The kernel does not depend on the pressure when only the opacity is affected by it, so it is shared by all dabs:
+    // the pressure is applied once to the alpha of each dab below.
+    // sometimes, Qt gives a pressure level > 1... so we clamp it
+    int pressureInt = 0;
+    if (myData->pressureAffectsSize || myData->pressureAffectsHardness) {
+        pressureInt = int(std::max( 0., std::min(pressure, 1.) ) * (ROTO_PRESSURE_LEVELS - 1) + 0.5);
+    }
+    assert(pressureInt >= 0 && pressureInt < ROTO_PRESSURE_LEVELS);
+    int& kernelIndex = myData->kernelForPressureLevel[pressureInt];
+    if (kernelIndex == -1) {
+        kernelIndex = (int)myData->kernels.size();
+        myData->kernels.resize(myData->kernels.size() + 1);
+        computeDabKernel(internalDotRadius, externalDotRadius, opacityStops, &myData->kernels.back());
+    }
+
+    StrokeDab dab;
+    dab.x = center.x;
+    dab.y = center.y;
+    dab.kernel = kernelIndex;
+    // With a hardness of 1, Cairo fills the dot with the opacity unaffected by the pressure
+    dab.alpha = (float)myData->opacity;
+    if ( myData->pressureAffectsOpacity && !opacityStops.empty() ) {
+        dab.alpha *= (float)pressure;
+    }
+    const double radius = myData->kernels[kernelIndex].externalRadius;
+    dab.bbox.x1 = (int)std::floor(center.x - radius);
+    dab.bbox.y1 = (int)std::floor(center.y - radius);
+    dab.bbox.x2 = (int)std::ceil(center.x + radius) + 1;
+    dab.bbox.y2 = (int)std::ceil(center.y + radius) + 1;
+    myData->dabs.push_back(dab);
+
+    return true;
+} // renderStrokeRenderDot_cpu
+
+template <typename PIX, int maxValue, int srcNComps>
+static void
+readTileFromImage(const RectI& tile,
+                  int colorChannel,
+                  double colorValue,
+                  Image::WriteAccess* acc,
+                  std::vector<float>* coverage)
+{
+    const int width = tile.width();
+    float* dst = &coverage->front();
+
+    for (int y = tile.y1; y < tile.y2; ++y) {
+        const PIX* srcPix = (const PIX*)acc->pixelAt(tile.x1, y);
+        assert(srcPix);
+        for (int x = 0; x < width; ++x, ++dst, srcPix += srcNComps) {
+            switch (srcNComps) {
+            case 1:
+                *dst = (float)srcPix[0] / maxValue;
+                break;
+            case 4:
+                // The alpha channel holds the coverage, the color channels are premultiplied by the stroke color
+                *dst = (float)srcPix[3] / maxValue;
+                break;
+            default:
+                *dst = colorValue == 0. ? 0.f : (float)(srcPix[colorChannel] / (maxValue * colorValue));
+                break;
+            }
+        }
+    }
+}
+
+template <typename PIX, int maxValue>
+static void
+readTileFromImageForDepth(const RectI& tile,
+                          int nComps,
+                          int colorChannel,
+                          double colorValue,
+                          Image::WriteAccess* acc,
+                          std::vector<float>* coverage)
+{
+    switch (nComps) {
+    case 1:
+        readTileFromImage<PIX, maxValue, 1>(tile, colorChannel, colorValue, acc, coverage);
+        break;
+    case 2:
+        readTileFromImage<PIX, maxValue, 2>(tile, colorChannel, colorValue, acc, coverage);
+        break;
+    case 3:
+        readTileFromImage<PIX, maxValue, 3>(tile, colorChannel, colorValue, acc, coverage);
+        break;
+    case 4:
+        readTileFromImage<PIX, maxValue, 4>(tile, colorChannel, colorValue, acc, coverage);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Reads back the coverage of the stroke already painted in the image, this is the inverse of writeTileToImage
+ **/
+static void
+readTileFromImageForBitDepth(const RectI& tile,
+                             const RasterShape& shape,
+                             ImageBitDepthEnum depth,
+                             int nComps,
+                             Image::WriteAccess* acc,
+                             std::vector<float>* coverage)
+{
+    // Without an alpha channel, the coverage is recovered from the most significant color channel
+    int colorChannel = 0;
+    for (int c = 1; c < std::min(nComps, 3); ++c) {
+        if (shape.shapeColor[c] > shape.shapeColor[colorChannel]) {
+            colorChannel = c;
+        }
+    }
+    const double colorValue = shape.shapeColor[colorChannel] * shape.opacity;
+
+    switch (depth) {
+    case eImageBitDepthFloat:
+        readTileFromImageForDepth<float, 1>(tile, nComps, colorChannel, colorValue, acc, coverage);
+        break;
+    case eImageBitDepthByte:
+        readTileFromImageForDepth<unsigned char, 255>(tile, nComps, colorChannel, colorValue, acc, coverage);
+        break;
+    case eImageBitDepthShort:
+        readTileFromImageForDepth<unsigned short, 65535>(tile, nComps, colorChannel, colorValue, acc, coverage);
+        break;
+    case eImageBitDepthHalf:
+    case eImageBitDepthNone:
+        assert(false);
+        break;
+    }
+}
+
+// The dabs of the stroke whose bounding box intersects the tile
+static void
+getTileDabs(const RenderStrokeCPUData* data,
+            const RectI& tile,
+            std::vector<const StrokeDab*>* tileDabs)
+{
+    for (std::vector<StrokeDab>::const_iterator it = data->dabs.begin(); it != data->dabs.end(); ++it) {
+        if ( it->bbox.intersects(tile) ) {
+            tileDabs->push_back(&*it);
+        }
+    }
+}
+
+/**
+ * @brief Composites the given dabs over the coverage of the tile, which holds tile.width() * tile.height() values.
+ **/
+static void
+addDabsCoverage(const RenderStrokeCPUData* data,
+                const std::vector<const StrokeDab*>& tileDabs,
+                const RectI& tile,
+                std::vector<float>* coverage)
+{
+    const int width = tile.width();
+    std::vector<float> dabRow(width);
+    for (std::vector<const StrokeDab*>::const_iterator it = tileDabs.begin(); it != tileDabs.end(); ++it) {
+        const StrokeDab& dab = **it;
+        const DabKernel& kernel = data->kernels[dab.kernel];
+        const float* falloff = &kernel.falloff[0];
+        RectI area;
+        dab.bbox.intersect(tile, &area);
+
+        const double radiusSquared = kernel.externalRadius * kernel.externalRadius;
+        const float scale = (float)(NATRON_ROTO_DAB_KERNEL_SIZE / radiusSquared);
+        const int n = area.width();
+        const float x0 = (float)(area.x1 + 0.5 - dab.x);
+        for (int y = area.y1; y < area.y2; ++y) {
+            const float dy = (float)(y + 0.5 - dab.y);
+            const float dy2 = dy * dy;
+            if (dy2 >= radiusSquared) {
+                continue;
+            }
+            // Evaluate the dab on the row first: the compositing loops below are then free of branches
+            // and table lookups so that the compiler can vectorise them. Explicit SSE, guarded by __SSE2__ like in
+            // libmv's brute_region_tracker.cc, is not worth it here: the loops are short and already auto-vectorised.
+            for (int i = 0; i < n; ++i) {
+                const float dx = x0 + i;
+                int index = (int)( (dx * dx + dy2) * scale );
+                index = std::min(index, NATRON_ROTO_DAB_KERNEL_SIZE);
+                dabRow[i] = dab.alpha * falloff[index];
+            }
+            float* dst = &(*coverage)[(y - tile.y1) * width + (area.x1 - tile.x1)];
+            const float* src = &dabRow[0];
+            if (data->buildUp) {
+                for (int i = 0; i < n; ++i) {
+                    dst[i] += src[i] * (1.f - dst[i]);
+                }
+            } else {
+                for (int i = 0; i < n; ++i) {
+                    dst[i] = std::max(dst[i], src[i]);
+                }
+            }
+        }
+    }
+} // addDabsCoverage
+
+/**
+ * @brief Splats all the dabs of the stroke intersecting the given tile and writes the result to the image.
+ * Both compositing operators are commutative (OVER on the alpha only in build-up mode, LIGHTEN otherwise)
+ * so the dabs may be splatted in any order and tiles may be processed concurrently.
+ **/
+static void
+splatDabsOnTile(const RenderStrokeCPUData* data,
+                const RasterShape* shape,
+                bool isDuringPainting,
+                ImageBitDepthEnum depth,
+                int nComps,
+                Image::WriteAccess* acc,
+                const RectI& tile)
+{
+    std::vector<const StrokeDab*> tileDabs;
+    getTileDabs(data, tile, &tileDabs);
+    if ( isDuringPainting && tileDabs.empty() ) {
+        // The content of the image is left untouched
+        return;
+    }
+
+    std::vector<float> coverage(tile.width() * tile.height(), 0.f);
+    if (isDuringPainting) {
+        readTileFromImageForBitDepth(tile, *shape, depth, nComps, acc, &coverage);
+    }
+
+    addDabsCoverage(data, tileDabs, tile, &coverage);
+
+    writeTileToImageForBitDepth(coverage, tile, *shape, depth, nComps, acc);
+} // splatDabsOnTile
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT;
+
+
+void
+RotoShapeRenderCPU::renderBezier_cpu(const Bezier* bezier,
+                                     double opacity,
+                                     double time,
+                                     double startTime,
+                                     double endTime,
+                                     double mbFrameStep,
+                                     unsigned int mipmapLevel,
+                                     const RectI& roi,
+                                     const ImagePtr& dstImage)
+{
+    if ( roi.isNull() ) {
+        return;
+    }
+
+    RasterShape shape;
+    bezier->getColor(time, shape.shapeColor);
+    shape.opacity = opacity;
+    shape.rampType = (RampTypeEnum)bezier->getFallOffRampTypeKnob()->getValue();
+
+    ///render the bezier only if finished (closed) and activated
+    if ( bezier->isCurveFinished() && bezier->isActivated(time) && ( bezier->getControlPointsCount() > 1 ) ) {
+        for (double t = startTime; t <= endTime; t += mbFrameStep) {
+            shape.samples.resize(shape.samples.size() + 1);
+            buildRasterSample(bezier, t, mipmapLevel, &shape.samples.back());
+        }
+    }
+
+    ImageBitDepthEnum depth = dstImage->getBitDepth();
+    int nComps = (int)dstImage->getComponentsCount();
+
+    // Take the write lock once for all tiles: the lock is recursive per thread and the tiles do not overlap
+    Image::WriteAccess acc = dstImage->getWriteRights();
+
+    std::vector<RectI> tiles = roi.splitIntoSmallerRects( appPTR->getHardwareIdealThreadCount() );
+    bool runInCurrentThread = tiles.size() <= 1 || QThreadPool::globalInstance()->activeThreadCount() >= QThreadPool::globalInstance()->maxThreadCount();
+
+    if (runInCurrentThread) {
+        for (std::vector<RectI>::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+            renderTile(&shape, depth, nComps, &acc, *it);
+        }
+    } else {
+        QtConcurrent::map( tiles, boost::bind(&renderTile, &shape, depth, nComps, &acc, _1) ).waitForFinished();
+    }
+} // RotoShapeRenderCPU::renderBezier_cpu
+
+void
+RotoShapeRenderCPU::rasterizeCoverage_cpu(const std::vector<ParametricPoint>& polygon,
+                                          const std::vector<RotoBezierTriangulation::RotoFeatherVertex>& featherMesh,
+                                          RampTypeEnum rampType,
+                                          double fallOff,
+                                          const RectI& window,
+                                          std::vector<float>* coverage)
+{
+    coverage->assign(window.width() * window.height(), 0.f);
+    if ( window.isNull() ) {
+        return;
+    }
+
+    RasterSample sample;
+    buildRasterSampleFromPolygon(polygon, featherMesh, fallOff, &sample);
+
+    std::vector<float> accumulation;
+    std::vector<float> featherCoverage;
+    addSampleCoverage(sample, rampType, window, 1.f, &accumulation, &featherCoverage, coverage);
+}
+
+void
+RotoShapeRenderCPU::rasterizeDabs_cpu(const std::list<std::pair<Point, double> >& dots,
+                                      double brushSizePixel,
+                                      double brushHardness,
+                                      bool pressureAffectsOpacity,
+                                      bool pressureAffectsHardness,
+                                      bool pressureAffectsSize,
+                                      bool buildUp,
+                                      double opacity,
+                                      const RectI& window,
+                                      std::vector<float>* coverage)
+{
+    coverage->assign(window.width() * window.height(), 0.f);
+
+    RenderStrokeCPUData data;
+    double shapeColor[3] = {1., 1., 1.};
+    renderStrokeBegin_cpu( (RotoShapeRenderNodePrivate::RenderStrokeDataPtr)&data, brushSizePixel, 0. /*brushSpacing*/, brushHardness,
+                           pressureAffectsOpacity, pressureAffectsHardness, pressureAffectsSize, buildUp, shapeColor, opacity );
+    for (std::list<std::pair<Point, double> >::const_iterator it = dots.begin(); it != dots.end(); ++it) {
+        double spacing;
+        renderStrokeRenderDot_cpu( (RotoShapeRenderNodePrivate::RenderStrokeDataPtr)&data, it->first, it->first, it->second, &spacing );
+    }
+    renderStrokeEnd_cpu( (RotoShapeRenderNodePrivate::RenderStrokeDataPtr)&data );
+
+    if ( window.isNull() ) {
+        return;
+    }
+
+    std::vector<const StrokeDab*> dabs;
+    getTileDabs(&data, window, &dabs);
+    addDabsCoverage(&data, dabs, window, coverage);
+}
+
+void
+RotoShapeRenderCPU::renderStroke_cpu(const std::list<std::list<std::pair<Point, double> > >& strokes,
+                                     const double distToNextIn,
+                                     const Point& lastCenterPointIn,
+                                     const RotoDrawableItem* stroke,
+                                     bool doBuildup,
+                                     double opacity,
+                                     double time,
+                                     unsigned int mipmapLevel,
+                                     bool isDuringPainting,
+                                     const RectI& roi,
+                                     const ImagePtr& dstImage,
+                                     double* distToNextOut,
+                                     Point* lastCenterPointOut)
+{
+    RenderStrokeCPUData data;
+
+    RotoShapeRenderNodePrivate::renderStroke_generic((RotoShapeRenderNodePrivate::RenderStrokeDataPtr)&data,
+                                                     renderStrokeBegin_cpu,
+                                                     renderStrokeRenderDot_cpu,
+                                                     renderStrokeEnd_cpu,
+                                                     strokes,
+                                                     distToNextIn,
+                                                     lastCenterPointIn,
+                                                     stroke,
+                                                     doBuildup,
+                                                     opacity,
+                                                     time,
+                                                     mipmapLevel,
+                                                     distToNextOut,
+                                                     lastCenterPointOut);
+
+    if ( roi.isNull() ) {
+        return;
+    }
+
+    // The opacity is already applied to each dab
+    RasterShape shape;
+    stroke->getColor(time, shape.shapeColor);
+    shape.opacity = 1.;
+    shape.rampType = eRampTypeLinear;
+
+    ImageBitDepthEnum depth = dstImage->getBitDepth();
+    int nComps = (int)dstImage->getComponentsCount();
+
+    // Take the write lock once for all tiles: the lock is recursive per thread and the tiles do not overlap
+    Image::WriteAccess acc = dstImage->getWriteRights();
+
+    std::vector<RectI> tiles = roi.splitIntoSmallerRects( appPTR->getHardwareIdealThreadCount() );
+    bool runInCurrentThread = tiles.size() <= 1 || data.dabs.empty() || QThreadPool::globalInstance()->activeThreadCount() >= QThreadPool::globalInstance()->maxThreadCount();
+
+    if (runInCurrentThread) {
+        for (std::vector<RectI>::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+            splatDabsOnTile(&data, &shape, isDuringPainting, depth, nComps, &acc, *it);
+        }
+    } else {
+        QtConcurrent::map( tiles, boost::bind(&splatDabsOnTile, &data, &shape, isDuringPainting, depth, nComps, &acc, _1) ).waitForFinished();
+    }
+} // RotoShapeRenderCPU::renderStroke_cpu
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,124 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+
+#ifndef ROTOSHAPERENDERCPU_H
+#define ROTOSHAPERENDERCPU_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include <list>
+#include <vector>
+
+#include "Global/GlobalDefines.h"
+#include "Engine/EngineFwd.h"
+#include "Engine/RotoBezierTriangulation.h"
+#include "Engine/RotoShapeRenderGL.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Native CPU rasteriser for closed roto shapes.
+ * It does not depend on Cairo: the shape interior coverage is computed analytically from the
+ * discretized bezier polygon and the feather ramp is interpolated across the triangles of the
+ * feather mesh computed by RotoBezierTriangulation, exactly like the OpenGL renderer does.
+ * The render window is split into tiles which are rasterised concurrently.
+ * Paint strokes and open beziers are rendered by splatting all their dabs at once with a
+ * precomputed falloff kernel, tile by tile.
+ **/
+class RotoShapeRenderCPU
+{
+public:
+
+    RotoShapeRenderCPU()
+    {
+
+    }
+
+    /**
+     * @brief High level: renders the given closed bezier with motion blur into the roi of dstImage.
+     * Every pixel of the roi is written. Motion blur samples taken from startTime to endTime by
+     * mbFrameStep are averaged.
+     **/
+    static void renderBezier_cpu(const Bezier* bezier,
+                                 double opacity,
+                                 double time,
+                                 double startTime,
+                                 double endTime,
+                                 double mbFrameStep,
+                                 unsigned int mipmapLevel,
+                                 const RectI& roi,
+                                 const ImagePtr& dstImage);
+
+    /**
+     * @brief Low level: rasterises a single motion blur sample of a closed shape, given by its discretized
+     * polygon and its feather mesh, over the window. coverage receives window.width() * window.height()
+     * values in [0, 1], row by row starting at window.y1. This is what renderBezier_cpu does for each sample.
+     **/
+    static void rasterizeCoverage_cpu(const std::vector<ParametricPoint>& polygon,
+                                      const std::vector<RotoBezierTriangulation::RotoFeatherVertex>& featherMesh,
+                                      RampTypeEnum rampType,
+                                      double fallOff,
+                                      const RectI& window,
+                                      std::vector<float>* coverage);
+
+    /**
+     * @brief Low level: splats one dab of the brush at each of the given centers, with the associated pen pressure,
+     * over the window. Unlike renderStroke_cpu, no dab is interpolated between the dots. coverage receives
+     * window.width() * window.height() values in [0, 1], row by row starting at window.y1.
+     **/
+    static void rasterizeDabs_cpu(const std::list<std::pair<Point, double> >& dots,
+                                  double brushSizePixel,
+                                  double brushHardness,
+                                  bool pressureAffectsOpacity,
+                                  bool pressureAffectsHardness,
+                                  bool pressureAffectsSize,
+                                  bool buildUp,
+                                  double opacity,
+                                  const RectI& window,
+                                  std::vector<float>* coverage);
+
+    /**
+     * @brief High level: renders the dabs of the given strokes into the roi of dstImage.
+     * The dabs positions are computed by RotoShapeRenderNodePrivate::renderStroke_generic, then
+     * they are all splatted at once, in parallel over tiles of the roi.
+     * If isDuringPainting is true, the dabs are composited over the current content of dstImage
+     * so that only the last segments of the stroke need to be rendered.
+     **/
+    static void renderStroke_cpu(const std::list<std::list<std::pair<Point, double> > >& strokes,
+                                 const double distToNextIn,
+                                 const Point& lastCenterPointIn,
+                                 const RotoDrawableItem* stroke,
+                                 bool doBuildup,
+                                 double opacity,
+                                 double time,
+                                 unsigned int mipmapLevel,
+                                 bool isDuringPainting,
+                                 const RectI& roi,
+                                 const ImagePtr& dstImage,
+                                 double* distToNextOut,
+                                 Point* lastCenterPointOut);
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // ROTOSHAPERENDERCPU_H
@@ -660,18 +660,11 @@ RotoShapeRenderGL::renderBezier_gl(const OSGLContextPtr& glContext,
 
     for (double t = startTime; t <= endTime; t+=mbFrameStep) {
         double fallOff = bezier->getFeatherFallOff(t);
-        double featherDist = bezier->getFeatherDistance(t);
         double shapeColor[3];
         bezier->getColor(t, shapeColor);
 
-
-        ///Adjust the feather distance so it takes the mipmap level into account
-        if (mipmapLevel != 0) {
-            featherDist /= (1 << mipmapLevel);
-        }
-
-        RotoBezierTriangulation::PolygonData data;
-        RotoBezierTriangulation::computeTriangles(bezier, t, mipmapLevel, featherDist, &data);
+        RotoBezierTriangulation::PolygonDataConstPtr dataPtr = RotoBezierTriangulation::getTriangles(bezier, t, mipmapLevel);
+        const RotoBezierTriangulation::PolygonData& data = *dataPtr;
 
         if (glContext->isGPUContext()) {
             setupTexParams<GL_GPU>(target);
@@ -38,6 +38,7 @@
 #include "Engine/RotoStrokeItem.h"
 #include "Engine/RotoShapeRenderNodePrivate.h"
 #include "Engine/RotoShapeRenderCairo.h"
+#include "Engine/RotoShapeRenderCPU.h"
 #include "Engine/RotoShapeRenderGL.h"
 #include "Engine/ParallelRenderArgs.h"
 
@@ -389,9 +390,21 @@ RotoShapeRenderNode::render(const RenderActionArgs& args)
 
 #ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
             if (!args.useOpenGL) {
-                RotoShapeRenderCairo::renderMaskInternal_cairo(rotoItem, args.roi, outputPlane.first, startTime, endTime, mbFrameStep, args.time, outputPlane.second->getBitDepth(), mipmapLevel, isDuringPainting, distNextIn, lastCenterIn, strokes, outputPlane.second, &distToNextOut, &lastCenterOut);
-                if (isDuringPainting) {
-                    getApp()->updateStrokeData(lastCenterOut, distToNextOut);
+                if ( isStroke || !isBezier || isBezier->isOpenBezier() ) {
+                    // All dabs of the stroke are splatted at once by the native renderer
+                    bool doBuildUp = isStroke ? rotoItem->getBuildupKnob()->getValueAtTime(args.time) : true;
+                    RotoShapeRenderCPU::renderStroke_cpu(strokes, distNextIn, lastCenterIn, rotoItem.get(), doBuildUp, rotoItem->getOpacity(args.time), args.time, mipmapLevel, isDuringPainting, args.roi, outputPlane.second, &distToNextOut, &lastCenterOut);
+                    if (isDuringPainting) {
+                        getApp()->updateStrokeData(lastCenterOut, distToNextOut);
+                    }
+                } else if (!isDuringPainting) {
+                    // Closed shapes are rendered by the tile-parallel native rasteriser
+                    RotoShapeRenderCPU::renderBezier_cpu(isBezier, rotoItem->getOpacity(args.time), args.time, startTime, endTime, mbFrameStep, mipmapLevel, args.roi, outputPlane.second);
+                } else {
+                    RotoShapeRenderCairo::renderMaskInternal_cairo(rotoItem, args.roi, outputPlane.first, startTime, endTime, mbFrameStep, args.time, outputPlane.second->getBitDepth(), mipmapLevel, isDuringPainting, distNextIn, lastCenterIn, strokes, outputPlane.second, &distToNextOut, &lastCenterOut);
+                    if (isDuringPainting) {
+                        getApp()->updateStrokeData(lastCenterOut, distToNextOut);
+                    }
                 }
             }
 #endif
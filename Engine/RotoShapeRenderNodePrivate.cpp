@@ -24,6 +24,9 @@
 
 #include "RotoShapeRenderNodePrivate.h"
 
+#include <cmath>
+#include <algorithm>
+
 #include "Engine/KnobTypes.h"
 #include "Engine/Image.h"
 #include "Engine/RotoShapeRenderNode.h"
@@ -35,6 +38,69 @@ RotoShapeRenderNodePrivate::RotoShapeRenderNodePrivate()
 {
 }
 
+static inline
+double
+hardnessGaussLookup(double f)
+{
+    //2 hyperbolas + 1 parabola to approximate a gauss function
+    if (f < -0.5) {
+        f = -1. - f;
+
+        return (2. * f * f);
+    }
+
+    if (f < 0.5) {
+        return (1. - 2. * f * f);
+    }
+    f = 1. - f;
+
+    return (2. * f * f);
+}
+
+void
+RotoShapeRenderNodePrivate::getRenderDotParams(double alpha,
+                                               double brushSizePixel,
+                                               double brushHardness,
+                                               double brushSpacing,
+                                               double pressure,
+                                               bool pressureAffectsOpacity,
+                                               bool pressureAffectsSize,
+                                               bool pressureAffectsHardness,
+                                               double* internalDotRadius,
+                                               double* externalDotRadius,
+                                               double * spacing,
+                                               std::vector<std::pair<double, double> >* opacityStops)
+{
+    if (pressureAffectsSize) {
+        brushSizePixel *= pressure;
+    }
+    if (pressureAffectsHardness) {
+        brushHardness *= pressure;
+    }
+    if (pressureAffectsOpacity) {
+        alpha *= pressure;
+    }
+
+    *internalDotRadius = std::max(brushSizePixel * brushHardness, 1.) / 2.;
+    *externalDotRadius = std::max(brushSizePixel, 1.) / 2.;
+    *spacing = *externalDotRadius * 2. * brushSpacing;
+
+    if (opacityStops) {
+        opacityStops->clear();
+
+        double exp = brushHardness != 1.0 ?  0.4 / (1.0 - brushHardness) : 0.;
+        const int maxStops = 8;
+        double incr = 1. / maxStops;
+
+        if (brushHardness != 1.) {
+            for (double d = 0; d <= 1.; d += incr) {
+                double o = hardnessGaussLookup( std::pow(d, exp) );
+                opacityStops->push_back( std::make_pair(d, o * alpha) );
+            }
+        }
+    }
+} // RotoShapeRenderNodePrivate::getRenderDotParams
+
 
 Point
 RotoShapeRenderNodePrivate::dampenSmearEffect(const Point& prevCenter, const Point& center, const double spacing)
@@ -26,6 +26,7 @@
 // ***** END PYTHON BLOCK *****
 #include <map>
 #include <list>
+#include <vector>
 #include "Engine/EngineFwd.h"
 #include "Global/GlobalDefines.h"
 #include "Engine/OSGLContext.h"
@@ -107,6 +108,24 @@ public:
                                      double* distToNextOut,
                                      Point* lastCenterPoint);
 
+    /**
+     * @brief Computes the radii of a dot rendered at the given pressure and the spacing to the next dot.
+     * If opacityStops is not NULL, it is filled with the radial opacity ramp of the dot going from
+     * the internal radius (0) to the external radius (1). The ramp is empty when the brush hardness is 1.
+     **/
+    static void getRenderDotParams(double alpha,
+                                   double brushSizePixel,
+                                   double brushHardness,
+                                   double brushSpacing,
+                                   double pressure,
+                                   bool pressureAffectsOpacity,
+                                   bool pressureAffectsSize,
+                                   bool pressureAffectsHardness,
+                                   double* internalDotRadius,
+                                   double* externalDotRadius,
+                                   double * spacing,
+                                   std::vector<std::pair<double, double> >* opacityStops);
+
     // If we were to copy exactly the portion in prevCenter, the smear would leave traces
     // too long. To dampen the effect of the smear, we clamp the spacing
     static Point dampenSmearEffect(const Point& prevCenter, const Point& center, const double spacing);
@@ -377,6 +377,14 @@ Settings::initializeKnobsThreading()
                                       "other prior tasks are done.") );
     _queueRenders->setName("queueRenders");
     _threadingPage->addKnob(_queueRenders);
+
+    _renderWritersTogether = AppManager::createKnob<KnobBool>( shared_from_this(), tr("Render writers together") );
+    _renderWritersTogether->setName("renderWritersTogether");
+    _renderWritersTogether->setHintToolTip( tr("When checked, writers started at the same time with the same frame range are rendered "
+                                               "together frame by frame: the nodes they have in common upstream are rendered once per frame "
+                                               "and kept in the cache until all the writers using them have written the frame. "
+                                               "Writers which can only write frames in order (such as movie writers) are always rendered separately.") );
+    _threadingPage->addKnob(_renderWritersTogether);
 } // Settings::initializeKnobsThreading
 
 void
@@ -1508,6 +1516,7 @@ Settings::setDefaultValues()
     _nThreadsPerEffect->setDefaultValue(0);
     _renderInSeparateProcess->setDefaultValue(false, 0);
     _queueRenders->setDefaultValue(false);
+    _renderWritersTogether->setDefaultValue(false);
     _autoPreviewEnabledForNewProjects->setDefaultValue(true, 0);
     _firstReadSetProjectFormat->setDefaultValue(true);
     _fixPathsOnProjectPathChanged->setDefaultValue(true);
@@ -3628,6 +3637,12 @@ Settings::isRenderQueuingEnabled() const
     return _queueRenders->getValue();
 }
 
+bool
+Settings::isRenderWritersTogetherEnabled() const
+{
+    return _renderWritersTogether->getValue();
+}
+
 bool
 Settings::isFileDialogEnabledForNewWriters() const
 {
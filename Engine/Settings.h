@@ -170,6 +170,8 @@ public:
 
     void setRenderQueuingEnabled(bool enabled);
 
+    bool isRenderWritersTogetherEnabled() const;
+
     void restoreDefault();
 
     int getMaximumUndoRedoNodeGraph() const;
@@ -437,6 +439,7 @@ private:
     KnobIntPtr _nThreadsPerEffect;
     KnobBoolPtr _renderInSeparateProcess;
     KnobBoolPtr _queueRenders;
+    KnobBoolPtr _renderWritersTogether;
 
     // General/Rendering
     KnobPagePtr _renderingPage;
@@ -31,6 +31,8 @@ CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QWaitCondition>
 #include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QRunnable>
 #include <QtCore/QCoreApplication>
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
@@ -1813,6 +1815,124 @@ TrackSchedulerPrivate::trackStepFunctor(int trackIndex,
 
 NATRON_NAMESPACE_ANONYMOUS_ENTER
 
+/**
+ * @brief Shared state of a tracking pass. Each track advances through the frames on its own as a chain of
+ * tasks in the global thread pool: tracks never wait on each other at the end of a frame, so a slow track
+ * does not leave the other cores idle.
+ **/
+struct TrackPipeline
+{
+    boost::shared_ptr<TrackArgs> args;
+    int start;
+    int step;
+    int numTracks;
+
+    // Protects everything below
+    QMutex lock;
+    QWaitCondition cond;
+
+    // For each frame, the number of tracks that went through it and the number of tracks that succeeded
+    std::vector<int> finishedPerFrame, succeededPerFrame;
+
+    // No task is launched for frames starting at this index: all tracks failed at this frame or before
+    int stopFrameIndex;
+
+    // Number of leading frames for which all tracks are done
+    int framesCompleted;
+
+    // Number of track chains still running
+    int runningChains;
+    bool aborted;
+
+    TrackPipeline(const boost::shared_ptr<TrackArgs>& args,
+                  int start,
+                  int step,
+                  int nFrames)
+        : args(args)
+        , start(start)
+        , step(step)
+        , numTracks( args->getNumTracks() )
+        , lock()
+        , cond()
+        , finishedPerFrame(nFrames, 0)
+        , succeededPerFrame(nFrames, 0)
+        , stopFrameIndex(nFrames)
+        , framesCompleted(0)
+        , runningChains(0)
+        , aborted(false)
+    {
+    }
+};
+
+typedef boost::shared_ptr<TrackPipeline> TrackPipelinePtr;
+
+class TrackStepRunnable
+    : public QRunnable
+{
+    TrackPipelinePtr _pipeline;
+    int _trackIndex;
+    int _frameIndex;
+
+public:
+
+    TrackStepRunnable(const TrackPipelinePtr& pipeline,
+                      int trackIndex,
+                      int frameIndex)
+        : QRunnable()
+        , _pipeline(pipeline)
+        , _trackIndex(trackIndex)
+        , _frameIndex(frameIndex)
+    {
+    }
+
+    virtual ~TrackStepRunnable()
+    {
+    }
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        TrackPipeline& p = *_pipeline;
+        {
+            QMutexLocker k(&p.lock);
+            if ( p.aborted || (_frameIndex >= p.stopFrameIndex) ) {
+                --p.runningChains;
+                p.cond.wakeAll();
+
+                return;
+            }
+        }
+
+        int time = p.start + _frameIndex * p.step;
+        bool ok = TrackSchedulerPrivate::trackStepFunctor(_trackIndex, *p.args, time);
+
+        QMutexLocker k(&p.lock);
+        ++p.finishedPerFrame[_frameIndex];
+        if (ok) {
+            ++p.succeededPerFrame[_frameIndex];
+        }
+        if (p.finishedPerFrame[_frameIndex] == p.numTracks) {
+            // We don't have any successful track at this frame, stop
+            if ( (p.succeededPerFrame[_frameIndex] == 0) && (_frameIndex < p.stopFrameIndex) ) {
+                p.stopFrameIndex = _frameIndex;
+            }
+            while ( p.framesCompleted < (int)p.finishedPerFrame.size() &&
+                    p.finishedPerFrame[p.framesCompleted] == p.numTracks ) {
+                ++p.framesCompleted;
+            }
+        }
+
+        // Continue the chain on the next frame: it goes at the end of the thread pool queue so that all tracks move forward at a similar pace
+        if ( !p.aborted && (_frameIndex + 1 < p.stopFrameIndex) ) {
+            QThreadPool::globalInstance()->start( new TrackStepRunnable(_pipeline, _trackIndex, _frameIndex + 1) );
+        } else {
+            --p.runningChains;
+        }
+        p.cond.wakeAll();
+    }
+};
+
 class IsTrackingFlagSetter_RAII
 {
     Q_DECLARE_TR_FUNCTIONS(TrackScheduler)
@@ -1872,7 +1992,6 @@ TrackScheduler::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
     ViewerInstancePtr viewer =  args->getViewer();
     int end = args->getEnd();
     int start = args->getStart();
-    int cur = start;
     int frameStep = args->getStep();
     int framesCount = 0;
     if (frameStep != 0) {
@@ -1882,9 +2001,7 @@ TrackScheduler::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
 
     const std::vector<TrackMarkerAndOptionsPtr >& tracks = args->getTracks();
     const int numTracks = (int)tracks.size();
-    std::vector<int> trackIndexes( tracks.size() );
     for (std::size_t i = 0; i < tracks.size(); ++i) {
-        trackIndexes[i] = i;
         tracks[i]->natronMarker->notifyTrackingStarted();
         // unslave the enabled knob, since it is slaved to the gui but we may modify it
         KnobBoolPtr enabledKnob = tracks[i]->natronMarker->getEnabledKnob();
@@ -1900,58 +2017,33 @@ TrackScheduler::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
     timeval lastProgressUpdateTime;
     gettimeofday(&lastProgressUpdateTime, 0);
 
-    bool allTrackFailed = false;
     {
         ///Use RAII style for setting the isDoingPartialUpdates flag so we're sure it gets removed
         IsTrackingFlagSetter_RAII __istrackingflag__(effect, this, frameStep, reportProgress, viewer, doPartialUpdates);
 
         if ( (frameStep == 0) || ( (frameStep > 0) && (start >= end) ) || ( (frameStep < 0) && (start <= end) ) ) {
             // Invalid range
-            cur = end;
+            framesCount = 0;
         }
 
-
-        while (cur != end) {
-            ///Launch parallel thread for each track using the global thread pool
-            QFuture<bool> future = QtConcurrent::mapped( trackIndexes,
-                                                         boost::bind(&TrackSchedulerPrivate::trackStepFunctor,
-                                                                     _1,
-                                                                     *args,
-                                                                     cur) );
-            future.waitForFinished();
-
-            allTrackFailed = true;
-            for (QFuture<bool>::const_iterator it = future.begin(); it != future.end(); ++it) {
-                if ( (*it) ) {
-                    allTrackFailed = false;
-                    break;
-                }
-            }
-
-
-
-            lastValidFrame = cur;
-
-
-
-            // We don't have any successful track, stop
-            if (allTrackFailed) {
-                break;
+        TrackPipelinePtr pipeline( new TrackPipeline(args, start, frameStep, framesCount) );
+        if ( (framesCount > 0) && (numTracks > 0) ) {
+            ///Launch a chain of tasks for each track using the global thread pool
+            pipeline->runningChains = numTracks;
+            for (int i = 0; i < numTracks; ++i) {
+                QThreadPool::globalInstance()->start( new TrackStepRunnable(pipeline, i, 0) );
             }
+        }
 
+        int framesReported = 0;
+        QMutexLocker k(&pipeline->lock);
+        while (pipeline->runningChains > 0) {
+            pipeline->cond.wait(&pipeline->lock, NATRON_TRACKER_REPORT_PROGRESS_DELTA_MS);
 
+            int framesCompleted = pipeline->framesCompleted;
+            bool stopped = pipeline->runningChains == 0;
+            k.unlock();
 
-            cur += frameStep;
-
-            double progress;
-            if (frameStep > 0) {
-                progress = (double)(cur - start) / framesCount;
-            } else {
-                progress = (double)(start - cur) / framesCount;
-            }
-
-            bool isUpdateViewerOnTrackingEnabled = _imp->paramsProvider->getUpdateViewer();
-            bool isCenterViewerEnabled = _imp->paramsProvider->getCenterOnTrack();
             bool enoughTimePassedToReportProgress;
             {
                 timeval now;
@@ -1960,19 +2052,24 @@ TrackScheduler::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
                             (now.tv_usec - lastProgressUpdateTime.tv_usec) * 1e-6f;
                 dt *= 1000; // switch to MS
                 enoughTimePassedToReportProgress = dt > NATRON_TRACKER_REPORT_PROGRESS_DELTA_MS;
-                if (enoughTimePassedToReportProgress) {
-                    lastProgressUpdateTime = now;
-                }
             }
 
+            if ( enoughTimePassedToReportProgress && (framesCompleted > framesReported) && !stopped ) {
+                // All tracks are done up to this frame
+                framesReported = framesCompleted;
+                gettimeofday(&lastProgressUpdateTime, 0);
+
+                int cur = start + framesCompleted * frameStep;
+                double progress = (double)framesCompleted / framesCount;
+                bool isUpdateViewerOnTrackingEnabled = _imp->paramsProvider->getUpdateViewer();
+                bool isCenterViewerEnabled = _imp->paramsProvider->getCenterOnTrack();
 
-            ///Ok all tracks are finished now for this frame, refresh viewer if needed
-            if (isUpdateViewerOnTrackingEnabled && viewer) {
-                //This will not refresh the viewer since when tracking, renderCurrentFrame()
-                //is not called on viewers, see Gui::onTimeChanged
-                timeline->seekFrame(cur, true, OutputEffectInstancePtr(), eTimelineChangeReasonOtherSeek);
+                ///Refresh viewer if needed
+                if (isUpdateViewerOnTrackingEnabled && viewer) {
+                    //This will not refresh the viewer since when tracking, renderCurrentFrame()
+                    //is not called on viewers, see Gui::onTimeChanged
+                    timeline->seekFrame(cur, true, OutputEffectInstancePtr(), eTimelineChangeReasonOtherSeek);
 
-                if (enoughTimePassedToReportProgress) {
                     if (doPartialUpdates) {
                         std::list<RectD> updateRects;
                         args->getRedrawAreasNeeded(cur, &updateRects);
@@ -1982,19 +2079,26 @@ TrackScheduler::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
                     }
                     Q_EMIT renderCurrentFrameForViewer(viewer);
                 }
-            }
 
-            if (enoughTimePassedToReportProgress && reportProgress && effect) {
-                ///Notify we progressed of 1 frame
-                Q_EMIT trackingProgress(progress);
+                if (reportProgress && effect) {
+                    Q_EMIT trackingProgress(progress);
+                }
             }
 
-            // Check for abortion
-            state = resolveState();
+            // Check for abortion: running tasks will not start a new frame
+            if ( (state != eThreadStateAborted) && (state != eThreadStateStopped) ) {
+                state = resolveState();
+            }
+            k.relock();
             if ( (state == eThreadStateAborted) || (state == eThreadStateStopped) ) {
-                break;
+                pipeline->aborted = true;
             }
-        } // while (cur != end) {
+        } // while (pipeline->runningChains > 0)
+
+        // Last frame that was tracked by all tracks
+        if (pipeline->framesCompleted > 0) {
+            lastValidFrame = start + (std::min(pipeline->framesCompleted, pipeline->stopFrameIndex + 1) - 1) * frameStep;
+        }
     } // IsTrackingFlagSetter_RAII
     TrackerContext* isContext = dynamic_cast<TrackerContext*>(_imp->paramsProvider);
     if (isContext) {
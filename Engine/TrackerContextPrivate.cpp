@@ -43,6 +43,9 @@
 //#define TRACKER_GENERATE_DATA_SEQUENTIALLY
 #endif
 
+// Number of batches of keyframes per thread of the pool when solving the transform/corner pin
+#define NATRON_TRACKER_SOLVER_BATCHES_PER_THREAD 4
+
 
 NATRON_NAMESPACE_ENTER;
 
@@ -1170,7 +1173,7 @@ TrackerContext::trackMarkers(const std::list<TrackMarkerPtr >& markers,
     bool autoKeyingOnEnabledParamEnabled = _imp->autoKeyEnabled.lock()->getValue();
     
     /// The accessor and its cache is local to a track operation, it is wiped once the whole sequence track is finished.
-    boost::shared_ptr<TrackerFrameAccessor> accessor( new TrackerFrameAccessor(this, enabledChannels, formatHeight) );
+    boost::shared_ptr<TrackerFrameAccessor> accessor( new TrackerFrameAccessor(this, enabledChannels, formatHeight, frameStep) );
     boost::shared_ptr<mv::AutoTrack> trackContext( new mv::AutoTrack( accessor.get() ) );
     std::vector<TrackMarkerAndOptionsPtr > trackAndOptions;
     mv::TrackRegionOptions mvOptions;
@@ -1845,6 +1848,7 @@ TrackerContextPrivate::extractSortedPointsFromMarkers(double refTime,
 
 TrackerContextPrivate::TransformData
 TrackerContextPrivate::computeTransformParamsFromTracksAtTime(double refTime,
+                                                              const RectD& rodRef,
                                                               double time,
                                                               int jitterPeriod,
                                                               bool jitterAdd,
@@ -1852,7 +1856,6 @@ TrackerContextPrivate::computeTransformParamsFromTracksAtTime(double refTime,
                                                               const std::vector<TrackMarkerPtr>& allMarkers)
 {
 
-    RectD rodRef = getInputRoDAtTime(refTime);
     RectD rodTime = getInputRoDAtTime(time);
     int w1 = rodRef.width();
     int h1 = rodRef.height();
@@ -1907,13 +1910,13 @@ TrackerContextPrivate::computeTransformParamsFromTracksAtTime(double refTime,
 
 TrackerContextPrivate::CornerPinData
 TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime(double refTime,
+                                                              const RectD& rodRef,
                                                               double time,
                                                               int jitterPeriod,
                                                               bool jitterAdd,
                                                               bool robustModel,
                                                               const std::vector<TrackMarkerPtr>& allMarkers)
 {
-    RectD rodRef = getInputRoDAtTime(refTime);
     RectD rodTime = getInputRoDAtTime(time);
     int w1 = rodRef.width();
     int h1 = rodRef.height();
@@ -1971,6 +1974,69 @@ TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime(double refTime,
     return data;
 } // TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime
 
+TrackerContextPrivate::TransformDataBatch
+TrackerContextPrivate::computeTransformParamsFromTracksForBatch(double refTime,
+                                                                const SolverKeyframesBatch& keyframes,
+                                                                int jitterPeriod,
+                                                                bool jitterAdd,
+                                                                bool robustModel,
+                                                                const std::vector<TrackMarkerPtr>& allMarkers)
+{
+    // The reference frame is the same for all keyframes
+    RectD rodRef = getInputRoDAtTime(refTime);
+    TransformDataBatch ret;
+
+    for (SolverKeyframesBatch::const_iterator it = keyframes.begin(); it != keyframes.end(); ++it) {
+        ret.push_back( computeTransformParamsFromTracksAtTime(refTime, rodRef, *it, jitterPeriod, jitterAdd, robustModel, allMarkers) );
+    }
+
+    return ret;
+}
+
+TrackerContextPrivate::CornerPinDataBatch
+TrackerContextPrivate::computeCornerPinParamsFromTracksForBatch(double refTime,
+                                                                const SolverKeyframesBatch& keyframes,
+                                                                int jitterPeriod,
+                                                                bool jitterAdd,
+                                                                bool robustModel,
+                                                                const std::vector<TrackMarkerPtr>& allMarkers)
+{
+    // The reference frame is the same for all keyframes
+    RectD rodRef = getInputRoDAtTime(refTime);
+    CornerPinDataBatch ret;
+
+    for (SolverKeyframesBatch::const_iterator it = keyframes.begin(); it != keyframes.end(); ++it) {
+        ret.push_back( computeCornerPinParamsFromTracksAtTime(refTime, rodRef, *it, jitterPeriod, jitterAdd, robustModel, allMarkers) );
+    }
+
+    return ret;
+}
+
+std::vector<TrackerContextPrivate::SolverKeyframesBatch>
+TrackerContextPrivate::getSolverKeyframesBatches() const
+{
+    std::vector<SolverKeyframesBatch> batches;
+    const std::set<double>& keyframes = lastSolveRequest.keyframes;
+
+    if ( keyframes.empty() ) {
+        return batches;
+    }
+
+    // A few batches per thread so that the load remains balanced if some keyframes are slower to solve
+    std::size_t nBatches = std::max(1, QThreadPool::globalInstance()->maxThreadCount() * NATRON_TRACKER_SOLVER_BATCHES_PER_THREAD);
+    std::size_t batchSize = std::max( (std::size_t)1, (keyframes.size() + nBatches - 1) / nBatches );
+
+    for (std::set<double>::const_iterator it = keyframes.begin(); it != keyframes.end(); ++it) {
+        if ( batches.empty() || (batches.back().size() >= batchSize) ) {
+            batches.push_back( SolverKeyframesBatch() );
+            batches.back().reserve(batchSize);
+        }
+        batches.back().push_back(*it);
+    }
+
+    return batches;
+}
+
 
 struct CornerPinPoints
 {
@@ -2371,18 +2437,20 @@ TrackerContextPrivate::computeCornerParamsFromTracks()
 {
 #ifndef TRACKER_GENERATE_DATA_SEQUENTIALLY
     lastSolveRequest.tWatcher.reset();
-    lastSolveRequest.cpWatcher.reset( new QFutureWatcher<TrackerContextPrivate::CornerPinData>() );
+    lastSolveRequest.cpWatcher.reset( new QFutureWatcher<TrackerContextPrivate::CornerPinDataBatch>() );
     QObject::connect( lastSolveRequest.cpWatcher.get(), SIGNAL(finished()), this, SLOT(onCornerPinSolverWatcherFinished()) );
     QObject::connect( lastSolveRequest.cpWatcher.get(), SIGNAL(progressValueChanged(int)), this, SLOT(onCornerPinSolverWatcherProgress(int)) );
-    lastSolveRequest.cpWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.keyframes, boost::bind(&TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime, this, lastSolveRequest.refTime, _1, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers) ) );
+    lastSolveRequest.batches = getSolverKeyframesBatches();
+    lastSolveRequest.cpWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.batches, boost::bind(&TrackerContextPrivate::computeCornerPinParamsFromTracksForBatch, this, lastSolveRequest.refTime, _1, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers) ) );
 #else
     NodePtr thisNode = node.lock();
     QList<CornerPinData> validResults;
     {
+        RectD rodRef = getInputRoDAtTime(lastSolveRequest.refTime);
         int nKeys = (int)lastSolveRequest.keyframes.size();
         int keyIndex = 0;
         for (std::set<double>::const_iterator it = lastSolveRequest.keyframes.begin(); it != lastSolveRequest.keyframes.end(); ++it, ++keyIndex) {
-            CornerPinData data = computeCornerPinParamsFromTracksAtTime(lastSolveRequest.refTime, *it, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers);
+            CornerPinData data = computeCornerPinParamsFromTracksAtTime(lastSolveRequest.refTime, rodRef, *it, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers);
             if (data.valid) {
                 validResults.push_back(data);
             }
@@ -2548,18 +2616,20 @@ TrackerContextPrivate::computeTransformParamsFromTracks()
 {
 #ifndef TRACKER_GENERATE_DATA_SEQUENTIALLY
     lastSolveRequest.cpWatcher.reset();
-    lastSolveRequest.tWatcher.reset( new QFutureWatcher<TrackerContextPrivate::TransformData>() );
+    lastSolveRequest.tWatcher.reset( new QFutureWatcher<TrackerContextPrivate::TransformDataBatch>() );
     QObject::connect( lastSolveRequest.tWatcher.get(), SIGNAL(finished()), this, SLOT(onTransformSolverWatcherFinished()) );
     QObject::connect( lastSolveRequest.tWatcher.get(), SIGNAL(progressValueChanged(int)), this, SLOT(onTransformSolverWatcherProgress(int)) );
-    lastSolveRequest.tWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.keyframes, boost::bind(&TrackerContextPrivate::computeTransformParamsFromTracksAtTime, this, lastSolveRequest.refTime, _1, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers) ) );
+    lastSolveRequest.batches = getSolverKeyframesBatches();
+    lastSolveRequest.tWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.batches, boost::bind(&TrackerContextPrivate::computeTransformParamsFromTracksForBatch, this, lastSolveRequest.refTime, _1, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers) ) );
 #else
     NodePtr thisNode = node.lock();
     QList<TransformData> validResults;
     {
+        RectD rodRef = getInputRoDAtTime(lastSolveRequest.refTime);
         int nKeys = lastSolveRequest.keyframes.size();
         int keyIndex = 0;
         for (std::set<double>::const_iterator it = lastSolveRequest.keyframes.begin(); it != lastSolveRequest.keyframes.end(); ++it, ++keyIndex) {
-            TransformData data = computeTransformParamsFromTracksAtTime(lastSolveRequest.refTime, *it, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers);
+            TransformData data = computeTransformParamsFromTracksAtTime(lastSolveRequest.refTime, rodRef, *it, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers);
             if (data.valid) {
                 validResults.push_back(data);
             }
@@ -2575,14 +2645,26 @@ void
 TrackerContextPrivate::onCornerPinSolverWatcherFinished()
 {
     assert(lastSolveRequest.cpWatcher);
-    computeCornerParamsFromTracksEnd( lastSolveRequest.refTime, lastSolveRequest.maxFittingError, lastSolveRequest.cpWatcher->future().results() );
+    // Batches are ordered by time
+    QList<CornerPinData> results;
+    QList<CornerPinDataBatch> batches = lastSolveRequest.cpWatcher->future().results();
+    for (QList<CornerPinDataBatch>::const_iterator it = batches.begin(); it != batches.end(); ++it) {
+        results.append(*it);
+    }
+    computeCornerParamsFromTracksEnd(lastSolveRequest.refTime, lastSolveRequest.maxFittingError, results);
 }
 
 void
 TrackerContextPrivate::onTransformSolverWatcherFinished()
 {
     assert(lastSolveRequest.tWatcher);
-    computeTransformParamsFromTracksEnd( lastSolveRequest.refTime, lastSolveRequest.maxFittingError, lastSolveRequest.tWatcher->future().results() );
+    // Batches are ordered by time
+    QList<TransformData> results;
+    QList<TransformDataBatch> batches = lastSolveRequest.tWatcher->future().results();
+    for (QList<TransformDataBatch>::const_iterator it = batches.begin(); it != batches.end(); ++it) {
+        results.append(*it);
+    }
+    computeTransformParamsFromTracksEnd(lastSolveRequest.refTime, lastSolveRequest.maxFittingError, results);
 }
 
 void
@@ -477,8 +477,12 @@ public:
         double rms;
     };
 
-    typedef boost::shared_ptr<QFutureWatcher<CornerPinData> > CornerPinSolverWatcher;
-    typedef boost::shared_ptr<QFutureWatcher<TransformData> > TransformSolverWatcher;
+    // The solver processes consecutive keyframes in batches, each batch is solved by a thread of the pool
+    typedef std::vector<double> SolverKeyframesBatch;
+    typedef QList<CornerPinData> CornerPinDataBatch;
+    typedef QList<TransformData> TransformDataBatch;
+    typedef boost::shared_ptr<QFutureWatcher<CornerPinDataBatch> > CornerPinSolverWatcher;
+    typedef boost::shared_ptr<QFutureWatcher<TransformDataBatch> > TransformSolverWatcher;
 
     struct SolveRequest
     {
@@ -486,6 +490,7 @@ public:
         TransformSolverWatcher tWatcher;
         double refTime;
         std::set<double> keyframes;
+        std::vector<SolverKeyframesBatch> batches;
         int jitterPeriod;
         bool jitterAdd;
         bool robustModel;
@@ -643,6 +648,7 @@ public:
 
 
     TransformData computeTransformParamsFromTracksAtTime(double refTime,
+                                                         const RectD& rodRef,
                                                          double time,
                                                          int jitterPeriod,
                                                          bool jitterAdd,
@@ -650,6 +656,7 @@ public:
                                                          const std::vector<TrackMarkerPtr>& allMarkers);
 
     CornerPinData computeCornerPinParamsFromTracksAtTime(double refTime,
+                                                         const RectD& rodRef,
                                                          double time,
                                                          int jitterPeriod,
                                                          bool jitterAdd,
@@ -657,6 +664,26 @@ public:
                                                          const std::vector<TrackMarkerPtr>& allMarkers);
 
 
+    TransformDataBatch computeTransformParamsFromTracksForBatch(double refTime,
+                                                                const SolverKeyframesBatch& keyframes,
+                                                                int jitterPeriod,
+                                                                bool jitterAdd,
+                                                                bool robustModel,
+                                                                const std::vector<TrackMarkerPtr>& allMarkers);
+
+    CornerPinDataBatch computeCornerPinParamsFromTracksForBatch(double refTime,
+                                                                const SolverKeyframesBatch& keyframes,
+                                                                int jitterPeriod,
+                                                                bool jitterAdd,
+                                                                bool robustModel,
+                                                                const std::vector<TrackMarkerPtr>& allMarkers);
+
+    /**
+     * @brief Split the keyframes of the last solve request in batches of consecutive keyframes so that
+     * each thread of the pool gets a few of them.
+     **/
+    std::vector<SolverKeyframesBatch> getSolverKeyframesBatches() const;
+
     void resetTransformParamsAnimation();
 
     void computeTransformParamsFromTracks();
@@ -32,17 +32,36 @@ GCC_DIAG_OFF(unused-parameter)
 GCC_DIAG_ON(unused-function)
 GCC_DIAG_ON(unused-parameter)
 
+#include <algorithm> // min, max
+#include <cstring> // memcpy
+#include <list>
+#include <map>
+#include <set>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/bind.hpp>
+#endif
+
 #include <QtCore/QDebug>
+#include <QtCore/QWaitCondition>
+#include <QtConcurrentRun> // QtCore on Qt4, QtConcurrent on Qt5
 
 #include "Engine/AbortableRenderInfo.h"
 #include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
 #include "Engine/Project.h"
 #include "Engine/TimeLine.h"
 #include "Engine/EffectInstance.h"
 #include "Engine/Image.h"
 #include "Engine/Node.h"
+#include "Engine/TLSHolder.h"
 #include "Engine/TrackerContext.h"
 
+// Memory budget of the full frames kept by the accessor. At least NATRON_TRACKER_ACCESSOR_CACHE_MIN_FRAMES are kept:
+// the reference frame, the frame being tracked and the prefetched frame.
+#define NATRON_TRACKER_ACCESSOR_CACHE_MAX_BYTES (512 * 1024 * 1024)
+#define NATRON_TRACKER_ACCESSOR_CACHE_MIN_FRAMES 3
+
 NATRON_NAMESPACE_ENTER;
 
 namespace  {
@@ -110,16 +129,19 @@ public:
 };
 
 
+typedef boost::shared_ptr<MvFloatImage> MvFloatImagePtr;
+
 struct FrameAccessorCacheEntry
 {
-    boost::shared_ptr<MvFloatImage> image;
-
-    // If null, this is the full image
+    // The luminance of the full frame at the mipmap level of the key
+    MvFloatImagePtr image;
     RectI bounds;
-    unsigned int referenceCount;
+    std::size_t nBytes;
 };
 
-typedef std::multimap<FrameAccessorCacheKey, FrameAccessorCacheEntry, CacheKey_compare_less > FrameAccessorCache;
+typedef std::list<FrameAccessorCacheKey> FrameAccessorLRUList;
+typedef std::map<FrameAccessorCacheKey, std::pair<FrameAccessorCacheEntry, FrameAccessorLRUList::iterator>, CacheKey_compare_less > FrameAccessorCache;
+typedef std::set<FrameAccessorCacheKey, CacheKey_compare_less> FrameAccessorKeySet;
 
 
 template <bool doR, bool doG, bool doB>
@@ -200,6 +222,60 @@ natronImageToLibMvFloatImage(bool enabledChannels[3],
         }
     }
 }
+/*
+ * @brief Copy the portion roi of the full frame image which has the given bounds
+ */
+void
+cropLibMvFloatImage(const MvFloatImage& fullFrame,
+                    const RectI& bounds,
+                    const RectI& roi,
+                    MvFloatImage& mvImg)
+{
+    assert( bounds.contains(roi) );
+    int w = roi.width();
+    int h = roi.height();
+    int fullW = bounds.width();
+    const float* src_pixels = fullFrame.Data() + (roi.y1 - bounds.y1) * fullW + (roi.x1 - bounds.x1);
+    float* dst_pixels = mvImg.Data();
+    for (int y = 0; y < h; ++y, src_pixels += fullW, dst_pixels += w) {
+        std::memcpy( dst_pixels, src_pixels, w * sizeof(float) );
+    }
+}
+
+/*
+ * @brief Make the next level of the pyramid with a box filter
+ */
+void
+downscaleLibMvFloatImage(const MvFloatImage& src,
+                         const RectI& srcBounds,
+                         const RectI& dstBounds,
+                         MvFloatImage& dst)
+{
+    int srcW = srcBounds.width();
+    int dstW = dstBounds.width();
+    int dstH = dstBounds.height();
+    float* dst_pixels = dst.Data();
+
+    for (int y = 0; y < dstH; ++y) {
+        int srcY = (dstBounds.y1 + y) * 2;
+        int y1 = std::max(srcY, srcBounds.y1) - srcBounds.y1;
+        int y2 = std::min(srcY + 2, srcBounds.y2) - srcBounds.y1;
+        for (int x = 0; x < dstW; ++x, ++dst_pixels) {
+            int srcX = (dstBounds.x1 + x) * 2;
+            int x1 = std::max(srcX, srcBounds.x1) - srcBounds.x1;
+            int x2 = std::min(srcX + 2, srcBounds.x2) - srcBounds.x1;
+            float sum = 0.f;
+            int n = 0;
+            for (int sy = y1; sy < y2; ++sy) {
+                const float* src_pixels = src.Data() + sy * srcW;
+                for (int sx = x1; sx < x2; ++sx, ++n) {
+                    sum += src_pixels[sx];
+                }
+            }
+            *dst_pixels = n ? sum / n : 0.f;
+        }
+    }
+}
 } // anon namespace
 
 
@@ -207,20 +283,50 @@ struct TrackerFrameAccessorPrivate
 {
     const TrackerContext* context;
     NodePtr trackerInput;
-    mutable QMutex cacheMutex;
-    FrameAccessorCache cache;
     bool enabledChannels[3];
     int formatHeight;
+    int frameStep;
+
+    // Protects everything below
+    mutable QMutex cacheMutex;
+
+    // Signaled when a frame is no longer pending
+    QWaitCondition pendingCond;
+
+    // Full frames shared by all tracks, the most recently used is at the back of the LRU list
+    FrameAccessorCache cache;
+    FrameAccessorLRUList lru;
+    std::size_t cacheBytes;
+
+    // Frames currently being rendered by a track or by the prefetch
+    FrameAccessorKeySet pendingFrames;
+
+    // Images returned by GetImage() and not yet released. The same full frame may be lent several times.
+    std::multimap<MvFloatImage*, MvFloatImagePtr> lentImages;
+
+    QFuture<void> prefetchFuture;
+    AbortableRenderInfoPtr prefetchAbortInfo;
+    bool destroying;
 
     TrackerFrameAccessorPrivate(const TrackerContext* context,
                                 bool enabledChannels[3],
-                                int formatHeight)
+                                int formatHeight,
+                                int frameStep)
         : context(context)
         , trackerInput()
-        , cacheMutex()
-        , cache()
         , enabledChannels()
         , formatHeight(formatHeight)
+        , frameStep(frameStep)
+        , cacheMutex()
+        , pendingCond()
+        , cache()
+        , lru()
+        , cacheBytes(0)
+        , pendingFrames()
+        , lentImages()
+        , prefetchFuture()
+        , prefetchAbortInfo()
+        , destroying(false)
     {
         trackerInput = context->getNode()->getInput(0);
         assert(trackerInput);
@@ -228,18 +334,41 @@ struct TrackerFrameAccessorPrivate
             this->enabledChannels[i] = enabledChannels[i];
         }
     }
+
+    bool getFullFrame(const FrameAccessorCacheKey& key, FrameAccessorCacheEntry* entry);
+
+    bool renderFullFrame(const FrameAccessorCacheKey& key, const AbortableRenderInfoPtr& abortInfo, FrameAccessorCacheEntry* entry);
+
+    void insertInCache_locked(const FrameAccessorCacheKey& key, const FrameAccessorCacheEntry& entry);
+
+    void prefetchFrame(FrameAccessorCacheKey key);
+
+    void launchPrefetch(const FrameAccessorCacheKey& key);
 };
 
 TrackerFrameAccessor::TrackerFrameAccessor(const TrackerContext* context,
                                            bool enabledChannels[3],
-                                           int formatHeight)
+                                           int formatHeight,
+                                           int frameStep)
     : mv::FrameAccessor()
-    , _imp( new TrackerFrameAccessorPrivate(context, enabledChannels, formatHeight) )
+    , _imp( new TrackerFrameAccessorPrivate(context, enabledChannels, formatHeight, frameStep) )
 {
 }
 
 TrackerFrameAccessor::~TrackerFrameAccessor()
 {
+    {
+        QMutexLocker k(&_imp->cacheMutex);
+        _imp->destroying = true;
+        if (_imp->prefetchAbortInfo) {
+            _imp->prefetchAbortInfo->setAborted();
+        }
+    }
+    _imp->prefetchFuture.waitForFinished();
+
+    if (_imp->cacheBytes) {
+        _imp->context->getNode()->getEffectInstance()->unregisterPluginMemory(_imp->cacheBytes);
+    }
 }
 
 void
@@ -272,75 +401,113 @@ TrackerFrameAccessor::convertLibMVRegionToRectI(const mv::Region& region,
     //roi->y2 = invertYCoordinate(region.min(1), formatHeight);
 }
 
-/*
- * @brief This is called by LibMV to retrieve an image either for reference or as search frame.
- */
-mv::FrameAccessor::Key
-TrackerFrameAccessor::GetImage(int /*clip*/,
-                               int frame,
-                               mv::FrameAccessor::InputMode input_mode,
-                               int downscale,            // Downscale by 2^downscale.
-                               const mv::Region* region,     // Get full image if NULL.
-                               const mv::FrameAccessor::Transform* /*transform*/, // May be NULL.
-                               mv::FloatImage** destination)
+void
+TrackerFrameAccessorPrivate::insertInCache_locked(const FrameAccessorCacheKey& key,
+                                                  const FrameAccessorCacheEntry& entry)
 {
-    // Since libmv only uses MONO images for now we have only optimized for this case, remove and handle properly
-    // other case(s) when they get integrated into libmv.
-    assert(input_mode == mv::FrameAccessor::MONO);
-
+    // cacheMutex must be locked
+    lru.push_back(key);
+    cache.insert( std::make_pair( key, std::make_pair( entry, --lru.end() ) ) );
+    cacheBytes += entry.nBytes;
+
+    std::size_t freedBytes = 0;
+    while ( cacheBytes > NATRON_TRACKER_ACCESSOR_CACHE_MAX_BYTES && lru.size() > NATRON_TRACKER_ACCESSOR_CACHE_MIN_FRAMES ) {
+        FrameAccessorCache::iterator found = cache.find( lru.front() );
+        assert( found != cache.end() );
+        // Images still lent to LibMV are owned by lentImages, they remain valid
+        cacheBytes -= found->second.first.nBytes;
+        freedBytes += found->second.first.nBytes;
+        cache.erase(found);
+        lru.pop_front();
+    }
 
-    FrameAccessorCacheKey key;
-    key.frame = frame;
-    key.mipMapLevel = downscale;
-    key.mode = input_mode;
+    EffectInstancePtr effect = context->getNode()->getEffectInstance();
+    if (entry.nBytes > freedBytes) {
+        effect->registerPluginMemory(entry.nBytes - freedBytes);
+    } else if (freedBytes > entry.nBytes) {
+        effect->unregisterPluginMemory(freedBytes - entry.nBytes);
+    }
+}
 
-    /*
-       Check if a frame exists in the cache with matching key and bounds enclosing the given region
-     */
-    RectI roi;
-    if (region) {
-        convertLibMVRegionToRectI(*region, _imp->formatHeight, &roi);
+/*
+ * @brief Returns the full frame for the given key, either from the cache, by downscaling the level above in the pyramid,
+ * or by rendering it. If another thread is already computing it, wait for it instead of doing the work twice.
+ */
+bool
+TrackerFrameAccessorPrivate::getFullFrame(const FrameAccessorCacheKey& key,
+                                          FrameAccessorCacheEntry* entry)
+{
+    {
+        QMutexLocker k(&cacheMutex);
+        for (;;) {
+            FrameAccessorCache::iterator found = cache.find(key);
+            if ( found != cache.end() ) {
+                // Mark it as the most recently used
+                lru.splice(lru.end(), lru, found->second.second);
+                *entry = found->second.first;
 
-        QMutexLocker k(&_imp->cacheMutex);
-        std::pair<FrameAccessorCache::iterator, FrameAccessorCache::iterator> range = _imp->cache.equal_range(key);
-        for (FrameAccessorCache::iterator it = range.first; it != range.second; ++it) {
-            if ( (roi.x1 >= it->second.bounds.x1) && (roi.x2 <= it->second.bounds.x2) &&
-                 ( roi.y1 >= it->second.bounds.y1) && ( roi.y2 <= it->second.bounds.y2) ) {
-#ifdef TRACE_LIB_MV
-                qDebug() << QThread::currentThread() << "FrameAccessor::GetImage():" << "Found cached image at frame" << frame << "with RoI x1="
-                         << region->min(0) << "y1=" << region->max(1) << "x2=" << region->max(0) << "y2=" << region->min(1);
-#endif
-                // LibMV is kinda dumb on this we must necessarily copy the data either via CopyFrom or the
-                // assignment constructor:
-                // EDIT: fixed libmv
-                *destination = it->second.image.get();
-                //destination->CopyFrom<float>(*it->second.image);
-                ++it->second.referenceCount;
-
-                return (mv::FrameAccessor::Key)it->second.image.get();
+                return true;
             }
+            if ( pendingFrames.find(key) == pendingFrames.end() ) {
+                break;
+            }
+            pendingCond.wait(&cacheMutex);
         }
+        pendingFrames.insert(key);
     }
 
+    bool ok;
+    if (key.mipMapLevel > 0) {
+        // Build the pyramid from the level above rather than rendering again
+        FrameAccessorCacheKey parentKey = key;
+        --parentKey.mipMapLevel;
+        FrameAccessorCacheEntry parent;
+        ok = getFullFrame(parentKey, &parent);
+        if (ok) {
+            entry->bounds = parent.bounds.downscalePowerOfTwoSmallestEnclosing(1);
+            entry->image.reset( new MvFloatImage( entry->bounds.height(), entry->bounds.width() ) );
+            entry->nBytes = entry->bounds.area() * sizeof(float);
+            downscaleLibMvFloatImage(*parent.image, parent.bounds, entry->bounds, *entry->image);
+        }
+    } else {
+        ok = renderFullFrame( key, AbortableRenderInfo::create(false, 0), entry );
+    }
+
+    QMutexLocker k(&cacheMutex);
+    pendingFrames.erase(key);
+    if (ok) {
+        insertInCache_locked(key, *entry);
+    }
+    pendingCond.wakeAll();
+
+    return ok;
+} // TrackerFrameAccessorPrivate::getFullFrame
+
+bool
+TrackerFrameAccessorPrivate::renderFullFrame(const FrameAccessorCacheKey& key,
+                                             const AbortableRenderInfoPtr& abortInfo,
+                                             FrameAccessorCacheEntry* entry)
+{
     EffectInstancePtr effect;
-    if (_imp->trackerInput) {
-        effect = _imp->trackerInput->getEffectInstance();
+
+    if (trackerInput) {
+        effect = trackerInput->getEffectInstance();
     }
     if (!effect) {
-        return (mv::FrameAccessor::Key)0;
+        return false;
     }
 
-    // Not in accessor cache, call renderRoI
+    int frame = key.frame;
+    unsigned int downscale = (unsigned int)key.mipMapLevel;
     RenderScale scale;
-    scale.y = scale.x = Image::getScaleFromMipMapLevel( (unsigned int)downscale );
+    scale.y = scale.x = Image::getScaleFromMipMapLevel(downscale);
 
-    NodePtr node = _imp->context->getNode();
+    NodePtr node = context->getNode();
 
 
     const bool isRenderUserInteraction = true;
     const bool isSequentialRender = false;
 
-    AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(false, 0);
     AbortableThread* isAbortable = dynamic_cast<AbortableThread*>( QThread::currentThread() );
     if (isAbortable) {
         isAbortable->setAbortInfo( isRenderUserInteraction, abortInfo, node->getEffectInstance() );
@@ -365,7 +532,7 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
     try {
         frameRenderArgs.reset(new ParallelRenderArgsSetter(tlsArgs));
     } catch (...) {
-        return (mv::FrameAccessor::Key)0;
+        return false;
     }
 
     U64 effectHash;
@@ -374,24 +541,24 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
     (void)gotHash;
     double par = effect->getAspectRatio(-1);
     RectD precomputedRoD;
-    if (!region) {
-
-        StatusEnum stat = effect->getRegionOfDefinition_public(effectHash, frame, scale, ViewIdx(0), &precomputedRoD);
-        if (stat == eStatusFailed) {
-            return (mv::FrameAccessor::Key)0;
-        }
-        precomputedRoD.toPixelEnclosing( (unsigned int)downscale, par, &roi );
+    StatusEnum stat = effect->getRegionOfDefinition_public(effectHash, frame, scale, ViewIdx(0), &precomputedRoD);
+    if (stat == eStatusFailed) {
+        return false;
     }
+    if ( precomputedRoD.isNull() || precomputedRoD.isInfinite() ) {
+        // e.g: generators, track in the project format instead
+        Format f;
+        node->getApp()->getProject()->getProjectDefaultFormat(&f);
+        precomputedRoD = f.toCanonicalFormat();
+    }
+    RectI roi;
+    precomputedRoD.toPixelEnclosing(downscale, par, &roi);
 
     std::list<ImageComponents> components;
     components.push_back( ImageComponents::getRGBComponents() );
 
-
-
-    RectD canonicalRoi;
-    roi.toCanonical(downscale, par, precomputedRoD, &canonicalRoi);
-    if (frameRenderArgs->computeRequestPass(downscale, canonicalRoi) != eStatusOK) {
-        return (mv::FrameAccessor::Key)0;
+    if (frameRenderArgs->computeRequestPass(downscale, precomputedRoD) != eStatusOK) {
+        return false;
     }
 
     EffectInstance::RenderRoIArgs args( frame,
@@ -404,19 +571,19 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
                                         components,
                                         eImageBitDepthFloat,
                                         true,
-                                        _imp->context->getNode()->getEffectInstance(),
+                                        node->getEffectInstance(),
                                         eStorageModeRAM /*returnOpenGLTex*/,
                                         frame);
     std::map<ImageComponents, ImagePtr> planes;
 
-    EffectInstance::RenderRoIRetCode stat = effect->renderRoI(args, &planes);
-    if ( (stat != EffectInstance::eRenderRoIRetCodeOk) || planes.empty() ) {
+    EffectInstance::RenderRoIRetCode retCode = effect->renderRoI(args, &planes);
+    if ( (retCode != EffectInstance::eRenderRoIRetCodeOk) || planes.empty() ) {
 #ifdef TRACE_LIB_MV
         qDebug() << QThread::currentThread() << "FrameAccessor::GetImage():" << "Failed to call renderRoI on input at frame" << frame << "with RoI x1="
                  << roi.x1 << "y1=" << roi.y1 << "x2=" << roi.x2 << "y2=" << roi.y2;
 #endif
 
-        return (mv::FrameAccessor::Key)0;
+        return false;
     }
 
     assert( !planes.empty() );
@@ -429,7 +596,7 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
                  << roi.x1 << "y1=" << roi.y1 << "x2=" << roi.x2 << "y2=" << roi.y2 << ")";
 #endif
 
-        return (mv::FrameAccessor::Key)0;
+        return false;
     }
 
 #ifdef TRACE_LIB_MV
@@ -440,30 +607,128 @@ TrackerFrameAccessor::GetImage(int /*clip*/,
     /*
        Copy the Natron image to the LivMV float image
      */
-    FrameAccessorCacheEntry entry;
-    entry.image.reset( new MvFloatImage( intersectedRoI.height(), intersectedRoI.width() ) );
-    entry.bounds = intersectedRoI;
-    entry.referenceCount = 1;
-    natronImageToLibMvFloatImage(_imp->enabledChannels,
+    entry->image.reset( new MvFloatImage( intersectedRoI.height(), intersectedRoI.width() ) );
+    entry->bounds = intersectedRoI;
+    entry->nBytes = intersectedRoI.area() * sizeof(float);
+    natronImageToLibMvFloatImage(enabledChannels,
                                  sourceImage.get(),
                                  intersectedRoI,
-                                 *entry.image);
-    // we ignore the transform parameter and do it in natronImageToLibMvFloatImage instead
+                                 *entry->image);
 
-    *destination = entry.image.get();
-    //destination->CopyFrom<float>(*entry.image);
+    return true;
+} // TrackerFrameAccessorPrivate::renderFullFrame
 
-    //insert into the cache
+void
+TrackerFrameAccessorPrivate::prefetchFrame(FrameAccessorCacheKey key)
+{
+    AbortableRenderInfoPtr abortInfo;
     {
-        QMutexLocker k(&_imp->cacheMutex);
-        _imp->cache.insert( std::make_pair(key, entry) );
+        QMutexLocker k(&cacheMutex);
+        abortInfo = prefetchAbortInfo;
+    }
+    FrameAccessorCacheEntry entry;
+    bool ok = renderFullFrame(key, abortInfo, &entry);
+
+    QMutexLocker k(&cacheMutex);
+    pendingFrames.erase(key);
+    if ( ok && !abortInfo->isAborted() ) {
+        insertInCache_locked(key, entry);
+    }
+    pendingCond.wakeAll();
+
+    appPTR->getAppTLS()->cleanupTLSForThread();
+}
+
+/*
+ * @brief Render the given frame in the background, unless it is available or a prefetch is already running
+ */
+void
+TrackerFrameAccessorPrivate::launchPrefetch(const FrameAccessorCacheKey& key)
+{
+    QMutexLocker k(&cacheMutex);
+
+    if ( destroying || prefetchFuture.isRunning() ||
+         ( cache.find(key) != cache.end() ) || ( pendingFrames.find(key) != pendingFrames.end() ) ) {
+        return;
+    }
+    pendingFrames.insert(key);
+    prefetchAbortInfo = AbortableRenderInfo::create(true, 0);
+    prefetchFuture = QtConcurrent::run( boost::bind(&TrackerFrameAccessorPrivate::prefetchFrame, this, key) );
+}
+
+/*
+ * @brief This is called by LibMV to retrieve an image either for reference or as search frame.
+ */
+mv::FrameAccessor::Key
+TrackerFrameAccessor::GetImage(int /*clip*/,
+                               int frame,
+                               mv::FrameAccessor::InputMode input_mode,
+                               int downscale,            // Downscale by 2^downscale.
+                               const mv::Region* region,     // Get full image if NULL.
+                               const mv::FrameAccessor::Transform* /*transform*/, // May be NULL.
+                               mv::FloatImage** destination)
+{
+    // Since libmv only uses MONO images for now we have only optimized for this case, remove and handle properly
+    // other case(s) when they get integrated into libmv.
+    assert(input_mode == mv::FrameAccessor::MONO);
+
+
+    FrameAccessorCacheKey key;
+    key.frame = frame;
+    key.mipMapLevel = downscale;
+    key.mode = input_mode;
+
+    /*
+       All tracks share the same full frames: get it from the cache or render it once
+     */
+    FrameAccessorCacheEntry fullFrame;
+    if ( !_imp->getFullFrame(key, &fullFrame) ) {
+        return (mv::FrameAccessor::Key)0;
     }
+
+    // While this frame is tracked, render the next one in the background
+    if (_imp->frameStep != 0) {
+        FrameAccessorCacheKey nextKey = key;
+        nextKey.frame = frame + _imp->frameStep;
+        nextKey.mipMapLevel = 0;
+        _imp->launchPrefetch(nextKey);
+    }
+
+    RectI roi = fullFrame.bounds;
+    if (region) {
+        RectI regionRoI;
+        convertLibMVRegionToRectI(*region, _imp->formatHeight, &regionRoI);
+        if ( !regionRoI.intersect(fullFrame.bounds, &roi) ) {
 #ifdef TRACE_LIB_MV
-    qDebug() << QThread::currentThread() << "FrameAccessor::GetImage():" << "Rendered frame" << frame << "with RoI x1="
-             << intersectedRoI.x1 << "y1=" << intersectedRoI.y1 << "x2=" << intersectedRoI.x2 << "y2=" << intersectedRoI.y2;
+            qDebug() << QThread::currentThread() << "FrameAccessor::GetImage():" << "RoI does not intersect the source image bounds (RoI x1="
+                     << regionRoI.x1 << "y1=" << regionRoI.y1 << "x2=" << regionRoI.x2 << "y2=" << regionRoI.y2 << ")";
 #endif
 
-    return (mv::FrameAccessor::Key)entry.image.get();
+            return (mv::FrameAccessor::Key)0;
+        }
+    }
+
+    MvFloatImagePtr image;
+    if (roi == fullFrame.bounds) {
+        image = fullFrame.image;
+    } else {
+        image.reset( new MvFloatImage( roi.height(), roi.width() ) );
+        cropLibMvFloatImage(*fullFrame.image, fullFrame.bounds, roi, *image);
+    }
+    // we ignore the transform parameter
+
+#ifdef TRACE_LIB_MV
+    qDebug() << QThread::currentThread() << "FrameAccessor::GetImage():" << "Got frame" << frame << "with RoI x1="
+             << roi.x1 << "y1=" << roi.y1 << "x2=" << roi.x2 << "y2=" << roi.y2;
+#endif
+
+    *destination = image.get();
+    {
+        QMutexLocker k(&_imp->cacheMutex);
+        _imp->lentImages.insert( std::make_pair(image.get(), image) );
+    }
+
+    return (mv::FrameAccessor::Key)image.get();
 } // TrackerFrameAccessor::GetImage
 
 void
@@ -472,15 +737,9 @@ TrackerFrameAccessor::ReleaseImage(Key key)
     MvFloatImage* imgKey = (MvFloatImage*)key;
     QMutexLocker k(&_imp->cacheMutex);
 
-    for (FrameAccessorCache::iterator it = _imp->cache.begin(); it != _imp->cache.end(); ++it) {
-        if (it->second.image.get() == imgKey) {
-            --it->second.referenceCount;
-            if (!it->second.referenceCount) {
-                _imp->cache.erase(it);
-
-                return;
-            }
-        }
+    std::multimap<MvFloatImage*, MvFloatImagePtr>::iterator found = _imp->lentImages.find(imgKey);
+    if ( found != _imp->lentImages.end() ) {
+        _imp->lentImages.erase(found);
     }
 }
 
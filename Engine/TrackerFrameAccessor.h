@@ -44,9 +44,14 @@ class TrackerFrameAccessor
 {
 public:
 
+    /**
+     * @brief Frames are shared by all tracks. While a frame is being tracked, the frame at frameStep
+     * from it is rendered in the background.
+     **/
     TrackerFrameAccessor(const TrackerContext* context,
                          bool enabledChannels[3],
-                         int formatHeight);
+                         int formatHeight,
+                         int frameStep);
 
     virtual ~TrackerFrameAccessor();
 
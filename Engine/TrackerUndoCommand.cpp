@@ -56,7 +56,7 @@ AddTrackCommand::undo()
         context->removeMarker(it->second);
     }
     context->endEditSelection(TrackerContext::eTrackSelectionInternal);
-    context->getNode()->getApp()->triggerAutoSave();
+    context->getNode()->getApp()->triggerAutoSave( context->getNode() );
 }
 
 void
@@ -80,7 +80,7 @@ AddTrackCommand::redo()
     }
 
     context->endEditSelection(TrackerContext::eTrackSelectionInternal);
-    context->getNode()->getApp()->triggerAutoSave();
+    context->getNode()->getApp()->triggerAutoSave( context->getNode() );
     _isFirstRedo = false;
 }
 
@@ -124,7 +124,7 @@ RemoveTracksCommand::undo()
         context->addTrackToSelection(it->track, TrackerContext::eTrackSelectionInternal);
     }
     context->endEditSelection(TrackerContext::eTrackSelectionInternal);
-    context->getNode()->getApp()->triggerAutoSave();
+    context->getNode()->getApp()->triggerAutoSave( context->getNode() );
 }
 
 void
@@ -146,7 +146,7 @@ RemoveTracksCommand::redo()
         context->addTrackToSelection(nextMarker, TrackerContext::eTrackSelectionInternal);
     }
     context->endEditSelection(TrackerContext::eTrackSelectionInternal);
-    context->getNode()->getApp()->triggerAutoSave();
+    context->getNode()->getApp()->triggerAutoSave( context->getNode() );
 }
 
 NATRON_NAMESPACE_EXIT;
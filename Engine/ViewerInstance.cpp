@@ -944,6 +944,7 @@ ViewerInstance::getViewerRoIAndTexture(const RectD& rod,
 
                 // The data will be valid as long as the cachedFrame shared pointer use_count is gt 1
                 it->cachedData = foundCachedEntry;
+                it->cachedData->raiseCachePriority(outArgs->params->isSequential ? eCacheEntryPriorityPlayback : eCacheEntryPriorityInteractive);
                 it->isCached = true;
                 it->ramBuffer = foundCachedEntry->data();
                 assert(it->ramBuffer);
@@ -1577,6 +1578,7 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
 
                         return eViewerRenderRetCodeFail;
                     }
+                    it->cachedData->raiseCachePriority(updateParams->isSequential ? eCacheEntryPriorityPlayback : eCacheEntryPriorityInteractive);
 
                     ///The entry has already been locked by the cache
                     if (!cached) {
@@ -491,6 +491,15 @@ enum StorageModeEnum
     eStorageModeGLTex //< will be allocated as an OpenGL texture
 };
 
+// Classes of cache entries, from the first to be evicted to the last
+enum CacheEntryPriorityEnum
+{
+    eCacheEntryPriorityAnalysis = 0, //< produced for an analysis, e.g: tracking
+    eCacheEntryPriorityBackground, //< produced by a render nobody is watching, e.g: previews or writers
+    eCacheEntryPriorityInteractive, //< produced for the viewer in response to a user interaction
+    eCacheEntryPriorityPlayback //< produced for the viewer during playback
+};
+
 enum OrientationEnum
 {
     eOrientationHorizontal = 0x1,
@@ -114,6 +114,15 @@ typedef OfxRangeD RangeD;
 
 #define kBgProcessServerCreatedShort "--bg_server_created"
 
+///these are used between a client and a NatronRenderer started with --render-server
+#define kRenderServerJobShort "-j"
+
+#define kRenderServerJobDoneShort "-d"
+
+#define kRenderServerJobFailedShort "-f"
+
+#define kRenderServerQuitShort "-q"
+
 //Increment this to wipe all disk cache structure and ensure that the user has a clean cache when starting the next version of Natron
 #define NATRON_CACHE_VERSION 4
 #define kNatronCacheVersionSettingsKey "NatronCacheVersionSettingsKey"
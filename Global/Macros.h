@@ -97,6 +97,10 @@ namespace NATRON_PYTHON_NAMESPACE { }
 #define NATRON_PROJECT_FILE_EXT "ntp"
 #define NATRON_PROJECT_FILE_MIME_TYPE "application/vnd.natron.project"
 #define NATRON_PROJECT_UNTITLED "Untitled." NATRON_PROJECT_FILE_EXT
+// Suffix appended to an auto-save file path to get the path of its incremental journal
+#define NATRON_AUTOSAVE_JOURNAL_SUFFIX ".journal"
+// Number of records the auto-save journal may hold before it gets compacted into the base auto-save
+#define NATRON_AUTOSAVE_JOURNAL_MAX_ENTRIES 100
 #define NATRON_CACHE_FILE_EXT "ntc"
 #define NATRON_LAYOUT_FILE_EXT "nl"
 #define NATRON_LAYOUT_FILE_MIME_TYPE "application/vnd.natron.layout"
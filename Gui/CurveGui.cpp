@@ -26,7 +26,10 @@
 
 #include <cmath>
 #include <algorithm> // min, max
+#include <limits>
+#include <map>
 #include <stdexcept>
+#include <vector>
 
 #include <QtCore/QThread>
 #include <QtCore/QObject>
@@ -115,24 +118,21 @@ CurveGui::nextPointForSegment(const double x, // < in curve coordinates
         assert(xClamped >= parametricXMin && xClamped <= parametricXMax);
     }
     {
+        KeyFrameSet::const_iterator itKeys = *lastUpperIt;
 
-        KeyFrameSet::const_iterator itKeys = keys.begin();
-
-        if ( *lastUpperIt != keys.end() ) {
-            // If we already have called this function before, start from the previously
-            // computed iterator to avoid n square complexity
-            itKeys = *lastUpperIt;
-        } else {
-            // Otherwise start from the begining
-            itKeys = keys.begin();
+        // If we already have called this function before, the upper keyframe is most likely the previously
+        // computed iterator, otherwise find it with a binary search so that dense curves do not cost n square
+        bool lastUpperStillValid = itKeys != keys.end() && itKeys->getTime() > xClamped;
+        if (lastUpperStillValid && itKeys != keys.begin()) {
+            KeyFrameSet::const_iterator prev = itKeys;
+            --prev;
+            lastUpperStillValid = prev->getTime() <= xClamped;
         }
-
-        for (; itKeys != keys.end(); ++itKeys) {
-            if (itKeys->getTime() > xClamped) {
-                upperIt = itKeys;
-                *lastUpperIt = upperIt;
-                break;
-            }
+        if (lastUpperStillValid) {
+            upperIt = itKeys;
+        } else {
+            upperIt = keys.upper_bound( KeyFrame(xClamped, 0.) );
+            *lastUpperIt = upperIt;
         }
     }
 
@@ -279,6 +279,50 @@ drawLineStrip(const std::vector<float>& vertices,
     GL_GPU::glEnd();
 }
 
+/**
+ * @brief Removes the vertices of a line strip that fall in the same pixel column, except the first and last ones
+ * and the extrema of the column, so that the strip looks the same on screen. This bounds the number of vertices
+ * to a few per pixel column for curves with more keyframes than pixels.
+ **/
+static void
+decimateLineStrip(const std::vector<float>& vertices,
+                  double xOrigin,
+                  double pixelWidth,
+                  std::vector<float>* decimated)
+{
+    std::size_t nVertices = vertices.size() / 2;
+
+    decimated->clear();
+    decimated->reserve( vertices.size() );
+
+    std::size_t i = 0;
+    while (i < nVertices) {
+        double column = std::floor( (vertices[2 * i] - xOrigin) / pixelWidth );
+        std::size_t iMin = i;
+        std::size_t iMax = i;
+        std::size_t j = i + 1;
+        while ( j < nVertices && std::floor( (vertices[2 * j] - xOrigin) / pixelWidth ) == column ) {
+            if (vertices[2 * j + 1] < vertices[2 * iMin + 1]) {
+                iMin = j;
+            }
+            if (vertices[2 * j + 1] > vertices[2 * iMax + 1]) {
+                iMax = j;
+            }
+            ++j;
+        }
+
+        // Keep the vertices in their original order
+        const std::size_t kept[4] = { i, std::min(iMin, iMax), std::max(iMin, iMax), j - 1 };
+        for (int k = 0; k < 4; ++k) {
+            if ( (k == 0) || (kept[k] != kept[k - 1]) ) {
+                decimated->push_back(vertices[2 * kept[k]]);
+                decimated->push_back(vertices[2 * kept[k] + 1]);
+            }
+        }
+        i = j;
+    }
+}
+
 void
 CurveGui::drawCurve(int curveIndex,
                     int curvesCount)
@@ -367,6 +411,16 @@ CurveGui::drawCurve(int curveIndex,
     QPointF topRight = _curveWidget->toZoomCoordinates(_curveWidget->width() - 1, 0);
     const QColor & curveColor = _selected ?  _curveWidget->getSelectedCurveColor() : _color;
 
+    // Each keyframe is a vertex of the strip: when they are denser than the pixels, only keep the ones which are visible
+    {
+        double pixelWidth = _curveWidget->toZoomCoordinates(1, 0).x() - _curveWidget->toZoomCoordinates(0, 0).x();
+        if ( (pixelWidth > 0) && ( (int)vertices.size() > 4 * widgetWidth ) ) {
+            std::vector<float> decimated;
+            decimateLineStrip(vertices, btmLeft.x(), pixelWidth, &decimated);
+            vertices.swap(decimated);
+        }
+    }
+
     {
         GLProtectAttrib<GL_GPU> a(GL_HINT_BIT | GL_ENABLE_BIT | GL_LINE_BIT | GL_COLOR_BUFFER_BIT | GL_POINT_BIT | GL_CURRENT_BIT);
 
@@ -449,29 +503,58 @@ CurveGui::drawCurve(int curveIndex,
             }
         }
 
-        //bool isCurveSelected = foundCurveSelected != selectedKeyFrames.end();
-
-        for (KeyFrameSet::const_iterator k = keyframes.begin(); k != keyframes.end(); ++k) {
-            const KeyFrame & key = (*k);
+        // The selected keyframes of this curve, by time
+        std::map<double, KeyPtr> selectedKeysByTime;
+        if ( foundCurveSelected != selectedKeyFrames.end() ) {
+            for (std::list<KeyPtr>::const_iterator it2 = foundCurveSelected->second.begin();
+                 it2 != foundCurveSelected->second.end(); ++it2) {
+                if ( (*it2)->curve.get() == this ) {
+                    selectedKeysByTime[(*it2)->key.getTime()] = *it2;
+                }
+            }
+        }
 
-            if ( ( key.getTime() < btmLeft.x() ) || ( key.getTime() > topRight.x() ) || ( key.getValue() < btmLeft.y() ) || ( key.getValue() > topRight.y() ) ) {
-                continue;
+        // Only visit the keyframes in the visible time range. The unselected ones are drawn in a single call,
+        // at most one per pixel, and the selected ones are drawn over them with their derivatives.
+        KeyFrameSet::const_iterator firstVisible = keyframes.lower_bound( KeyFrame(btmLeft.x(), 0.) );
+        KeyFrameSet::const_iterator lastVisible = keyframes.upper_bound( KeyFrame(topRight.x(), 0.) );
+        std::vector<float> keyVertices;
+        std::vector<KeyFrameSet::const_iterator> selectedVisibleKeys;
+        {
+            QPoint lastPixel( std::numeric_limits<int>::min(), std::numeric_limits<int>::min() );
+            for (KeyFrameSet::const_iterator k = firstVisible; k != lastVisible; ++k) {
+                if ( ( k->getValue() < btmLeft.y() ) || ( k->getValue() > topRight.y() ) ) {
+                    continue;
+                }
+                if ( selectedKeysByTime.find( k->getTime() ) != selectedKeysByTime.end() ) {
+                    selectedVisibleKeys.push_back(k);
+                    continue;
+                }
+                QPoint pixel = _curveWidget->toWidgetCoordinates( k->getTime(), k->getValue() ).toPoint();
+                if (pixel == lastPixel) {
+                    continue;
+                }
+                lastPixel = pixel;
+                keyVertices.push_back( (float)k->getTime() );
+                keyVertices.push_back( (float)k->getValue() );
             }
+        }
 
+        if ( !keyVertices.empty() ) {
             GL_GPU::glColor4f( _color.redF(), _color.greenF(), _color.blueF(), _color.alphaF() );
+            GL_GPU::glEnableClientState(GL_VERTEX_ARRAY);
+            GL_GPU::glVertexPointer(2, GL_FLOAT, 0, &keyVertices.front());
+            GL_GPU::glDrawArrays(GL_POINTS, 0, (GLsizei)(keyVertices.size() / 2));
+            GL_GPU::glDisableClientState(GL_VERTEX_ARRAY);
+            glCheckErrorIgnoreOSXBug(GL_GPU);
+        }
 
-            //if the key is selected change its color to white
-            KeyPtr isSelected;
-            if ( foundCurveSelected != selectedKeyFrames.end() ) {
-                for (std::list<KeyPtr>::const_iterator it2 = foundCurveSelected->second.begin();
-                     it2 != foundCurveSelected->second.end(); ++it2) {
-                    if ( ( (*it2)->key.getTime() == key.getTime() ) && ( (*it2)->curve.get() == this ) ) {
-                        isSelected = *it2;
-                        GL_GPU::glColor4f(1.f, 1.f, 1.f, 1.f);
-                        break;
-                    }
-                }
-            }
+        for (std::vector<KeyFrameSet::const_iterator>::const_iterator k = selectedVisibleKeys.begin(); k != selectedVisibleKeys.end(); ++k) {
+            const KeyFrame & key = (**k);
+
+            //the key is selected, draw it in white
+            const KeyPtr& isSelected = selectedKeysByTime[key.getTime()];
+            GL_GPU::glColor4f(1.f, 1.f, 1.f, 1.f);
 
             double x = key.getTime();
             double y = key.getValue();
@@ -536,7 +619,7 @@ CurveGui::drawCurve(int curveIndex,
                 GL_GPU::glEnd();
             } // if ( !isBezierGui && ( isSelected != selectedKeyFrames.end() ) && (key.getInterpolation() != eKeyframeTypeConstant) ) {
 
-        } // for (KeyFrameSet::const_iterator k = keyframes.begin(); k != keyframes.end(); ++k) {
+        } // for (std::vector<KeyFrameSet::const_iterator>::const_iterator k = selectedVisibleKeys.begin(); k != selectedVisibleKeys.end(); ++k) {
     } // GLProtectAttrib(GL_HINT_BIT | GL_ENABLE_BIT | GL_LINE_BIT | GL_COLOR_BUFFER_BIT | GL_POINT_BIT | GL_CURRENT_BIT);
 
     glCheckError(GL_GPU);
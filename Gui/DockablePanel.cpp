@@ -554,6 +554,7 @@ DockablePanel::onPageIndexChanged(int index)
     for (PagesMap::const_iterator it = pages.begin(); it != pages.end(); ++it) {
         if (it->second->tab == curTab) {
             setCurrentPage(it->second);
+            refreshPendingKnobsAfterTimeChange();
             EffectInstancePtr isEffect = toEffectInstance(_imp->_holder.lock());
             if ( isEffect && isEffect->getNode()->hasOverlay() ) {
                 isEffect->getApp()->redrawAllViewers();
@@ -562,6 +563,51 @@ DockablePanel::onPageIndexChanged(int index)
     }
 }
 
+void
+DockablePanel::refreshVisibleKnobsAfterTimeChange(bool isPlayback,
+                                                  double time)
+{
+    KnobHolderPtr holder = _imp->_holder.lock();
+
+    if (!holder) {
+        return;
+    }
+    if (!_imp->_tabWidget) {
+        // All knobs are visible when pages are turned off
+        if (!_imp->_minimized) {
+            holder->refreshAfterTimeChange(isPlayback, time);
+            _imp->_knobsTimeRefreshPending = false;
+
+            return;
+        }
+    }
+
+    KnobPagePtr visiblePage;
+    if (!_imp->_minimized) {
+        KnobPageGuiPtr curPage = getCurrentPage();
+        if (curPage) {
+            visiblePage = curPage->pageKnob.lock();
+        }
+    }
+    if ( holder->refreshAfterTimeChange(isPlayback, time, visiblePage) ) {
+        _imp->_knobsTimeRefreshPending = true;
+    }
+}
+
+void
+DockablePanel::refreshPendingKnobsAfterTimeChange()
+{
+    if (!_imp->_knobsTimeRefreshPending || _imp->_minimized) {
+        return;
+    }
+    KnobHolderPtr holder = _imp->_holder.lock();
+    if ( !holder || !getGui() ) {
+        return;
+    }
+    _imp->_knobsTimeRefreshPending = false;
+    holder->refreshAfterTimeChange( false, getGui()->getApp()->getTimeLine()->currentFrame() );
+}
+
 void
 DockablePanel::refreshCurrentPage()
 {
@@ -954,6 +1000,7 @@ DockablePanel::setClosedInternal(bool c)
     NodeSettingsPanel* nodePanel = dynamic_cast<NodeSettingsPanel*>(this);
     if (nodePanel) {
         nodePanel->getNode()->getNode()->getEffectInstance()->refreshAfterTimeChange( false, getGui()->getApp()->getTimeLine()->currentFrame() );
+        _imp->_knobsTimeRefreshPending = false;
 
 
         NodeGuiPtr nodeGui = nodePanel->getNode();
@@ -1009,6 +1056,7 @@ DockablePanel::minimizeOrMaximize(bool toggled)
         Q_EMIT maximized();
     }
     _imp->_rightContainer->setVisible(!_imp->_minimized);
+    refreshPendingKnobsAfterTimeChange();
     std::vector<QWidget*> _panels;
     for (int i = 0; i < _imp->_container->count(); ++i) {
         if ( QWidget * myItem = dynamic_cast <QWidget*>( _imp->_container->itemAt(i) ) ) {
@@ -130,6 +130,12 @@ public:
 
     void floatPanelInWindow(FloatingWidget* window);
 
+    /**
+     * @brief Refresh after a time change the knobs of the holder that are visible in the panel, that is the ones on
+     * the current page if the panel is not minimized. The others are refreshed when they become visible.
+     **/
+    void refreshVisibleKnobsAfterTimeChange(bool isPlayback, double time);
+
 public:
 
 
@@ -165,6 +171,8 @@ private:
     virtual void refreshCurrentPage() OVERRIDE FINAL;
     virtual void onPageLabelChanged(const KnobPageGuiPtr& page) OVERRIDE FINAL;
 
+    void refreshPendingKnobsAfterTimeChange();
+
 public Q_SLOTS:
 
     void onPageIndexChanged(int index);
@@ -94,6 +94,7 @@ DockablePanelPrivate::DockablePanelPrivate(DockablePanel* publicI,
     , _redoButton(NULL)
     , _restoreDefaultsButton(NULL)
     , _minimized(false)
+    , _knobsTimeRefreshPending(false)
     , _floating(false)
     , _floatingWidget(NULL)
     , _knobsVisibilityBeforeHideModif()
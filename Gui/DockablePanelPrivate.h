@@ -89,6 +89,7 @@ struct DockablePanelPrivate
     Button* _redoButton;
     Button* _restoreDefaultsButton;
     bool _minimized; /*!< true if the panel is minimized*/
+    bool _knobsTimeRefreshPending; /*!< true if some knobs were not refreshed after a time change because they were not visible*/
     bool _floating; /*!< true if the panel is floating*/
     FloatingWidget* _floatingWidget;
 
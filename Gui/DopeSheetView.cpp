@@ -25,8 +25,11 @@
 #include "DopeSheetView.h"
 
 #include <algorithm> // min, max
+#include <cmath>
 #include <limits>
+#include <map>
 #include <stdexcept>
+#include <vector>
 
 // Qt includes
 #include <QApplication>
@@ -217,11 +220,31 @@ public:
     void drawRange(const DSNodePtr &dsNode) const;
     void drawKeyframes(const DSNodePtr &dsNode) const;
 
-    void drawTexturedKeyframe(DopeSheetViewPrivate::KeyframeTexture textureType,
-                              bool drawTime,
-                              double time,
-                              const QColor& textColor,
-                              const RectD &rect) const;
+    /**
+     * @brief The keyframes glyphs using the same texture, accumulated while traversing the rows
+     * so that they are drawn with a single call.
+     **/
+    struct KeyframeGlyphsBatch
+    {
+        std::vector<float> vertices;
+        std::vector<float> texCoords;
+    };
+
+    void appendKeyframeGlyph(DopeSheetViewPrivate::KeyframeTexture textureType,
+                             const RectD &rect,
+                             std::vector<KeyframeGlyphsBatch>* batches) const;
+
+    void drawKeyframeGlyphs(const std::vector<KeyframeGlyphsBatch>& batches) const;
+
+    void drawKeyframeTime(double time,
+                          const QColor& textColor,
+                          const RectD &rect) const;
+
+    const KeyFrameSet& getCachedKeyFrames(const DSKnobPtr& dsKnob) const;
+
+    void invalidateCachedKeyFrames(const KnobIPtr& knob);
+
+    void connectKnobAnimationSignals(const KnobIPtr& knob, const KnobGuiPtr& knobGui) const;
 
     void drawGroupOverlay(const DSNodePtr &dsNode, const DSNodePtr &group) const;
 
@@ -284,6 +307,12 @@ public:
     // for textures
     GLuint kfTexturesIDs[KF_TEXTURES_COUNT];
 
+    // Copy of the keyframes of each knob dimension drawn, so that they are not copied out of the curve on each redraw.
+    // An entry is removed whenever the animation of its knob changes. Knobs are referenced weakly: a knob allocated
+    // at the address of a deleted one is a different key.
+    typedef std::map<std::pair<KnobIWPtr, int>, KeyFrameSet> KeyFramesCache;
+    mutable KeyFramesCache keyframesCache;
+
     // for navigating
     mutable QMutex zoomContextMutex;
     ZoomContext zoomContext;
@@ -329,6 +358,7 @@ DopeSheetViewPrivate::DopeSheetViewPrivate(DopeSheetView *qq)
     , font( new QFont(appFont, appFontSize) )
     , textRenderer()
     , kfTexturesIDs()
+    , keyframesCache()
     , zoomContext()
     , zoomOrPannedSinceLastFit(false)
     , selectionRect()
@@ -1249,10 +1279,85 @@ DopeSheetViewPrivate::drawRange(const DSNodePtr &dsNode) const
     }
 } // DopeSheetViewPrivate::drawRange
 
+const KeyFrameSet&
+DopeSheetViewPrivate::getCachedKeyFrames(const DSKnobPtr& dsKnob) const
+{
+    int dim = dsKnob->getDimension();
+    KnobIPtr knob = dsKnob->getInternalKnob();
+    std::pair<KnobIWPtr, int> key(knob, dim);
+    KeyFramesCache::iterator found = keyframesCache.find(key);
+
+    if ( found != keyframesCache.end() ) {
+        return found->second;
+    }
+
+    // Knobs may be added to the node after it was added to the dope sheet: make sure this one invalidates its entry
+    KnobGuiPtr knobGui = dsKnob->getKnobGui();
+    connectKnobAnimationSignals(knob, knobGui);
+
+    KeyFrameSet& keys = keyframesCache[key];
+    CurvePtr curve = knobGui->getCurve(ViewIdx(0), dim);
+    if (curve) {
+        keys = curve->getKeyFrames_mt_safe();
+    }
+
+    return keys;
+}
+
+void
+DopeSheetViewPrivate::invalidateCachedKeyFrames(const KnobIPtr& knob)
+{
+    KnobIWPtr knobW(knob);
+    KeyFramesCache::iterator it = keyframesCache.lower_bound( std::make_pair( knobW, std::numeric_limits<int>::min() ) );
+
+    // Weak pointers are ordered by owner: entries of the same knob are equivalent to knobW
+    while ( it != keyframesCache.end() && !(knobW < it->first.first) ) {
+        keyframesCache.erase(it++);
+    }
+}
+
+void
+DopeSheetViewPrivate::connectKnobAnimationSignals(const KnobIPtr& knob,
+                                                  const KnobGuiPtr& knobGui) const
+{
+    KnobSignalSlotHandler* handler = knob ? knob->getSignalSlotHandler().get() : 0;
+
+    if (!handler || !knobGui) {
+        return;
+    }
+    QObject::connect( handler, SIGNAL(keyFrameSet(double,ViewSpec,int,int,bool)),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+    QObject::connect( handler, SIGNAL(keyFrameRemoved(double,ViewSpec,int,int)),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+    QObject::connect( handler, SIGNAL(multipleKeyFramesSet(std::list<double>,ViewSpec,int,int)),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+    QObject::connect( handler, SIGNAL(multipleKeyFramesRemoved(std::list<double>,ViewSpec,int,int)),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+    QObject::connect( handler, SIGNAL(keyFrameMoved(ViewSpec,int,double,double)),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+    QObject::connect( handler, SIGNAL(keyFrameInterpolationChanged(double,ViewSpec,int)),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+    QObject::connect( handler, SIGNAL(redrawGuiCurve(int,ViewSpec,int)),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+    QObject::connect( handler, SIGNAL(animationRemoved(ViewSpec,int)),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+    // Keyframes edited by the user are only notified by the gui
+    QObject::connect( knobGui.get(), SIGNAL(keyFrameSet()),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+    QObject::connect( knobGui.get(), SIGNAL(keyFrameRemoved()),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+    QObject::connect( knobGui.get(), SIGNAL(keyInterpolationChanged()),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+    QObject::connect( knobGui.get(), SIGNAL(refreshDopeSheet()),
+                      q_ptr, SLOT(onKnobAnimationChanged()), Qt::UniqueConnection );
+}
+
 /**
  * @brief DopeSheetViewPrivate::drawKeyframes
  *
- *
+ * Only the keyframes in the visible time range are visited: they are found by a binary search
+ * in the cached keyframes of each knob. Glyphs falling in the same pixel column of a row with the same
+ * texture are drawn once, and all glyphs are batched by texture.
  */
 void
 DopeSheetViewPrivate::drawKeyframes(const DSNodePtr &dsNode) const
@@ -1277,6 +1382,11 @@ DopeSheetViewPrivate::drawKeyframes(const DSNodePtr &dsNode) const
         int hasSingleKfTimeSelected = model->getSelectionModel()->hasSingleKeyFrameTimeSelected(&kfTimeSelected);
         std::map<double, bool> nodeKeytimes;
         std::map<DSKnob *, std::map<double, bool> > knobsKeytimes;
+        std::vector<KeyframeGlyphsBatch> batches(KF_TEXTURES_COUNT);
+
+        // The time of the selected keyframe is drawn once per row, after the glyphs
+        std::vector<RectD> selectedTimeRects;
+        const double viewHeight = q_ptr->height();
 
         for (DSTreeItemKnobMap::const_iterator it = knobItems.begin();
              it != knobItems.end();
@@ -1295,66 +1405,61 @@ DopeSheetViewPrivate::drawKeyframes(const DSNodePtr &dsNode) const
                 continue;
             }
 
-            KeyFrameSet keyframes = dsKnob->getKnobGui()->getCurve(ViewIdx(0), dim)->getKeyFrames_mt_safe();
+            const KeyFrameSet& keyframes = getCachedKeyFrames(dsKnob);
 
-            for (KeyFrameSet::const_iterator kIt = keyframes.begin();
-                 kIt != keyframes.end();
-                 ++kIt) {
-                KeyFrame kf = (*kIt);
-                double keyTime = kf.getTime();
+            // Clip keyframes horizontally
+            KeyFrameSet::const_iterator first = keyframes.lower_bound( KeyFrame(zoomContext.left(), 0.) );
+            KeyFrameSet::const_iterator last = keyframes.upper_bound( KeyFrame(zoomContext.right(), 0.) );
+            if (first == last) {
+                continue;
+            }
 
-                // Clip keyframes horizontally //TODO Clip vertically too
-                if ( ( keyTime < zoomContext.left() ) || ( keyTime > zoomContext.right() ) ) {
-                    continue;
-                }
+            QRectF rowRect = hierarchyView->visualItemRect(knobTreeItem);
+            double rowCenterYWidget = rowRect.center().y();
 
-                double rowCenterYWidget = hierarchyView->visualItemRect( dsKnob->getTreeItem() ).center().y();
-                RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(keyTime, rowCenterYWidget);
-                bool kfSelected = model->getSelectionModel()->keyframeIsSelected(dsKnob, kf);
+            // Draw keyframe in the knob dim row only if it's visible, and clip it vertically
+            bool drawInDimRow = hierarchyView->itemIsVisibleFromOutside(knobTreeItem) &&
+                                rowRect.bottom() >= 0 && rowRect.top() <= viewHeight;
+            DSKnobPtr rootDSKnob = model->mapNameItemToDSKnob( knobTreeItem->parent() );
+            std::map<double, bool>* knobTimes = rootDSKnob ? &knobsKeytimes[rootDSKnob.get()] : 0;
+            int lastGlyphColumn = std::numeric_limits<int>::min();
+            DopeSheetViewPrivate::KeyframeTexture lastGlyphTexture = DopeSheetViewPrivate::kfTextureNone;
 
-                // Draw keyframe in the knob dim row only if it's visible
-                bool drawInDimRow = hierarchyView->itemIsVisibleFromOutside(knobTreeItem);
+            for (KeyFrameSet::const_iterator kIt = first; kIt != last; ++kIt) {
+                const KeyFrame& kf = (*kIt);
+                double keyTime = kf.getTime();
+                bool kfSelected = model->getSelectionModel()->keyframeIsSelected(dsKnob, kf);
 
                 if (drawInDimRow) {
+                    RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(keyTime, rowCenterYWidget);
                     DopeSheetViewPrivate::KeyframeTexture texType = kfTextureFromKeyframeType( kf.getInterpolation(),
                                                                                                kfSelected || selectionRect.intersects(zoomKfRect) );
+                    int column = (int)std::floor( zoomContext.toWidgetCoordinates(keyTime, 0).x() );
 
-                    if (texType != DopeSheetViewPrivate::kfTextureNone) {
-                        drawTexturedKeyframe(texType, hasSingleKfTimeSelected && kfSelected,
-                                             kfTimeSelected, selectionColor, zoomKfRect);
+                    if ( (texType != DopeSheetViewPrivate::kfTextureNone) &&
+                         ( (column != lastGlyphColumn) || (texType != lastGlyphTexture) ) ) {
+                        appendKeyframeGlyph(texType, zoomKfRect, &batches);
+                        lastGlyphColumn = column;
+                        lastGlyphTexture = texType;
+                    }
+                    if (hasSingleKfTimeSelected && kfSelected) {
+                        selectedTimeRects.push_back(zoomKfRect);
                     }
                 }
 
                 // Fill the knob times map
-                {
-                    DSKnobPtr rootDSKnob = model->mapNameItemToDSKnob( knobTreeItem->parent() );
-                    if (rootDSKnob) {
-                        assert(rootDSKnob);
-                        const std::map<double, bool>& map = knobsKeytimes[rootDSKnob.get()];
-                        bool knobTimeExists = ( map.find(keyTime) != map.end() );
-
-                        if (!knobTimeExists) {
-                            knobsKeytimes[rootDSKnob.get()][keyTime] = kfSelected;
-                        } else {
-                            bool knobTimeIsSelected = knobsKeytimes[rootDSKnob.get()][keyTime];
-
-                            if (!knobTimeIsSelected && kfSelected) {
-                                knobsKeytimes[rootDSKnob.get()][keyTime] = true;
-                            }
-                        }
+                if (knobTimes) {
+                    std::pair<std::map<double, bool>::iterator, bool> ret = knobTimes->insert( std::make_pair(keyTime, kfSelected) );
+                    if (!ret.second && kfSelected) {
+                        ret.first->second = true;
                     }
                 }
 
                 // Fill the node times map
-                bool nodeTimeExists = ( nodeKeytimes.find(keyTime) != nodeKeytimes.end() );
-
-                if (!nodeTimeExists) {
-                    nodeKeytimes[keyTime] = kfSelected;
-                } else {
-                    bool nodeTimeIsSelected = nodeKeytimes[keyTime];
-
-                    if (!nodeTimeIsSelected && kfSelected) {
-                        nodeKeytimes[keyTime] = true;
+                {
+                    std::pair<std::map<double, bool>::iterator, bool> ret = nodeKeytimes.insert( std::make_pair(keyTime, kfSelected) );
+                    if (!ret.second && kfSelected) {
+                        ret.first->second = true;
                     }
                 }
             }
@@ -1365,87 +1470,130 @@ DopeSheetViewPrivate::drawKeyframes(const DSNodePtr &dsNode) const
              it != knobsKeytimes.end();
              ++it) {
             QTreeWidgetItem *knobRootItem = (*it).first->getTreeItem();
-            std::map<double, bool> knobTimes = (*it).second;
+            bool drawInKnobRootRow = hierarchyView->itemIsVisibleFromOutside(knobRootItem);
+
+            if (!drawInKnobRootRow) {
+                continue;
+            }
+
+            const std::map<double, bool>& knobTimes = (*it).second;
+            double newCenterY = hierarchyView->visualItemRect(knobRootItem).center().y();
 
             for (std::map<double, bool>::const_iterator mIt = knobTimes.begin();
                  mIt != knobTimes.end();
                  ++mIt) {
                 double time = (*mIt).first;
                 bool drawSelected = (*mIt).second;
-                bool drawInKnobRootRow = hierarchyView->itemIsVisibleFromOutside(knobRootItem);
-
-                if (drawInKnobRootRow) {
-                    double newCenterY = hierarchyView->visualItemRect(knobRootItem).center().y();
-                    RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(time, newCenterY);
-                    DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
-                                                                        ? DopeSheetViewPrivate::kfTextureMasterSelected
-                                                                        : DopeSheetViewPrivate::kfTextureMaster;
+                RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(time, newCenterY);
+                DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
+                                                                    ? DopeSheetViewPrivate::kfTextureMasterSelected
+                                                                    : DopeSheetViewPrivate::kfTextureMaster;
 
-                    drawTexturedKeyframe(textureType, hasSingleKfTimeSelected && drawSelected,
-                                         kfTimeSelected, selectionColor, zoomKfRect);
+                appendKeyframeGlyph(textureType, zoomKfRect, &batches);
+                if (hasSingleKfTimeSelected && drawSelected) {
+                    selectedTimeRects.push_back(zoomKfRect);
                 }
             }
         }
 
         // Draw master keys in node section
-        for (std::map<double, bool>::const_iterator it = nodeKeytimes.begin();
-             it != nodeKeytimes.end();
-             ++it) {
-            double time = (*it).first;
-            bool drawSelected = (*it).second;
-            QTreeWidgetItem *nodeItem = dsNode->getTreeItem();
-            bool drawInNodeRow = hierarchyView->itemIsVisibleFromOutside(nodeItem);
+        QTreeWidgetItem *nodeItem = dsNode->getTreeItem();
+        bool drawInNodeRow = hierarchyView->itemIsVisibleFromOutside(nodeItem);
+
+        if (drawInNodeRow) {
+            double newCenterY = hierarchyView->visualItemRect(nodeItem).center().y();
 
-            if (drawInNodeRow) {
-                double newCenterY = hierarchyView->visualItemRect(nodeItem).center().y();
+            for (std::map<double, bool>::const_iterator it = nodeKeytimes.begin();
+                 it != nodeKeytimes.end();
+                 ++it) {
+                double time = (*it).first;
+                bool drawSelected = (*it).second;
                 RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(time, newCenterY);
                 DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
                                                                     ? DopeSheetViewPrivate::kfTextureMasterSelected
                                                                     : DopeSheetViewPrivate::kfTextureMaster;
 
-                drawTexturedKeyframe(textureType, hasSingleKfTimeSelected && drawSelected,
-                                     kfTimeSelected, selectionColor, zoomKfRect);
+                appendKeyframeGlyph(textureType, zoomKfRect, &batches);
+                if (hasSingleKfTimeSelected && drawSelected) {
+                    selectedTimeRects.push_back(zoomKfRect);
+                }
             }
         }
+
+        drawKeyframeGlyphs(batches);
+
+        for (std::vector<RectD>::const_iterator it = selectedTimeRects.begin(); it != selectedTimeRects.end(); ++it) {
+            drawKeyframeTime(kfTimeSelected, selectionColor, *it);
+        }
     }
 } // DopeSheetViewPrivate::drawKeyframes
 
 void
-DopeSheetViewPrivate::drawTexturedKeyframe(DopeSheetViewPrivate::KeyframeTexture textureType,
-                                           bool drawTime,
-                                           double time,
-                                           const QColor& textColor,
-                                           const RectD &rect) const
+DopeSheetViewPrivate::appendKeyframeGlyph(DopeSheetViewPrivate::KeyframeTexture textureType,
+                                          const RectD &rect,
+                                          std::vector<KeyframeGlyphsBatch>* batches) const
+{
+    assert(textureType >= 0 && textureType < (int)batches->size());
+    KeyframeGlyphsBatch& batch = (*batches)[textureType];
+    const float vertices[8] = {
+        (float)rect.left(), (float)rect.top(),
+        (float)rect.left(), (float)rect.bottom(),
+        (float)rect.right(), (float)rect.bottom(),
+        (float)rect.right(), (float)rect.top()
+    };
+    static const float texCoords[8] = {
+        0.f, 1.f,
+        0.f, 0.f,
+        1.f, 0.f,
+        1.f, 1.f
+    };
+
+    batch.vertices.insert(batch.vertices.end(), vertices, vertices + 8);
+    batch.texCoords.insert(batch.texCoords.end(), texCoords, texCoords + 8);
+}
+
+void
+DopeSheetViewPrivate::drawKeyframeGlyphs(const std::vector<KeyframeGlyphsBatch>& batches) const
 {
     GLProtectAttrib<GL_GPU> a(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_TRANSFORM_BIT);
     GLProtectMatrix<GL_GPU> pr(GL_MODELVIEW);
 
     GL_GPU::glEnable(GL_TEXTURE_2D);
-    GL_GPU::glBindTexture(GL_TEXTURE_2D, kfTexturesIDs[textureType]);
+    GL_GPU::glEnableClientState(GL_VERTEX_ARRAY);
+    GL_GPU::glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 
-    GL_GPU::glBegin(GL_POLYGON);
-    GL_GPU::glTexCoord2f(0.0f, 1.0f);
-    GL_GPU::glVertex2f( rect.left(), rect.top() );
-    GL_GPU::glTexCoord2f(0.0f, 0.0f);
-    GL_GPU::glVertex2f( rect.left(), rect.bottom() );
-    GL_GPU::glTexCoord2f(1.0f, 0.0f);
-    GL_GPU::glVertex2f( rect.right(), rect.bottom() );
-    GL_GPU::glTexCoord2f(1.0f, 1.0f);
-    GL_GPU::glVertex2f( rect.right(), rect.top() );
-    GL_GPU::glEnd();
+    for (std::size_t i = 0; i < batches.size(); ++i) {
+        const KeyframeGlyphsBatch& batch = batches[i];
+        if ( batch.vertices.empty() ) {
+            continue;
+        }
+        GL_GPU::glBindTexture(GL_TEXTURE_2D, kfTexturesIDs[i]);
+        GL_GPU::glVertexPointer(2, GL_FLOAT, 0, &batch.vertices.front());
+        GL_GPU::glTexCoordPointer(2, GL_FLOAT, 0, &batch.texCoords.front());
+        GL_GPU::glDrawArrays(GL_QUADS, 0, (GLsizei)(batch.vertices.size() / 2));
+    }
+
+    GL_GPU::glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    GL_GPU::glDisableClientState(GL_VERTEX_ARRAY);
 
     GL_GPU::glColor4f(1, 1, 1, 1);
     GL_GPU::glBindTexture(GL_TEXTURE_2D, 0);
 
     GL_GPU::glDisable(GL_TEXTURE_2D);
+    glCheckError(GL_GPU);
+}
 
-    if (drawTime) {
-        QString text = QString::number(time);
-        QPointF p = zoomContext.toWidgetCoordinates( rect.right(), rect.bottom() );
-        p.rx() += 3;
-        p = zoomContext.toZoomCoordinates( p.x(), p.y() );
-        renderText(p.x(), p.y(), text, textColor, *font);
-    }
+void
+DopeSheetViewPrivate::drawKeyframeTime(double time,
+                                       const QColor& textColor,
+                                       const RectD &rect) const
+{
+    QString text = QString::number(time);
+    QPointF p = zoomContext.toWidgetCoordinates( rect.right(), rect.bottom() );
+
+    p.rx() += 3;
+    p = zoomContext.toZoomCoordinates( p.x(), p.y() );
+    renderText(p.x(), p.y(), text, textColor, *font);
 }
 
 void
@@ -2979,6 +3127,15 @@ DopeSheetView::onNodeAdded(const DSNodePtr& dsNode)
     NodePtr node = dsNode->getInternalNode();
     bool mustComputeNodeRange = true;
 
+    // Keep the cached keyframes in sync with the curves, whatever the origin of the change
+    {
+        const std::list<std::pair<KnobIWPtr, KnobGuiPtr> > &knobs = dsNode->getNodeGui()->getKnobs();
+
+        for (std::list<std::pair<KnobIWPtr, KnobGuiPtr> >::const_iterator knobIt = knobs.begin(); knobIt != knobs.end(); ++knobIt) {
+            _imp->connectKnobAnimationSignals(knobIt->first.lock(), knobIt->second);
+        }
+    }
+
     if (nodeType == eDopeSheetItemTypeCommon) {
         if ( _imp->model->isPartOfGroup(dsNode) ) {
             const std::list<std::pair<KnobIWPtr, KnobGuiPtr> > &knobs = dsNode->getNodeGui()->getKnobs();
@@ -3067,6 +3224,9 @@ DopeSheetView::onNodeAboutToBeRemoved(const DSNodePtr& dsNode)
         _imp->nodeRanges.erase(toRemove);
     }
 
+    // The knobs of the node may be destroyed with it
+    _imp->keyframesCache.clear();
+
     _imp->computeSelectedKeysBRect();
 
     redraw();
@@ -3102,6 +3262,33 @@ DopeSheetView::onKeyframeChanged()
     }
 }
 
+void
+DopeSheetView::onKnobAnimationChanged()
+{
+    QObject *signalSender = sender();
+    KnobIPtr knob;
+
+    {
+        KnobSignalSlotHandler *knobHandler = qobject_cast<KnobSignalSlotHandler *>(signalSender);
+        if (knobHandler) {
+            knob = knobHandler->getKnob();
+        } else {
+            KnobGui *knobGui = qobject_cast<KnobGui *>(signalSender);
+            if (knobGui) {
+                knob = knobGui->getKnob();
+            }
+        }
+    }
+
+    if (!knob) {
+        // Unknown sender: forget everything
+        _imp->keyframesCache.clear();
+
+        return;
+    }
+    _imp->invalidateCachedKeyFrames(knob);
+}
+
 void
 DopeSheetView::onRangeNodeChanged(ViewSpec /*view*/,
                                   int /*dimension*/,
@@ -246,6 +246,14 @@ public Q_SLOTS:
      */
     void onKeyframeChanged();
 
+    /**
+     * @brief Forgets the cached keyframes of the knob that emitted the signal.
+     *
+     * This slot is automatically called whenever the animation of a knob
+     * of a node in the dope sheet changes.
+     */
+    void onKnobAnimationChanged();
+
     /**
      * @brief Updates the range of the node associated with the modified knob
      * that emitted the signal.
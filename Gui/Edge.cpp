@@ -253,6 +253,25 @@ Edge::setDefaultColor(const QColor & color)
     _imp->defaultColor = color;
 }
 
+QColor
+Edge::getColor() const
+{
+    QColor color;
+
+    if (_imp->useHighlight) {
+        color = Qt::green;
+    } else if (_imp->useRenderingColor) {
+        color = _imp->renderingColor;
+    } else {
+        color = _imp->defaultColor;
+        if (_imp->optional && !_imp->paintWithDash) {
+            color.setAlphaF(0.4);
+        }
+    }
+
+    return color;
+}
+
 bool
 Edge::isBendPointVisible() const
 {
@@ -726,19 +745,28 @@ Edge::paint(QPainter *painter,
             const QStyleOptionGraphicsItem * /*options*/,
             QWidget * /*parent*/)
 {
+    NodeGraph::LevelOfDetailEnum lod = NodeGraph::eLevelOfDetailFull;
+    NodeGuiPtr dst = _imp->dest.lock();
+    if (dst) {
+        NodeGraph* graph = dst->getDagGui();
+        if ( graph->isDoingNavigatorRender() ) {
+            return;
+        }
+        lod = graph->getLevelOfDetail();
+    }
+
+    // At the minimal level of detail, the graph draws all edges at once
+    if (lod == NodeGraph::eLevelOfDetailMinimal) {
+        return;
+    }
+
     bool antialias = appPTR->getCurrentSettings()->isNodeGraphAntiAliasingEnabled();
 
-    if (!antialias) {
+    if ( !antialias || (lod != NodeGraph::eLevelOfDetailFull) ) {
         painter->setRenderHint(QPainter::Antialiasing, false);
     }
 
     QPen myPen = pen();
-    NodeGuiPtr dst = _imp->dest.lock();
-    if (dst) {
-        if ( dst->getDagGui()->isDoingNavigatorRender() ) {
-            return;
-        }
-    }
 
     if (_imp->paintWithDash) {
         QVector<qreal> dashStyle;
@@ -766,6 +794,11 @@ Edge::paint(QPainter *painter,
 
     painter->drawLine( line() );
 
+    // Arrow heads and bend points are too small to be seen when zoomed out
+    if (lod != NodeGraph::eLevelOfDetailFull) {
+        return;
+    }
+
     myPen.setStyle(Qt::SolidLine);
     painter->setPen(myPen);
 
@@ -96,6 +96,11 @@ public:
 
     void setDefaultColor(const QColor & color);
 
+    /**
+     * @brief Returns the color with which the edge line is drawn, depending on its state
+     **/
+    QColor getColor() const;
+
     bool isBendPointVisible() const;
 
     bool areOptionalInputsAutoHidden() const;
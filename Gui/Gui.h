@@ -550,6 +550,9 @@ public Q_SLOTS:
 
     void onTimelineTimeAboutToChange();
 
+    ///Refresh the visible knobs at the last time the timeline was set to, once per event loop cycle
+    void refreshVisibleKnobsAfterTimelineTimeChange();
+
     void reloadStylesheet();
 
     ///Close the project instance, asking questions to the user and leaving the main window intact
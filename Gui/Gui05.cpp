@@ -220,7 +220,6 @@ Gui::createGroupGui(const NodePtr & group,
     }
 
     QGraphicsScene* scene = new QGraphicsScene(this);
-    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
 
     
     std::string newName = isGrp->getNode()->getFullyQualifiedName();
@@ -34,6 +34,7 @@
 
 #include <QtCore/QSettings>
 #include <QtCore/QFileInfo>
+#include <QtCore/QTimer>
 
 #if QT_VERSION >= 0x050000
 #include <QtGui/QScreen>
@@ -831,16 +832,18 @@ Gui::renderViewersAndRefreshKnobsAfterTimelineTimeChange(SequenceTime time,
     ProjectPtr project = getApp()->getProject();
     bool isPlayback = reason == eTimelineChangeReasonPlaybackSeek;
 
-    ///Refresh all visible knobs at the current time
+    ///Refresh all visible knobs at the current time. During playback the timeline may change several times
+    ///before the event loop gets back to us: only refresh once for the last time.
     if ( !getApp()->isGuiFrozen() ) {
-        std::list<DockablePanelI*> openedPanels = getApp()->getOpenedSettingsPanels();
-        for (std::list<DockablePanelI*>::const_iterator it = openedPanels.begin(); it != openedPanels.end(); ++it) {
-            NodeSettingsPanel* nodePanel = dynamic_cast<NodeSettingsPanel*>(*it);
-            if (nodePanel) {
-                NodePtr node = nodePanel->getNode()->getNode();
-                node->getEffectInstance()->refreshAfterTimeChange(isPlayback, time);
-            }
+        if (_imp->_knobsTimeRefreshScheduled) {
+            // If any of the coalesced changes is not a playback seek, knobs evaluated on time changes must be notified
+            _imp->_knobsTimeRefreshIsPlayback = _imp->_knobsTimeRefreshIsPlayback && isPlayback;
+        } else {
+            _imp->_knobsTimeRefreshScheduled = true;
+            _imp->_knobsTimeRefreshIsPlayback = isPlayback;
+            QTimer::singleShot( 0, this, SLOT(refreshVisibleKnobsAfterTimelineTimeChange()) );
         }
+        _imp->_knobsTimeRefreshTime = time;
     }
 
 
@@ -861,4 +864,25 @@ Gui::renderViewersAndRefreshKnobsAfterTimelineTimeChange(SequenceTime time,
     }
 } // Gui::renderViewersAndRefreshKnobsAfterTimelineTimeChange
 
+void
+Gui::refreshVisibleKnobsAfterTimelineTimeChange()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+    if (!_imp->_knobsTimeRefreshScheduled) {
+        return;
+    }
+    _imp->_knobsTimeRefreshScheduled = false;
+    if ( getApp()->isGuiFrozen() ) {
+        return;
+    }
+
+    std::list<DockablePanelI*> openedPanels = getApp()->getOpenedSettingsPanels();
+    for (std::list<DockablePanelI*>::const_iterator it = openedPanels.begin(); it != openedPanels.end(); ++it) {
+        NodeSettingsPanel* nodePanel = dynamic_cast<NodeSettingsPanel*>(*it);
+        if (nodePanel) {
+            nodePanel->refreshVisibleKnobsAfterTimeChange(_imp->_knobsTimeRefreshIsPlayback, _imp->_knobsTimeRefreshTime);
+        }
+    }
+}
+
 NATRON_NAMESPACE_EXIT;
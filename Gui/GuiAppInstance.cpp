@@ -422,7 +422,8 @@ GuiAppInstance::findAndTryLoadUntitledAutoSave()
         searchStr.append( QString::fromUtf8(NATRON_PROJECT_FILE_EXT) );
         searchStr.append( QString::fromUtf8(".autosave") );
         int suffixPos = entry.indexOf(searchStr);
-        if ( (suffixPos == -1) || entry.contains( QString::fromUtf8("RENDER_SAVE") ) ) {
+        if ( (suffixPos == -1) || entry.contains( QString::fromUtf8("RENDER_SAVE") ) ||
+             entry.endsWith( QString::fromUtf8(NATRON_AUTOSAVE_JOURNAL_SUFFIX) ) ) {
             continue;
         }
 
@@ -1097,9 +1097,10 @@ GuiApplicationManager::getKnobClipBoard(KnobClipBoardType *type,
 
 void
 GuiApplicationManager::appendTaskToPreviewThread(const NodeGuiPtr& node,
-                                                 double time)
+                                                 double time,
+                                                 bool isOnScreen)
 {
-    _imp->previewRenderThread.appendToQueue(node, time);
+    _imp->previewRenderThread.appendToQueue(node, time, isOnScreen);
 }
 
 int
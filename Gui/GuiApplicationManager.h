@@ -181,7 +181,7 @@ public:
 
     bool handleImageFileOpenRequest(const std::string& imageFile);
 
-    void appendTaskToPreviewThread(const NodeGuiPtr& node, double time);
+    void appendTaskToPreviewThread(const NodeGuiPtr& node, double time, bool isOnScreen);
 
     int getDocumentationServerPort();
 
@@ -44,6 +44,12 @@
 #define NATRON_PREVIEW_WIDTH 64
 #define NATRON_PREVIEW_HEIGHT 38
 
+// Maximum number of nodes waiting for their preview to be computed
+#define NATRON_PREVIEW_MAX_QUEUED_REQUESTS 64
+
+// Interval at which postponed previews are retried while the viewers are busy
+#define NATRON_PREVIEW_BUSY_RETRY_MS 100
+
 #define NODE_WIDTH 80
 #define NODE_HEIGHT 30
 
@@ -212,6 +212,9 @@ GuiPrivate::GuiPrivate(const GuiAppInstancePtr& app,
     , _maxPanelsOpenedSpinBox(0)
     , _isGUIFrozenMutex()
     , _isGUIFrozen(false)
+    , _knobsTimeRefreshScheduled(false)
+    , _knobsTimeRefreshTime(0)
+    , _knobsTimeRefreshIsPlayback(false)
     , menubar(0)
     , menuFile(0)
     , menuRecentFiles(0)
@@ -374,8 +377,6 @@ void
 GuiPrivate::createNodeGraphGui()
 {
     QGraphicsScene* scene = new QGraphicsScene(_gui);
-
-    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
     _nodeGraphArea = new NodeGraph(_gui, _appInstance.lock()->getProject(), kNodeGraphObjectName, scene, _gui);
     _nodeGraphArea->setLabel( tr("Node Graph").toStdString() );
     _nodeGraphArea->setVisible(false);
@@ -188,6 +188,11 @@ public:
     QMutex _isGUIFrozenMutex;
     bool _isGUIFrozen;
 
+    ///Timeline changes received during the same event loop cycle are coalesced in a single knobs refresh
+    bool _knobsTimeRefreshScheduled;
+    SequenceTime _knobsTimeRefreshTime;
+    bool _knobsTimeRefreshIsPlayback;
+
     ///The menu bar and all the menus
     QMenuBar *menubar;
     Menu *menuFile;
@@ -25,6 +25,7 @@
 #include "Histogram.h"
 
 #include <algorithm> // min, max
+#include <cmath>
 #include <stdexcept>
 
 #include <QHBoxLayout>
@@ -130,9 +131,15 @@ public:
         , sizeH()
         , showViewerPicker(false)
         , viewerPickerColor()
+        , scopeTexture(0)
     {
     }
 
+    bool isScopeMode() const
+    {
+        return mode == Histogram::eDisplayModeWaveform || mode == Histogram::eDisplayModeVectorscope;
+    }
+
     ImagePtr getHistogramImage(RectI* imagePortion) const;
 
 
@@ -152,6 +159,8 @@ public:
 
     void drawHistogramCPU();
 
+    void drawScopeCPU();
+
     //////////////////////////////////
     // data members
 
@@ -199,6 +208,9 @@ public:
     QSize sizeH;
     bool showViewerPicker;
     std::vector<double> viewerPickerColor;
+
+    // The texture in which the waveform and vectorscope are uploaded to be drawn
+    GLuint scopeTexture;
 };
 
 Histogram::Histogram(const std::string& scriptName,
@@ -297,6 +309,16 @@ Histogram::Histogram(const std::string& scriptName,
     bAction->setText( QString::fromUtf8("B") );
     bAction->setData(5);
     _imp->modeActions->addAction(bAction);
+
+    QAction* waveformAction = new QAction(_imp->modeMenu);
+    waveformAction->setText( tr("Waveform") );
+    waveformAction->setData(6);
+    _imp->modeActions->addAction(waveformAction);
+
+    QAction* vectorscopeAction = new QAction(_imp->modeMenu);
+    vectorscopeAction->setText( tr("Vectorscope") );
+    vectorscopeAction->setData(7);
+    _imp->modeActions->addAction(vectorscopeAction);
     QList<QAction*> actions = _imp->modeActions->actions();
     for (int i = 0; i < actions.size(); ++i) {
         _imp->modeMenu->addAction( actions.at(i) );
@@ -342,6 +364,9 @@ Histogram::~Histogram()
     // always running in the main thread
     assert( qApp && qApp->thread() == QThread::currentThread() );
     makeCurrent();
+    if (_imp->scopeTexture) {
+        GL_GPU::glDeleteTextures(1, &_imp->scopeTexture);
+    }
 }
 
 int
@@ -640,9 +665,16 @@ Histogram::paintGL()
         GL_GPU::glClear(GL_COLOR_BUFFER_BIT);
         glCheckErrorIgnoreOSXBug(GL_GPU);
 
-        _imp->drawScale();
-
-        if (_imp->hasImage) {
+        if ( _imp->isScopeMode() ) {
+            // Scopes are drawn to fill the widget, they have no scale nor picker
+            if (_imp->hasImage) {
+                _imp->drawScopeCPU();
+                _imp->drawWarnings();
+            } else {
+                _imp->drawMissingImage();
+            }
+        } else if (_imp->hasImage) {
+            _imp->drawScale();
             _imp->drawHistogramCPU();
             if (_imp->drawCoordinates) {
                 _imp->drawPicker();
@@ -654,6 +686,7 @@ Histogram::paintGL()
                 _imp->drawViewerPicker();
             }
         } else {
+            _imp->drawScale();
             _imp->drawMissingImage();
         }
 
@@ -795,12 +828,19 @@ HistogramPrivate::updatePicker(double x)
     // always running in the main thread
     assert( qApp && qApp->thread() == QThread::currentThread() );
 
-    xCoordinateStr = QString::fromUtf8("x=") + QString::number(x, 'f', 6);
-    double binSize = (vmax - vmin) / binsCount;
-    int index = (int)( (x - vmin) / binSize );
+    xCoordinateStr.clear();
     rValueStr.clear();
     gValueStr.clear();
     bValueStr.clear();
+    if ( isScopeMode() || (binsCount == 0) ) {
+        return;
+    }
+    xCoordinateStr = QString::fromUtf8("x=") + QString::number(x, 'f', 6);
+    double binSize = (vmax - vmin) / binsCount;
+    int index = (int)( (x - vmin) / binSize );
+    if ( (index < 0) || (index >= (int)binsCount) || (index >= (int)histogram1.size()) ) {
+        return;
+    }
     if (mode == Histogram::eDisplayModeRGB) {
         float r = histogram1.empty() ? 0 :  histogram1[index];
         float g = histogram2.empty() ? 0 :  histogram2[index];
@@ -988,6 +1028,11 @@ Histogram::computeHistogramAndRefresh(bool forceEvenIfNotVisible)
     QPointF topRight = _imp->zoomCtx.toZoomCoordinates(width() - 1, 0);
     double vmin = btmLeft.x();
     double vmax = topRight.x();
+    if ( _imp->isScopeMode() ) {
+        // Scopes are not zoomable: the waveform displays the values vertically
+        vmin = 0.;
+        vmax = 1.;
+    }
 
 
     RectI rect;
@@ -1464,6 +1509,103 @@ HistogramPrivate::drawHistogramCPU()
     glCheckError(GL_GPU);
 } // drawHistogramCPU
 
+void
+HistogramPrivate::drawScopeCPU()
+{
+    // always running in the main thread
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+    assert( QGLContext::currentContext() == widget->context() );
+
+    int texWidth, texHeight;
+    bool isRGB;
+    if (mode == Histogram::eDisplayModeWaveform) {
+        texWidth = (int)binsCount;
+        texHeight = NATRON_SCOPE_WAVEFORM_ROWS;
+        isRGB = true;
+    } else {
+        texWidth = texHeight = NATRON_SCOPE_VECTORSCOPE_SIZE;
+        isRGB = false;
+    }
+    const std::size_t nBins = (std::size_t)texWidth * texHeight;
+
+    // The result may be the one of another mode if the mode was just changed
+    if ( (nBins == 0) || (histogram1.size() != nBins) || ( isRGB && ( (histogram2.size() != nBins) || (histogram3.size() != nBins) ) ) ) {
+        return;
+    }
+
+    // Use a logarithmic scale so that bins with few pixels remain visible next to the densest ones
+    float maxCount = 0.f;
+    for (std::size_t i = 0; i < nBins; ++i) {
+        maxCount = std::max(maxCount, histogram1[i]);
+        if (isRGB) {
+            maxCount = std::max( maxCount, std::max(histogram2[i], histogram3[i]) );
+        }
+    }
+    if (maxCount <= 0.f) {
+        return;
+    }
+    const float norm = 1.f / std::log(1.f + maxCount);
+    std::vector<float> pixels(nBins * 3);
+    for (std::size_t i = 0; i < nBins; ++i) {
+        float* pix = &pixels[i * 3];
+        pix[0] = std::log(1.f + histogram1[i]) * norm;
+        if (isRGB) {
+            pix[1] = std::log(1.f + histogram2[i]) * norm;
+            pix[2] = std::log(1.f + histogram3[i]) * norm;
+        } else {
+            pix[1] = pix[2] = pix[0];
+        }
+    }
+
+    glCheckError(GL_GPU);
+    {
+        GLProtectAttrib<GL_GPU> a(GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT);
+        GLProtectMatrix<GL_GPU> p(GL_PROJECTION);
+        GL_GPU::glLoadIdentity();
+        GL_GPU::glOrtho(0, 1, 0, 1, 1, -1);
+        GLProtectMatrix<GL_GPU> m(GL_MODELVIEW);
+        GL_GPU::glLoadIdentity();
+
+        if (!scopeTexture) {
+            GL_GPU::glGenTextures(1, &scopeTexture);
+        }
+        GL_GPU::glEnable(GL_TEXTURE_2D);
+        GL_GPU::glBindTexture(GL_TEXTURE_2D, scopeTexture);
+        GL_GPU::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        GL_GPU::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        GL_GPU::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        GL_GPU::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        GL_GPU::glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, texWidth, texHeight, 0, GL_RGB, GL_FLOAT, &pixels.front() );
+
+        GL_GPU::glColor4f(1., 1., 1., 1.);
+        GL_GPU::glBegin(GL_POLYGON);
+        GL_GPU::glTexCoord2d(0, 0); GL_GPU::glVertex2d(0, 0);
+        GL_GPU::glTexCoord2d(1, 0); GL_GPU::glVertex2d(1, 0);
+        GL_GPU::glTexCoord2d(1, 1); GL_GPU::glVertex2d(1, 1);
+        GL_GPU::glTexCoord2d(0, 1); GL_GPU::glVertex2d(0, 1);
+        GL_GPU::glEnd();
+
+        GL_GPU::glBindTexture(GL_TEXTURE_2D, 0);
+        GL_GPU::glDisable(GL_TEXTURE_2D);
+
+        // Graticule: the neutral axis of the vectorscope, the 0 and 1 levels of the waveform
+        GL_GPU::glEnable(GL_BLEND);
+        GL_GPU::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GL_GPU::glColor4f(_scaleColor.redF(), _scaleColor.greenF(), _scaleColor.blueF(), 0.5);
+        GL_GPU::glBegin(GL_LINES);
+        if (isRGB) {
+            GL_GPU::glVertex2d(0, 0.001); GL_GPU::glVertex2d(1, 0.001);
+            GL_GPU::glVertex2d(0, 0.999); GL_GPU::glVertex2d(1, 0.999);
+        } else {
+            GL_GPU::glVertex2d(0.5, 0); GL_GPU::glVertex2d(0.5, 1);
+            GL_GPU::glVertex2d(0, 0.5); GL_GPU::glVertex2d(1, 0.5);
+        }
+        GL_GPU::glEnd();
+        glCheckErrorIgnoreOSXBug(GL_GPU);
+    }
+    glCheckError(GL_GPU);
+} // drawScopeCPU
+
 
 void
 Histogram::renderText(double x,
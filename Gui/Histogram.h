@@ -66,7 +66,9 @@ public:
         eDisplayModeY,
         eDisplayModeR,
         eDisplayModeG,
-        eDisplayModeB
+        eDisplayModeB,
+        eDisplayModeWaveform,
+        eDisplayModeVectorscope
     };
 
     Histogram(const std::string& scriptName,
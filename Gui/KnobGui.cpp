@@ -877,7 +877,7 @@ KnobGui::createDuplicateOnNode(const EffectInstancePtr& effect,
             groupNodeGui->ensurePanelCreated();
         }
     }
-    effect->getApp()->triggerAutoSave();
+    effect->getApp()->triggerAutoSave( effect->getNode() );
 
     return ret;
 } // KnobGui::createDuplicateOnNode
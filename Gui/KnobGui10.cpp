@@ -112,7 +112,8 @@ KnobGui::onUnlinkActionTriggered()
         }
         thisKnob->endChanges();
     }
-    getKnob()->getHolder()->getApp()->triggerAutoSave();
+    EffectInstancePtr isEffect = toEffectInstance( thisKnob->getHolder() );
+    thisKnob->getHolder()->getApp()->triggerAutoSave( isEffect ? isEffect->getNode() : NodePtr() );
 }
 
 void
@@ -354,7 +354,7 @@ KnobGui::linkTo(int dimension)
             thisKnob->endChanges();
 
 
-            thisKnob->getHolder()->getApp()->triggerAutoSave();
+            thisKnob->getHolder()->getApp()->triggerAutoSave( isEffect->getNode() );
         }
     }
 } // KnobGui::linkTo
@@ -33,6 +33,9 @@
 #include <algorithm> // min, max
 #include <stdexcept>
 
+#include <QPainter>
+#include <QtCore/QVector>
+
 #include "Engine/Backdrop.h"
 #include "Engine/CreateNodeArgs.h"
 #include "Engine/Dot.h"
@@ -100,6 +103,10 @@ NodeGraph::NodeGraph(Gui* gui,
     QObject::connect( &_imp->autoScrollTimer, SIGNAL(timeout()), this, SLOT(onAutoScrollTimerTriggered()) );
 
 
+    // Index the items of the scene so that only the visible ones are drawn and hit-tested
+    scene->setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+    scene->setBspTreeDepth(NATRON_NODEGRAPH_BSP_TREE_DEPTH);
+
     setMouseTracking(true);
     setCacheMode(CacheBackground);
     setViewportUpdateMode(QGraphicsView::BoundingRectViewportUpdate);
@@ -213,6 +220,80 @@ NodeGraph::isDoingNavigatorRender() const
     return _imp->isDoingPreviewRender;
 }
 
+NodeGraph::LevelOfDetailEnum
+NodeGraph::getLevelOfDetail() const
+{
+    return _imp->levelOfDetail;
+}
+
+void
+NodeGraph::refreshLevelOfDetail()
+{
+    double zoomFactor = transform().mapRect( QRectF(0, 0, 1, 1) ).width();
+    LevelOfDetailEnum lod;
+
+    if (zoomFactor < NATRON_NODEGRAPH_LOD_MINIMAL_ZOOM) {
+        lod = eLevelOfDetailMinimal;
+    } else if (zoomFactor < NATRON_NODEGRAPH_LOD_SIMPLIFIED_ZOOM) {
+        lod = eLevelOfDetailSimplified;
+    } else {
+        lod = eLevelOfDetailFull;
+    }
+    if (lod == _imp->levelOfDetail) {
+        return;
+    }
+    _imp->levelOfDetail = lod;
+
+    NodesGuiList nodes = getAllActiveNodes_mt_safe();
+    for (NodesGuiList::iterator it = nodes.begin(); it != nodes.end(); ++it) {
+        (*it)->refreshLevelOfDetail();
+    }
+}
+
+void
+NodeGraph::drawForeground(QPainter* painter,
+                          const QRectF& rect)
+{
+    QGraphicsView::drawForeground(painter, rect);
+
+    if (_imp->levelOfDetail != eLevelOfDetailMinimal) {
+        return;
+    }
+
+    // Edges do not draw themselves at this level of detail: draw all visible edges at once, with one call per color
+    std::map<QRgb, QVector<QLineF> > linesPerColor;
+    {
+        QMutexLocker l(&_imp->_nodesMutex);
+        for (NodesGuiList::const_iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
+            if ( !(*it)->isVisible() ) {
+                continue;
+            }
+            const std::vector<Edge*>& edges = (*it)->getInputsArrows();
+            for (std::vector<Edge*>::const_iterator it2 = edges.begin(); it2 != edges.end(); ++it2) {
+                if ( !(*it2)->isVisible() ) {
+                    continue;
+                }
+                const QLineF line( (*it2)->mapToScene( (*it2)->line().p1() ), (*it2)->mapToScene( (*it2)->line().p2() ) );
+                if ( !QRectF( line.p1(), line.p2() ).normalized().adjusted(-1, -1, 1, 1).intersects(rect) ) {
+                    continue;
+                }
+                linesPerColor[(*it2)->getColor().rgba()].push_back(line);
+            }
+        }
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    QPen pen;
+    pen.setCosmetic(true);
+    for (std::map<QRgb, QVector<QLineF> >::const_iterator it = linesPerColor.begin(); it != linesPerColor.end(); ++it) {
+        pen.setColor( QColor::fromRgba(it->first) );
+        painter->setPen(pen);
+        painter->drawLines(it->second);
+    }
+    painter->restore();
+} // NodeGraph::drawForeground
+
 const std::list< NodeGuiPtr > &
 NodeGraph::getSelectedNodes() const
 {
@@ -284,6 +365,8 @@ NodeGraph::paintEvent(QPaintEvent* e)
 
     bool drawLockedMode = !isGroupEditable || !groupEdited;
 
+    refreshLevelOfDetail();
+
     if (_imp->_refreshOverlays) {
         ///The visible portion of the scene, in scene coordinates
         QRectF visibleScene = visibleSceneRect();
@@ -383,6 +466,7 @@ NodeGraph::createNodeGui(const NodePtr & node, const CreateNodeArgs& args)
 
     // This will create the node GUI across all Natron
     node_ui->initialize(this, node, args);
+    node_ui->refreshLevelOfDetail();
 
 
     // For groups do it in GuiAppInstance::onGroupCreationFinished once all internal nodes
@@ -67,6 +67,21 @@ GCC_DIAG_SUGGEST_OVERRIDE_ON
 
 public:
 
+    /**
+     * @brief How much of the nodes and edges is drawn, depending on the zoom level of the graph.
+     **/
+    enum LevelOfDetailEnum
+    {
+        // Everything is drawn
+        eLevelOfDetailFull = 0,
+
+        // Labels, icons, previews and indicators of the nodes as well as arrow heads are hidden
+        eLevelOfDetailSimplified,
+
+        // Nodes are only drawn as their shape and all edges are drawn at once as plain lines
+        eLevelOfDetailMinimal
+    };
+
     explicit NodeGraph(Gui* gui,
                        const NodeCollectionPtr& group,
                        const std::string& scriptName,
@@ -177,8 +192,13 @@ public:
 
     bool isDoingNavigatorRender() const;
 
+    /**
+     * @brief Returns the level of detail at which the graph is currently drawn. It is updated when the zoom level changes.
+     **/
+    LevelOfDetailEnum getLevelOfDetail() const;
+
 public Q_SLOTS:
-    
+
     bool pasteClipboard(const QPointF& pos = QPointF(INT_MIN, INT_MIN));
 
     void deleteSelection();
@@ -277,6 +297,7 @@ private:
     virtual void mouseDoubleClickEvent(QMouseEvent* e) OVERRIDE FINAL;
     virtual void resizeEvent(QResizeEvent* e) OVERRIDE FINAL;
     virtual void paintEvent(QPaintEvent* e) OVERRIDE FINAL;
+    virtual void drawForeground(QPainter* painter, const QRectF& rect) OVERRIDE FINAL;
     virtual void wheelEvent(QWheelEvent* e) OVERRIDE FINAL;
     virtual void focusInEvent(QFocusEvent* e) OVERRIDE FINAL;
     virtual void focusOutEvent(QFocusEvent* e) OVERRIDE FINAL;
@@ -304,6 +325,8 @@ private:
 
     void wheelEventInternal(bool ctrlDown, double delta);
 
+    void refreshLevelOfDetail();
+
     boost::scoped_ptr<NodeGraphPrivate> _imp;
 };
 
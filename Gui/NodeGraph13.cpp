@@ -57,12 +57,8 @@ NodeGraph::isNearbyNavigator(const QPoint& widgetPos,
 
     if ( ( widgetPos.x() >= navTopLeftWidget.x() ) && ( widgetPos.x() < btmRightWidget.x() ) &&
          ( widgetPos.y() >= navTopLeftWidget.y() ) && ( widgetPos.y() <= btmRightWidget.y() ) ) {
-        ///The bbox of all nodes in the nodegraph
-        QRectF sceneR = _imp->calcNodesBoundingRect();
-
-        ///The visible portion of the nodegraph
-        QRectF viewRect = visibleSceneRect();
-        sceneR = sceneR.united(viewRect);
+        ///The portion of the scene displayed by the navigator
+        QRectF sceneR = _imp->getNavigatorSceneRect();
 
         ///Make sceneR and viewRect keep the same aspect ratio as the navigator
         double xScale = navWidth / sceneR.width();
@@ -62,32 +62,21 @@ NATRON_NAMESPACE_ENTER;
 QImage
 NodeGraph::getFullSceneScreenShot()
 {
-    _imp->isDoingPreviewRender = true;
-
-    // The bbox of all nodes in the nodegraph
-    QRectF sceneR = _imp->calcNodesBoundingRect();
+    // The portion of the scene shown in the navigator: it includes all nodes and the visible portion
+    QRectF sceneR = _imp->getNavigatorSceneRect();
 
     // The visible portion of the nodegraph
     QRectF viewRect = visibleSceneRect();
 
-    // Make sure the visible rect is included in the scene rect
-    sceneR = sceneR.united(viewRect);
-
     int navWidth = std::ceil(width() * NATRON_NAVIGATOR_BASE_WIDTH);
     int navHeight = std::ceil(height() * NATRON_NAVIGATOR_BASE_HEIGHT);
 
-    // Make sceneR and viewRect keep the same aspect ratio as the navigator
-    double xScale = navWidth / sceneR.width();
-    double yScale =  navHeight / sceneR.height();
-    double scaleFactor = std::max( 0.001, std::min(xScale, yScale) );
-    int sceneW_navPixelCoord = std::floor(sceneR.width() * scaleFactor);
-    int sceneH_navPixelCoord = std::floor(sceneR.height() * scaleFactor);
+    // Render the scene, or only the portions that changed since the last render
+    _imp->refreshNavigatorSceneImage(sceneR, navWidth, navHeight);
+    const double scaleFactor = _imp->navigatorScaleFactor;
 
-    // Render the scene in an image with the same aspect ratio  as the scene rect
-    QImage renderImage(sceneW_navPixelCoord, sceneH_navPixelCoord, QImage::Format_ARGB32_Premultiplied);
-
-    // Fill the background
-    renderImage.fill( QColor(71, 71, 71, 255) );
+    // Draw the highlight on a copy of the rendered scene
+    QImage renderImage = _imp->navigatorSceneImage.copy();
 
     // Offset the visible rect corner as an offset relative to the scene rect corner
     viewRect.setX( viewRect.x() - sceneR.x() );
@@ -104,17 +93,6 @@ NodeGraph::getFullSceneScreenShot()
     // Paint the visible portion with a highlight
     QPainter painter(&renderImage);
 
-    // Remove the overlays from the scene before rendering it
-    scene()->removeItem(_imp->_cacheSizeText);
-    scene()->removeItem(_imp->_navigator);
-
-    // Render into the QImage with downscaling
-    scene()->render(&painter, renderImage.rect(), sceneR, Qt::KeepAspectRatio);
-
-    // Add the overlays back
-    scene()->addItem(_imp->_navigator);
-    scene()->addItem(_imp->_cacheSizeText);
-
     // Fill the highlight with a semi transparent whitish grey
     painter.fillRect( viewRect_navCoordinates, QColor(200, 200, 200, 100) );
 
@@ -154,8 +132,6 @@ NodeGraph::getFullSceneScreenShot()
         }
     }
 
-    _imp->isDoingPreviewRender = false;
-
     return img;
 } // getFullSceneScreenShot
 
@@ -25,8 +25,14 @@
 #include "NodeGraphPrivate.h"
 #include "NodeGraph.h"
 
+#include <algorithm> // min, max
+#include <cmath>
 #include <stdexcept>
 
+#include <QGraphicsScene>
+#include <QPainter>
+
+#include "Engine/Hash64.h"
 #include "Engine/Node.h"
 #include "Engine/NodeGroup.h"
 #include "Engine/Project.h"
@@ -91,6 +97,11 @@ NodeGraphPrivate::NodeGraphPrivate(NodeGraph* p,
     , _hasMovedOnce(false)
     , lastSelectedViewer(0)
     , isDoingPreviewRender(false)
+    , levelOfDetail(NodeGraph::eLevelOfDetailFull)
+    , navigatorSceneImage()
+    , navigatorSceneRect()
+    , navigatorScaleFactor(1.)
+    , navigatorSceneHash(0)
     , autoScrollTimer()
 {
     appPTR->getIcon(NATRON_PIXMAP_LOCKED, &unlockIcon);
@@ -183,6 +194,108 @@ NodeGraphPrivate::calcNodesBoundingRect()
     return ret;
 }
 
+QRectF
+NodeGraphPrivate::getNavigatorSceneRect()
+{
+    QRectF sceneR = calcNodesBoundingRect();
+
+    sceneR = sceneR.united( _publicInterface->visibleSceneRect() );
+
+    if ( !navigatorSceneRect.isNull() && navigatorSceneRect.contains(sceneR) &&
+         ( sceneR.width() >= navigatorSceneRect.width() * 0.5 ) && ( sceneR.height() >= navigatorSceneRect.height() * 0.5 ) ) {
+        return navigatorSceneRect;
+    }
+
+    // Leave some room around so that small pans do not change the rect
+    double marginX = sceneR.width() * 0.1;
+    double marginY = sceneR.height() * 0.1;
+
+    return sceneR.adjusted(-marginX, -marginY, marginX, marginY);
+}
+
+static void
+appendRectToHash(const QRectF& rect,
+                 Hash64* hash)
+{
+    hash->append( rect.x() );
+    hash->append( rect.y() );
+    hash->append( rect.width() );
+    hash->append( rect.height() );
+}
+
+U64
+NodeGraphPrivate::computeNavigatorSceneHash()
+{
+    Hash64 hash;
+    QMutexLocker l(&_nodesMutex);
+
+    for (NodesGuiList::const_iterator it = _nodes.begin(); it != _nodes.end(); ++it) {
+        if ( !(*it)->isVisible() ) {
+            continue;
+        }
+        appendRectToHash( (*it)->sceneBoundingRect(), &hash );
+        hash.append( (U64)(*it)->getCurrentColor().rgba() );
+        hash.append( (*it)->getIsSelected() );
+
+        const std::vector<Edge*>& edges = (*it)->getInputsArrows();
+        for (std::vector<Edge*>::const_iterator it2 = edges.begin(); it2 != edges.end(); ++it2) {
+            if ( !(*it2)->isVisible() ) {
+                continue;
+            }
+            appendRectToHash( (*it2)->sceneBoundingRect(), &hash );
+            hash.append( (U64)(*it2)->getColor().rgba() );
+        }
+    }
+    hash.computeHash();
+
+    return hash.value();
+}
+
+void
+NodeGraphPrivate::refreshNavigatorSceneImage(const QRectF& sceneRect,
+                                             int navWidth,
+                                             int navHeight)
+{
+    double xScale = navWidth / sceneRect.width();
+    double yScale =  navHeight / sceneRect.height();
+    double scaleFactor = std::max( 0.001, std::min(xScale, yScale) );
+    int sceneW_navPixelCoord = std::floor(sceneRect.width() * scaleFactor);
+    int sceneH_navPixelCoord = std::floor(sceneRect.height() * scaleFactor);
+
+    // Computing the hash is linear in the number of nodes, which is much cheaper than rendering them
+    U64 sceneHash = computeNavigatorSceneHash();
+
+    if ( !navigatorSceneImage.isNull() && (sceneRect == navigatorSceneRect) && (sceneHash == navigatorSceneHash) &&
+         ( navigatorSceneImage.width() == sceneW_navPixelCoord ) && ( navigatorSceneImage.height() == sceneH_navPixelCoord ) ) {
+        return;
+    }
+
+    navigatorSceneImage = QImage(sceneW_navPixelCoord, sceneH_navPixelCoord, QImage::Format_ARGB32_Premultiplied);
+    navigatorSceneRect = sceneRect;
+    navigatorScaleFactor = scaleFactor;
+    navigatorSceneHash = sceneHash;
+
+    // Fill the background
+    navigatorSceneImage.fill( QColor(71, 71, 71, 255) );
+
+    // Remove the overlays from the scene before rendering it
+    QGraphicsScene* scene = _publicInterface->scene();
+    scene->removeItem(_cacheSizeText);
+    scene->removeItem(_navigator);
+
+    isDoingPreviewRender = true;
+    {
+        // Render into the QImage with downscaling
+        QPainter painter(&navigatorSceneImage);
+        scene->render(&painter, navigatorSceneImage.rect(), sceneRect, Qt::KeepAspectRatio);
+    }
+    isDoingPreviewRender = false;
+
+    // Add the overlays back
+    scene->addItem(_navigator);
+    scene->addItem(_cacheSizeText);
+} // NodeGraphPrivate::refreshNavigatorSceneImage
+
 void
 NodeGraphPrivate::resetAllClipboards()
 {
@@ -43,9 +43,12 @@ CLANG_DIAG_OFF(uninitialized)
 #include <QColor>
 #include <QPen>
 #include <QStyleOptionGraphicsItem>
+#include <QtCore/QRectF>
+#include <QImage>
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
+#include "Gui/NodeGraph.h"
 #include "Gui/NodeGraphUndoRedo.h" // NodeGuiPtr
 #include "Gui/GuiFwd.h"
 
@@ -62,6 +65,15 @@ CLANG_DIAG_ON(uninitialized)
 #define NATRON_SCENE_MAX 1e6
 #define NATRON_SCENE_MIN 0
 
+///Below these zoom factors, the graph is drawn with a lower level of detail (see NodeGraph::LevelOfDetailEnum)
+#define NATRON_NODEGRAPH_LOD_SIMPLIFIED_ZOOM 0.4
+#define NATRON_NODEGRAPH_LOD_MINIMAL_ZOOM 0.15
+
+///Depth of the BSP tree indexing the items of the scene. Qt picks a depth from the number of items
+///but rebuilds the whole tree each time it grows. The scene spans NATRON_SCENE_MAX in both directions: with
+///8 splits per axis a leaf covers ~4000 units, i.e. a few hundred nodes of a graph of ~10k items.
+#define NATRON_NODEGRAPH_BSP_TREE_DEPTH 16
+
 NATRON_NAMESPACE_ENTER;
 
 enum EventStateEnum
@@ -203,6 +215,16 @@ public:
 
     ///True when the graph is rendered from the getFullSceneScreenShot() function
     bool isDoingPreviewRender;
+
+    ///The current level of detail, refreshed when the zoom factor changes
+    NodeGraph::LevelOfDetailEnum levelOfDetail;
+
+    ///The scene rendered in the navigator, without the highlight of the visible portion.
+    ///It is only rendered again when the hash of the nodes and edges (see computeNavigatorSceneHash) changed.
+    QImage navigatorSceneImage;
+    QRectF navigatorSceneRect;
+    double navigatorScaleFactor;
+    U64 navigatorSceneHash;
     QTimer autoScrollTimer;
     QTimer refreshRenderStateTimer;
 
@@ -216,6 +238,25 @@ public:
 
     QRectF calcNodesBoundingRect();
 
+    /**
+     * @brief Returns the portion of the scene displayed by the navigator: it contains all nodes and the visible portion of the graph.
+     * The portion used for the last render of the navigator is kept as long as it contains them and is not much larger, so that
+     * panning does not require to render the navigator again.
+     **/
+    QRectF getNavigatorSceneRect();
+
+    /**
+     * @brief Returns a hash of what the navigator displays: the geometry, color and selection state of the nodes and their edges.
+     * This does not depend on the zoom factor nor on the overlays, so that panning and zooming do not change it.
+     **/
+    U64 computeNavigatorSceneHash();
+
+    /**
+     * @brief Renders the scene into navigatorSceneImage, unless the image is already up to date.
+     * @param sceneRect The portion of the scene that must be visible in the navigator
+     **/
+    void refreshNavigatorSceneImage(const QRectF& sceneRect, int navWidth, int navHeight);
+
     void copyNodesInternal(const NodesGuiList& selection, SERIALIZATION_NAMESPACE::NodeClipBoard & clipboard);
     void pasteNodesInternal(const SERIALIZATION_NAMESPACE::NodeSerializationList & clipboard, const QPointF& scenPos,
                             bool useUndoCommand,
@@ -1158,6 +1158,7 @@ RenameNodeUndoRedoCommand::undo()
     NodeGuiPtr node = _node.lock();
 
     node->setName(_oldName);
+    node->getNode()->getApp()->triggerAutoSave();
 }
 
 void
@@ -1166,6 +1167,7 @@ RenameNodeUndoRedoCommand::redo()
     NodeGuiPtr node = _node.lock();
 
     node->setName(_newName);
+    node->getNode()->getApp()->triggerAutoSave();
 }
 
 static void
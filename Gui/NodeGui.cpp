@@ -199,6 +199,7 @@ NodeGui::NodeGui(QGraphicsItem *parent)
     , _availableViewsIndicator()
     , _passThroughIndicator()
     , identityStateSet(false)
+    , _previewPendingLowDetail(false)
 {
 }
 
@@ -675,6 +676,7 @@ NodeGui::ensurePreviewCreated()
         _previewPixmap->setTransform(QTransform::fromScale( appPTR->getLogicalDPIXRATIO(), appPTR->getLogicalDPIYRATIO() ), true);
         _previewPixmap->setPixmap(prev_pixmap);
         _previewPixmap->setZValue(getBaseDepth() + 1);
+        refreshLevelOfDetail();
     }
     QSize size = getSize();
     int w, h;
@@ -875,6 +877,8 @@ NodeGui::resize(int width,
 
     QRectF bbox(topLeft.x(), topLeft.y(), width, height);
 
+    // The bounding rect of the node is the one of _boundingBox: notify the scene index that it changes
+    prepareGeometryChange();
     _boundingBox->setRect(bbox);
 
     int iconSize = TO_DPIY(NATRON_PLUGIN_ICON_SIZE);
@@ -1238,11 +1242,18 @@ NodeGui::updatePreviewImage(double time)
             return;
         }
 
+        // The preview is not drawn when the graph is zoomed out, it is computed when zooming in again
+        if ( _graph && (_graph->getLevelOfDetail() != NodeGraph::eLevelOfDetailFull) ) {
+            _previewPendingLowDetail = true;
+
+            return;
+        }
+
         ensurePreviewCreated();
 
         NodeGuiPtr thisShared = shared_from_this();
         assert(thisShared);
-        appPTR->appendTaskToPreviewThread(thisShared, time);
+        appPTR->appendTaskToPreviewThread( thisShared, time, isOnScreen() );
     }
 }
 
@@ -1263,10 +1274,20 @@ NodeGui::forceComputePreview(double time)
         ensurePreviewCreated();
         NodeGuiPtr thisShared = shared_from_this();
         assert(thisShared);
-        appPTR->appendTaskToPreviewThread(thisShared, time);
+        appPTR->appendTaskToPreviewThread( thisShared, time, isOnScreen() );
     }
 }
 
+bool
+NodeGui::isOnScreen() const
+{
+    if ( !_graph || !_graph->isVisible() || !isVisible() ) {
+        return false;
+    }
+
+    return _graph->visibleSceneRect().intersects( sceneBoundingRect() );
+}
+
 void
 NodeGui::onPreviewImageComputed()
 {
@@ -2699,6 +2720,34 @@ NodeGuiIndicator::refreshPosition(const QPointF & center)
 
 ///////////////////
 
+void
+NodeGui::refreshLevelOfDetail()
+{
+    if (!_graph) {
+        return;
+    }
+    NodeGraph::LevelOfDetailEnum lod = _graph->getLevelOfDetail();
+    QList<QGraphicsItem*> children = childItems();
+    for (QList<QGraphicsItem*>::iterator it = children.begin(); it != children.end(); ++it) {
+        bool drawn;
+        if ( (lod == NodeGraph::eLevelOfDetailFull) || (*it == _boundingBox) ) {
+            drawn = true;
+        } else if (lod == NodeGraph::eLevelOfDetailSimplified) {
+            // Only keep the shapes
+            drawn = *it == _nameFrame || *it == _pluginIconFrame || *it == _stateIndicator ||
+                    *it == _disabledTopLeftBtmRight || *it == _disabledBtmLeftTopRight;
+        } else {
+            drawn = false;
+        }
+        (*it)->setOpacity(drawn ? 1. : 0.);
+    }
+
+    if ( (lod == NodeGraph::eLevelOfDetailFull) && _previewPendingLowDetail ) {
+        _previewPendingLowDetail = false;
+        updatePreviewImage( _graph->getGui()->getApp()->getTimeLine()->currentFrame() );
+    }
+}
+
 void
 NodeGui::setScale_natron(double scale)
 {
@@ -3028,7 +3077,7 @@ NodeGui::onSwitchInputActionTriggered()
             (*it)->renderCurrentFrame(true);
         }
         update();
-        node->getApp()->triggerAutoSave();
+        node->getApp()->triggerAutoSave(node);
     }
 }
 
@@ -3944,6 +3993,7 @@ NodeGui::onNodePresetsChanged()
                     _pluginIcon->setZValue(getBaseDepth() + 1);
                     _pluginIconFrame = new QGraphicsRectItem(this);
                     _pluginIconFrame->setZValue( getBaseDepth() );
+                    refreshLevelOfDetail();
 
                     int r, g, b;
                     appPTR->getCurrentSettings()->getPluginIconFrameColor(&r, &g, &b);
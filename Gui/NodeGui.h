@@ -289,6 +289,12 @@ public:
     ///same as setScale() but also scales the arrows
     void setScale_natron(double scale);
 
+    /**
+     * @brief Hides the details of the node that are not drawn at the current level of detail of the graph.
+     * They are hidden with their opacity so that it does not interfere with their visibility.
+     **/
+    void refreshLevelOfDetail();
+
     void removeHighlightOnAllEdges();
 
     QColor getCurrentColor() const;
@@ -548,6 +554,11 @@ private:
 
     void ensurePreviewCreated();
 
+    /**
+     * @brief Returns true if the node is in the visible portion of the node graph, its preview is then computed first
+     **/
+    bool isOnScreen() const;
+
     void setAboveItem(QGraphicsItem* item);
 
     void populateMenu();
@@ -655,6 +666,9 @@ private:
     boost::shared_ptr<NodeGuiIndicator> _passThroughIndicator;
     NodeWPtr _identityInput;
     bool identityStateSet;
+
+    ///True if the preview was not refreshed because it was not drawn at the level of detail of the graph
+    bool _previewPendingLowDetail;
     boost::shared_ptr<NATRON_PYTHON_NAMESPACE::PyModalDialog> _activeNodeCustomModalDialog;
 };
 
@@ -25,6 +25,7 @@
 #include "PreviewThread.h"
 
 #include <list>
+#include <map>
 #include <vector>
 #include <stdexcept>
 #include <cstring> // for std::memcpy, std::memset
@@ -32,26 +33,27 @@
 #include <QtCore/QWaitCondition>
 #include <QtCore/QMutex>
 
+#include "Gui/Gui.h"
 #include "Gui/GuiDefines.h"
+#include "Gui/NodeGraph.h"
 #include "Gui/NodeGui.h"
+#include "Gui/ViewerTab.h"
 
 #include "Engine/Node.h"
+#include "Engine/OutputSchedulerThread.h"
+#include "Engine/ViewerNode.h"
 
 
 NATRON_NAMESPACE_ENTER;
 
+// The requests are in PreviewThreadPrivate, a task only wakes up the thread to process the most urgent request
 class ComputePreviewRequest
     : public GenericThreadStartArgs
 {
 public:
 
-    double time;
-    NodeGuiWPtr node;
-
     ComputePreviewRequest()
         : GenericThreadStartArgs()
-        , time(0)
-        , node()
     {}
 
     virtual ~ComputePreviewRequest()
@@ -59,16 +61,130 @@ public:
     }
 };
 
+struct PendingPreviewRequest
+{
+    NodeGuiWPtr node;
+    double time;
+    bool isOnScreen;
+
+    // Increasing with the requests, used to serve requests of the same priority in order
+    U64 age;
+
+    // True if the preview could not be made from the cache while the viewers were busy
+    bool postponed;
+};
+
+typedef std::map<const NodeGui*, PendingPreviewRequest> PendingPreviewRequestsMap;
+
 struct PreviewThreadPrivate
 {
     std::vector<unsigned int> data;
 
+    // Protects requests and requestsAge
+    QMutex requestsMutex;
+    PendingPreviewRequestsMap requests;
+    U64 requestsAge;
+
     PreviewThreadPrivate()
         : data( NATRON_PREVIEW_HEIGHT * NATRON_PREVIEW_WIDTH * sizeof(unsigned int) )
+        , requestsMutex()
+        , requests()
+        , requestsAge(0)
+    {
+    }
+
+    /**
+     * @brief Removes the most urgent request from the queue: postponed requests come last, then
+     * on-screen nodes are served first, then the oldest request.
+     **/
+    bool popNextRequest(PendingPreviewRequest* request);
+
+    /**
+     * @brief Puts back in the queue a request that could not be served while the viewers are busy.
+     * Returns true if all requests in the queue are postponed.
+     **/
+    bool postponeRequest(const NodeGui* node, const PendingPreviewRequest& request);
+
+    static bool isRequestMoreUrgent(const PendingPreviewRequest& a, const PendingPreviewRequest& b)
     {
+        if (a.postponed != b.postponed) {
+            return !a.postponed;
+        }
+        if (a.isOnScreen != b.isOnScreen) {
+            return a.isOnScreen;
+        }
+
+        return a.age < b.age;
     }
+
+    static bool areViewersBusy(const NodeGuiPtr& node);
 };
 
+bool
+PreviewThreadPrivate::popNextRequest(PendingPreviewRequest* request)
+{
+    QMutexLocker k(&requestsMutex);
+
+    if ( requests.empty() ) {
+        return false;
+    }
+    PendingPreviewRequestsMap::iterator found = requests.begin();
+    for (PendingPreviewRequestsMap::iterator it = requests.begin(); it != requests.end(); ++it) {
+        if ( isRequestMoreUrgent(it->second, found->second) ) {
+            found = it;
+        }
+    }
+    *request = found->second;
+    requests.erase(found);
+
+    return true;
+}
+
+bool
+PreviewThreadPrivate::postponeRequest(const NodeGui* node,
+                                      const PendingPreviewRequest& request)
+{
+    QMutexLocker k(&requestsMutex);
+
+    // If the node was requested again in the meantime, the new request replaces this one
+    std::pair<PendingPreviewRequestsMap::iterator, bool> ret = requests.insert( std::make_pair(node, request) );
+    if (ret.second) {
+        ret.first->second.postponed = true;
+    }
+
+    for (PendingPreviewRequestsMap::const_iterator it = requests.begin(); it != requests.end(); ++it) {
+        if (!it->second.postponed) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+PreviewThreadPrivate::areViewersBusy(const NodeGuiPtr& node)
+{
+    NodeGraph* graph = node->getDagGui();
+    Gui* gui = graph ? graph->getGui() : 0;
+
+    if (!gui) {
+        return false;
+    }
+    std::list<ViewerTab*> viewers = gui->getViewersList_mt_safe();
+    for (std::list<ViewerTab*>::const_iterator it = viewers.begin(); it != viewers.end(); ++it) {
+        ViewerNodePtr viewer = (*it)->getInternalNode();
+        if (!viewer) {
+            continue;
+        }
+        RenderEnginePtr engine = viewer->getRenderEngine();
+        if ( engine && ( engine->isDoingSequentialRender() || engine->hasThreadsWorking() ) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 PreviewThread::PreviewThread()
     : GenericSchedulerThread()
     , _imp( new PreviewThreadPrivate() )
@@ -84,25 +200,62 @@ PreviewThread::~PreviewThread()
 
 void
 PreviewThread::appendToQueue(const NodeGuiPtr& node,
-                             double time)
+                             double time,
+                             bool isOnScreen)
 {
-    boost::shared_ptr<ComputePreviewRequest> r( new ComputePreviewRequest() );
+    {
+        QMutexLocker k(&_imp->requestsMutex);
+        PendingPreviewRequestsMap::iterator found = _imp->requests.find( node.get() );
+        if ( found != _imp->requests.end() ) {
+            // The thread is already going to process this node, only update the request
+            found->second.time = time;
+            found->second.isOnScreen = found->second.isOnScreen || isOnScreen;
+            found->second.postponed = false;
+
+            return;
+        }
+
+        if ( (int)_imp->requests.size() >= NATRON_PREVIEW_MAX_QUEUED_REQUESTS ) {
+            // Drop the least urgent request, unless it is more urgent than this one
+            PendingPreviewRequestsMap::iterator leastUrgent = _imp->requests.begin();
+            for (PendingPreviewRequestsMap::iterator it = _imp->requests.begin(); it != _imp->requests.end(); ++it) {
+                if ( PreviewThreadPrivate::isRequestMoreUrgent(leastUrgent->second, it->second) ) {
+                    leastUrgent = it;
+                }
+            }
+            if (leastUrgent->second.isOnScreen && !isOnScreen) {
+                return;
+            }
+            _imp->requests.erase(leastUrgent);
+        }
 
-    r->node = node;
-    r->time = time;
-    startTask(r);
+        PendingPreviewRequest& r = _imp->requests[node.get()];
+        r.node = node;
+        r.time = time;
+        r.isOnScreen = isOnScreen;
+        r.age = _imp->requestsAge++;
+        r.postponed = false;
+    }
+
+    startTask( boost::shared_ptr<ComputePreviewRequest>( new ComputePreviewRequest() ) );
 }
 
 GenericSchedulerThread::ThreadStateEnum
-PreviewThread::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
+PreviewThread::threadLoopOnce(const ThreadStartArgsPtr& /*inArgs*/)
 {
-    boost::shared_ptr<ComputePreviewRequest> args = boost::dynamic_pointer_cast<ComputePreviewRequest>(inArgs);
-
-    assert(args);
+    PendingPreviewRequest request;
 
+    if ( !_imp->popNextRequest(&request) ) {
+        // The request was merged with another one or dropped
+        return eThreadStateActive;
+    }
 
-    NodeGuiPtr node = args->node.lock();
+    NodeGuiPtr node = request.node.lock();
     if (node) {
+        // Do not compete with the viewers for the render threads and the cache: while they are busy
+        // only make the previews that can be taken from the cache
+        bool canRender = !PreviewThreadPrivate::areViewersBusy(node);
+
         ///Mark this thread as running
         appPTR->fetchAndAddNRunningThreads(1);
 
@@ -118,19 +271,34 @@ PreviewThread::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
             _imp->data[i] = qRgba(0, 0, 0, 255);
         }
 #endif
+        bool postponed = false;
         NodePtr internalNode = node->getNode();
         if (internalNode) {
-            bool ok = internalNode->makePreviewImage( args->time, &w, &h, &_imp->data.front() );
-            Q_UNUSED(ok);
-            node->copyPreviewImageBuffer(_imp->data, w, h);
+            bool ok = internalNode->makePreviewImage( request.time, &w, &h, &_imp->data.front(), canRender );
+            if (!ok && !canRender) {
+                postponed = true;
+            } else {
+                node->copyPreviewImageBuffer(_imp->data, w, h);
+            }
         }
 
         ///Unmark this thread as running
         appPTR->fetchAndAddNRunningThreads(-1);
+
+        if (postponed) {
+            if ( _imp->postponeRequest(node.get(), request) ) {
+                // Nothing else to do until the viewers are idle
+                ThreadStateEnum state = resolveState();
+                if (state != eThreadStateActive) {
+                    return state;
+                }
+                QThread::msleep(NATRON_PREVIEW_BUSY_RETRY_MS);
+            }
+            startTask( boost::shared_ptr<ComputePreviewRequest>( new ComputePreviewRequest() ) );
+        }
     }
 
     return eThreadStateActive;
 } // PreviewThread::threadLoopOnce
 
 NATRON_NAMESPACE_EXIT;
-
@@ -41,6 +41,14 @@
 
 NATRON_NAMESPACE_ENTER;
 
+/**
+ * @brief Computes the previews of the nodes in the node graph.
+ * There is at most 1 pending request per node: requesting the preview of a node which is already in the queue only
+ * updates the time of the request. Nodes visible on screen are served first and the queue is bounded by
+ * NATRON_PREVIEW_MAX_QUEUED_REQUESTS, off-screen requests being dropped first.
+ * Previews are made from the images already in the cache when possible. While a viewer is rendering or during playback,
+ * previews that would require a render are postponed so that they do not compete with the viewer.
+ **/
 struct PreviewThreadPrivate;
 class PreviewThread
     : public GenericSchedulerThread
@@ -50,7 +58,7 @@ public:
 
     virtual ~PreviewThread();
 
-    void appendToQueue(const NodeGuiPtr& node, double time);
+    void appendToQueue(const NodeGuiPtr& node, double time, bool isOnScreen);
 
 private:
 
@@ -3248,7 +3248,7 @@ RotoGui::moveSelectedCpsWithKeyArrows(int x,
                                                           (double)y * pixelScale.second, time) );
         _imp->computeSelectedCpsBBOX();
         _imp->context->evaluateChange();
-        _imp->node->getNode()->getApp()->triggerAutoSave();
+        _imp->node->getNode()->getApp()->triggerAutoSave( _imp->node->getNode() );
         _imp->viewerTab->onRotoEvaluatedForThisViewer();
     }
 }
@@ -3260,7 +3260,7 @@ RotoGui::evaluate(bool redraw)
         _imp->viewer->redraw();
     }
     _imp->context->evaluateChange();
-    _imp->node->getNode()->getApp()->triggerAutoSave();
+    _imp->node->getNode()->getApp()->triggerAutoSave( _imp->node->getNode() );
     _imp->viewerTab->onRotoEvaluatedForThisViewer();
 }
 
@@ -3268,7 +3268,7 @@ void
 RotoGui::autoSaveAndRedraw()
 {
     _imp->viewer->redraw();
-    _imp->node->getNode()->getApp()->triggerAutoSave();
+    _imp->node->getNode()->getApp()->triggerAutoSave( _imp->node->getNode() );
 }
 
 bool
@@ -3290,7 +3290,7 @@ RotoGui::penUp(double time,
 
     if (_imp->evaluateOnPenUp) {
         _imp->context->evaluateChange();
-        node->getApp()->triggerAutoSave();
+        node->getApp()->triggerAutoSave(node);
 
         //sync other viewers linked to this roto
         _imp->viewerTab->onRotoEvaluatedForThisViewer();
@@ -3798,7 +3798,7 @@ RotoGui::keyUp(double time,
 
     if (_imp->evaluateOnKeyUp) {
         _imp->context->evaluateChange();
-        _imp->node->getNode()->getApp()->triggerAutoSave();
+        _imp->node->getNode()->getApp()->triggerAutoSave( _imp->node->getNode() );
         _imp->viewerTab->onRotoEvaluatedForThisViewer();
         _imp->evaluateOnKeyUp = false;
     }
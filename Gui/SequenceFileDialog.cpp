@@ -1075,8 +1075,8 @@ SequenceFileDialog::updateView(const QString &directory)
     /*update the view to show the newly loaded directory*/
     setRootIndex(index);
 
-    /*clearselection*/
-    _view->selectionModel()->clear();
+    /*the selection was cleared by setDirectory: what was selected while the directory was
+       being loaded is kept*/
 }
 
 bool
@@ -2820,24 +2820,19 @@ SequenceFileDialog::fileSequencesFromFilesList(const QStringList & files,
                                                const QStringList & supportedFileTypes)
 {
     std::vector< SequenceParsing::SequenceFromFilesPtr > sequences;
+    FileSequencesIndex sequencesIndex(false);
 
     for (int i = 0; i < files.size(); ++i) {
-        SequenceParsing::FileNameContent fileContent( files.at(i).toStdString() );
+        std::string filePath = files.at(i).toStdString();
+        SequenceParsing::FileNameContent fileContent(filePath);
 
         if ( !supportedFileTypes.contains(QString::fromUtf8( fileContent.getExtension().c_str() ), Qt::CaseInsensitive) ) {
             continue;
         }
 
-        bool found = false;
-
-        for (U32 j = 0; j < sequences.size(); ++j) {
-            if ( sequences[j]->tryInsertFile(fileContent) ) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            SequenceParsing::SequenceFromFilesPtr seq( new SequenceParsing::SequenceFromFiles(fileContent, false) );
+        bool created;
+        SequenceParsing::SequenceFromFilesPtr seq = sequencesIndex.insertFile(filePath, fileContent, true, &created);
+        if (created) {
             sequences.push_back(seq);
         }
     }
@@ -166,6 +166,69 @@ ProjectSerialization::decode(const YAML::Node& node)
 
 } // ProjectSerialization::decode
 
+void
+ProjectJournalEntrySerialization::encode(YAML::Emitter& em) const
+{
+    em << YAML::BeginMap;
+    em << YAML::Key << "Op" << YAML::Value << (_type == eJournalEntryTypeNodeRemoved ? "Remove" : "Set");
+    em << YAML::Key << "ScriptName" << YAML::Value << _nodeScriptName;
+    em << YAML::Key << "Frame" << YAML::Value << _timelineCurrent;
+    if (_type == eJournalEntryTypeNodeChanged && _node) {
+        em << YAML::Key << "Node" << YAML::Value;
+        _node->encode(em);
+    }
+    em << YAML::EndMap;
+} // ProjectJournalEntrySerialization::encode
+
+void
+ProjectJournalEntrySerialization::decode(const YAML::Node& node)
+{
+    std::string op = node["Op"].as<std::string>();
+    if (op == "Remove") {
+        _type = eJournalEntryTypeNodeRemoved;
+    } else if (op == "Set") {
+        _type = eJournalEntryTypeNodeChanged;
+    } else {
+        throw YAML::InvalidNode();
+    }
+    _nodeScriptName = node["ScriptName"].as<std::string>();
+    if (node["Frame"]) {
+        _timelineCurrent = node["Frame"].as<int>();
+    }
+    if (_type == eJournalEntryTypeNodeChanged) {
+        if (!node["Node"]) {
+            throw YAML::InvalidNode();
+        }
+        _node.reset(new NodeSerialization);
+        _node->decode(node["Node"]);
+    }
+} // ProjectJournalEntrySerialization::decode
+
+void
+ProjectJournalEntrySerialization::applyTo(ProjectSerialization* project) const
+{
+    assert(project);
+    NodeSerializationList::iterator found = project->_nodes.end();
+    for (NodeSerializationList::iterator it = project->_nodes.begin(); it != project->_nodes.end(); ++it) {
+        if ((*it)->_nodeScriptName == _nodeScriptName) {
+            found = it;
+            break;
+        }
+    }
+    if (_type == eJournalEntryTypeNodeRemoved) {
+        if (found != project->_nodes.end()) {
+            project->_nodes.erase(found);
+        }
+    } else if (_node) {
+        if (found != project->_nodes.end()) {
+            *found = _node;
+        } else {
+            project->_nodes.push_back(_node);
+        }
+    }
+    project->_timelineCurrent = _timelineCurrent;
+} // ProjectJournalEntrySerialization::applyTo
+
 SERIALIZATION_NAMESPACE_EXIT
 
 
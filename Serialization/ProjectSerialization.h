@@ -135,6 +135,61 @@ public:
     void serialize(Archive & ar, const unsigned int version);
 };
 
+/**
+ * @brief A record of the auto-save journal. The journal is appended after the base auto-save file
+ * each time an incremental auto-save occurs: each record holds the full serialization of a top-level node
+ * (including its children if it is a group) that was modified since the base file was written, or
+ * marks that the top-level node no longer exists.
+ **/
+class ProjectJournalEntrySerialization : public SerializationObjectBase
+{
+public:
+
+    enum JournalEntryTypeEnum
+    {
+        // The node was created or modified, _node holds its new state
+        eJournalEntryTypeNodeChanged,
+
+        // The node was removed from the project
+        eJournalEntryTypeNodeRemoved
+    };
+
+    JournalEntryTypeEnum _type;
+
+    // The script-name of the top-level node this record applies to
+    std::string _nodeScriptName;
+
+    // The node state, only valid for eJournalEntryTypeNodeChanged
+    NodeSerializationPtr _node;
+
+    // The timeline current frame at the time the record was written
+    int _timelineCurrent;
+
+    ProjectJournalEntrySerialization()
+    : SerializationObjectBase()
+    , _type(eJournalEntryTypeNodeChanged)
+    , _nodeScriptName()
+    , _node()
+    , _timelineCurrent(0)
+    {
+
+    }
+
+    virtual ~ProjectJournalEntrySerialization()
+    {
+    }
+
+    virtual void encode(YAML::Emitter& em) const OVERRIDE;
+
+    virtual void decode(const YAML::Node& node) OVERRIDE;
+
+    /**
+     * @brief Apply this record onto the given project serialization: the node with the same script-name
+     * is replaced (or appended if it did not exist) or removed.
+     **/
+    void applyTo(ProjectSerialization* project) const;
+};
+
 SERIALIZATION_NAMESPACE_EXIT;
 
 #endif // PROJECTSERIALIZATION_H
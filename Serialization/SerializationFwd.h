@@ -45,6 +45,7 @@ class NodeClipBoard;
 class NodeSerialization;
 class NodePresetSerialization;
 class ProjectBeingLoadedInfo;
+class ProjectJournalEntrySerialization;
 class ProjectSerialization;
 class PythonPanelSerialization;
 class RectDSerialization;
@@ -0,0 +1,163 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <gtest/gtest.h>
+
+#include "Engine/ActionsCache.h"
+#include "Engine/NodeMetadata.h"
+#include "Engine/RectD.h"
+#include "Engine/ViewIdx.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+bool
+hasRoD(ActionsCache& cache,
+       U64 hash,
+       double time)
+{
+    RectD rod;
+
+    return cache.getRoDResult(hash, time, ViewIdx(0), 0, &rod);
+}
+
+// The memory used by the results of a single hash with a single RoD
+std::size_t
+getSingleRoDSizeInBytes()
+{
+    ActionsCache cache(NATRON_ACTIONS_CACHE_MAX_SIZE_BYTES);
+
+    cache.setRoDResult( 1, 0., ViewIdx(0), 0, RectD(0, 0, 10, 10) );
+
+    return cache.getSizeInBytes();
+}
+}
+
+TEST(ActionsCache, HitsOnlyTheSameHashTimeAndView)
+{
+    ActionsCache cache(NATRON_ACTIONS_CACHE_MAX_SIZE_BYTES);
+
+    cache.setRoDResult( 1, 10., ViewIdx(0), 0, RectD(0, 0, 100, 50) );
+
+    RectD rod;
+    ASSERT_TRUE( cache.getRoDResult(1, 10., ViewIdx(0), 0, &rod) );
+    EXPECT_EQ(100., rod.x2);
+    EXPECT_EQ(50., rod.y2);
+    EXPECT_FALSE( cache.getRoDResult(2, 10., ViewIdx(0), 0, &rod) );
+    EXPECT_FALSE( cache.getRoDResult(1, 11., ViewIdx(0), 0, &rod) );
+    EXPECT_FALSE( cache.getRoDResult(1, 10., ViewIdx(1), 0, &rod) );
+    EXPECT_FALSE( cache.getRoDResult(1, 10., ViewIdx(0), 1, &rod) );
+
+    // Replacing a result does not grow the cache
+    std::size_t size = cache.getSizeInBytes();
+    cache.setRoDResult( 1, 10., ViewIdx(0), 0, RectD(0, 0, 200, 50) );
+    EXPECT_EQ( size, cache.getSizeInBytes() );
+    ASSERT_TRUE( cache.getRoDResult(1, 10., ViewIdx(0), 0, &rod) );
+    EXPECT_EQ(200., rod.x2);
+
+    cache.clearAll();
+    EXPECT_EQ( (std::size_t)0, cache.getSizeInBytes() );
+    EXPECT_FALSE( cache.getRoDResult(1, 10., ViewIdx(0), 0, &rod) );
+}
+
+// When the budget is exceeded, the results of the least recently used hash are evicted first
+TEST(ActionsCache, EvictsLeastRecentlyUsedHashWithinBudget)
+{
+    const std::size_t singleSize = getSingleRoDSizeInBytes();
+    ActionsCache cache(3 * singleSize);
+
+    cache.setRoDResult( 1, 0., ViewIdx(0), 0, RectD(0, 0, 10, 10) );
+    cache.setRoDResult( 2, 0., ViewIdx(0), 0, RectD(0, 0, 10, 10) );
+    cache.setRoDResult( 3, 0., ViewIdx(0), 0, RectD(0, 0, 10, 10) );
+    EXPECT_EQ( (std::size_t)3, cache.getNumHashes() );
+
+    // A hit makes hash 1 the most recently used
+    EXPECT_TRUE( hasRoD(cache, 1, 0.) );
+
+    cache.setRoDResult( 4, 0., ViewIdx(0), 0, RectD(0, 0, 10, 10) );
+    EXPECT_EQ( (std::size_t)3, cache.getNumHashes() );
+    EXPECT_LE( cache.getSizeInBytes(), 3 * singleSize );
+    EXPECT_FALSE( hasRoD(cache, 2, 0.) );
+    EXPECT_TRUE( hasRoD(cache, 1, 0.) );
+    EXPECT_TRUE( hasRoD(cache, 3, 0.) );
+    EXPECT_TRUE( hasRoD(cache, 4, 0.) );
+
+    // More results for the same hash take budget from the other hashes
+    cache.setRoDResult( 4, 1., ViewIdx(0), 0, RectD(0, 0, 10, 10) );
+    cache.setRoDResult( 4, 2., ViewIdx(0), 0, RectD(0, 0, 10, 10) );
+    EXPECT_LE( cache.getSizeInBytes(), 3 * singleSize );
+    EXPECT_FALSE( hasRoD(cache, 1, 0.) );
+    EXPECT_TRUE( hasRoD(cache, 4, 2.) );
+}
+
+// The results of the most recently used hash are kept even if they do not fit in the budget
+TEST(ActionsCache, KeepsMostRecentlyUsedHash)
+{
+    ActionsCache cache(0);
+
+    cache.setRoDResult( 1, 0., ViewIdx(0), 0, RectD(0, 0, 10, 10) );
+    EXPECT_TRUE( hasRoD(cache, 1, 0.) );
+    cache.setRoDResult( 2, 0., ViewIdx(0), 0, RectD(0, 0, 10, 10) );
+    EXPECT_TRUE( hasRoD(cache, 2, 0.) );
+    EXPECT_FALSE( hasRoD(cache, 1, 0.) );
+    EXPECT_EQ( (std::size_t)1, cache.getNumHashes() );
+}
+
+TEST(ActionsCache, MetadataIsPerViewAndInputs)
+{
+    ActionsCache cache(NATRON_ACTIONS_CACHE_MAX_SIZE_BYTES);
+    MetadataActionInputs inputs;
+
+    inputs.connected.push_back(true);
+    inputs.metadatas.push_back( NodeMetadata() );
+
+    NodeMetadata left;
+    left.setOutputFrameRate(25.);
+    cache.setMetadataResult(1, ViewIdx(0), inputs, eStatusOK, left);
+
+    StatusEnum stat;
+    NodeMetadata metadata;
+    ASSERT_TRUE( cache.getMetadataResult(1, ViewIdx(0), inputs, &stat, &metadata) );
+    EXPECT_EQ(eStatusOK, stat);
+    EXPECT_EQ(25., metadata.getOutputFrameRate());
+    EXPECT_FALSE( cache.getMetadataResult(1, ViewIdx(1), inputs, &stat, &metadata) );
+
+    NodeMetadata right;
+    right.setOutputFrameRate(30.);
+    cache.setMetadataResult(1, ViewIdx(1), inputs, eStatusOK, right);
+    ASSERT_TRUE( cache.getMetadataResult(1, ViewIdx(1), inputs, &stat, &metadata) );
+    EXPECT_EQ(30., metadata.getOutputFrameRate());
+    ASSERT_TRUE( cache.getMetadataResult(1, ViewIdx(0), inputs, &stat, &metadata) );
+    EXPECT_EQ(25., metadata.getOutputFrameRate());
+
+    // A change of the inputs metadata is a miss
+    MetadataActionInputs changedInputs = inputs;
+    changedInputs.metadatas[0].setOutputFrameRate(50.);
+    EXPECT_FALSE( cache.getMetadataResult(1, ViewIdx(0), changedInputs, &stat, &metadata) );
+    changedInputs = inputs;
+    changedInputs.connected[0] = false;
+    EXPECT_FALSE( cache.getMetadataResult(1, ViewIdx(0), changedInputs, &stat, &metadata) );
+}
@@ -0,0 +1,254 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <map>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "Engine/Cache.h"
+#include "Engine/CacheEvictionPolicy.h"
+#include "Engine/LRUHashTable.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+struct TestEntry
+{
+    CacheEntryPriorityEnum priority;
+    double time;
+    double renderCost;
+    U64 bytes;
+
+    TestEntry(CacheEntryPriorityEnum priority,
+              double time,
+              double renderCost,
+              U64 bytes)
+        : priority(priority)
+        , time(time)
+        , renderCost(renderCost)
+        , bytes(bytes)
+    {
+    }
+};
+
+typedef boost::shared_ptr<TestEntry> TestEntryPtr;
+typedef BoostLRUHashTable<U64, TestEntryPtr> TestContainer;
+
+// Scores the entries like Cache::getEvictionScore, with a single time range pinned
+struct TestEvictionScore
+{
+    std::map<const void*, std::pair<double, double> > pinnedTimeRanges;
+    bool evictPinned;
+
+    TestEvictionScore(double pinnedFirst,
+                      double pinnedLast,
+                      bool evictPinned)
+        : pinnedTimeRanges()
+        , evictPinned(evictPinned)
+    {
+        pinnedTimeRanges[this] = std::make_pair(pinnedFirst, pinnedLast);
+    }
+
+    double operator()(const TestEntryPtr& entry,
+                      int rank) const
+    {
+        bool pinned = CacheEvictionPolicy::isPinned( entry->priority, CacheEvictionPolicy::isTimePinned(entry->time, pinnedTimeRanges) );
+
+        return CacheEvictionPolicy::getEvictionScore(entry->priority, eCacheEntryPriorityPlayback, pinned, evictPinned,
+                                                     entry->renderCost, entry->bytes, rank);
+    }
+};
+
+TestEntryPtr
+evictLowestScore(TestContainer& container,
+                 double pinnedFirst,
+                 double pinnedLast)
+{
+    return CacheEvictionPolicy::evictLowestScore<U64, TestEntryPtr>(container, TestEvictionScore(pinnedFirst, pinnedLast, false),
+                                                                    TestEvictionScore(pinnedFirst, pinnedLast, true), true).second;
+}
+}
+
+TEST(CacheEvictionPolicyTest, PriorityOrder)
+{
+    const U64 bytes = 1024 * 1024;
+    double analysis = CacheEvictionPolicy::getEvictionScore(eCacheEntryPriorityAnalysis, eCacheEntryPriorityPlayback, false, false, 0.1, bytes, 0);
+    double background = CacheEvictionPolicy::getEvictionScore(eCacheEntryPriorityBackground, eCacheEntryPriorityPlayback, false, false, 0.1, bytes, 0);
+    double interactive = CacheEvictionPolicy::getEvictionScore(eCacheEntryPriorityInteractive, eCacheEntryPriorityPlayback, false, false, 0.1, bytes, 0);
+    double playback = CacheEvictionPolicy::getEvictionScore(eCacheEntryPriorityPlayback, eCacheEntryPriorityPlayback, false, false, 0.1, bytes, 0);
+
+    EXPECT_GE(analysis, 0.);
+    EXPECT_LT(analysis, background);
+    EXPECT_LT(background, interactive);
+    EXPECT_LT(interactive, playback);
+
+    // Within a class, what is cheaper to render again per byte freed goes first
+    double cheap = CacheEvictionPolicy::getEvictionScore(eCacheEntryPriorityBackground, eCacheEntryPriorityPlayback, false, false, 0.01, bytes, 0);
+    double expensive = CacheEvictionPolicy::getEvictionScore(eCacheEntryPriorityBackground, eCacheEntryPriorityPlayback, false, false, 1., bytes, 0);
+    EXPECT_LT(cheap, expensive);
+
+    // And so does the least recently used
+    double older = CacheEvictionPolicy::getEvictionScore(eCacheEntryPriorityBackground, eCacheEntryPriorityPlayback, false, false, 0.1, bytes, 0);
+    double newer = CacheEvictionPolicy::getEvictionScore(eCacheEntryPriorityBackground, eCacheEntryPriorityPlayback, false, false, 0.1, bytes, 5);
+    EXPECT_LT(older, newer);
+
+    // Entries above the maximum priority cannot be evicted
+    EXPECT_LT(CacheEvictionPolicy::getEvictionScore(eCacheEntryPriorityPlayback, eCacheEntryPriorityInteractive, false, false, 0.1, bytes, 0), 0.);
+}
+
+TEST(CacheEvictionPolicyTest, EvictionOrder)
+{
+    TestContainer container;
+    const U64 bytes = 1024 * 1024;
+
+    // Inserted from the least to the most recently used
+    container.insert( 1, TestEntryPtr( new TestEntry(eCacheEntryPriorityPlayback, 1, 0.1, bytes) ) );
+    container.insert( 2, TestEntryPtr( new TestEntry(eCacheEntryPriorityInteractive, 2, 0.1, bytes) ) );
+    container.insert( 3, TestEntryPtr( new TestEntry(eCacheEntryPriorityBackground, 3, 0.1, bytes) ) );
+    container.insert( 4, TestEntryPtr( new TestEntry(eCacheEntryPriorityAnalysis, 4, 0.1, bytes) ) );
+    container.insert( 5, TestEntryPtr( new TestEntry(eCacheEntryPriorityBackground, 5, 0.1, bytes) ) );
+
+    // Nothing pinned: the lower classes go first, then the least recently used within a class
+    const CacheEntryPriorityEnum expected[] = { eCacheEntryPriorityAnalysis, eCacheEntryPriorityBackground, eCacheEntryPriorityBackground, eCacheEntryPriorityInteractive, eCacheEntryPriorityPlayback };
+    const double expectedTimes[] = { 4, 3, 5, 2, 1 };
+    for (int i = 0; i < 5; ++i) {
+        TestEntryPtr evicted = evictLowestScore(container, -1, -1);
+        ASSERT_TRUE(evicted);
+        EXPECT_EQ(expected[i], evicted->priority);
+        EXPECT_EQ(expectedTimes[i], evicted->time);
+    }
+    EXPECT_FALSE( evictLowestScore(container, -1, -1) );
+}
+
+TEST(CacheEvictionPolicyTest, EntriesInUseAreNotEvicted)
+{
+    TestContainer container;
+    TestEntryPtr inUse( new TestEntry(eCacheEntryPriorityAnalysis, 1, 0., 1024) );
+
+    container.insert(1, inUse);
+    container.insert( 2, TestEntryPtr( new TestEntry(eCacheEntryPriorityPlayback, 2, 1., 1024) ) );
+
+    TestEntryPtr evicted = evictLowestScore(container, -1, -1);
+    ASSERT_TRUE(evicted);
+    EXPECT_EQ(2., evicted->time);
+    EXPECT_FALSE( evictLowestScore(container, -1, -1) );
+}
+
+TEST(CacheEvictionPolicyTest, Pinning)
+{
+    const U64 bytes = 1024 * 1024;
+
+    EXPECT_LT(CacheEvictionPolicy::getEvictionScore(eCacheEntryPriorityInteractive, eCacheEntryPriorityPlayback, true, false, 0., bytes, 0), 0.);
+    EXPECT_EQ(std::numeric_limits<double>::max(),
+              CacheEvictionPolicy::getEvictionScore(eCacheEntryPriorityInteractive, eCacheEntryPriorityPlayback, true, true, 0., bytes, 0) );
+
+    TestContainer container;
+    // Pinned entries come first in LRU order and are the cheapest: they would be evicted first if they were candidates
+    for (int i = 0; i < 2 * NATRON_CACHE_EVICTION_CANDIDATES; ++i) {
+        container.insert( i, TestEntryPtr( new TestEntry(eCacheEntryPriorityPlayback, 10 + i % 10, 0., bytes) ) );
+    }
+    container.insert( 1000, TestEntryPtr( new TestEntry(eCacheEntryPriorityPlayback, 100, 10., bytes) ) );
+    container.insert( 1001, TestEntryPtr( new TestEntry(eCacheEntryPriorityBackground, 101, 10., bytes) ) );
+
+    // The entries out of the pinned range [10, 19] go first even beyond the candidates window
+    TestEntryPtr evicted = evictLowestScore(container, 10, 19);
+    ASSERT_TRUE(evicted);
+    EXPECT_EQ(101., evicted->time);
+    evicted = evictLowestScore(container, 10, 19);
+    ASSERT_TRUE(evicted);
+    EXPECT_EQ(100., evicted->time);
+
+    // Then the pinned ones, when nothing else is left
+    for (int i = 0; i < 2 * NATRON_CACHE_EVICTION_CANDIDATES; ++i) {
+        evicted = evictLowestScore(container, 10, 19);
+        ASSERT_TRUE(evicted);
+        EXPECT_GE(evicted->time, 10.);
+        EXPECT_LE(evicted->time, 19.);
+    }
+    EXPECT_FALSE( evictLowestScore(container, 10, 19) );
+}
+
+TEST(CacheEvictionPolicyTest, PinnedAndReservedEntries)
+{
+    std::map<const void*, std::pair<double, double> > pinnedTimeRanges;
+    int owner1, owner2;
+
+    EXPECT_FALSE( CacheEvictionPolicy::isTimePinned(10, pinnedTimeRanges) );
+    pinnedTimeRanges[&owner1] = std::make_pair(10., 19.);
+    pinnedTimeRanges[&owner2] = std::make_pair(30., 30.);
+    EXPECT_TRUE( CacheEvictionPolicy::isTimePinned(10, pinnedTimeRanges) );
+    EXPECT_TRUE( CacheEvictionPolicy::isTimePinned(19, pinnedTimeRanges) );
+    EXPECT_TRUE( CacheEvictionPolicy::isTimePinned(30, pinnedTimeRanges) );
+    EXPECT_FALSE( CacheEvictionPolicy::isTimePinned(20, pinnedTimeRanges) );
+    EXPECT_FALSE( CacheEvictionPolicy::isTimePinned(9.5, pinnedTimeRanges) );
+
+    // Only the entries produced for the viewer are pinned
+    EXPECT_FALSE( CacheEvictionPolicy::isPinned(eCacheEntryPriorityAnalysis, true) );
+    EXPECT_FALSE( CacheEvictionPolicy::isPinned(eCacheEntryPriorityBackground, true) );
+    EXPECT_TRUE( CacheEvictionPolicy::isPinned(eCacheEntryPriorityInteractive, true) );
+    EXPECT_TRUE( CacheEvictionPolicy::isPinned(eCacheEntryPriorityPlayback, true) );
+    EXPECT_FALSE( CacheEvictionPolicy::isPinned(eCacheEntryPriorityPlayback, false) );
+
+    // The reserved memory is for the playback entries and the pinned ones
+    EXPECT_TRUE( CacheEvictionPolicy::isUsingReservedMemory(eCacheEntryPriorityPlayback, false) );
+    EXPECT_TRUE( CacheEvictionPolicy::isUsingReservedMemory(eCacheEntryPriorityInteractive, true) );
+    EXPECT_FALSE( CacheEvictionPolicy::isUsingReservedMemory(eCacheEntryPriorityInteractive, false) );
+    EXPECT_FALSE( CacheEvictionPolicy::isUsingReservedMemory(eCacheEntryPriorityBackground, true) );
+}
+
+TEST(CacheEvictionPolicyTest, Reservation)
+{
+    const U64 maximumInMemorySize = 1000;
+
+    // Nothing reserved
+    EXPECT_EQ( 0ULL, CacheEvictionPolicy::getUnfilledReservedMemory(0, 0, maximumInMemorySize) );
+    EXPECT_FALSE( CacheEvictionPolicy::mustEvictForReservedMemory(850, 0, maximumInMemorySize) );
+
+    // The reservation is capped to NATRON_CACHE_MAX_RESERVED_PERCENT of the in-memory portion
+    EXPECT_EQ( (U64)(maximumInMemorySize * NATRON_CACHE_MAX_RESERVED_PERCENT),
+               CacheEvictionPolicy::getUnfilledReservedMemory(maximumInMemorySize, 0, maximumInMemorySize) );
+
+    // 400 bytes reserved, the cache holds 500 bytes of other entries: 400 + 500 fits
+    U64 unfilled = CacheEvictionPolicy::getUnfilledReservedMemory(400, 0, maximumInMemorySize);
+    EXPECT_EQ(400ULL, unfilled);
+    EXPECT_FALSE( CacheEvictionPolicy::mustEvictForReservedMemory(500, unfilled, maximumInMemorySize) );
+
+    // With 600 bytes of other entries it does not fit anymore
+    EXPECT_TRUE( CacheEvictionPolicy::mustEvictForReservedMemory(600, unfilled, maximumInMemorySize) );
+
+    // Playback filled its reservation: the cache holds 400 bytes of playback entries and 450 bytes of others.
+    // The playback entries are in the cache size already and must not be counted a second time.
+    unfilled = CacheEvictionPolicy::getUnfilledReservedMemory(400, 400, maximumInMemorySize);
+    EXPECT_EQ(0ULL, unfilled);
+    EXPECT_FALSE( CacheEvictionPolicy::mustEvictForReservedMemory(850, unfilled, maximumInMemorySize) );
+
+    // Half filled: 200 bytes are still to be freed
+    unfilled = CacheEvictionPolicy::getUnfilledReservedMemory(400, 200, maximumInMemorySize);
+    EXPECT_EQ(200ULL, unfilled);
+    EXPECT_FALSE( CacheEvictionPolicy::mustEvictForReservedMemory(700, unfilled, maximumInMemorySize) );
+    EXPECT_TRUE( CacheEvictionPolicy::mustEvictForReservedMemory(750, unfilled, maximumInMemorySize) );
+}
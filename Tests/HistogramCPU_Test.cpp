@@ -0,0 +1,265 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Engine/HistogramCPU.h"
+#include "Engine/RectI.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+// A RGBA float image covering bounds
+struct TestImage
+{
+    RectI bounds;
+    std::vector<float> pixels;
+
+    TestImage(const RectI& bounds)
+        : bounds(bounds)
+        , pixels(bounds.area() * 4, 0.f)
+    {
+    }
+
+    int rowStride() const
+    {
+        return bounds.width() * 4;
+    }
+
+    float* pixelAt(int x,
+                   int y)
+    {
+        return &pixels[( (y - bounds.y1) * bounds.width() + (x - bounds.x1) ) * 4];
+    }
+
+    void setPixel(int x,
+                  int y,
+                  float r,
+                  float g,
+                  float b,
+                  float a)
+    {
+        float* pix = pixelAt(x, y);
+
+        pix[0] = r;
+        pix[1] = g;
+        pix[2] = b;
+        pix[3] = a;
+    }
+
+    void bin(int mode,
+             const RectI& tileRect,
+             const RectI& rect,
+             int nBins,
+             ScopeTile* tile)
+    {
+        tile->rect = tileRect;
+        HistogramCPU::binScopeTile(mode, pixelAt(tileRect.x1, tileRect.y1), rowStride(), 4, rect, nBins, 0., 1., tile);
+    }
+
+    U64 hash(const RectI& rect)
+    {
+        return HistogramCPU::hashScopeTilePixels(pixelAt(rect.x1, rect.y1), rowStride(), 4, rect);
+    }
+};
+}
+
+TEST(HistogramCPU, BinsAllChannelsInOnePass)
+{
+    TestImage image( RectI(0, 0, 4, 2) );
+
+    image.setPixel(0, 0, 0.05f, 0.15f, 0.95f, 1.f);
+    image.setPixel(1, 0, 0.05f, 0.15f, 0.55f, 1.f);
+    image.setPixel(2, 0, 0.45f, 0.15f, 0.55f, 1.f);
+    image.setPixel(3, 0, 0.45f, 0.85f, 0.55f, 1.f);
+    // Outside of [0, 1): not counted
+    image.setPixel(0, 1, -0.5f, 1.f, 2.f, 1.f);
+    image.setPixel( 1, 1, std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(), 0.95f, 1.f );
+    image.setPixel(2, 1, 0.f, 0.999f, 0.55f, 1.f);
+    image.setPixel(3, 1, 0.45f, 0.15f, 0.55f, 1.f);
+
+    ScopeTile tile;
+    image.bin(eScopeModeRGB, image.bounds, image.bounds, 10, &tile);
+
+    ASSERT_EQ( (std::size_t)10, tile.bins[0].size() );
+    ASSERT_EQ( (std::size_t)10, tile.bins[1].size() );
+    ASSERT_EQ( (std::size_t)10, tile.bins[2].size() );
+
+    // Red
+    EXPECT_EQ(3.f, tile.bins[0][0]);
+    EXPECT_EQ(3.f, tile.bins[0][4]);
+    // Green
+    EXPECT_EQ(4.f, tile.bins[1][1]);
+    EXPECT_EQ(1.f, tile.bins[1][8]);
+    EXPECT_EQ(1.f, tile.bins[1][9]);
+    // Blue
+    EXPECT_EQ(5.f, tile.bins[2][5]);
+    EXPECT_EQ(2.f, tile.bins[2][9]);
+
+    float totals[3] = { 0.f, 0.f, 0.f };
+    for (int c = 0; c < 3; ++c) {
+        for (std::size_t i = 0; i < tile.bins[c].size(); ++i) {
+            totals[c] += tile.bins[c][i];
+        }
+    }
+    EXPECT_EQ(6.f, totals[0]);
+    EXPECT_EQ(6.f, totals[1]);
+    EXPECT_EQ(7.f, totals[2]);
+}
+
+TEST(HistogramCPU, BinsLuminance)
+{
+    TestImage image( RectI(0, 0, 2, 1) );
+
+    image.setPixel(0, 0, 0.55f, 0.55f, 0.55f, 1.f);
+    image.setPixel(1, 0, 1.f, 0.f, 0.f, 1.f);
+
+    ScopeTile tile;
+    image.bin(eScopeModeY, image.bounds, image.bounds, 10, &tile);
+
+    ASSERT_EQ( (std::size_t)10, tile.bins[0].size() );
+    EXPECT_TRUE( tile.bins[1].empty() );
+    EXPECT_EQ(1.f, tile.bins[0][5]);
+    // 0.299
+    EXPECT_EQ(1.f, tile.bins[0][2]);
+}
+
+// The sum of the bins of the tiles of the grid is the same as binning the whole image at once
+TEST(HistogramCPU, TilesAddUpToTheWholeImage)
+{
+    TestImage image( RectI(-3, -2, 13, 9) );
+
+    for (int y = image.bounds.y1; y < image.bounds.y2; ++y) {
+        for (int x = image.bounds.x1; x < image.bounds.x2; ++x) {
+            image.setPixel( x, y, ( (x * 7 + y * 3) % 20 ) / 20.f, ( (x + y * 5) % 20 ) / 20.f, ( (x * 3 + y) % 20 ) / 20.f, 1.f );
+        }
+    }
+
+    const int modes[] = { eScopeModeRGB, eScopeModeWaveform, eScopeModeVectorscope };
+    for (int m = 0; m < 3; ++m) {
+        const int mode = modes[m];
+        const int nBins = 8;
+        ScopeTile whole;
+        image.bin(mode, image.bounds, image.bounds, nBins, &whole);
+
+        const int nChannels = mode == eScopeModeVectorscope ? 1 : 3;
+        std::vector<float> sum[3];
+        for (int c = 0; c < nChannels; ++c) {
+            sum[c].assign(whole.bins[c].size(), 0.f);
+        }
+        const int tileSize = 5;
+        for (int y = image.bounds.y1; y < image.bounds.y2; y += tileSize) {
+            for (int x = image.bounds.x1; x < image.bounds.x2; x += tileSize) {
+                ScopeTile tile;
+                image.bin(mode, RectI( x, y, std::min(x + tileSize, image.bounds.x2), std::min(y + tileSize, image.bounds.y2) ), image.bounds, nBins, &tile);
+                for (int c = 0; c < nChannels; ++c) {
+                    if (mode == eScopeModeWaveform) {
+                        for (int row = 0; row < NATRON_SCOPE_WAVEFORM_ROWS; ++row) {
+                            for (int col = 0; col < tile.nColumns; ++col) {
+                                sum[c][row * nBins + tile.firstColumn + col] += tile.bins[c][row * tile.nColumns + col];
+                            }
+                        }
+                    } else {
+                        for (std::size_t i = 0; i < sum[c].size(); ++i) {
+                            sum[c][i] += tile.bins[c][i];
+                        }
+                    }
+                }
+            }
+        }
+        for (int c = 0; c < nChannels; ++c) {
+            ASSERT_EQ( whole.bins[c].size(), sum[c].size() );
+            for (std::size_t i = 0; i < sum[c].size(); ++i) {
+                EXPECT_EQ(whole.bins[c][i], sum[c][i]);
+            }
+        }
+    }
+}
+
+TEST(HistogramCPU, VectorscopeCentersGrey)
+{
+    TestImage image( RectI(0, 0, 3, 1) );
+
+    image.setPixel(0, 0, 0.2f, 0.2f, 0.2f, 1.f);
+    image.setPixel(1, 0, 0.8f, 0.8f, 0.8f, 1.f);
+    image.setPixel(2, 0, 0.f, 0.f, 0.8f, 1.f);
+
+    ScopeTile tile;
+    image.bin(eScopeModeVectorscope, image.bounds, image.bounds, 1, &tile);
+
+    const int n = NATRON_SCOPE_VECTORSCOPE_SIZE;
+    ASSERT_EQ( (std::size_t)(n * n), tile.bins[0].size() );
+    // Greys have no chroma: they land next to the center, depending on rounding
+    EXPECT_EQ(2.f, tile.bins[0][(n / 2 - 1) * n + n / 2 - 1] + tile.bins[0][(n / 2 - 1) * n + n / 2] +
+              tile.bins[0][(n / 2) * n + n / 2 - 1] + tile.bins[0][(n / 2) * n + n / 2]);
+    // Blue has a positive Cb and a slightly negative Cr
+    float blue = 0.f;
+    for (int y = 0; y < n / 2; ++y) {
+        for (int x = n / 2 + 1; x < n; ++x) {
+            blue += tile.bins[0][y * n + x];
+        }
+    }
+    EXPECT_EQ(1.f, blue);
+}
+
+// The bins of a tile are reused for the next frame when its hash did not change
+TEST(HistogramCPU, TileHashDependsOnlyOnTheTilePixels)
+{
+    TestImage image( RectI(0, 0, 8, 8) );
+
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 8; ++x) {
+            image.setPixel(x, y, x / 8.f, y / 8.f, 0.5f, 1.f);
+        }
+    }
+
+    const RectI tileRect(0, 0, 4, 4);
+    const U64 hash = image.hash(tileRect);
+
+    // Same pixels in another image
+    TestImage copy = image;
+    EXPECT_EQ( hash, copy.hash(tileRect) );
+
+    // A pixel outside of the tile
+    copy.setPixel(5, 5, 1.f, 1.f, 1.f, 1.f);
+    EXPECT_EQ( hash, copy.hash(tileRect) );
+
+    // A pixel inside of the tile, on any channel
+    for (int c = 0; c < 4; ++c) {
+        TestImage changed = image;
+        changed.pixelAt(3, 2)[c] += 0.25f;
+        EXPECT_NE( hash, changed.hash(tileRect) );
+    }
+
+    // Two pixels swapped
+    TestImage swapped = image;
+    swapped.setPixel(0, 0, 1.f / 8.f, 0.f, 0.5f, 1.f);
+    swapped.setPixel(1, 0, 0.f, 0.f, 0.5f, 1.f);
+    EXPECT_NE( hash, swapped.hash(tileRect) );
+}
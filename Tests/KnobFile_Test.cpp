@@ -598,3 +598,26 @@ TEST(SequenceFromFiles, ComplexTest) {
         EXPECT_TRUE(sequence.generateValidSequencePattern() == "/Users/Test/#####.jpg");
     }
 }
+
+TEST(SequenceParsing, FileSequencesIndex) {
+    ///files which may belong to the same sequence share the same key
+    EXPECT_EQ( FileSequencesIndex::getSequenceKey("/Users/Test/img.0001.jpg"), FileSequencesIndex::getSequenceKey("/Users/Test/img.10000.jpg") );
+    EXPECT_EQ( FileSequencesIndex::getSequenceKey("/Users/Test/img.-001.jpg"), FileSequencesIndex::getSequenceKey("/Users/Test/img.001.jpg") );
+    EXPECT_EQ( "/Users/Test/img_#_#.jpg", FileSequencesIndex::getSequenceKey("/Users/Test/img_12_0034.jpg") );
+    EXPECT_NE( FileSequencesIndex::getSequenceKey("/Users/Test/img.0001.jpg"), FileSequencesIndex::getSequenceKey("/Users/Test/img.0001.png") );
+
+    ///the index groups files the same way as trying all the sequences
+    FileSequencesIndex index(false);
+    bool created;
+    SequenceFromFilesPtr first = index.insertFile( "/Users/Test/img.0001.jpg", FileNameContent("/Users/Test/img.0001.jpg"), true, &created );
+    EXPECT_TRUE(created);
+    SequenceFromFilesPtr other = index.insertFile( "/Users/Test/other.jpg", FileNameContent("/Users/Test/other.jpg"), true, &created );
+    EXPECT_TRUE(created);
+    EXPECT_NE(first, other);
+    for (int i = 2; i < 10; ++i) {
+        std::string filename = "/Users/Test/img.000" + QString::number(i).toStdString() + ".jpg";
+        EXPECT_EQ( first, index.insertFile( filename, FileNameContent(filename), true, &created ) );
+        EXPECT_FALSE(created);
+    }
+    EXPECT_EQ( "/Users/Test/img.####.jpg", first->generateValidSequencePattern() );
+}
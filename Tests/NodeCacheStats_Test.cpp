@@ -0,0 +1,147 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <gtest/gtest.h>
+
+#include "Engine/Node.h"
+
+NATRON_NAMESPACE_USING
+
+// 1 MB images
+#define kTestImageBytes (1024 * 1024)
+
+// Renders a 1MB image in less than a microsecond: far below the cost of caching it
+#define kCheapRenderTime 1e-6
+
+// 1 second for 1MB
+#define kExpensiveRenderTime 1.
+
+TEST(NodeCacheStatsTest, CheapNeedsMeasures)
+{
+    NodeCacheStats stats;
+
+    EXPECT_FALSE( stats.isCheapToRender() );
+    stats.addRender(kCheapRenderTime, kTestImageBytes, kTestImageBytes);
+    EXPECT_FALSE( stats.isCheapToRender() );
+
+    // After a few renders the node is known to be cheap
+    for (int i = 0; i < 100 && !stats.isCheapToRender(); ++i) {
+        stats.addRender(kCheapRenderTime, kTestImageBytes, 0);
+    }
+    EXPECT_TRUE( stats.isCheapToRender() );
+}
+
+TEST(NodeCacheStatsTest, ExpensiveIsNotCheap)
+{
+    NodeCacheStats stats;
+
+    for (int i = 0; i < 100; ++i) {
+        stats.addRender(kExpensiveRenderTime, kTestImageBytes, kTestImageBytes);
+        EXPECT_FALSE( stats.isCheapToRender() );
+    }
+    EXPECT_NEAR(kExpensiveRenderTime / kTestImageBytes, stats.getRenderCostPerByte(), 1e-15);
+}
+
+TEST(NodeCacheStatsTest, CostFollowsChanges)
+{
+    NodeCacheStats stats;
+
+    for (int i = 0; i < 100; ++i) {
+        stats.addRender(kCheapRenderTime, kTestImageBytes, 0);
+    }
+    ASSERT_TRUE( stats.isCheapToRender() );
+
+    // The node parameters changed and it is now expensive: it must not stay cheap because of the old measures
+    for (int i = 0; i < 10; ++i) {
+        stats.addRender(kExpensiveRenderTime, kTestImageBytes, 0);
+    }
+    EXPECT_FALSE( stats.isCheapToRender() );
+}
+
+TEST(NodeCacheStatsTest, Sampling)
+{
+    NodeCacheStats stats;
+    int nAdmitted = 0;
+
+    EXPECT_FALSE( stats.admitCheapRenderSample() );
+    for (int i = 1; i < 100; ++i) {
+        if ( stats.admitCheapRenderSample() ) {
+            ++nAdmitted;
+        }
+    }
+    // Some renders are cached, but not most of them
+    EXPECT_GT(nAdmitted, 0);
+    EXPECT_LT(nAdmitted, 50);
+}
+
+/*
+ * Simulates renders of a node whose images are each re-used 'reuse' times from the cache when they are cached.
+ * As in Node::shouldCacheOutput, a render is not cached if the node is cheap, unless it is sampled.
+ */
+static void
+simulateRenders(NodeCacheStats* stats,
+                double renderTime,
+                int reuse,
+                int nRenders)
+{
+    for (int i = 0; i < nRenders; ++i) {
+        bool cached = !stats->isCheapToRender() || stats->admitCheapRenderSample();
+
+        // The lookup before the render misses
+        stats->addLookup(false, 0.);
+        stats->addRender(renderTime, kTestImageBytes, cached ? kTestImageBytes : 0);
+        if (cached) {
+            for (int j = 0; j < reuse; ++j) {
+                stats->addLookup(true, renderTime);
+            }
+        }
+    }
+}
+
+TEST(NodeCacheStatsTest, ReuseMakesItWorthCaching)
+{
+    NodeCacheStats stats;
+
+    // A render time per byte just below the admission threshold, with no re-use: not worth caching
+    const double renderTime = 0.5e-9 * kTestImageBytes;
+    simulateRenders(&stats, renderTime, 0, 100);
+    EXPECT_TRUE( stats.isCheapToRender() );
+
+    // The images are now re-used several times each: even though most renders are not cached anymore, the node
+    // must be found worth caching again
+    simulateRenders(&stats, renderTime, 3, 100);
+    EXPECT_FALSE( stats.isCheapToRender() );
+    EXPECT_GT(stats.hits, 0ULL);
+    EXPECT_GT(stats.savedTime, 0.);
+
+    // And stays so as long as they are re-used
+    simulateRenders(&stats, renderTime, 3, 100);
+    EXPECT_FALSE( stats.isCheapToRender() );
+
+    // Until they are not re-used anymore
+    simulateRenders(&stats, renderTime, 0, 100);
+    EXPECT_TRUE( stats.isCheapToRender() );
+}
@@ -0,0 +1,166 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <list>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+
+#include "Engine/FStreamsSupport.h"
+#include "Engine/ProjectPrivate.h"
+
+#include "Serialization/NodeSerialization.h"
+#include "Serialization/ProjectSerialization.h"
+#include "Serialization/SerializationIO.h"
+
+NATRON_NAMESPACE_USING
+
+static SERIALIZATION_NAMESPACE::NodeSerializationPtr
+makeNode(const std::string& scriptName,
+         const std::string& label)
+{
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr node(new SERIALIZATION_NAMESPACE::NodeSerialization);
+
+    node->_nodeScriptName = scriptName;
+    node->_nodeLabel = label;
+    node->_pluginID = "net.sf.openfx.TestPlugin";
+    node->_pluginMajorVersion = 1;
+    node->_pluginMinorVersion = 0;
+
+    return node;
+}
+
+static SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization
+makeEntry(const std::string& scriptName,
+          const SERIALIZATION_NAMESPACE::NodeSerializationPtr& node,
+          int frame)
+{
+    SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization entry;
+
+    entry._nodeScriptName = scriptName;
+    entry._timelineCurrent = frame;
+    if (node) {
+        entry._type = SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization::eJournalEntryTypeNodeChanged;
+        entry._node = node;
+    } else {
+        entry._type = SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization::eJournalEntryTypeNodeRemoved;
+    }
+
+    return entry;
+}
+
+static SERIALIZATION_NAMESPACE::NodeSerializationPtr
+findNode(const SERIALIZATION_NAMESPACE::ProjectSerialization& project,
+         const std::string& scriptName)
+{
+    for (SERIALIZATION_NAMESPACE::NodeSerializationList::const_iterator it = project._nodes.begin(); it != project._nodes.end(); ++it) {
+        if ( (*it)->_nodeScriptName == scriptName ) {
+            return *it;
+        }
+    }
+
+    return SERIALIZATION_NAMESPACE::NodeSerializationPtr();
+}
+
+TEST(ProjectJournal,
+     ReplayOntoBaseAutoSave)
+{
+    QString autoSaveFilePath = QDir::tempPath() + QString::fromUtf8("/ProjectJournal_Test.ntp");
+    QString journalFilePath = ProjectPrivate::getAutoSaveJournalFilePath(autoSaveFilePath);
+
+    QFile::remove(autoSaveFilePath);
+    QFile::remove(journalFilePath);
+
+    // Write the base auto-save with 2 nodes
+    {
+        SERIALIZATION_NAMESPACE::ProjectSerialization base;
+        base._nodes.push_back( makeNode("Blur1", "Blur") );
+        base._nodes.push_back( makeNode("Grade1", "Grade") );
+        base._timelineCurrent = 1;
+        base._projectLoadedInfo.vMajor = NATRON_VERSION_MAJOR;
+        base._projectLoadedInfo.vMinor = NATRON_VERSION_MINOR;
+        base._projectLoadedInfo.vRev = NATRON_VERSION_REVISION;
+        base._projectLoadedInfo.gitBranch = "master";
+        base._projectLoadedInfo.gitCommit = "0";
+        base._projectLoadedInfo.osStr = "Linux";
+        base._projectLoadedInfo.bits = 64;
+
+        FStreamsSupport::ofstream ofile;
+        FStreamsSupport::open( &ofile, autoSaveFilePath.toStdString() );
+        ASSERT_TRUE(ofile);
+        SERIALIZATION_NAMESPACE::write(ofile, base);
+    }
+
+    // Append 2 incremental auto-saves to the journal: Blur1 is modified then Grade1 removed and Merge1 created
+    {
+        std::list<SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization> entries;
+        entries.push_back( makeEntry("Blur1", makeNode("Blur1", "Blur modified"), 5) );
+        ASSERT_TRUE( ProjectPrivate::writeAutoSaveJournalEntries(journalFilePath, entries) );
+    }
+    {
+        std::list<SERIALIZATION_NAMESPACE::ProjectJournalEntrySerialization> entries;
+        entries.push_back( makeEntry("Grade1", SERIALIZATION_NAMESPACE::NodeSerializationPtr(), 7) );
+        entries.push_back( makeEntry("Merge1", makeNode("Merge1", "Merge"), 8) );
+        ASSERT_TRUE( ProjectPrivate::writeAutoSaveJournalEntries(journalFilePath, entries) );
+    }
+
+    // Simulate a crash while writing the last record: it must be ignored
+    {
+        FStreamsSupport::ofstream ofile;
+        FStreamsSupport::open( &ofile, journalFilePath.toStdString(), std::ios_base::out | std::ios_base::app );
+        ASSERT_TRUE(ofile);
+        ofile << "---\nOp: Set\nScriptName: Blur1\nNode: {";
+    }
+
+    SERIALIZATION_NAMESPACE::ProjectSerialization restored;
+    {
+        FStreamsSupport::ifstream ifile;
+        FStreamsSupport::open( &ifile, autoSaveFilePath.toStdString() );
+        ASSERT_TRUE(ifile);
+        SERIALIZATION_NAMESPACE::read(ifile, &restored);
+    }
+    ProjectPrivate::applyAutoSaveJournal(autoSaveFilePath, &restored);
+
+    EXPECT_EQ( (std::size_t)2, restored._nodes.size() );
+
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr blur = findNode(restored, "Blur1");
+    ASSERT_TRUE(blur);
+    EXPECT_EQ( std::string("Blur modified"), blur->_nodeLabel );
+
+    EXPECT_FALSE( findNode(restored, "Grade1") );
+
+    SERIALIZATION_NAMESPACE::NodeSerializationPtr merge = findNode(restored, "Merge1");
+    ASSERT_TRUE(merge);
+    EXPECT_EQ( std::string("Merge"), merge->_nodeLabel );
+
+    EXPECT_EQ(8, restored._timelineCurrent);
+
+    QFile::remove(autoSaveFilePath);
+    QFile::remove(journalFilePath);
+}
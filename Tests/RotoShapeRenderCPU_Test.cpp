@@ -0,0 +1,259 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cmath>
+#include <list>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Engine/RectI.h"
+#include "Engine/RotoShapeRenderCPU.h"
+
+NATRON_NAMESPACE_USING
+
+static void
+addPoint(double x,
+         double y,
+         std::vector<ParametricPoint>* polygon)
+{
+    ParametricPoint p;
+
+    p.x = x;
+    p.y = y;
+    p.t = 0.;
+    polygon->push_back(p);
+}
+
+static void
+addFeatherVertex(double x,
+                 double y,
+                 bool isInner,
+                 std::vector<RotoBezierTriangulation::RotoFeatherVertex>* mesh)
+{
+    RotoBezierTriangulation::RotoFeatherVertex v;
+
+    v.x = x;
+    v.y = y;
+    v.isInner = isInner;
+    mesh->push_back(v);
+}
+
+static void
+addDot(double x,
+       double y,
+       double pressure,
+       std::list<std::pair<Point, double> >* dots)
+{
+    Point p;
+
+    p.x = x;
+    p.y = y;
+    dots->push_back( std::make_pair(p, pressure) );
+}
+
+static float
+coverageAt(const std::vector<float>& coverage,
+           const RectI& window,
+           int x,
+           int y)
+{
+    return coverage[(y - window.y1) * window.width() + (x - window.x1)];
+}
+
+TEST(RotoShapeRenderCPU,
+     RectangleCoverage)
+{
+    // The vertical edges lie in the middle of a pixel column, the horizontal edges on pixel borders
+    std::vector<ParametricPoint> polygon;
+    addPoint(2.5, 3., &polygon);
+    addPoint(7.5, 3., &polygon);
+    addPoint(7.5, 8., &polygon);
+    addPoint(2.5, 8., &polygon);
+
+    RectI window(0, 0, 10, 10);
+    std::vector<float> coverage;
+    RotoShapeRenderCPU::rasterizeCoverage_cpu(polygon, std::vector<RotoBezierTriangulation::RotoFeatherVertex>(), eRampTypeLinear, 1., window, &coverage);
+    ASSERT_EQ( (std::size_t)100, coverage.size() );
+
+    double sum = 0.;
+    for (int y = 0; y < 10; ++y) {
+        for (int x = 0; x < 10; ++x) {
+            float expected = 0.f;
+            if ( (y >= 3) && (y < 8) ) {
+                if ( (x == 2) || (x == 7) ) {
+                    expected = 0.5f;
+                } else if ( (x > 2) && (x < 7) ) {
+                    expected = 1.f;
+                }
+            }
+            EXPECT_NEAR( expected, coverageAt(coverage, window, x, y), 1e-5 ) << "at pixel (" << x << ", " << y << ")";
+            sum += coverageAt(coverage, window, x, y);
+        }
+    }
+    EXPECT_NEAR(25., sum, 1e-4);
+
+    // The same rectangle rendered over a window that clips it must give the same pixels
+    RectI clipped(4, 5, 9, 7);
+    std::vector<float> clippedCoverage;
+    RotoShapeRenderCPU::rasterizeCoverage_cpu(polygon, std::vector<RotoBezierTriangulation::RotoFeatherVertex>(), eRampTypeLinear, 1., clipped, &clippedCoverage);
+    for (int y = clipped.y1; y < clipped.y2; ++y) {
+        for (int x = clipped.x1; x < clipped.x2; ++x) {
+            EXPECT_NEAR( coverageAt(coverage, window, x, y), coverageAt(clippedCoverage, clipped, x, y), 1e-5 ) << "at pixel (" << x << ", " << y << ")";
+        }
+    }
+}
+
+TEST(RotoShapeRenderCPU,
+     CircleCoverage)
+{
+    const double cx = 32.3;
+    const double cy = 31.7;
+    const double radius = 20.;
+    const int nPoints = 256;
+    std::vector<ParametricPoint> polygon;
+
+    for (int i = 0; i < nPoints; ++i) {
+        double a = 2. * M_PI * i / nPoints;
+        addPoint(cx + radius * std::cos(a), cy + radius * std::sin(a), &polygon);
+    }
+
+    RectI window(0, 0, 64, 64);
+    std::vector<float> coverage;
+    RotoShapeRenderCPU::rasterizeCoverage_cpu(polygon, std::vector<RotoBezierTriangulation::RotoFeatherVertex>(), eRampTypeLinear, 1., window, &coverage);
+
+    // The coverage is analytic: its sum is the area of the polygon
+    double polygonArea = 0.5 * nPoints * radius * radius * std::sin(2. * M_PI / nPoints);
+    double sum = 0.;
+    for (std::size_t i = 0; i < coverage.size(); ++i) {
+        EXPECT_GE(coverage[i], 0.f);
+        EXPECT_LE(coverage[i], 1.f);
+        sum += coverage[i];
+    }
+    EXPECT_NEAR(polygonArea, sum, 1e-2);
+
+    EXPECT_NEAR( 1.f, coverageAt(coverage, window, 32, 31), 1e-5 );
+    EXPECT_NEAR( 0.f, coverageAt(coverage, window, 0, 0), 1e-5 );
+    EXPECT_NEAR( 0.f, coverageAt(coverage, window, 63, 63), 1e-5 );
+
+    // Pixels crossed by the border are partially covered
+    int borderX = (int)std::floor(cx + radius);
+    float border = coverageAt(coverage, window, borderX, (int)cy);
+    EXPECT_GT(border, 0.f);
+    EXPECT_LT(border, 1.f);
+}
+
+TEST(RotoShapeRenderCPU,
+     FeatheredEdgeCoverage)
+{
+    // A square from x = 10 to 20 with its right edge feathered up to x = 30
+    std::vector<ParametricPoint> polygon;
+    addPoint(10., 0., &polygon);
+    addPoint(20., 0., &polygon);
+    addPoint(20., 10., &polygon);
+    addPoint(10., 10., &polygon);
+
+    std::vector<RotoBezierTriangulation::RotoFeatherVertex> mesh;
+    addFeatherVertex(20., 0., true, &mesh);
+    addFeatherVertex(30., 0., false, &mesh);
+    addFeatherVertex(30., 10., false, &mesh);
+    addFeatherVertex(20., 0., true, &mesh);
+    addFeatherVertex(30., 10., false, &mesh);
+    addFeatherVertex(20., 10., true, &mesh);
+
+    RectI window(0, 0, 40, 10);
+    std::vector<float> coverage;
+    RotoShapeRenderCPU::rasterizeCoverage_cpu(polygon, mesh, eRampTypeLinear, 1., window, &coverage);
+
+    for (int y = 0; y < 10; ++y) {
+        for (int x = 0; x < 40; ++x) {
+            float expected;
+            if ( (x < 10) || (x >= 30) ) {
+                expected = 0.f;
+            } else if (x < 20) {
+                expected = 1.f;
+            } else {
+                // The ramp is evaluated at the pixel center
+                expected = (30. - (x + 0.5)) / 10.;
+            }
+            EXPECT_NEAR( expected, coverageAt(coverage, window, x, y), 1e-5 ) << "at pixel (" << x << ", " << y << ")";
+        }
+    }
+
+    // The ramp type and the falloff shape the ramp like the OpenGL renderer does
+    RotoShapeRenderCPU::rasterizeCoverage_cpu(polygon, mesh, eRampTypeSmooth, 2., window, &coverage);
+    float previous = 1.f;
+    for (int x = 20; x < 30; ++x) {
+        double t = (30. - (x + 0.5)) / 10.;
+        double expected = std::pow(t * t * (3. - 2. * t), 2.);
+        float value = coverageAt(coverage, window, x, 5);
+        EXPECT_NEAR(expected, value, 1e-5);
+        EXPECT_LE(value, previous);
+        previous = value;
+    }
+}
+
+TEST(RotoShapeRenderCPU,
+     PressureAffectsDabOpacityOnce)
+{
+    // Two dabs far apart with a soft brush: the first one drawn with half the pressure of the second one
+    const double size = 20.;
+    const double hardness = 0.5;
+    const double opacity = 0.8;
+    RectI window(0, 0, 80, 30);
+
+    std::list<std::pair<Point, double> > stroke;
+    addDot(20., 15., 0.5, &stroke);
+    addDot(60., 15., 1., &stroke);
+    std::vector<float> coverage;
+    RotoShapeRenderCPU::rasterizeDabs_cpu(stroke, size, hardness, true, false, false, false, opacity, window, &coverage);
+
+    // The same dabs with the pressure ignored
+    std::list<std::pair<Point, double> > reference;
+    addDot(20., 15., 1., &reference);
+    addDot(60., 15., 1., &reference);
+    std::vector<float> referenceCoverage;
+    RotoShapeRenderCPU::rasterizeDabs_cpu(reference, size, hardness, false, false, false, false, opacity, window, &referenceCoverage);
+
+    // Each dab is scaled by its own pressure, exactly once
+    double sum = 0.;
+    for (int y = window.y1; y < window.y2; ++y) {
+        for (int x = window.x1; x < window.x2; ++x) {
+            double pressure = x < 40 ? 0.5 : 1.;
+            EXPECT_NEAR( pressure * coverageAt(referenceCoverage, window, x, y), coverageAt(coverage, window, x, y), 1e-5 ) << "at pixel (" << x << ", " << y << ")";
+            sum += coverageAt(referenceCoverage, window, x, y);
+        }
+    }
+    EXPECT_GT(sum, 0.);
+
+    // The stroke may start with either pressure
+    stroke.reverse();
+    std::vector<float> reversedCoverage;
+    RotoShapeRenderCPU::rasterizeDabs_cpu(stroke, size, hardness, true, false, false, false, opacity, window, &reversedCoverage);
+    for (std::size_t i = 0; i < coverage.size(); ++i) {
+        EXPECT_NEAR(coverage[i], reversedCoverage[i], 1e-5);
+    }
+}
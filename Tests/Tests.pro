@@ -50,10 +50,16 @@ SOURCES += \
     google-mock/src/gmock-all.cc \
     BaseTest.cpp \
     Hash64_Test.cpp \
+    ActionsCache_Test.cpp \
+    Cache_Test.cpp \
+    HistogramCPU_Test.cpp \
     Image_Test.cpp \
     Lut_Test.cpp \
+    NodeCacheStats_Test.cpp \
     KnobFile_Test.cpp \
     Curve_Test.cpp \
+    ProjectJournal_Test.cpp \
+    RotoShapeRenderCPU_Test.cpp \
     Tracker_Test.cpp \
     wmain.cpp
 
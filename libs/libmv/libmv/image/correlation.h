@@ -21,11 +21,174 @@
 #ifndef LIBMV_IMAGE_CORRELATION_H
 #define LIBMV_IMAGE_CORRELATION_H
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+#include <cmath>
+
 #include "libmv/logging/logging.h"
 #include "libmv/image/image.h"
 
 namespace libmv {
 
+// Weighted sum of absolute differences between a row of a pattern and a row
+// of an image scaled by "scale":
+//
+//   sum(|mask[j] * (pattern[j] - scale * image[j])|)
+//
+// This is the reference implementation of MaskedSumOfAbsoluteDifferences().
+inline float MaskedSumOfAbsoluteDifferencesScalar(const float *mask,
+                                                  const float *pattern,
+                                                  const float *image,
+                                                  float scale,
+                                                  int size) {
+  float sad = 0.0f;
+  for (int j = 0; j < size; ++j) {
+    sad += std::abs(mask[j] * (pattern[j] - scale * image[j]));
+  }
+  return sad;
+}
+
+// Same as MaskedSumOfAbsoluteDifferencesScalar(), four elements at a time
+// when SSE2 is available. The result only differs from the scalar one by the
+// order of the floating point additions.
+inline float MaskedSumOfAbsoluteDifferences(const float *mask,
+                                            const float *pattern,
+                                            const float *image,
+                                            float scale,
+                                            int size) {
+#ifdef __SSE2__
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 scale4 = _mm_set1_ps(scale);
+  __m128 sad4 = _mm_setzero_ps();
+  int j = 0;
+  for (; j + 4 <= size; j += 4) {
+    const __m128 difference =
+        _mm_sub_ps(_mm_loadu_ps(pattern + j),
+                   _mm_mul_ps(scale4, _mm_loadu_ps(image + j)));
+    sad4 = _mm_add_ps(sad4,
+                      _mm_and_ps(_mm_mul_ps(_mm_loadu_ps(mask + j),
+                                            difference),
+                                 abs_mask));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, sad4);
+  float sad = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; j < size; ++j) {
+    sad += std::abs(mask[j] * (pattern[j] - scale * image[j]));
+  }
+  return sad;
+#else
+  return MaskedSumOfAbsoluteDifferencesScalar(mask, pattern, image,
+                                              scale, size);
+#endif
+}
+
+// Weighted sum of a row of an image: sum(mask[j] * image[j]).
+//
+// This is the reference implementation of MaskedSum().
+inline float MaskedSumScalar(const float *mask, const float *image, int size) {
+  float sum = 0.0f;
+  for (int j = 0; j < size; ++j) {
+    sum += mask[j] * image[j];
+  }
+  return sum;
+}
+
+// Same as MaskedSumScalar(), four elements at a time when SSE2 is available.
+inline float MaskedSum(const float *mask, const float *image, int size) {
+#ifdef __SSE2__
+  __m128 sum4 = _mm_setzero_ps();
+  int j = 0;
+  for (; j + 4 <= size; j += 4) {
+    sum4 = _mm_add_ps(sum4, _mm_mul_ps(_mm_loadu_ps(mask + j),
+                                       _mm_loadu_ps(image + j)));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, sum4);
+  float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; j < size; ++j) {
+    sum += mask[j] * image[j];
+  }
+  return sum;
+#else
+  return MaskedSumScalar(mask, image, size);
+#endif
+}
+
+// Sums of x, y, x * x, y * y and x * y over the first channel of both images,
+// in this order.
+//
+// This is the reference implementation of CorrelationSums().
+inline void CorrelationSumsScalar(const FloatImage &image1,
+                                  const FloatImage &image2,
+                                  double sums[5]) {
+  double sX = 0, sY = 0, sXX = 0, sYY = 0, sXY = 0;
+  for (int r = 0; r < image1.Height(); ++r) {
+    for (int c = 0; c < image1.Width(); ++c) {
+      double x = image1(r, c, 0);
+      double y = image2(r, c, 0);
+      sX += x;
+      sY += y;
+      sXX += x * x;
+      sYY += y * y;
+      sXY += x * y;
+    }
+  }
+  sums[0] = sX;
+  sums[1] = sY;
+  sums[2] = sXX;
+  sums[3] = sYY;
+  sums[4] = sXY;
+}
+
+// Same as CorrelationSumsScalar(), two pixels at a time in double precision
+// when SSE2 is available. The result only differs from the scalar one by the
+// order of the floating point additions.
+inline void CorrelationSums(const FloatImage &image1,
+                            const FloatImage &image2,
+                            double sums[5]) {
+#ifdef __SSE2__
+  // The pixels of a row are contiguous, the channels are interleaved.
+  const int size = image1.Height() * image1.Width();
+  const int stride1 = image1.Depth();
+  const int stride2 = image2.Depth();
+  const float *data1 = image1.Data();
+  const float *data2 = image2.Data();
+  __m128d sX = _mm_setzero_pd(), sY = _mm_setzero_pd(),
+          sXX = _mm_setzero_pd(), sYY = _mm_setzero_pd(),
+          sXY = _mm_setzero_pd();
+  int i = 0;
+  for (; i + 2 <= size; i += 2) {
+    const __m128d x = _mm_set_pd(data1[(i + 1) * stride1], data1[i * stride1]);
+    const __m128d y = _mm_set_pd(data2[(i + 1) * stride2], data2[i * stride2]);
+    sX = _mm_add_pd(sX, x);
+    sY = _mm_add_pd(sY, y);
+    sXX = _mm_add_pd(sXX, _mm_mul_pd(x, x));
+    sYY = _mm_add_pd(sYY, _mm_mul_pd(y, y));
+    sXY = _mm_add_pd(sXY, _mm_mul_pd(x, y));
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, sX);  sums[0] = lanes[0] + lanes[1];
+  _mm_storeu_pd(lanes, sY);  sums[1] = lanes[0] + lanes[1];
+  _mm_storeu_pd(lanes, sXX); sums[2] = lanes[0] + lanes[1];
+  _mm_storeu_pd(lanes, sYY); sums[3] = lanes[0] + lanes[1];
+  _mm_storeu_pd(lanes, sXY); sums[4] = lanes[0] + lanes[1];
+  for (; i < size; ++i) {
+    double x = data1[i * stride1];
+    double y = data2[i * stride2];
+    sums[0] += x;
+    sums[1] += y;
+    sums[2] += x * x;
+    sums[3] += y * y;
+    sums[4] += x * y;
+  }
+#else
+  CorrelationSumsScalar(image1, image2, sums);
+#endif
+}
+
 inline double PearsonProductMomentCorrelation(
         const FloatImage &image_and_gradient1_sampled,
         const FloatImage &image_and_gradient2_sampled) {
@@ -36,19 +199,12 @@ inline double PearsonProductMomentCorrelation(
 
   const int width = image_and_gradient1_sampled.Width(),
             height = image_and_gradient1_sampled.Height();
-  double sX = 0, sY = 0, sXX = 0, sYY = 0, sXY = 0;
-
-  for (int r = 0; r < height; ++r) {
-    for (int c = 0; c < width; ++c) {
-      double x = image_and_gradient1_sampled(r, c, 0);
-      double y = image_and_gradient2_sampled(r, c, 0);
-      sX += x;
-      sY += y;
-      sXX += x * x;
-      sYY += y * y;
-      sXY += x * y;
-    }
-  }
+  double sums[5];
+  CorrelationSums(image_and_gradient1_sampled,
+                  image_and_gradient2_sampled,
+                  sums);
+  double sX = sums[0], sY = sums[1], sXX = sums[2], sYY = sums[3],
+         sXY = sums[4];
 
   // Normalize.
   double N = width * height;
@@ -0,0 +1,159 @@
+// Copyright (c) 2012 libmv authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include <ctime>
+#include <vector>
+
+#include "libmv/image/correlation.h"
+#include "testing/testing.h"
+
+using namespace libmv;
+
+namespace {
+
+// Deterministic rows of values in [0, 1), with some masked out elements.
+void FillRows(int size,
+              std::vector<float> *mask,
+              std::vector<float> *pattern,
+              std::vector<float> *image) {
+  mask->resize(size);
+  pattern->resize(size);
+  image->resize(size);
+  for (int j = 0; j < size; ++j) {
+    (*mask)[j] = (j % 5 == 0) ? 0.0f : (j % 7) / 7.0f;
+    (*pattern)[j] = (j * 13 % 17) / 17.0f;
+    (*image)[j] = (j * 7 % 11) / 11.0f;
+  }
+}
+
+// The SSE2 kernel must match the scalar one, including for the sizes which
+// are not a multiple of the vector width.
+TEST(Correlation, MaskedSumOfAbsoluteDifferencesMatchesScalar) {
+  for (int size = 0; size < 40; ++size) {
+    std::vector<float> mask, pattern, image;
+    FillRows(size, &mask, &pattern, &image);
+    // Use a dummy element so the pointers are valid for empty rows.
+    mask.push_back(0.0f);
+    pattern.push_back(0.0f);
+    image.push_back(0.0f);
+    const float scales[] = { 1.0f, 0.73f, 1.9f };
+    for (int k = 0; k < 3; ++k) {
+      const float expected =
+          MaskedSumOfAbsoluteDifferencesScalar(&mask[0], &pattern[0],
+                                               &image[0], scales[k], size);
+      const float actual =
+          MaskedSumOfAbsoluteDifferences(&mask[0], &pattern[0],
+                                         &image[0], scales[k], size);
+      EXPECT_NEAR(expected, actual, 1e-5 * (1 + expected));
+    }
+  }
+}
+
+TEST(Correlation, MaskedSumOfAbsoluteDifferencesGolden) {
+  const float mask[] = { 1.0f, 0.5f, 0.0f, 1.0f, 1.0f };
+  const float pattern[] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+  const float image[] = { 0.5f, 1.0f, 9.0f, 2.0f, 1.0f };
+  // |1 - 1| + 0.5 * |2 - 2| + 0 + |4 - 4| + |5 - 2| = 3.
+  EXPECT_FLOAT_EQ(3.0f, MaskedSumOfAbsoluteDifferences(mask, pattern, image,
+                                                       2.0f, 5));
+  // |1 - 0.5| + 0.5 * |2 - 1| + 0 + |4 - 2| + |5 - 1| = 7.
+  EXPECT_FLOAT_EQ(7.0f, MaskedSumOfAbsoluteDifferences(mask, pattern, image,
+                                                       1.0f, 5));
+}
+
+TEST(Correlation, MaskedSumMatchesScalar) {
+  for (int size = 0; size < 40; ++size) {
+    std::vector<float> mask, pattern, image;
+    FillRows(size, &mask, &pattern, &image);
+    mask.push_back(0.0f);
+    image.push_back(0.0f);
+    const float expected = MaskedSumScalar(&mask[0], &image[0], size);
+    const float actual = MaskedSum(&mask[0], &image[0], size);
+    EXPECT_NEAR(expected, actual, 1e-5 * (1 + expected));
+  }
+}
+
+// Only the first channel of the images is used.
+TEST(Correlation, CorrelationSumsMatchesScalar) {
+  FloatImage image1(9, 7, 3), image2(9, 7, 3);
+  for (int r = 0; r < 9; ++r) {
+    for (int c = 0; c < 7; ++c) {
+      for (int i = 0; i < 3; ++i) {
+        image1(r, c, i) = (r * 5 + c * 3 + i * 11) % 13 / 13.0f;
+        image2(r, c, i) = (r * 3 + c * 7 + i * 17) % 19 / 19.0f;
+      }
+    }
+  }
+  double expected[5], actual[5];
+  CorrelationSumsScalar(image1, image2, expected);
+  CorrelationSums(image1, image2, actual);
+  for (int k = 0; k < 5; ++k) {
+    EXPECT_NEAR(expected[k], actual[k], 1e-9);
+  }
+}
+
+TEST(Correlation, PearsonProductMomentCorrelationGolden) {
+  FloatImage image(5, 5), same(5, 5), inverted(5, 5);
+  for (int r = 0; r < 5; ++r) {
+    for (int c = 0; c < 5; ++c) {
+      image(r, c) = (r * 5 + c) % 7;
+      same(r, c) = 2 * image(r, c) + 1;
+      inverted(r, c) = -image(r, c);
+    }
+  }
+  EXPECT_NEAR(1.0, PearsonProductMomentCorrelation(image, same), 1e-9);
+  EXPECT_NEAR(-1.0, PearsonProductMomentCorrelation(image, inverted), 1e-9);
+}
+
+#ifdef __SSE2__
+// The brute force translation search of the region tracker evaluates this
+// kernel for every row of every shift: the SSE2 version must be faster than
+// the scalar one.
+TEST(Correlation, MaskedSumOfAbsoluteDifferencesIsFasterThanScalar) {
+  const int size = 64;
+  const int iterations = 200000;
+  std::vector<float> mask, pattern, image;
+  FillRows(size, &mask, &pattern, &image);
+
+  double scalar_sad = 0;
+  clock_t start = clock();
+  for (int k = 0; k < iterations; ++k) {
+    scalar_sad += MaskedSumOfAbsoluteDifferencesScalar(&mask[0], &pattern[0],
+                                                       &image[0],
+                                                       1.0f + k % 3, size);
+  }
+  const double scalar_seconds = double(clock() - start) / CLOCKS_PER_SEC;
+
+  double sad = 0;
+  start = clock();
+  for (int k = 0; k < iterations; ++k) {
+    sad += MaskedSumOfAbsoluteDifferences(&mask[0], &pattern[0], &image[0],
+                                          1.0f + k % 3, size);
+  }
+  const double seconds = double(clock() - start) / CLOCKS_PER_SEC;
+
+  LG << "Masked SAD: scalar " << scalar_seconds << "s, SSE2 " << seconds
+     << "s.";
+  EXPECT_NEAR(scalar_sad, sad, 1e-4 * scalar_sad);
+  EXPECT_LT(seconds, scalar_seconds);
+}
+#endif
+
+}  // namespace
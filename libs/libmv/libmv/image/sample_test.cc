@@ -86,4 +86,56 @@ TEST(Image, DownsampleBy2MultiChannel) {
   EXPECT_FLOAT_EQ((5+6+7+8)/4.,    resampled_image(0, 0, 1));
   EXPECT_FLOAT_EQ((9+10+11+12)/4., resampled_image(0, 0, 2));
 }
+
+// SamplePattern() shares the interpolation weights between samples, it must
+// give exactly the same result as sampling each pixel with SampleLinear(),
+// including on the borders of the image.
+TEST(Image, SamplePatternMatchesSampleLinear) {
+  Array3Df image(23, 31, 3);
+  for (int r = 0; r < image.Height(); ++r) {
+    for (int c = 0; c < image.Width(); ++c) {
+      for (int i = 0; i < image.Depth(); ++i) {
+        image(r, c, i) = (r * 7 + c * 13 + i * 5) % 17 / 17.0f;
+      }
+    }
+  }
+
+  const double centers[][2] = { { 15.3, 11.7 }, { 0.25, 0.5 },
+                                { 29.9, 21.1 }, { -2.4, 25.6 } };
+  const int half_width = 5;
+  for (int k = 0; k < 4; ++k) {
+    const double x = centers[k][0];
+    const double y = centers[k][1];
+    FloatImage sampled;
+    SamplePattern(image, x, y, half_width, 3, &sampled);
+    ASSERT_EQ(2 * half_width + 1, sampled.Height());
+    ASSERT_EQ(2 * half_width + 1, sampled.Width());
+    ASSERT_EQ(3, sampled.Depth());
+    for (int r = -half_width; r <= half_width; ++r) {
+      for (int c = -half_width; c <= half_width; ++c) {
+        for (int i = 0; i < 3; ++i) {
+          EXPECT_EQ(SampleLinear(image, y + r, x + c, i),
+                    sampled(r + half_width, c + half_width, i));
+        }
+      }
+    }
+  }
+}
+
+// Only the first channels of the image are sampled.
+TEST(Image, SamplePatternFewerChannels) {
+  Array3Df image(8, 8, 3);
+  image.Fill(1.0f);
+  for (int r = 0; r < 8; ++r) {
+    for (int c = 0; c < 8; ++c) {
+      image(r, c, 0) = c;
+    }
+  }
+  FloatImage sampled;
+  SamplePattern(image, 3.5, 3.0, 1, 1, &sampled);
+  ASSERT_EQ(1, sampled.Depth());
+  EXPECT_FLOAT_EQ(2.5, sampled(1, 0, 0));
+  EXPECT_FLOAT_EQ(3.5, sampled(1, 1, 0));
+  EXPECT_FLOAT_EQ(4.5, sampled(1, 2, 0));
+}
 }  // namespace
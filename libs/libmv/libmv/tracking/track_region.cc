@@ -36,6 +36,7 @@
 #include "ceres/ceres.h"
 #include "libmv/logging/logging.h"
 #include "libmv/image/image.h"
+#include "libmv/image/correlation.h"
 #include "libmv/image/sample.h"
 #include "libmv/image/convolve.h"
 #include "libmv/multiview/homography.h"
@@ -1223,8 +1224,9 @@ bool BruteTranslationOnlyInitialize(const FloatImage &image1,
     pattern *= inverse_pattern_mean;
   }
 
-  // Use Eigen on the images via maps for strong vectorization.
-  Map<const FloatArray> search(image2.Data(), image2.Height(), image2.Width());
+  // The rows of the search image are read in place.
+  const float *search = image2.Data();
+  const int search_stride = image2.Width();
 
   // Try all possible locations inside the search area. Yes, everywhere.
   //
@@ -1246,20 +1248,30 @@ bool BruteTranslationOnlyInitialize(const FloatImage &image1,
 
   for (int r = 0; r < (image2.Height() - h); ++r) {
     for (int c = 0; c < (image2.Width() - w); ++c) {
-      // Compute the weighted sum of absolute differences, Eigen style. Note
-      // that the block from the search image is never stored in a variable, to
-      // avoid copying overhead and permit inlining.
-      double sad;
+      // Compute the weighted sum of absolute differences with the SSE2
+      // kernels of correlation.h, reading the rows of the pattern, the mask
+      // and the search area in place.
+      //
+      // The sum is accumulated one pattern row at a time so that the shift
+      // can be rejected as soon as it cannot beat the best one found so far:
+      // most shifts are far from the match and only a few rows are visited.
+      double sad = 0;
+      float scale = 1.0f;
       if (use_normalized_intensities) {
         // TODO(keir): It's really dumb to recompute the search mean for every
         // shift. A smarter implementation would use summed area tables
         // instead, reducing the mean calculation to an O(1) operation.
-        double inverse_search_mean =
-            mask_sum / ((mask * search.block(r, c, h, w)).sum());
-        sad = (mask * (pattern - (search.block(r, c, h, w) *
-                                  inverse_search_mean))).abs().sum();
-      } else {
-        sad = (mask * (pattern - search.block(r, c, h, w))).abs().sum();
+        double masked_search_sum = 0;
+        for (int i = 0; i < h; ++i) {
+          const float *search_row = search + (r + i) * search_stride + c;
+          masked_search_sum += MaskedSum(&mask(i, 0), search_row, w);
+        }
+        scale = mask_sum / masked_search_sum;
+      }
+      for (int i = 0; i < h && sad < best_sad; ++i) {
+        const float *search_row = search + (r + i) * search_stride + c;
+        sad += MaskedSumOfAbsoluteDifferences(&mask(i, 0), &pattern(i, 0),
+                                              search_row, scale, w);
       }
       if (sad < best_sad) {
         best_r = r;
@@ -1302,13 +1314,29 @@ void CopyQuad(double *src_x, double *src_y,
 
 }  // namespace
 
+namespace {
+
+// The blurred images and their derivatives only depend on the input images
+// and on sigma: when the refinement is attempted before the brute
+// initialization and fails, the second attempt reuses them.
+struct BlurredImagesAndDerivatives {
+  BlurredImagesAndDerivatives() : computed(false) {}
+
+  Array3Df image_and_gradient1;
+  Array3Df image_and_gradient2;
+  bool computed;
+};
+
+}  // namespace
+
 template<typename Warp>
 void TemplatedTrackRegion(const FloatImage &image1,
                           const FloatImage &image2,
                           const double *x1, const double *y1,
                           const TrackRegionOptions &options,
                           double *x2, double *y2,
-                          TrackRegionResult *result) {
+                          TrackRegionResult *result,
+                          BlurredImagesAndDerivatives *blurred) {
   for (int i = 0; i < 4 + options.num_extra_points; ++i) {
     LG << "P" << i << ": (" << x1[i] << ", " << y1[i] << "); guess ("
        << x2[i] << ", " << y2[i] << "); (dx, dy): (" << (x2[i] - x1[i]) << ", "
@@ -1329,7 +1357,7 @@ void TemplatedTrackRegion(const FloatImage &image1,
 
     TemplatedTrackRegion<Warp>(image1, image2,
                                x1, y1, modified_options,
-                               x2_first_try, y2_first_try, result);
+                               x2_first_try, y2_first_try, result, blurred);
 
     // Of the things that can happen in the first pass, don't try the brute
     // pass (and second attempt) if the error is one of the terminations below.
@@ -1371,12 +1399,15 @@ void TemplatedTrackRegion(const FloatImage &image1,
   }
 
   // Prepare the image and gradient.
-  Array3Df image_and_gradient1;
-  Array3Df image_and_gradient2;
-  BlurredImageAndDerivativesChannels(image1, options.sigma,
-                                     &image_and_gradient1);
-  BlurredImageAndDerivativesChannels(image2, options.sigma,
-                                     &image_and_gradient2);
+  if (!blurred->computed) {
+    BlurredImageAndDerivativesChannels(image1, options.sigma,
+                                       &blurred->image_and_gradient1);
+    BlurredImageAndDerivativesChannels(image2, options.sigma,
+                                       &blurred->image_and_gradient2);
+    blurred->computed = true;
+  }
+  const Array3Df &image_and_gradient1 = blurred->image_and_gradient1;
+  const Array3Df &image_and_gradient2 = blurred->image_and_gradient2;
 
   // Possibly do a brute-force translation-only initialization.
   if (SearchAreaTooBigForDescent(image2, x2, y2) &&
@@ -1535,13 +1566,15 @@ void TrackRegion(const FloatImage &image1,
                  double *x2, double *y2,
                  TrackRegionResult *result) {
   // Enum is necessary due to templated nature of autodiff.
+  BlurredImagesAndDerivatives blurred;
 #define HANDLE_MODE(mode_enum, mode_type) \
   if (options.mode == TrackRegionOptions::mode_enum) { \
     TemplatedTrackRegion<mode_type>(image1, image2, \
                                     x1, y1, \
                                     options, \
                                     x2, y2, \
-                                    result); \
+                                    result, \
+                                    &blurred); \
     return; \
   }
   HANDLE_MODE(TRANSLATION,                TranslationWarp);
@@ -0,0 +1,128 @@
+// Copyright (c) 2016 libmv authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "libmv/tracking/track_region.h"
+#include "libmv/image/image.h"
+#include "testing/testing.h"
+
+namespace libmv {
+namespace {
+
+// Draw a smooth blob centered at x, y with the given peak intensity.
+void DrawBlob(double x, double y, float intensity, FloatImage *image) {
+  for (int r = 0; r < image->Height(); ++r) {
+    for (int c = 0; c < image->Width(); ++c) {
+      double d2 = (c - x) * (c - x) + (r - y) * (r - y);
+      (*image)(r, c) += intensity * exp(-d2 / 18.0);
+    }
+  }
+}
+
+// Pattern quad of the given half size centered at x, y.
+void MakeQuad(double x, double y, double half_size, double *xs, double *ys) {
+  xs[0] = x - half_size; ys[0] = y - half_size;
+  xs[1] = x + half_size; ys[1] = y - half_size;
+  xs[2] = x + half_size; ys[2] = y + half_size;
+  xs[3] = x - half_size; ys[3] = y + half_size;
+}
+
+void TrackShiftedBlob(bool use_normalized_intensities,
+                      float intensity2,
+                      bool attempt_refine_before_brute) {
+  const double x0 = 30, y0 = 28;
+  const double dx = 7, dy = -5;
+
+  FloatImage image1(64, 64);
+  FloatImage image2(64, 64);
+  image1.Fill(0.1f);
+  image2.Fill(0.1f);
+  DrawBlob(x0, y0, 1.0f, &image1);
+  DrawBlob(x0 + dx + 8, y0 + dy + 12, 0.3f, &image1);
+  DrawBlob(x0 + dx, y0 + dy, intensity2, &image2);
+  DrawBlob(x0 + dx + 8, y0 + dy + 12, 0.3f * intensity2, &image2);
+
+  double x1[4], y1[4], x2[4], y2[4];
+  MakeQuad(x0, y0, 8, x1, y1);
+  // No prediction: the brute initialization has to find the shift.
+  MakeQuad(x0, y0, 8, x2, y2);
+
+  TrackRegionOptions options;
+  options.mode = TrackRegionOptions::TRANSLATION;
+  options.use_normalized_intensities = use_normalized_intensities;
+  options.attempt_refine_before_brute = attempt_refine_before_brute;
+
+  TrackRegionResult result;
+  TrackRegion(image1, image2, x1, y1, options, x2, y2, &result);
+
+  EXPECT_TRUE(result.is_usable());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NEAR(x1[i] + dx, x2[i], 0.05);
+    EXPECT_NEAR(y1[i] + dy, y2[i], 0.05);
+  }
+}
+
+TEST(TrackRegion, BruteInitializationFindsLargeShift) {
+  TrackShiftedBlob(false, 1.0f, false);
+}
+
+TEST(TrackRegion, RefineBeforeBruteFindsLargeShift) {
+  // The first refinement attempt fails and the blurred images are reused by
+  // the brute initialization.
+  TrackShiftedBlob(false, 1.0f, true);
+}
+
+TEST(TrackRegion, NormalizedIntensitiesFindsLargeShift) {
+  TrackShiftedBlob(true, 0.6f, true);
+}
+
+// A large shift over a low contrast texture: many shifts have a close score,
+// so the early rejection of the brute force search must not discard the
+// correct one.
+TEST(TrackRegion, BruteInitializationLowContrastLargeSearchArea) {
+  const int size = 160;
+  FloatImage image1(size, size);
+  FloatImage image2(size, size);
+  image1.Fill(0.f);
+  image2.Fill(0.f);
+  for (int r = 0; r < size; ++r) {
+    for (int c = 0; c < size; ++c) {
+      // Low contrast texture so that many shifts are plausible.
+      image1(r, c) = image2(r, c) = 0.05f * ((r * 31 + c * 17) % 7) / 7.0f;
+    }
+  }
+  DrawBlob(80, 80, 1.0f, &image1);
+  DrawBlob(80 + 23, 80 - 31, 1.0f, &image2);
+
+  double x1[4], y1[4], x2[4], y2[4];
+  MakeQuad(80, 80, 10, x1, y1);
+  MakeQuad(80, 80, 10, x2, y2);
+
+  TrackRegionOptions options;
+  options.attempt_refine_before_brute = false;
+  TrackRegionResult result;
+  TrackRegion(image1, image2, x1, y1, options, x2, y2, &result);
+
+  EXPECT_TRUE(result.is_usable());
+  EXPECT_NEAR(80 + 23, (x2[0] + x2[2]) / 2, 0.1);
+  EXPECT_NEAR(80 - 31, (y2[0] + y2[2]) / 2, 0.1);
+}
+
+}  // namespace
+}  // namespace libmv
@@ -0,0 +1,139 @@
+# -*- coding: utf-8 -*-
+# This file is part of Natron <http://www.natron.fr/>,
+# Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+#
+# Natron is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+
+# Performance benchmarks, to be run from the Script Editor of Natron (or with NatronRenderer -t for the ones that do
+# not need the GUI):
+#   execfile("/path/to/tools/utils/benchmarks.py")
+#
+#   runNodeGraphBenchmark(app, nNodes=10000)
+#     Measures the frame time of the Node Graph on a synthetic graph made of columns of Merge nodes (or Dot nodes if the
+#     Merge plug-in is not available), each node being connected to the node above it and to a node of the previous
+#     column. The Node Graph is zoomed at several levels of detail and panned across the graph, and the time to repaint
+#     it synchronously is reported for each zoom level. Needs the GUI.
+#
+#   runOrderedWriterBenchmark(app, "/tmp/natronBenchmark", nFrames=100)
+#     Measures the throughput of a writer that can only encode frames in order (a movie encoder) compared to a writer of
+#     image sequences which accepts frames in any order. The graph rendered is a CheckerBoard followed by a Blur, so that
+#     the frames are expensive to render compared to encoding them. The input of the movie writer is rendered ahead by
+#     all render threads while the frames are encoded in order, hence both writers should report a similar number of
+#     frames per second on a machine with several cores.
+
+import os
+import time
+
+from NatronEngine import *
+
+def _timeCall(func, *args):
+    start = time.time()
+    ret = func(*args)
+    return (time.time() - start, ret)
+
+def _report(benchmark, message):
+    print("%s: %s" % (benchmark, message))
+
+def _fps(nFrames, elapsed):
+    return nFrames / max(elapsed, 1e-6)
+
+
+# Node Graph
+
+def _findNodeGraphView():
+    from PySide.QtGui import QApplication, QGraphicsView
+    for w in QApplication.instance().allWidgets():
+        if w.metaObject().className().endswith("NodeGraph") and isinstance(w, QGraphicsView) and w.isVisible():
+            return w
+    return None
+
+def createSyntheticGraph(app, nNodes, nodesPerColumn=100, spacing=150):
+    nodes = []
+    for i in range(nNodes):
+        node = app.createNode("net.sf.openfx.MergePlugin")
+        if node is None:
+            node = app.createNode("fr.inria.built-in.Dot")
+        column = i // nodesPerColumn
+        row = i % nodesPerColumn
+        node.setPosition(column * spacing * 2, row * spacing)
+        if row > 0:
+            node.connectInput(0, nodes[i - 1])
+        if column > 0 and node.getMaxInputCount() > 1:
+            node.connectInput(1, nodes[i - nodesPerColumn])
+        nodes.append(node)
+    return nodes
+
+def _panAndRepaint(view, nFrames):
+    # Pan across the graph and repaint synchronously at each step
+    for i in range(nFrames):
+        view.translate(10, 5)
+        view.viewport().repaint()
+
+def runNodeGraphBenchmark(app, nNodes=10000, zoomLevels=(1., 0.3, 0.1, 0.03), nFrames=50):
+    benchmark = "nodeGraphBenchmark"
+    view = _findNodeGraphView()
+    if view is None:
+        _report(benchmark, "the Node Graph must be visible")
+        return
+
+    (elapsed, nodes) = _timeCall(createSyntheticGraph, app, nNodes)
+    _report(benchmark, "created %d nodes in %.2f s" % (nNodes, elapsed))
+
+    for zoom in zoomLevels:
+        view.resetTransform()
+        view.scale(zoom, zoom)
+        # The first repaint also renders the navigator entirely
+        (firstFrame, ret) = _timeCall(view.viewport().repaint)
+        (elapsed, ret) = _timeCall(_panAndRepaint, view, nFrames)
+        frameTime = elapsed / nFrames
+        _report(benchmark, "zoom %.2f: first frame %.1f ms, %.1f ms per frame (%.1f fps)" %
+                (zoom, firstFrame * 1000., frameTime * 1000., _fps(nFrames, elapsed)))
+
+
+# Ordered writers
+
+def _createWriterInputGraph(app, size=2048):
+    source = app.createNode("net.sf.openfx.CheckerBoardPlugin")
+    if source is None:
+        _report("orderedWriterBenchmark", "the CheckerBoard plug-in is required")
+        return None
+    blur = app.createNode("net.sf.cimg.CImgBlur")
+    if blur is None:
+        return source
+    blur.connectInput(0, source)
+    blur.getParam("size").setValue(size / 50., 0)
+    blur.getParam("size").setValue(size / 50., 1)
+    return blur
+
+def _renderBlocking(app, writer, firstFrame, lastFrame):
+    # In the GUI, render() returns as soon as the render is started
+    if hasattr(app, "renderBlocking"):
+        app.renderBlocking(writer, firstFrame, lastFrame)
+    else:
+        app.render(writer, firstFrame, lastFrame)
+
+def _timeWriter(app, inputNode, filename, firstFrame, lastFrame):
+    writer = app.createNode("fr.inria.built-in.Write")
+    writer.connectInput(0, inputNode)
+    writer.getParam("filename").setValue(filename)
+    (elapsed, ret) = _timeCall(_renderBlocking, app, writer, firstFrame, lastFrame)
+    writer.destroy()
+    return elapsed
+
+def runOrderedWriterBenchmark(app, outputDir, nFrames=100):
+    if not os.path.isdir(outputDir):
+        os.makedirs(outputDir)
+
+    inputNode = _createWriterInputGraph(app)
+    if inputNode is None:
+        return
+
+    writers = (("image sequence (any order)", os.path.join(outputDir, "frames_####.exr")),
+               ("movie (in order)", os.path.join(outputDir, "movie.mov")))
+    for (name, filename) in writers:
+        elapsed = _timeWriter(app, inputNode, filename, 1, nFrames)
+        _report("orderedWriterBenchmark", "%s: %d frames in %.2f s (%.1f fps)" %
+                (name, nFrames, elapsed, _fps(nFrames, elapsed)))